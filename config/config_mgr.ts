@@ -12,6 +12,9 @@ export interface ConfigMgr {
     entry: string;
     startSection: boolean;
     dumpSemanticTree: boolean;
+    keepUnusedBuiltins: boolean;
+    byteDataView: boolean;
+    simpleLibdyntype: boolean;
 }
 
 const defaultConfig: ConfigMgr = {
@@ -23,6 +26,9 @@ const defaultConfig: ConfigMgr = {
     entry: '_entry',
     startSection: false,
     dumpSemanticTree: false,
+    keepUnusedBuiltins: false,
+    byteDataView: false,
+    simpleLibdyntype: false,
 };
 
 let currentConfig: ConfigMgr = { ...defaultConfig };
@@ -23,6 +23,8 @@
 #include <signal.h>
 #include <unistd.h>
 #include <strings.h>
+#include <errno.h>
+#include <sys/uio.h>
 
 #include "runtime_lib.h"
 #include "runtime_timer.h"
@@ -34,6 +36,7 @@
 #include "module_wasm_app.h"
 #include "wasm_export.h"
 #include "libdyntype_export.h"
+#include "send_queue.h"
 
 #define MAX 2048
 
@@ -69,6 +72,20 @@ get_lib_array_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
 extern uint32_t
 get_lib_timer_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
 
+extern uint32_t
+get_lib_math_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
+
+extern uint32_t
+get_lib_dataview_symbols(char **p_module_name,
+                         NativeSymbol **p_native_symbols);
+
+extern uint32_t
+get_lib_collection_symbols(char **p_module_name,
+                           NativeSymbol **p_native_symbols);
+
+extern uint32_t
+get_lib_number_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
+
 extern uint32_t
 get_struct_indirect_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
 
@@ -80,6 +97,8 @@ dyntype_callback_wasm_dispatcher(void *exec_env_v, dyn_ctx_t ctx, void *vfunc,
 #ifndef CONNECTION_UART
 int listenfd = -1;
 int sockfd = -1;
+/* guards sockfd against being closed or replaced while the writer thread of
+ * the send queue writes to it */
 static pthread_mutex_t sock_lock = PTHREAD_MUTEX_INITIALIZER;
 #else
 int uartfd = -1;
@@ -97,8 +116,12 @@ func(void *arg)
     struct sockaddr_in servaddr;
 
     while (1) {
-        if (sockfd != -1)
+        if (sockfd != -1) {
+            pthread_mutex_lock(&sock_lock);
             close(sockfd);
+            sockfd = -1;
+            pthread_mutex_unlock(&sock_lock);
+        }
         // socket create and verification
         sockfd = socket(AF_INET, SOCK_STREAM, 0);
         if (sockfd == -1) {
@@ -144,35 +167,46 @@ func(void *arg)
     close(sockfd);
 }
 
+/* Called by the writer thread of the send queue only, once per batch */
+static int
+sock_writev(const struct iovec *iov, int iovcnt)
+{
+    int ret;
+
+    pthread_mutex_lock(&sock_lock);
+    if (sockfd == -1) {
+        errno = ENOTCONN;
+        ret = -1;
+    }
+    else {
+        ret = writev(sockfd, iov, iovcnt);
+    }
+    pthread_mutex_unlock(&sock_lock);
+
+    return ret;
+}
+
 static bool
 host_init()
 {
-    return true;
+    return send_queue_init(sock_writev);
 }
 
 int
 host_send(void *ctx, const char *buf, int size)
 {
-    int ret;
-
-    if (pthread_mutex_trylock(&sock_lock) == 0) {
-        if (sockfd == -1) {
-            pthread_mutex_unlock(&sock_lock);
-            return 0;
-        }
-
-        ret = write(sockfd, buf, size);
-
-        pthread_mutex_unlock(&sock_lock);
-        return ret;
-    }
+    /* dropped until the host connects */
+    if (sockfd == -1)
+        return 0;
 
-    return -1;
+    return send_queue_push(buf, size);
 }
 
 void
 host_destroy()
 {
+    send_queue_destroy();
+
     if (server_mode)
         close(listenfd);
 
@@ -195,7 +229,7 @@ host_interface interface = {
 void *
 func_server_mode(void *arg)
 {
-    int clilent;
+    int clilent, connfd;
     struct sockaddr_in serv_addr, cli_addr;
     int n;
     char buff[MAX];
@@ -231,10 +265,11 @@ func_server_mode(void *arg)
     clilent = sizeof(cli_addr);
 
     while (1) {
-        pthread_mutex_lock(&sock_lock);
-
-        sockfd = accept(listenfd, (struct sockaddr *)&cli_addr, &clilent);
+        /* the writer thread doesn't wait for the accept */
+        connfd = accept(listenfd, (struct sockaddr *)&cli_addr, &clilent);
 
+        pthread_mutex_lock(&sock_lock);
+        sockfd = connfd;
         pthread_mutex_unlock(&sock_lock);
 
         if (sockfd < 0) {
@@ -378,23 +413,33 @@ func_uart_mode(void *arg)
 }
 
 static int
-uart_send(void *ctx, const char *buf, int size)
+uart_writev(const struct iovec *iov, int iovcnt)
 {
-    int ret;
+    return writev(uartfd, iov, iovcnt);
+}
 
-    ret = write(uartfd, buf, size);
+static bool
+uart_host_init()
+{
+    return send_queue_init(uart_writev);
+}
 
-    return ret;
+static int
+uart_send(void *ctx, const char *buf, int size)
+{
+    return send_queue_push(buf, size);
 }
 
 static void
 uart_destroy()
 {
+    send_queue_destroy();
     close(uartfd);
 }
 
 /* clang-format off */
 static host_interface interface = {
+    .init = uart_host_init,
     .send = uart_send,
     .destroy = uart_destroy
 };
@@ -576,6 +621,34 @@ iwasm_main(int argc, char *argv[])
         goto fail1;
     }
 
+    symbol_count = get_lib_math_symbols(&module_name, &native_symbols);
+    if (!wasm_runtime_register_natives(module_name, native_symbols,
+                                       symbol_count)) {
+        printf("Register stdlib APIs failed.\n");
+        goto fail1;
+    }
+
+    symbol_count = get_lib_dataview_symbols(&module_name, &native_symbols);
+    if (!wasm_runtime_register_natives(module_name, native_symbols,
+                                       symbol_count)) {
+        printf("Register stdlib APIs failed.\n");
+        goto fail1;
+    }
+
+    symbol_count = get_lib_collection_symbols(&module_name, &native_symbols);
+    if (!wasm_runtime_register_natives(module_name, native_symbols,
+                                       symbol_count)) {
+        printf("Register stdlib APIs failed.\n");
+        goto fail1;
+    }
+
+    symbol_count = get_lib_number_symbols(&module_name, &native_symbols);
+    if (!wasm_runtime_register_natives(module_name, native_symbols,
+                                       symbol_count)) {
+        printf("Register stdlib APIs failed.\n");
+        goto fail1;
+    }
+
     symbol_count = get_struct_indirect_symbols(&module_name, &native_symbols);
     if (!wasm_runtime_register_natives(module_name, native_symbols,
                                        symbol_count)) {
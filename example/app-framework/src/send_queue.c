@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* A bounded multi-producer single-consumer ring: every slot carries a
+ * sequence number telling whether it is free for the producer claiming
+ * position pos (seq == pos), or filled and ready for the consumer
+ * (seq == pos + 1). Producers claim positions with a CAS on the tail and
+ * never wait for each other, the writer thread only sleeps when the ring is
+ * empty. */
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bh_platform.h"
+#include "send_queue.h"
+
+/* must be a power of 2 */
+#define SEND_QUEUE_SIZE 1024
+/* app manager messages are sent as a few header pieces and the payload,
+ * headers fit in the slot, payloads larger than that are copied to the
+ * heap */
+#define SEND_SLOT_INLINE_SIZE 128
+/* far below IOV_MAX */
+#define SEND_BATCH_MAX 64
+
+typedef struct SendSlot {
+    atomic_size_t seq;
+    int size;
+    char *data;
+    char inline_data[SEND_SLOT_INLINE_SIZE];
+} SendSlot;
+
+typedef struct SendQueue {
+    SendSlot slots[SEND_QUEUE_SIZE];
+    /* the next position claimed by a producer */
+    atomic_size_t tail;
+    /* the next position taken by the writer, only the writer uses it */
+    size_t head;
+    /* set while the writer sleeps, producers only signal it then */
+    atomic_bool writer_waiting;
+    atomic_bool stopping;
+    korp_mutex lock;
+    korp_cond cond;
+    korp_tid writer;
+    send_queue_write_func_t write_func;
+} SendQueue;
+
+static SendQueue send_queue;
+
+static inline SendSlot *
+queue_slot(SendQueue *queue, size_t pos)
+{
+    return &queue->slots[pos & (SEND_QUEUE_SIZE - 1)];
+}
+
+static bool
+slot_is_ready(SendQueue *queue, size_t pos)
+{
+    SendSlot *slot = queue_slot(queue, pos);
+
+    return atomic_load_explicit(&slot->seq, memory_order_acquire) == pos + 1;
+}
+
+int
+send_queue_push(const char *buf, int size)
+{
+    SendQueue *queue = &send_queue;
+    SendSlot *slot;
+    char *heap_data = NULL;
+    size_t pos, seq;
+
+    if (size <= 0) {
+        return 0;
+    }
+    /* allocated before claiming a slot, a claimed slot must be filled */
+    if (size > SEND_SLOT_INLINE_SIZE && !(heap_data = malloc(size))) {
+        return -1;
+    }
+
+    pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    for (;;) {
+        slot = queue_slot(queue, pos);
+        seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq == pos) {
+            if (atomic_compare_exchange_weak_explicit(
+                    &queue->tail, &pos, pos + 1, memory_order_relaxed,
+                    memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if ((intptr_t)(seq - pos) < 0) {
+            /* the writer is a whole ring behind */
+            free(heap_data);
+            return -1;
+        }
+        else {
+            pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
+
+    slot->data = heap_data ? heap_data : slot->inline_data;
+    slot->size = size;
+    memcpy(slot->data, buf, size);
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+
+    /* pairs with the fence of the writer going to sleep: either it sees the
+     * slot, or this thread sees it waiting */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&queue->writer_waiting, memory_order_relaxed)) {
+        os_mutex_lock(&queue->lock);
+        os_cond_signal(&queue->cond);
+        os_mutex_unlock(&queue->lock);
+    }
+
+    return size;
+}
+
+/* The buffers of a batch the connection can't take are dropped, as a send
+ * failing under the old lock was */
+static void
+write_batch(SendQueue *queue, struct iovec *iov, int iovcnt)
+{
+    int n;
+
+    while (iovcnt > 0) {
+        if ((n = queue->write_func(iov, iovcnt)) <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        /* skip what was written, a short write leaves the rest of a buffer */
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= (int)iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+}
+
+static void *
+writer_thread(void *arg)
+{
+    SendQueue *queue = (SendQueue *)arg;
+    struct iovec iov[SEND_BATCH_MAX];
+    int count, i;
+
+    for (;;) {
+        for (count = 0; count < SEND_BATCH_MAX; count++) {
+            SendSlot *slot;
+
+            if (!slot_is_ready(queue, queue->head + count)) {
+                break;
+            }
+            slot = queue_slot(queue, queue->head + count);
+            iov[count].iov_base = slot->data;
+            iov[count].iov_len = slot->size;
+        }
+
+        if (count == 0) {
+            /* the queue is flushed before the writer stops */
+            if (atomic_load(&queue->stopping)) {
+                break;
+            }
+            os_mutex_lock(&queue->lock);
+            atomic_store_explicit(&queue->writer_waiting, true,
+                                  memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+            if (!slot_is_ready(queue, queue->head)
+                && !atomic_load(&queue->stopping)) {
+                os_cond_wait(&queue->cond, &queue->lock);
+            }
+            atomic_store_explicit(&queue->writer_waiting, false,
+                                  memory_order_relaxed);
+            os_mutex_unlock(&queue->lock);
+            continue;
+        }
+
+        write_batch(queue, iov, count);
+
+        /* hand the slots back to the producers */
+        for (i = 0; i < count; i++, queue->head++) {
+            SendSlot *slot = queue_slot(queue, queue->head);
+
+            if (slot->data != slot->inline_data) {
+                free(slot->data);
+            }
+            atomic_store_explicit(&slot->seq, queue->head + SEND_QUEUE_SIZE,
+                                  memory_order_release);
+        }
+    }
+
+    return NULL;
+}
+
+bool
+send_queue_init(send_queue_write_func_t write_func)
+{
+    SendQueue *queue = &send_queue;
+    size_t i;
+
+    for (i = 0; i < SEND_QUEUE_SIZE; i++) {
+        atomic_init(&queue->slots[i].seq, i);
+    }
+    atomic_init(&queue->tail, 0);
+    queue->head = 0;
+    atomic_init(&queue->writer_waiting, false);
+    atomic_init(&queue->stopping, false);
+    queue->write_func = write_func;
+
+    if (os_mutex_init(&queue->lock) != BHT_OK) {
+        return false;
+    }
+    if (os_cond_init(&queue->cond) != BHT_OK) {
+        os_mutex_destroy(&queue->lock);
+        return false;
+    }
+    if (os_thread_create(&queue->writer, writer_thread, queue,
+                         BH_APPLET_PRESERVED_STACK_SIZE)
+        != BHT_OK) {
+        os_cond_destroy(&queue->cond);
+        os_mutex_destroy(&queue->lock);
+        return false;
+    }
+    return true;
+}
+
+void
+send_queue_destroy(void)
+{
+    SendQueue *queue = &send_queue;
+
+    os_mutex_lock(&queue->lock);
+    atomic_store(&queue->stopping, true);
+    os_cond_signal(&queue->cond);
+    os_mutex_unlock(&queue->lock);
+
+    os_thread_join(queue->writer, NULL);
+    os_cond_destroy(&queue->cond);
+    os_mutex_destroy(&queue->lock);
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef __SEND_QUEUE_H_
+#define __SEND_QUEUE_H_
+
+#include <stdbool.h>
+#include <sys/uio.h>
+
+/* Writes a batch to the connection, returns the bytes written, or -1 if the
+ * connection is gone */
+typedef int (*send_queue_write_func_t)(const struct iovec *iov, int iovcnt);
+
+/**
+ * @brief Start the writer thread
+ *
+ * Messages sent by the wasm threads go to a bounded lock-free queue, a single
+ * writer thread takes them in batches and writes each batch with one
+ * writev call.
+ *
+ * @param write_func writes a batch to the connection
+ * @return true if success, false otherwise
+ */
+bool
+send_queue_init(send_queue_write_func_t write_func);
+
+/**
+ * @brief Queue a buffer to be written, from any thread
+ *
+ * The buffer is copied, buffers queued by one thread are written in order.
+ *
+ * @return size if success, -1 if the queue is full or out of memory
+ */
+int
+send_queue_push(const char *buf, int size);
+
+/**
+ * @brief Write the buffers still queued and stop the writer thread
+ */
+void
+send_queue_destroy(void);
+
+#endif /* end of __SEND_QUEUE_H_ */
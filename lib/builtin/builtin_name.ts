@@ -85,6 +85,7 @@ export namespace BuiltinNames {
     export const OBJECT = 'Object';
     export const FUNCTION = 'Function';
     export const CONSOLE = 'console';
+    export const CONSOLE_CLASS = 'Console';
     export const PROMISE = 'Promise';
     export const MAP = 'Map';
     export const SET = 'Set';
@@ -94,6 +95,24 @@ export namespace BuiltinNames {
     export const ARRAYBUFFERCONSTRCTOR = 'ArrayBufferConstructor';
     export const DATAVIEW = 'DataView';
     export const STRINGCONSTRCTOR = 'StringConstructor';
+    export const NUMBERCONSTRCTOR = 'NumberConstructor';
+    export const REGEXP = 'RegExp';
+    export const FLOAT64ARRAY = 'Float64Array';
+    export const FLOAT32ARRAY = 'Float32Array';
+    export const INT32ARRAY = 'Int32Array';
+    export const UINT32ARRAY = 'Uint32Array';
+    export const INT16ARRAY = 'Int16Array';
+    export const UINT8ARRAY = 'Uint8Array';
+    export const UINT8CLAMPEDARRAY = 'Uint8ClampedArray';
+    export const typedArrayNames = [
+        FLOAT64ARRAY,
+        FLOAT32ARRAY,
+        INT32ARRAY,
+        UINT32ARRAY,
+        INT16ARRAY,
+        UINT8ARRAY,
+        UINT8CLAMPEDARRAY,
+    ];
 
     // decorator name
     export const decorator = 'binaryen';
@@ -104,6 +123,83 @@ export namespace BuiltinNames {
     export const mathCeilFuncName = 'Math|ceil';
     export const mathFloorFuncName = 'Math|floor';
     export const mathTruncFuncName = 'Math|trunc';
+    export const mathRoundFuncName = 'Math|round';
+    export const mathSignFuncName = 'Math|sign';
+    export const mathFroundFuncName = 'Math|fround';
+    export const mathHypotFuncName = 'Math|hypot';
+    /* Math methods forwarded to the libm backed natives, the imported
+        native function is named `Math_${name}` */
+    export const mathNativeFuncPrefix = 'Math_';
+    export const mathUnaryNativeMethods = [
+        'exp',
+        'log',
+        'log2',
+        'log10',
+        'sin',
+        'cos',
+        'tan',
+        'asin',
+        'acos',
+        'atan',
+        'cbrt',
+    ];
+    export const mathBinaryNativeMethods = ['pow', 'atan2'];
+    /* Math.hypot is variadic, only the two arguments form is imported */
+    export const mathHypotNativeFuncName = 'Math_hypot';
+    /* natives accessing multi-byte DataView elements in one go */
+    export const dataViewLoad16FuncName = 'dataview_load_i16';
+    export const dataViewLoad32FuncName = 'dataview_load_i32';
+    export const dataViewLoad64FuncName = 'dataview_load_i64';
+    export const dataViewStore16FuncName = 'dataview_store_i16';
+    export const dataViewStore32FuncName = 'dataview_store_i32';
+    export const dataViewStore64FuncName = 'dataview_store_i64';
+    /* hash functions of static Map/Set keys, object keys are hashed by the
+        native since wasm has no identity hash */
+    export const collectionHashNumberFuncName = 'collection_hash_number';
+    export const collectionHashStringFuncName = 'collection_hash_string';
+    export const collectionHashRefFuncName = 'collection_ref_hash';
+    /* natives of the compiled pattern cache, backed by libregexp */
+    export const regExpCompileFuncName = 'regexp_compile';
+    export const regExpCompileDynamicFuncName = 'regexp_compile_dynamic';
+    export const regExpBindFuncName = 'regexp_bind';
+    export const regExpCaptureCountFuncName = 'regexp_capture_count';
+    export const regExpGetFlagsFuncName = 'regexp_get_flags';
+    export const regExpExecFuncName = 'regexp_exec';
+    export const regExpCreateFuncName = 'RegExp|create';
+    export const regExpNewFuncName = 'RegExp|new';
+    /* string to number conversions, backed by the natives of lib_number,
+        the *_cstr natives take the string copied to the linear memory */
+    export const numberParseFloatFuncName = 'NumberConstructor|parseFloat';
+    export const numberParseIntFuncName = 'NumberConstructor|parseInt';
+    export const stringToNumberFuncName = 'String|toNumber';
+    export const numberParseFloatNativeFuncName = 'Number_parseFloat';
+    export const numberParseIntNativeFuncName = 'Number_parseInt';
+    export const numberFromStringNativeFuncName = 'Number_fromString';
+    export const cstrNativeFuncSuffix = '_cstr';
+    /* global parseFloat and parseInt are the same as the Number methods */
+    export const parseFloatName = `${builtinTypeManglePrefix}|parseFloat`;
+    export const parseIntName = `${builtinTypeManglePrefix}|parseInt`;
+    export const builtinDeclaredFuncs = new Map<string, string>([
+        [parseFloatName, numberParseFloatFuncName],
+        [parseIntName, numberParseIntFuncName],
+    ]);
+    /* console calls with number, boolean and string arguments are lowered
+        to one native call per argument, the first argument is the output
+        stream (0: stdout, 1: stderr) */
+    export const consoleStreams = new Map<string, number>([
+        ['log', 0],
+        ['error', 1],
+        ['warn', 1],
+    ]);
+    export const consoleWriteNumberFuncName = 'Console_writeNumber';
+    export const consoleWriteBooleanFuncName = 'Console_writeBoolean';
+    export const consoleWriteStringFuncName = 'Console_writeString';
+    export const consoleWriteStringrefFuncName = 'Console_writeStringref';
+    export const consoleWriteEndFuncName = 'Console_writeEnd';
+    /* String methods taking a RegExp instead of a string */
+    export const stringRegExpMethods = ['match', 'search', 'replace', 'split'];
+    export const stringRegExpFuncSuffix = '_regexp';
+    export const stringMatchAllFuncName = 'String|matchAll';
     export const arrayIsArrayFuncName = 'ArrayConstructor|isArray';
     export const stringConcatFuncName = 'String|concat';
     export const stringSliceFuncName = 'String|slice';
@@ -124,6 +220,7 @@ export namespace BuiltinNames {
     export const anyrefCond = 'anyrefCond';
     export const newExtRef = 'newExtRef';
     export const allocExtRefTableSlot = 'allocExtRefTableSlot';
+    export const freeExtRefTableSlot = 'freeExtRefTableSlot';
     export const extRefTableMaskArr = 'extRefTableMaskArr';
     export const getPropertyIfTypeIdMismatch =
         'get_property_if_typeid_mismatch';
@@ -263,12 +360,16 @@ export namespace BuiltinNames {
     export const builtInObjectTypes = [
         'ArrayBuffer',
         'DataView',
+        'RegExp',
         'ArrayBufferConstructor',
         'Math',
         'Console',
+        /* typed arrays must be matched before Array */
+        ...typedArrayNames,
         'Array',
         'ArrayConstructor',
         'StringConstructor',
+        'NumberConstructor',
     ];
 
     export function getSpecializedFuncName(
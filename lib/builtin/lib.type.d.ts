@@ -118,7 +118,25 @@ type NewableFunction = Function;
 
 interface Object {}
 
-interface RegExp {}
+/* RegExp is compiled by libregexp, the pattern id refers to the bytecode
+ * in the native cache */
+interface RegExp {
+    readonly source: string;
+    readonly flags: string;
+    readonly global: boolean;
+    readonly sticky: boolean;
+    lastIndex: number;
+    readonly pattern_id: i32;
+    readonly capture_count: i32;
+
+    test(str: string): boolean;
+    exec(str: string): string[];
+}
+
+interface RegExpConstructor {
+    new (pattern: string, flags?: string): RegExp;
+}
+declare var RegExp: RegExpConstructor;
 
 interface String {
     readonly length: number;
@@ -126,11 +144,16 @@ interface String {
     slice(start?: number, end?: number): string;
     readonly [index: number]: string;
     replace(from: string, to: string): string;
+    replace(from: RegExp, to: string): string;
     split(sep: string): string[];
+    split(sep: RegExp): string[];
     indexOf(str: string): number;
     lastIndexOf(str: string): number;
     match(pattern: string): string[];
+    match(pattern: RegExp): string[];
+    matchAll(regexp: RegExp): string[][];
     search(pattern: string): number;
+    search(pattern: RegExp): number;
     charAt(index: number): string;
     toLowerCase(): string;
     toUpperCase(): string;
@@ -154,6 +177,24 @@ interface Math {
     abs(x: number): number;
     ceil(x: number): number;
     floor(x: number): number;
+    trunc(x: number): number;
+    round(x: number): number;
+    sign(x: number): number;
+    fround(x: number): number;
+    exp(x: number): number;
+    log(x: number): number;
+    log2(x: number): number;
+    log10(x: number): number;
+    sin(x: number): number;
+    cos(x: number): number;
+    tan(x: number): number;
+    asin(x: number): number;
+    acos(x: number): number;
+    atan(x: number): number;
+    atan2(y: number, x: number): number;
+    cbrt(x: number): number;
+    hypot(...values: number[]): number;
+    random(): number;
 }
 declare var Math: Math;
 
@@ -161,12 +202,27 @@ interface TypedPropertyDescriptor<T> {}
 
 interface Console {
     log(...data: any[]): void;
+    error(...data: any[]): void;
+    warn(...data: any[]): void;
 }
 
 declare var console: Console;
 
+interface Map<K = any, V = any> {
+    readonly size: i32;
+    get(key: K): V;
+    set(key: K, value: V): Map<K, V>;
+    has(key: K): boolean;
+    delete(key: K): boolean;
+    clear(): void;
+    keys(): K[];
+    values(): V[];
+    entries(): [K, V][];
+    forEach(callbackfn: (value: V, key: K, map: Map<K, V>) => void): void;
+}
+
 interface MapConstructor {
-    new (): Map<any, any>;
+    new <K = any, V = any>(): Map<K, V>;
     set(key: any, value: any): void;
     get(key: any): any;
     has(key: any): boolean;
@@ -179,8 +235,18 @@ interface MapConstructor {
 }
 declare var Map: MapConstructor;
 
+interface Set<T = any> {
+    readonly size: i32;
+    add(value: T): Set<T>;
+    has(value: T): boolean;
+    delete(value: T): boolean;
+    clear(): void;
+    values(): T[];
+    forEach(callbackfn: (value: T, value2: T, set: Set<T>) => void): void;
+}
+
 interface SetConstructor {
-    new (): Set<any>;
+    new <T = any>(): Set<T>;
     add(key: any): void;
     has(key: any): boolean;
     delete(key: any): boolean;
@@ -272,6 +338,15 @@ interface Number {
     toString(radix?: number): string;
 }
 
+interface NumberConstructor {
+    (value?: any): number;
+    parseFloat(string: string): number;
+    parseInt(string: string, radix?: number): number;
+}
+declare var Number: NumberConstructor;
+declare function parseFloat(string: string): number;
+declare function parseInt(string: string, radix?: number): number;
+
 interface Object {
     /** Returns a string representation of an object. */
     toString(): string;
@@ -302,6 +377,28 @@ declare function setTimeout(
     ...args: any[]
 ): number;
 declare function clearTimeout(timerid: number): void;
+declare function setInterval(
+    callback: () => void,
+    ms: number,
+    ...args: any[]
+): number;
+declare function clearInterval(timerid: number): void;
+declare function createWorker(entry: string): number;
+declare function workerPostMessage(
+    worker: number,
+    message: any,
+    ...transfer: ArrayBuffer[]
+): void;
+declare function workerOnMessage(
+    worker: number,
+    callback: (message: any) => void,
+): void;
+declare function terminateWorker(worker: number): void;
+declare function postMessage(message: any, ...transfer: ArrayBuffer[]): void;
+declare function onMessage(callback: (message: any) => void): void;
+declare function closeWorker(): void;
+declare function writeHeapSnapshot(path: string): void;
+declare function getGCMemoryInfo(): any;
 
 interface ArrayBuffer {
     readonly backing_store: anyref;
@@ -346,3 +443,104 @@ interface DataViewConstructor {
     ): DataView;
 }
 declare var DataView: DataViewConstructor;
+
+/* Typed arrays are backed by element-typed wasm arrays, subarray creates a
+ * view sharing the backing array */
+interface Float64Array {
+    readonly backing_store: anyref;
+    readonly length: i32;
+    readonly byteOffset: i32;
+
+    fill(value: number, start?: number, end?: number): Float64Array;
+    set(array: Float64Array, offset?: number): void;
+    subarray(begin?: number, end?: number): Float64Array;
+    [index: number]: number;
+}
+interface Float64ArrayConstructor {
+    new (length: number): Float64Array;
+}
+declare var Float64Array: Float64ArrayConstructor;
+interface Float32Array {
+    readonly backing_store: anyref;
+    readonly length: i32;
+    readonly byteOffset: i32;
+
+    fill(value: number, start?: number, end?: number): Float32Array;
+    set(array: Float32Array, offset?: number): void;
+    subarray(begin?: number, end?: number): Float32Array;
+    [index: number]: number;
+}
+interface Float32ArrayConstructor {
+    new (length: number): Float32Array;
+}
+declare var Float32Array: Float32ArrayConstructor;
+interface Int32Array {
+    readonly backing_store: anyref;
+    readonly length: i32;
+    readonly byteOffset: i32;
+
+    fill(value: number, start?: number, end?: number): Int32Array;
+    set(array: Int32Array, offset?: number): void;
+    subarray(begin?: number, end?: number): Int32Array;
+    [index: number]: number;
+}
+interface Int32ArrayConstructor {
+    new (length: number): Int32Array;
+}
+declare var Int32Array: Int32ArrayConstructor;
+interface Uint32Array {
+    readonly backing_store: anyref;
+    readonly length: i32;
+    readonly byteOffset: i32;
+
+    fill(value: number, start?: number, end?: number): Uint32Array;
+    set(array: Uint32Array, offset?: number): void;
+    subarray(begin?: number, end?: number): Uint32Array;
+    [index: number]: number;
+}
+interface Uint32ArrayConstructor {
+    new (length: number): Uint32Array;
+}
+declare var Uint32Array: Uint32ArrayConstructor;
+interface Int16Array {
+    readonly backing_store: anyref;
+    readonly length: i32;
+    readonly byteOffset: i32;
+
+    fill(value: number, start?: number, end?: number): Int16Array;
+    set(array: Int16Array, offset?: number): void;
+    subarray(begin?: number, end?: number): Int16Array;
+    [index: number]: number;
+}
+interface Int16ArrayConstructor {
+    new (length: number): Int16Array;
+}
+declare var Int16Array: Int16ArrayConstructor;
+interface Uint8Array {
+    readonly backing_store: anyref;
+    readonly length: i32;
+    readonly byteOffset: i32;
+
+    fill(value: number, start?: number, end?: number): Uint8Array;
+    set(array: Uint8Array, offset?: number): void;
+    subarray(begin?: number, end?: number): Uint8Array;
+    [index: number]: number;
+}
+interface Uint8ArrayConstructor {
+    new (length: number): Uint8Array;
+}
+declare var Uint8Array: Uint8ArrayConstructor;
+interface Uint8ClampedArray {
+    readonly backing_store: anyref;
+    readonly length: i32;
+    readonly byteOffset: i32;
+
+    fill(value: number, start?: number, end?: number): Uint8ClampedArray;
+    set(array: Uint8ClampedArray, offset?: number): void;
+    subarray(begin?: number, end?: number): Uint8ClampedArray;
+    [index: number]: number;
+}
+interface Uint8ClampedArrayConstructor {
+    new (length: number): Uint8ClampedArray;
+}
+declare var Uint8ClampedArray: Uint8ClampedArrayConstructor;
@@ -8,26 +8,27 @@
  */
 export declare class Console {
     log(...values: any[]): void;
+    error(...values: any[]): void;
+    warn(...values: any[]): void;
 }
 
+/* Other Math methods are implemented in callBuiltInAPIs, and max/min calls
+ * with 2 or 3 arguments are lowered to f64.max/f64.min at the call site, so
+ * only the variadic forms are implemented here.
+ */
 export class Math {
-    pow(x: number, y: number): number {
-        let res = 1;
-        let power = y < 0 ? -y : y;
-        while (power > 0) {
-            res = res * x;
-            power--;
-        }
-        res = y < 0 ? 1 / res : res;
-        return res;
-    }
-
     max(...x: number[]): number {
         const arrLen = x.length;
-        let res = x[0];
-        for (let i = 1; i < arrLen; i++) {
-            if (res < x[i]) {
-                res = x[i];
+        let res = -Infinity;
+        for (let i = 0; i < arrLen; i++) {
+            const value = x[i];
+            /* NaN is propagated */
+            if (value !== value) {
+                return value;
+            }
+            /* +0 is larger than -0, but they compare equal */
+            if (res < value || (value === 0 && res === 0 && 1 / res < 0)) {
+                res = value;
             }
         }
         return res;
@@ -35,10 +36,14 @@ export class Math {
 
     min(...x: number[]): number {
         const arrLen = x.length;
-        let res = x[0];
-        for (let i = 1; i < arrLen; i++) {
-            if (res > x[i]) {
-                res = x[i];
+        let res = Infinity;
+        for (let i = 0; i < arrLen; i++) {
+            const value = x[i];
+            if (value !== value) {
+                return value;
+            }
+            if (res > value || (value === 0 && res === 0 && 1 / value < 0)) {
+                res = value;
             }
         }
         return res;
@@ -47,8 +52,16 @@ export class Math {
 
 export class ArrayBufferConstructor {
     isView(arg: any) {
-        /* workaround: TypedArray is not supported */
-        if (arg instanceof DataView) {
+        if (
+            arg instanceof DataView ||
+            arg instanceof Float64Array ||
+            arg instanceof Float32Array ||
+            arg instanceof Int32Array ||
+            arg instanceof Uint32Array ||
+            arg instanceof Int16Array ||
+            arg instanceof Uint8Array ||
+            arg instanceof Uint8ClampedArray
+        ) {
             return true;
         } else {
             return false;
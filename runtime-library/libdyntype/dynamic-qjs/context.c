@@ -3,10 +3,23 @@
  * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
  */
 
+#include <pthread.h>
+
 #include "type.h"
 #include "pure_dynamic.h"
 
-static dyn_ctx_t g_dynamic_context = NULL;
+static DYNTYPE_THREAD_LOCAL dyn_ctx_t g_dynamic_context = NULL;
+
+/* JS_NewClassID bumps a process wide counter without locking, the extref
+ * class id is allocated once and shared by the contexts of all threads */
+static pthread_once_t extref_class_once = PTHREAD_ONCE_INIT;
+static JSClassID extref_class_id;
+
+static void
+extref_class_id_alloc(void)
+{
+    JS_NewClassID(&extref_class_id);
+}
 
 JSValue *
 dynamic_dup_value(JSContext *ctx, JSValue value)
@@ -23,15 +36,10 @@ dynamic_dup_value(JSContext *ctx, JSValue value)
 /******************* Initialization and destroy *****************/
 
 dyn_ctx_t
-dynamic_context_init()
+dynamic_context_create()
 {
-    JSClassID class_id;
     dyn_ctx_t ctx = NULL;
 
-    if (g_dynamic_context) {
-        return g_dynamic_context;
-    }
-
     ctx = malloc(sizeof(DynTypeContext));
     if (!ctx) {
         return NULL;
@@ -57,12 +65,9 @@ dynamic_context_init()
         goto fail;
     }
 
-    class_id = 0;
-    ctx->extref_class_id = JS_NewClassID(&class_id);
-
-    (void)class_id;
+    pthread_once(&extref_class_once, extref_class_id_alloc);
+    ctx->extref_class_id = extref_class_id;
 
-    g_dynamic_context = ctx;
     return ctx;
 
 fail:
@@ -70,6 +75,21 @@ fail:
     return NULL;
 }
 
+dyn_ctx_t
+dynamic_context_init()
+{
+    if (!g_dynamic_context) {
+        g_dynamic_context = dynamic_context_create();
+    }
+    return g_dynamic_context;
+}
+
+void
+dynamic_context_bind(dyn_ctx_t ctx)
+{
+    g_dynamic_context = ctx;
+}
+
 dyn_ctx_t
 dynamic_context_init_with_opt(dyn_options_t *options)
 {
@@ -96,7 +116,9 @@ dynamic_context_destroy(dyn_ctx_t ctx)
         free(ctx);
     }
 
-    g_dynamic_context = NULL;
+    if (g_dynamic_context == ctx) {
+        g_dynamic_context = NULL;
+    }
 }
 
 dyn_ctx_t
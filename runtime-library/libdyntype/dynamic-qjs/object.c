@@ -1066,6 +1066,24 @@ dynamic_collect(dyn_ctx_t ctx)
     // TODO
 }
 
+/* QuickJS allocates values from its own runtime, arenas are accepted so
+ * that callers don't depend on the backend, but have no effect */
+int
+dynamic_arena_begin(dyn_ctx_t ctx)
+{
+    return DYNTYPE_SUCCESS;
+}
+
+void
+dynamic_arena_end(dyn_ctx_t ctx)
+{}
+
+void
+dynamic_arena_get_stats(dyn_ctx_t ctx, dyntype_arena_stats_t *stats)
+{
+    memset(stats, 0, sizeof(dyntype_arena_stats_t));
+}
+
 /******************* Exception *******************/
 
 dyn_value_t
@@ -23,6 +23,16 @@ dynamic_context_init_with_opt(dyn_options_t *options)
     return g_dynamic_context;
 }
 
+dyn_ctx_t
+dynamic_context_create()
+{
+    return g_dynamic_context;
+}
+
+void
+dynamic_context_bind(dyn_ctx_t ctx)
+{}
+
 void
 dynamic_context_destroy(dyn_ctx_t ctx)
 {}
@@ -58,13 +58,13 @@ DynValue *
 date_constructor(int argc, DynValue *argv[])
 {
     DyntypeDate *dyn_obj =
-        (DyntypeDate *)wasm_runtime_malloc(sizeof(DyntypeDate));
+        (DyntypeDate *)dyn_value_alloc(sizeof(DyntypeDate));
     if (!dyn_obj) {
         return NULL;
     }
 
     if (!init_dyn_object((DyntypeObject *)dyn_obj, DynClassDate)) {
-        wasm_runtime_free(dyn_obj);
+        dyn_value_free((DynValue *)dyn_obj);
         return NULL;
     }
 
@@ -21,11 +21,10 @@ DynValue *string_concat(DynValue *this_val, int argc, DynValue *argv[])
         return NULL;
     }
 
-    res = (DyntypeString *)wasm_runtime_malloc(total_size);
+    res = (DyntypeString *)dyn_value_alloc(total_size);
     if (!res) {
         return NULL;
     }
-    memset(res, 0, total_size);
 
     res->header.type = DynString;
     res->header.ref_count = 1;
@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* Every value records its allocation site and size, and is linked into the
+ * list of live values. The kind of a value is only known once its creator
+ * has set its header, so values are counted by kind when they are freed,
+ * and when the live ones are walked by the dump. */
+
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "dyn_value.h"
+#include "libdyntype_export.h"
+
+/* rows printed by site */
+#define DYN_ALLOC_PROFILE_TOP_SITES 30
+
+enum DynAllocKind {
+    DynAllocNumber,
+    DynAllocBoolean,
+    DynAllocString,
+    DynAllocObject,
+    DynAllocArray,
+    DynAllocExtref,
+    DynAllocDate,
+    DynAllocOther,
+    DynAllocKindCount,
+};
+
+static const char *kind_names[DynAllocKindCount] = {
+    "number", "boolean", "string", "object",
+    "array",  "extref",  "date",   "other",
+};
+
+typedef struct DynAllocStats {
+    uint64_t count;
+    uint64_t bytes;
+    uint64_t live_count;
+    uint64_t live_bytes;
+} DynAllocStats;
+
+/* slot 0 is DYNTYPE_ALLOC_SITE_UNKNOWN, slot n + 1 site n */
+typedef struct DynAllocSite {
+    DynAllocStats kinds[DynAllocKindCount];
+} DynAllocSite;
+
+typedef struct DynAllocRow {
+    uint32_t slot;
+    uint32_t kind;
+    DynAllocStats *stats;
+} DynAllocRow;
+
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+static DynValue *live_values = NULL;
+/* the values freed so far, the live ones are added by the dump */
+static DynAllocSite *sites = NULL;
+static uint32_t site_slot_count = 0;
+
+static uint32_t
+value_kind(DynValue *value)
+{
+    switch (value->type) {
+        case DynNumber:
+            return DynAllocNumber;
+        case DynBoolean:
+            return DynAllocBoolean;
+        case DynString:
+            return DynAllocString;
+        case DynObject:
+            switch (value->class_id) {
+                case DynClassArray:
+                    return DynAllocArray;
+                case DynClassExtref:
+                    return DynAllocExtref;
+                case DynClassDate:
+                    return DynAllocDate;
+                default:
+                    return DynAllocObject;
+            }
+        default:
+            return DynAllocOther;
+    }
+}
+
+static uint32_t
+site_slot(uint32_t site)
+{
+    return site == DYNTYPE_ALLOC_SITE_UNKNOWN ? 0 : site + 1;
+}
+
+/* Get the stats of a slot, growing the sites if needed */
+static DynAllocSite *
+slot_stats(DynAllocSite **p_sites, uint32_t *p_slot_count, uint32_t slot)
+{
+    DynAllocSite *new_sites;
+    uint32_t new_count;
+
+    if (slot >= *p_slot_count) {
+        new_count = *p_slot_count ? *p_slot_count : 64;
+        while (new_count <= slot) {
+            new_count *= 2;
+        }
+        if (!(new_sites = realloc(*p_sites, sizeof(DynAllocSite) * new_count))) {
+            return NULL;
+        }
+        memset(new_sites + *p_slot_count, 0,
+               sizeof(DynAllocSite) * (new_count - *p_slot_count));
+        *p_sites = new_sites;
+        *p_slot_count = new_count;
+    }
+    return *p_sites + slot;
+}
+
+void
+dyn_alloc_profile_add(DynValue *value, uint32_t size)
+{
+    value->profile_site = dyntype_alloc_profile_get_site();
+    value->profile_size = size;
+
+    pthread_mutex_lock(&profile_lock);
+    value->profile_prev = NULL;
+    value->profile_next = live_values;
+    if (live_values) {
+        live_values->profile_prev = value;
+    }
+    live_values = value;
+    pthread_mutex_unlock(&profile_lock);
+}
+
+void
+dyn_alloc_profile_remove(DynValue *value)
+{
+    DynAllocSite *site;
+
+    pthread_mutex_lock(&profile_lock);
+    if (value->profile_prev) {
+        value->profile_prev->profile_next = value->profile_next;
+    }
+    else {
+        live_values = value->profile_next;
+    }
+    if (value->profile_next) {
+        value->profile_next->profile_prev = value->profile_prev;
+    }
+
+    if ((site = slot_stats(&sites, &site_slot_count,
+                           site_slot(value->profile_site)))) {
+        site->kinds[value_kind(value)].count++;
+        site->kinds[value_kind(value)].bytes += value->profile_size;
+    }
+    pthread_mutex_unlock(&profile_lock);
+}
+
+static int
+compare_row_bytes(const void *a, const void *b)
+{
+    uint64_t bytes_a = ((const DynAllocRow *)a)->stats->bytes;
+    uint64_t bytes_b = ((const DynAllocRow *)b)->stats->bytes;
+
+    return bytes_a < bytes_b ? 1 : bytes_a > bytes_b ? -1 : 0;
+}
+
+static void
+print_stats(FILE *out, const DynAllocStats *stats)
+{
+    fprintf(out,
+            "%12" PRIu64 " %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "  ",
+            stats->count, stats->bytes, stats->live_count, stats->live_bytes);
+}
+
+void
+dyn_alloc_profile_dump(FILE *out, dyntype_site_name_func_t name_func,
+                       void *user_data)
+{
+    DynAllocSite *totals = NULL, *site;
+    DynAllocStats kinds[DynAllocKindCount] = { 0 }, all = { 0 };
+    DynAllocRow *rows = NULL;
+    uint32_t slot_count = 0, row_count = 0, slot, kind, i;
+    DynValue *value;
+    const char *name;
+
+    pthread_mutex_lock(&profile_lock);
+    if (site_slot_count > 0
+        && !(totals = malloc(sizeof(DynAllocSite) * site_slot_count))) {
+        pthread_mutex_unlock(&profile_lock);
+        fprintf(out, "dyntype: allocation profile not available\n");
+        return;
+    }
+    if (totals) {
+        memcpy(totals, sites, sizeof(DynAllocSite) * site_slot_count);
+        slot_count = site_slot_count;
+    }
+    for (value = live_values; value; value = value->profile_next) {
+        if (!(site = slot_stats(&totals, &slot_count,
+                                site_slot(value->profile_site)))) {
+            continue;
+        }
+        kind = value_kind(value);
+        site->kinds[kind].count++;
+        site->kinds[kind].bytes += value->profile_size;
+        site->kinds[kind].live_count++;
+        site->kinds[kind].live_bytes += value->profile_size;
+    }
+    pthread_mutex_unlock(&profile_lock);
+
+    if (slot_count > 0
+        && !(rows = malloc(sizeof(DynAllocRow) * slot_count
+                           * DynAllocKindCount))) {
+        free(totals);
+        fprintf(out, "dyntype: allocation profile not available\n");
+        return;
+    }
+
+    for (slot = 0; slot < slot_count; slot++) {
+        for (kind = 0; kind < DynAllocKindCount; kind++) {
+            DynAllocStats *stats = &totals[slot].kinds[kind];
+
+            if (stats->count == 0) {
+                continue;
+            }
+            kinds[kind].count += stats->count;
+            kinds[kind].bytes += stats->bytes;
+            kinds[kind].live_count += stats->live_count;
+            kinds[kind].live_bytes += stats->live_bytes;
+            rows[row_count].slot = slot;
+            rows[row_count].kind = kind;
+            rows[row_count].stats = stats;
+            row_count++;
+        }
+    }
+    for (kind = 0; kind < DynAllocKindCount; kind++) {
+        all.count += kinds[kind].count;
+        all.bytes += kinds[kind].bytes;
+        all.live_count += kinds[kind].live_count;
+        all.live_bytes += kinds[kind].live_bytes;
+    }
+
+    fprintf(out,
+            "dyntype: %" PRIu64 " values allocated, %" PRIu64 " bytes, %" PRIu64
+            " values live, %" PRIu64 " bytes\n",
+            all.count, all.bytes, all.live_count, all.live_bytes);
+    fprintf(out, "dyntype: %12s %12s %12s %12s  %s\n", "values", "bytes",
+            "live", "live bytes", "kind");
+    for (kind = 0; kind < DynAllocKindCount; kind++) {
+        if (kinds[kind].count > 0) {
+            fprintf(out, "dyntype: ");
+            print_stats(out, &kinds[kind]);
+            fprintf(out, "%s\n", kind_names[kind]);
+        }
+    }
+
+    qsort(rows, row_count, sizeof(DynAllocRow), compare_row_bytes);
+    fprintf(out, "dyntype: %12s %12s %12s %12s  %s\n", "values", "bytes",
+            "live", "live bytes", "kind, site");
+    for (i = 0; i < row_count && i < DYN_ALLOC_PROFILE_TOP_SITES; i++) {
+        fprintf(out, "dyntype: ");
+        print_stats(out, rows[i].stats);
+        fprintf(out, "%s, ", kind_names[rows[i].kind]);
+        if (rows[i].slot == 0) {
+            fprintf(out, "unknown\n");
+        }
+        else if (name_func
+                 && (name = name_func(rows[i].slot - 1, user_data))) {
+            fprintf(out, "%s (func %" PRIu32 ")\n", name, rows[i].slot - 1);
+        }
+        else {
+            fprintf(out, "func %" PRIu32 "\n", rows[i].slot - 1);
+        }
+    }
+    if (row_count > DYN_ALLOC_PROFILE_TOP_SITES) {
+        fprintf(out, "dyntype: %" PRIu32 " more sites\n",
+                row_count - DYN_ALLOC_PROFILE_TOP_SITES);
+    }
+
+    free(rows);
+    free(totals);
+}
+
+#endif /* end of DYNTYPE_ENABLE_ALLOC_PROFILE != 0 */
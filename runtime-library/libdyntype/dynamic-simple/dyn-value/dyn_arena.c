@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* Values created while an arena is open are bump allocated from chunks of
+ * the arena, each value preceded by a pointer to its chunk. A chunk counts
+ * its live values: destroying a value only decrements the count, and the
+ * chunk is freed as a whole once it is retired (full, or its arena ended)
+ * and the count drops to 0. Values still referenced when the arena ends,
+ * e.g. held by a global or a field of a static object, keep their chunk
+ * alive, so they stay valid without being copied.
+ *
+ * Such a pinned chunk may hold a single small value. Values are promoted
+ * where an arena value is stored into an object allocated from the heap
+ * (see dyn_value_promote): numbers, booleans and strings have no identity
+ * and are copied to the heap there, other values can't be moved out since
+ * all their references aren't known. The memory pinned by ended arenas is
+ * therefore capped per thread: once it reaches DYN_ARENA_MAX_PINNED_SIZE,
+ * values are allocated from the heap as without an arena, until pinned
+ * chunks are freed again. dyn_arena_get_stats counts both cases. */
+
+#include "dyn_value.h"
+
+#define DYN_ARENA_CHUNK_SIZE (16 * 1024)
+/* larger values are allocated from the heap, as without an arena */
+#define DYN_ARENA_MAX_VALUE_SIZE (DYN_ARENA_CHUNK_SIZE / 4)
+/* chunks kept alive by values which outlived their arena */
+#define DYN_ARENA_MAX_PINNED_SIZE (16 * DYN_ARENA_CHUNK_SIZE)
+#define DYN_ARENA_ALIGN 8
+#define DYN_ARENA_ALIGN_UP(size) \
+    (((size) + DYN_ARENA_ALIGN - 1) & ~(uint32_t)(DYN_ARENA_ALIGN - 1))
+
+struct DynArena;
+
+typedef struct DynArenaChunk {
+    /* the retired chunks of an arena still open, to pin them when it ends */
+    struct DynArena *arena;
+    struct DynArenaChunk *prev;
+    struct DynArenaChunk *next;
+    /* values allocated from the chunk and not destroyed yet */
+    uint32_t live_count;
+    uint32_t used;
+    /* no longer allocated from, freed with its last value */
+    bool retired;
+    /* retired and its arena ended, counted in pinned_size */
+    bool pinned;
+    uint64_t data[1];
+} DynArenaChunk;
+
+#define DYN_ARENA_CHUNK_DATA_SIZE \
+    (DYN_ARENA_CHUNK_SIZE - offsetof(DynArenaChunk, data))
+
+typedef struct DynArena {
+    struct DynArena *parent;
+    DynArenaChunk *chunk;
+    /* retired chunks with live values */
+    DynArenaChunk *retired_chunks;
+} DynArena;
+
+static DYNTYPE_THREAD_LOCAL DynArena *current_arena = NULL;
+static DYNTYPE_THREAD_LOCAL uint32_t pinned_size = 0;
+static DYNTYPE_THREAD_LOCAL uint64_t fallback_count = 0;
+static DYNTYPE_THREAD_LOCAL uint64_t promoted_count = 0;
+static DYNTYPE_THREAD_LOCAL uint64_t escaped_count = 0;
+
+static void
+chunk_free(DynArenaChunk *chunk)
+{
+    if (chunk->pinned) {
+        pinned_size -= DYN_ARENA_CHUNK_SIZE;
+    }
+    else if (chunk->arena) {
+        if (chunk->prev) {
+            chunk->prev->next = chunk->next;
+        }
+        else {
+            chunk->arena->retired_chunks = chunk->next;
+        }
+        if (chunk->next) {
+            chunk->next->prev = chunk->prev;
+        }
+    }
+    wasm_runtime_free(chunk);
+}
+
+static void
+chunk_retire(DynArena *arena, DynArenaChunk *chunk)
+{
+    chunk->retired = true;
+    if (chunk->live_count == 0) {
+        wasm_runtime_free(chunk);
+        return;
+    }
+    chunk->arena = arena;
+    chunk->prev = NULL;
+    chunk->next = arena->retired_chunks;
+    if (chunk->next) {
+        chunk->next->prev = chunk;
+    }
+    arena->retired_chunks = chunk;
+}
+
+static DynArenaChunk *
+chunk_new()
+{
+    DynArenaChunk *chunk = wasm_runtime_malloc(DYN_ARENA_CHUNK_SIZE);
+
+    if (chunk) {
+        chunk->arena = NULL;
+        chunk->prev = NULL;
+        chunk->next = NULL;
+        chunk->live_count = 0;
+        chunk->used = 0;
+        chunk->retired = false;
+        chunk->pinned = false;
+    }
+    return chunk;
+}
+
+void *
+dyn_value_alloc(uint32_t size)
+{
+    DynArena *arena = current_arena;
+    uint32_t slot_size =
+        DYN_ARENA_ALIGN_UP(sizeof(DynArenaChunk *)) + DYN_ARENA_ALIGN_UP(size);
+    DynArenaChunk *chunk;
+    DynValue *value;
+    uint8_t *slot;
+
+    if (!arena || size > DYN_ARENA_MAX_VALUE_SIZE
+        || pinned_size >= DYN_ARENA_MAX_PINNED_SIZE) {
+        if (arena && size <= DYN_ARENA_MAX_VALUE_SIZE) {
+            fallback_count++;
+        }
+        if ((value = wasm_runtime_malloc(size))) {
+            memset(value, 0, size);
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+            dyn_alloc_profile_add(value, size);
+#endif
+        }
+        return value;
+    }
+
+    chunk = arena->chunk;
+    if (chunk && chunk->used + slot_size > DYN_ARENA_CHUNK_DATA_SIZE) {
+        chunk_retire(arena, chunk);
+        chunk = arena->chunk = NULL;
+    }
+    if (!chunk && !(chunk = arena->chunk = chunk_new())) {
+        return NULL;
+    }
+
+    slot = (uint8_t *)chunk->data + chunk->used;
+    chunk->used += slot_size;
+    chunk->live_count++;
+
+    *(DynArenaChunk **)slot = chunk;
+    value = (DynValue *)(slot + DYN_ARENA_ALIGN_UP(sizeof(DynArenaChunk *)));
+    memset(value, 0, size);
+    value->flags = DYN_VALUE_FLAG_ARENA;
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+    dyn_alloc_profile_add(value, size);
+#endif
+    return value;
+}
+
+void
+dyn_value_free(DynValue *obj)
+{
+    DynArenaChunk *chunk;
+
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+    dyn_alloc_profile_remove(obj);
+#endif
+    if (!(obj->flags & DYN_VALUE_FLAG_ARENA)) {
+        wasm_runtime_free(obj);
+        return;
+    }
+
+    chunk = *(DynArenaChunk **)((uint8_t *)obj
+                                - DYN_ARENA_ALIGN_UP(sizeof(DynArenaChunk *)));
+    if (--chunk->live_count == 0) {
+        if (chunk->retired) {
+            chunk_free(chunk);
+        }
+        else {
+            /* the current chunk of an arena is reused from the start */
+            chunk->used = 0;
+        }
+    }
+}
+
+DynValue *
+dyn_value_promote(DynValue *owner, DynValue *value)
+{
+    DynValue *copy;
+    uint32_t size;
+
+    if (!(value->flags & DYN_VALUE_FLAG_ARENA)
+        || (owner->flags & DYN_VALUE_FLAG_ARENA)) {
+        dyn_value_hold(value);
+        return value;
+    }
+
+    switch (value->type) {
+        case DynNumber:
+            size = sizeof(DyntypeNumber);
+            break;
+        case DynBoolean:
+            size = sizeof(DyntypeBoolean);
+            break;
+        case DynString:
+            size = offsetof(DyntypeString, data)
+                   + ((DyntypeString *)value)->length + 1;
+            break;
+        default:
+            escaped_count++;
+            dyn_value_hold(value);
+            return value;
+    }
+
+    if (!(copy = wasm_runtime_malloc(size))) {
+        escaped_count++;
+        dyn_value_hold(value);
+        return value;
+    }
+    bh_memcpy_s(copy, size, value, size);
+    copy->ref_count = 1;
+    copy->flags = 0;
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+    dyn_alloc_profile_add(copy, size);
+#endif
+    promoted_count++;
+    return copy;
+}
+
+void
+dyn_arena_get_stats(dyntype_arena_stats_t *stats)
+{
+    stats->fallback_count = fallback_count;
+    stats->promoted_count = promoted_count;
+    stats->escaped_count = escaped_count;
+    stats->pinned_size = pinned_size;
+}
+
+int
+dyn_arena_begin()
+{
+    DynArena *arena = wasm_runtime_malloc(sizeof(DynArena));
+
+    if (!arena) {
+        return DYNTYPE_EXCEPTION;
+    }
+    arena->parent = current_arena;
+    arena->chunk = NULL;
+    arena->retired_chunks = NULL;
+    current_arena = arena;
+    return DYNTYPE_SUCCESS;
+}
+
+void
+dyn_arena_end()
+{
+    DynArena *arena = current_arena;
+    DynArenaChunk *chunk, *next;
+
+    if (!arena) {
+        return;
+    }
+    if (arena->chunk) {
+        chunk_retire(arena, arena->chunk);
+    }
+    /* the values left outlive the arena, their chunks are pinned */
+    for (chunk = arena->retired_chunks; chunk; chunk = next) {
+        next = chunk->next;
+        chunk->arena = NULL;
+        chunk->prev = chunk->next = NULL;
+        chunk->pinned = true;
+        pinned_size += DYN_ARENA_CHUNK_SIZE;
+    }
+    current_arena = arena->parent;
+    wasm_runtime_free(arena);
+}
@@ -33,7 +33,7 @@ DynValue *
 dyn_value_new_number(double value)
 {
     DyntypeNumber *dyn_num =
-        (DyntypeNumber *)wasm_runtime_malloc(sizeof(DyntypeNumber));
+        (DyntypeNumber *)dyn_value_alloc(sizeof(DyntypeNumber));
     if (!dyn_num) {
         return NULL;
     }
@@ -50,7 +50,7 @@ DynValue *
 dyn_value_new_boolean(bool value)
 {
     DyntypeBoolean *dyn_bool =
-        (DyntypeBoolean *)wasm_runtime_malloc(sizeof(DyntypeBoolean));
+        (DyntypeBoolean *)dyn_value_alloc(sizeof(DyntypeBoolean));
     if (!dyn_bool) {
         return NULL;
     }
@@ -67,11 +67,10 @@ DynValue *
 dyn_value_new_string(const void *buf, uint32_t length)
 {
     uint32 total_size = offsetof(DyntypeString, data) + length + 1;
-    DyntypeString *dyn_str = (DyntypeString *)wasm_runtime_malloc(total_size);
+    DyntypeString *dyn_str = (DyntypeString *)dyn_value_alloc(total_size);
     if (!dyn_str) {
         return NULL;
     }
-    memset(dyn_str, 0, total_size);
 
     dyn_str->header.type = DynString;
     dyn_str->header.class_id = DynClassString;
@@ -137,13 +136,13 @@ DynValue *
 dyn_value_new_object()
 {
     DyntypeObject *dyn_obj =
-        (DyntypeObject *)wasm_runtime_malloc(sizeof(DyntypeObject));
+        (DyntypeObject *)dyn_value_alloc(sizeof(DyntypeObject));
     if (!dyn_obj) {
         return NULL;
     }
 
     if (!init_dyn_object(dyn_obj, DynClassObject)) {
-        wasm_runtime_free(dyn_obj);
+        dyn_value_free((DynValue *)dyn_obj);
         return NULL;
     }
 
@@ -155,12 +154,14 @@ dyn_value_new_array(int len)
 {
     uint32_t total_size =
         offsetof(DyntypeArray, data) + len * sizeof(DynValue *);
-    DyntypeArray *dyn_array = (DyntypeArray *)wasm_runtime_malloc(total_size);
+    DyntypeArray *dyn_array = (DyntypeArray *)dyn_value_alloc(total_size);
 
-    memset(dyn_array, 0, total_size);
+    if (!dyn_array) {
+        return NULL;
+    }
 
     if (!init_dyn_object((DyntypeObject *)dyn_array, DynClassArray)) {
-        wasm_runtime_free(dyn_array);
+        dyn_value_free((DynValue *)dyn_array);
         return NULL;
     }
 
@@ -196,13 +197,13 @@ DynValue *
 dyn_value_new_extref(void *ptr, external_ref_tag tag, void *opaque)
 {
     DyntypeExtref *dyn_extref =
-        (DyntypeExtref *)wasm_runtime_malloc(sizeof(DyntypeExtref));
+        (DyntypeExtref *)dyn_value_alloc(sizeof(DyntypeExtref));
     if (!dyn_extref) {
         return NULL;
     }
 
     if (!init_dyn_object((DyntypeObject *)dyn_extref, DynClassExtref)) {
-        wasm_runtime_free(dyn_extref);
+        dyn_value_free((DynValue *)dyn_extref);
         return NULL;
     }
 
@@ -302,7 +303,7 @@ dyn_value_destroy(void *obj)
         }
     }
 
-    wasm_runtime_free(dyn_value);
+    dyn_value_free(dyn_value);
 }
 
 void
@@ -327,11 +328,10 @@ dyn_string_concat(DyntypeString *dyn_str1, DyntypeString *dyn_str2)
 {
     uint32_t total_size =
         offsetof(DyntypeString, data) + dyn_str1->length + dyn_str2->length + 1;
-    DyntypeString *dyn_str = (DyntypeString *)wasm_runtime_malloc(total_size);
+    DyntypeString *dyn_str = (DyntypeString *)dyn_value_alloc(total_size);
     if (!dyn_str) {
         return NULL;
     }
-    memset(dyn_str, 0, total_size);
 
     dyn_str->header.type = DynString;
     dyn_str->header.ref_count = 1;
@@ -368,11 +368,10 @@ dyn_string_slice(DyntypeString *dyn_str, uint32_t start, uint32_t end)
     actual_end = end == UINT32_MAX ? dyn_str->length : end;
 
     total_size = offsetof(DyntypeString, data) + actual_end - start + 1;
-    dyn_str_res = (DyntypeString *)wasm_runtime_malloc(total_size);
+    dyn_str_res = (DyntypeString *)dyn_value_alloc(total_size);
     if (!dyn_str_res) {
         return NULL;
     }
-    memset(dyn_str_res, 0, total_size);
 
     dyn_str_res->header.type = DynString;
     dyn_str_res->header.ref_count = 1;
@@ -22,10 +22,21 @@ enum DynValueClass {
     DynClassEnd,
 };
 
+/* the value is allocated from an arena chunk, see dyn_value_alloc */
+#define DYN_VALUE_FLAG_ARENA 1
+
 typedef struct DynValue {
     uint8_t type;
     uint8_t class_id;
     uint16_t ref_count;
+    uint8_t flags;
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+    /* the list of live values, see dyn_alloc_profile.c */
+    struct DynValue *profile_prev;
+    struct DynValue *profile_next;
+    uint32_t profile_site;
+    uint32_t profile_size;
+#endif
 } DynValue;
 
 typedef struct DyntypeNumber {
@@ -66,6 +77,42 @@ typedef struct DyntypeDate {
     time_t time;
 } DyntypeDate;
 
+/* memory of values, from the innermost open arena of the thread if any */
+void *
+dyn_value_alloc(uint32_t size);
+
+void
+dyn_value_free(DynValue *obj);
+
+int
+dyn_arena_begin();
+
+void
+dyn_arena_end();
+
+void
+dyn_arena_get_stats(dyntype_arena_stats_t *stats);
+
+/* the reference to store into owner: an arena number, boolean or string
+ * stored into a heap object is copied to the heap so it doesn't pin its
+ * chunk, other values are returned held */
+DynValue *
+dyn_value_promote(DynValue *owner, DynValue *value);
+
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+/* record a value allocated with size bytes */
+void
+dyn_alloc_profile_add(DynValue *value, uint32_t size);
+
+/* called before the value is freed */
+void
+dyn_alloc_profile_remove(DynValue *value);
+
+void
+dyn_alloc_profile_dump(FILE *out, dyntype_site_name_func_t name_func,
+                       void *user_data);
+#endif
+
 DynValue *
 dyn_value_new_number(double value);
 
@@ -235,8 +235,7 @@ dynamic_set_elem(dyn_ctx_t ctx, dyn_value_t obj, int index, dyn_value_t elem)
         dynamic_release(ctx, dyn_array->data[index]);
     }
 
-    dyn_array->data[index] = elem;
-    dynamic_hold(ctx, elem);
+    dyn_array->data[index] = dyn_value_promote(obj, elem);
 
     return true;
 }
@@ -281,13 +280,15 @@ dynamic_set_property(dyn_ctx_t ctx, dyn_value_t obj, const char *prop,
     }
 
     key = bh_strdup(prop);
+    /* held, or a heap copy when it would pin an arena chunk */
+    value = dyn_value_promote(obj, value);
 
     if (!bh_hash_map_find(dyn_obj->properties, (void *)key)) {
         if (!bh_hash_map_insert(dyn_obj->properties, (void *)key, value)) {
             wasm_runtime_free(key);
+            dynamic_release(ctx, value);
             return false;
         }
-        dynamic_hold(ctx, value);
     }
     else {
         void *old_key;
@@ -299,10 +300,10 @@ dynamic_set_property(dyn_ctx_t ctx, dyn_value_t obj, const char *prop,
 
         if (!bh_hash_map_insert(dyn_obj->properties, (void *)key, value)) {
             wasm_runtime_free(key);
+            dynamic_release(ctx, value);
             return false;
         }
 
-        dynamic_hold(ctx, value);
         dynamic_release(ctx, old_value);
     }
 
@@ -895,6 +896,34 @@ dynamic_collect(dyn_ctx_t ctx)
     // TODO
 }
 
+int
+dynamic_arena_begin(dyn_ctx_t ctx)
+{
+    return dyn_arena_begin();
+}
+
+void
+dynamic_arena_end(dyn_ctx_t ctx)
+{
+    dyn_arena_end();
+}
+
+void
+dynamic_arena_get_stats(dyn_ctx_t ctx, dyntype_arena_stats_t *stats)
+{
+    dyn_arena_get_stats(stats);
+}
+
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+void
+dynamic_alloc_profile_dump(dyn_ctx_t ctx, FILE *out,
+                           dyntype_site_name_func_t name_func,
+                           void *user_data)
+{
+    dyn_alloc_profile_dump(out, name_func, user_data);
+}
+#endif
+
 /******************* Exception *******************/
 
 dyn_value_t
@@ -21,6 +21,12 @@ dynamic_context_init();
 dyn_ctx_t
 dynamic_context_init_with_opt(dyn_options_t *options);
 
+dyn_ctx_t
+dynamic_context_create();
+
+void
+dynamic_context_bind(dyn_ctx_t ctx);
+
 void
 dynamic_context_destroy(dyn_ctx_t ctx);
 
@@ -49,6 +55,22 @@ dynamic_release(dyn_ctx_t ctx, dyn_value_t obj);
 void
 dynamic_collect(dyn_ctx_t ctx);
 
+int
+dynamic_arena_begin(dyn_ctx_t ctx);
+
+void
+dynamic_arena_end(dyn_ctx_t ctx);
+
+void
+dynamic_arena_get_stats(dyn_ctx_t ctx, dyntype_arena_stats_t *stats);
+
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+void
+dynamic_alloc_profile_dump(dyn_ctx_t ctx, FILE *out,
+                           dyntype_site_name_func_t name_func,
+                           void *user_data);
+#endif
+
 /********************************************/
 /*     APIs exposed to wasm application     */
 /********************************************/
@@ -716,6 +716,19 @@ dyntype_callback_wasm_dispatcher(void *exec_env_v, dyn_ctx_t ctx, void *vfunc,
     return res;
 }
 
+/******************* Arena *******************/
+int
+dyntype_arena_begin_wrapper(wasm_exec_env_t exec_env, wasm_anyref_obj_t ctx)
+{
+    return dyntype_arena_begin(UNBOX_ANYREF(ctx));
+}
+
+void
+dyntype_arena_end_wrapper(wasm_exec_env_t exec_env, wasm_anyref_obj_t ctx)
+{
+    dyntype_arena_end(UNBOX_ANYREF(ctx));
+}
+
 /* clang-format off */
 #define REG_NATIVE_FUNC(func_name, signature) \
     { #func_name, func_name##_wrapper, signature, NULL }
@@ -776,6 +789,9 @@ static NativeSymbol native_symbols[] = {
 
     REG_NATIVE_FUNC(dyntype_get_global, "(r$)r"),
 
+    REG_NATIVE_FUNC(dyntype_arena_begin, "(r)i"),
+    REG_NATIVE_FUNC(dyntype_arena_end, "(r)"),
+
     /* TODO */
 };
 /* clang-format on */
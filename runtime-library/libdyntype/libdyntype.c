@@ -8,8 +8,13 @@
 #include "pure_dynamic.h"
 #include "extref/extref.h"
 
-static void *g_exec_env = NULL;
-static dyntype_callback_dispatcher_t g_cb_dispatcher = NULL;
+static DYNTYPE_THREAD_LOCAL void *g_exec_env = NULL;
+static DYNTYPE_THREAD_LOCAL dyntype_callback_dispatcher_t g_cb_dispatcher =
+    NULL;
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+/* set once by the embedder, shared by all threads */
+static dyntype_alloc_site_func_t g_alloc_site_func = NULL;
+#endif
 
 /********************************************/
 /*     APIs exposed to runtime embedder     */
@@ -26,11 +31,26 @@ dyntype_context_init_with_opt(dyn_options_t *options)
     return dynamic_context_init_with_opt(options);
 }
 
+dyn_ctx_t
+dyntype_context_create()
+{
+    return dynamic_context_create();
+}
+
+void
+dyntype_context_bind(dyn_ctx_t ctx)
+{
+    dynamic_context_bind(ctx);
+}
+
 void
 dyntype_context_destroy(dyn_ctx_t ctx)
 {
-    g_exec_env = NULL;
-    g_cb_dispatcher = NULL;
+    /* a context that isn't bound leaves the thread state alone */
+    if (ctx == dynamic_get_context()) {
+        g_exec_env = NULL;
+        g_cb_dispatcher = NULL;
+    }
     dynamic_context_destroy(ctx);
 }
 
@@ -106,6 +126,49 @@ dyntype_collect(dyn_ctx_t ctx)
     dynamic_collect(ctx);
 }
 
+int
+dyntype_arena_begin(dyn_ctx_t ctx)
+{
+    return dynamic_arena_begin(ctx);
+}
+
+void
+dyntype_arena_end(dyn_ctx_t ctx)
+{
+    dynamic_arena_end(ctx);
+}
+
+void
+dyntype_arena_get_stats(dyn_ctx_t ctx, dyntype_arena_stats_t *stats)
+{
+    dynamic_arena_get_stats(ctx, stats);
+}
+
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+void
+dyntype_alloc_profile_set_site_func(dyntype_alloc_site_func_t func)
+{
+    g_alloc_site_func = func;
+}
+
+uint32_t
+dyntype_alloc_profile_get_site()
+{
+    if (!g_alloc_site_func || !g_exec_env) {
+        return DYNTYPE_ALLOC_SITE_UNKNOWN;
+    }
+    return g_alloc_site_func(g_exec_env);
+}
+
+void
+dyntype_alloc_profile_dump(dyn_ctx_t ctx, FILE *out,
+                           dyntype_site_name_func_t name_func,
+                           void *user_data)
+{
+    dynamic_alloc_profile_dump(ctx, out, name_func, user_data);
+}
+#endif
+
 /********************************************/
 /*     APIs exposed to wasm application     */
 /********************************************/
@@ -22,6 +22,14 @@ else()
     )
 endif()
 
+if (USE_DYNTYPE_ALLOC_PROFILE EQUAL 1)
+    if (NOT USE_SIMPLE_LIBDYNTYPE EQUAL 1)
+        message(FATAL_ERROR "USE_DYNTYPE_ALLOC_PROFILE requires USE_SIMPLE_LIBDYNTYPE=1")
+    endif()
+    message("     * Allocation profile of dynamic values enabled")
+    add_definitions(-DDYNTYPE_ENABLE_ALLOC_PROFILE=1)
+endif()
+
 file (GLOB source_all
     ${LIBDYNTYPE_DIR}/*.c
     ${LIBDYNTYPE_DIR}/extref/*.c
@@ -21,6 +21,14 @@ extern "C" {
 #define DYNTYPE_EXCEPTION 1
 #define DYNTYPE_TYPEERR 2
 
+/* The context and the state bound to it belong to the calling thread, so
+ * several module instances can run on their own threads */
+#if defined(_MSC_VER)
+#define DYNTYPE_THREAD_LOCAL __declspec(thread)
+#else
+#define DYNTYPE_THREAD_LOCAL __thread
+#endif
+
 struct DynTypeContext;
 
 typedef struct DynTypeContext *dyn_ctx_t;
@@ -33,6 +41,36 @@ typedef dyn_value_t (*dyntype_callback_dispatcher_t)(void *env, dyn_ctx_t ctx,
                                                      int argc,
                                                      dyn_value_t *args);
 
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+#include <stdio.h>
+
+/* the allocation site of the values created for unknown code */
+#define DYNTYPE_ALLOC_SITE_UNKNOWN UINT32_MAX
+
+/* Get the allocation site of the values created now by the code running on
+ * exec_env, e.g. the index of the calling wasm function */
+typedef uint32_t (*dyntype_alloc_site_func_t)(void *exec_env);
+
+/* Get the name of an allocation site, NULL if unknown */
+typedef const char *(*dyntype_site_name_func_t)(uint32_t site,
+                                                void *user_data);
+#endif
+
+/* arena activity of the calling thread, see dyntype_arena_get_stats */
+typedef struct dyntype_arena_stats_t {
+    /* values allocated from the heap while an arena was open, because the
+     * memory pinned by ended arenas reached its cap */
+    uint64_t fallback_count;
+    /* numbers, booleans and strings of an arena copied to the heap when
+     * stored into an object allocated from the heap */
+    uint64_t promoted_count;
+    /* other arena values stored into an object allocated from the heap,
+     * they pin their chunk once the arena ends */
+    uint64_t escaped_count;
+    /* bytes of the chunks pinned by values outliving their arena */
+    uint32_t pinned_size;
+} dyntype_arena_stats_t;
+
 typedef enum external_ref_tag {
     ExtObj,
     ExtFunc,
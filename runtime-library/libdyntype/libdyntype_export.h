@@ -25,6 +25,9 @@ extern "C" {
 /**
  * @brief Initialize the dynamic type system context
  *
+ * @note the context belongs to the calling thread, each thread running a
+ * module instance initializes its own one
+ *
  * @return dynamic type system context if success, NULL otherwise
  */
 dyn_ctx_t
@@ -50,6 +53,27 @@ dyntype_context_init_with_opt(dyn_options_t *options);
 void
 dyntype_context_destroy(dyn_ctx_t ctx);
 
+/**
+ * @brief Create a new dynamic type system context without binding it to the
+ * calling thread
+ *
+ * @note used to keep several isolated contexts on one thread, e.g. one per
+ * pooled module instance, see dyntype_context_bind
+ *
+ * @return dynamic type system context if success, NULL otherwise
+ */
+dyn_ctx_t
+dyntype_context_create();
+
+/**
+ * @brief Bind the context to the calling thread, dyntype_get_context returns
+ * it afterwards
+ *
+ * @param ctx context to bind, NULL unbinds the current one
+ */
+void
+dyntype_context_bind(dyn_ctx_t ctx);
+
 /**
  * @brief Bind an execution environment to libdyntype
  *
@@ -75,7 +99,8 @@ dyntype_context_get_exec_env();
  * functions from libdyntype, so the implementer can decide how to invoke the
  * actual function.
  *
- * @note If another callback is set, the previous one will be overwrite.
+ * @note If another callback is set, the previous one will be overwrite. The
+ * callback is set per thread, like the context.
  *
  * @param callback the callback to set
  */
@@ -177,6 +202,77 @@ dyntype_release(dyn_ctx_t ctx, dyn_value_t obj);
 void
 dyntype_collect(dyn_ctx_t ctx);
 
+/**
+ * @brief Open an arena on the calling thread, dynamic values created until
+ * the matching dyntype_arena_end are allocated from it and freed together.
+ * Arenas nest.
+ *
+ * @note values still referenced when the arena ends, e.g. stored into a
+ * global or a static object, stay valid, the memory they share is freed
+ * with the last of them. The QuickJS backend ignores arenas.
+ *
+ * @param ctx the dynamic type system context
+ * @return DYNTYPE_SUCCESS if success, DYNTYPE_EXCEPTION if out of memory
+ */
+int
+dyntype_arena_begin(dyn_ctx_t ctx);
+
+/**
+ * @brief Close the innermost arena of the calling thread
+ *
+ * @param ctx the dynamic type system context
+ */
+void
+dyntype_arena_end(dyn_ctx_t ctx);
+
+/**
+ * @brief Get the arena counters of the calling thread, to see how many
+ * values escape the arenas or are allocated from the heap since the memory
+ * pinned by them reached its cap. The QuickJS backend reports zeros.
+ *
+ * @param ctx the dynamic type system context
+ * @param stats the counters
+ */
+void
+dyntype_arena_get_stats(dyn_ctx_t ctx, dyntype_arena_stats_t *stats);
+
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+/**
+ * @brief Set how the allocation site of a dynamic value is found, values
+ * are recorded at DYNTYPE_ALLOC_SITE_UNKNOWN until it is set
+ *
+ * @note Only the simple implementation records allocations, built with
+ * USE_DYNTYPE_ALLOC_PROFILE=1
+ *
+ * @param func called with the exec env bound to the thread
+ */
+void
+dyntype_alloc_profile_set_site_func(dyntype_alloc_site_func_t func);
+
+/**
+ * @brief Get the allocation site of the values created now on the calling
+ * thread
+ *
+ * @return the site, DYNTYPE_ALLOC_SITE_UNKNOWN if unknown
+ */
+uint32_t
+dyntype_alloc_profile_get_site();
+
+/**
+ * @brief Print the values allocated since the start, by kind and by
+ * allocation site, with those still alive
+ *
+ * @param ctx the dynamic type system context
+ * @param out the output
+ * @param name_func gets the names of the sites, may be NULL
+ * @param user_data passed to name_func
+ */
+void
+dyntype_alloc_profile_dump(dyn_ctx_t ctx, FILE *out,
+                           dyntype_site_name_func_t name_func,
+                           void *user_data);
+#endif
+
 /**
  * @brief Get array's length
  *
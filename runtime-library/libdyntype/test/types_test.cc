@@ -510,3 +510,66 @@ TEST_F(TypesTest, get_global_obj)
     wasm_string_destroy(wasm_string);
 #endif
 }
+
+TEST_F(TypesTest, arena)
+{
+    dyn_value_t kept, temp, nested;
+    double value;
+
+    EXPECT_EQ(dyntype_arena_begin(ctx), DYNTYPE_SUCCESS);
+    kept = dyntype_new_number(ctx, 1);
+    temp = dyntype_new_object(ctx);
+    EXPECT_TRUE(dyntype_is_object(ctx, temp));
+
+    EXPECT_EQ(dyntype_arena_begin(ctx), DYNTYPE_SUCCESS);
+    nested = dyntype_new_number(ctx, 2);
+    dyntype_release(ctx, nested);
+    dyntype_arena_end(ctx);
+
+    dyntype_release(ctx, temp);
+    dyntype_arena_end(ctx);
+
+    /* a value outliving its arena stays valid */
+    EXPECT_EQ(dyntype_to_number(ctx, kept, &value), DYNTYPE_SUCCESS);
+    EXPECT_EQ(value, 1);
+    dyntype_release(ctx, kept);
+
+    /* without an arena, values are allocated as usual */
+    temp = dyntype_new_number(ctx, 3);
+    EXPECT_EQ(dyntype_to_number(ctx, temp, &value), DYNTYPE_SUCCESS);
+    EXPECT_EQ(value, 3);
+    dyntype_release(ctx, temp);
+}
+
+TEST_F(TypesTest, arena_stats)
+{
+    dyntype_arena_stats_t before, after;
+    dyn_value_t holder, num, obj, prop;
+    double value;
+
+    /* allocated from the heap, it outlives the arena */
+    holder = dyntype_new_object(ctx);
+    dyntype_arena_get_stats(ctx, &before);
+
+    EXPECT_EQ(dyntype_arena_begin(ctx), DYNTYPE_SUCCESS);
+    num = dyntype_new_number(ctx, 42);
+    obj = dyntype_new_object(ctx);
+    EXPECT_EQ(dyntype_set_property(ctx, holder, "num", num), DYNTYPE_SUCCESS);
+    EXPECT_EQ(dyntype_set_property(ctx, holder, "obj", obj), DYNTYPE_SUCCESS);
+    dyntype_release(ctx, num);
+    dyntype_release(ctx, obj);
+    dyntype_arena_end(ctx);
+
+    /* the number is copied to the heap, the object escapes the arena (the
+     * QuickJS backend counts neither) */
+    dyntype_arena_get_stats(ctx, &after);
+    EXPECT_EQ(after.promoted_count - before.promoted_count,
+              after.escaped_count - before.escaped_count);
+    EXPECT_EQ(after.fallback_count, before.fallback_count);
+
+    prop = dyntype_get_property(ctx, holder, "num");
+    EXPECT_EQ(dyntype_to_number(ctx, prop, &value), DYNTYPE_SUCCESS);
+    EXPECT_EQ(value, 42);
+    dyntype_release(ctx, prop);
+    dyntype_release(ctx, holder);
+}
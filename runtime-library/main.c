@@ -6,14 +6,36 @@
 #ifndef _GNU_SOURCE
 #define _GNU_SOURCE
 #endif
+#include <errno.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #include "bh_platform.h"
 #include "bh_read_file.h"
 #include "wasm_export.h"
 #include "libdyntype_export.h"
+#include "instance_pool.h"
+#include "module_file.h"
+#include "gc_tuner.h"
+#include "gc_telemetry.h"
+#include "native_profiler.h"
+#include "sampling_profiler.h"
+#include "heap_snapshot.h"
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+#include "wamr_utils.h"
+#endif
+
+/* mean collection pause the growing gc heap tries to stay under, in ms */
+#define GC_PAUSE_TARGET_DEFAULT 10
+/* native calls shorter than this aren't traced, in us */
+#define PROFILE_TRACE_THRESHOLD_DEFAULT 10
+/* samples per second, off the 100 Hz of periodic work */
+#define PROFILE_SAMPLING_RATE_DEFAULT 99
 
 extern uint32_t
 get_libdyntype_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
@@ -27,6 +49,61 @@ get_lib_array_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
 extern uint32_t
 get_lib_timer_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
 
+extern int
+timer_events_poll(wasm_exec_env_t exec_env);
+
+extern void
+timer_events_destroy(void);
+
+extern uint64_t
+timer_events_next_deadline(void);
+
+extern uint32_t
+get_lib_worker_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
+
+extern bool
+worker_runtime_init(uint32_t stack_size, uint32_t heap_size,
+                    instance_pool_drain_func_t run_loop);
+
+extern void
+worker_runtime_destroy(void);
+
+extern int
+worker_events_poll(wasm_exec_env_t exec_env, uint64_t deadline);
+
+extern void
+worker_events_destroy(void);
+
+extern void
+console_set_output(FILE *output);
+
+extern uint32_t
+get_lib_math_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
+
+extern uint32_t
+get_lib_dataview_symbols(char **p_module_name,
+                         NativeSymbol **p_native_symbols);
+
+extern uint32_t
+get_lib_collection_symbols(char **p_module_name,
+                           NativeSymbol **p_native_symbols);
+
+extern uint32_t
+get_lib_number_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
+
+extern uint32_t
+get_lib_heap_snapshot_symbols(char **p_module_name,
+                              NativeSymbol **p_native_symbols);
+
+extern uint32_t
+get_lib_gc_memory_symbols(char **p_module_name,
+                          NativeSymbol **p_native_symbols);
+
+#if WASMNIZER_ENABLE_REGEXP != 0
+extern uint32_t
+get_lib_regexp_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
+#endif
+
 extern uint32_t
 get_struct_indirect_symbols(char **p_module_name, NativeSymbol **p_native_symbols);
 
@@ -42,6 +119,30 @@ dyntype_callback_wasm_dispatcher(void *exec_env_v, dyn_ctx_t ctx, void *vfunc,
 static int app_argc;
 static char **app_argv;
 
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+static const char *
+alloc_site_name(uint32_t site, void *user_data)
+{
+    return module_func_names_get((ModuleFuncNames *)user_data, site);
+}
+
+/* Print the dynamic values allocated by the module, by the wasm function
+ * creating them, named from the name section of the wasm file if any */
+static void
+dump_alloc_profile(dyn_ctx_t dyn_ctx, const char *wasm_file)
+{
+    ModuleFile file;
+    ModuleFuncNames names = { 0 };
+
+    if (module_file_open(wasm_file, &file)) {
+        module_file_read_func_names(&file, &names);
+        module_file_close(&file);
+    }
+    dyntype_alloc_profile_dump(dyn_ctx, stderr, alloc_site_name, &names);
+    module_func_names_destroy(&names);
+}
+#endif
+
 /* clang-format off */
 static int
 print_help()
@@ -65,6 +166,12 @@ print_help()
 #endif
 #if WASM_ENABLE_JIT != 0 && WASM_ENABLE_FAST_JIT != 0 && WASM_ENABLE_LAZY_JIT != 0
     printf("  --multi-tier-jit         Run the wasm app with multi-tier jit mode\n");
+#endif
+#if WASM_ENABLE_AOT != 0
+    printf("  --aot-cache=<dir>        Cache AOT compiled modules in the directory, a cached\n"
+           "                           module is loaded as native code, a missing one is\n"
+           "                           compiled in the background for the next run\n");
+    printf("  --aot-compiler=<path>    Set the AOT compiler of the cache, default is wamrc\n");
 #endif
     printf("  --stack-size=n           Set maximum stack size in bytes, default is 64 KB\n");
     printf("  --heap-size=n            Set maximum heap size in bytes, default is 16 KB\n");
@@ -75,13 +182,48 @@ print_help()
 #if WASM_ENABLE_GC != 0
     printf("  --gc-heap-size=n         Set maximum gc heap size in bytes,\n");
     printf("                           default is %u KB\n", GC_HEAP_SIZE_DEFAULT / 1024);
+    printf("  --gc-heap-max=n          Reserve n bytes for the gc heap and let it grow from\n"
+           "                           the size of --gc-heap-size up to them, adapting how\n"
+           "                           often it is collected to the program\n");
+    printf("  --gc-pause-target=ms     Set the mean collection pause the growing gc heap\n"
+           "                           tries to stay under, default is %u ms\n", GC_PAUSE_TARGET_DEFAULT);
+    printf("  --gc-stats               Print the collections, pause times and heap sizes\n"
+           "                           of the gc heap at exit\n");
 #endif
 #if WASM_ENABLE_JIT != 0
     printf("  --llvm-jit-size-level=n  Set LLVM JIT size level, default is 3\n");
     printf("  --llvm-jit-opt-level=n   Set LLVM JIT optimization level, default is 3\n");
 #endif
+    printf("  --profile-natives[=<file>]\n"
+           "                           Print the calls and times of the natives at exit,\n"
+           "                           and write the calls to a Chrome trace event file\n");
+    printf("  --profile-trace-threshold=us\n"
+           "                           Only trace the native calls lasting at least us\n"
+           "                           microseconds, default is %u\n", PROFILE_TRACE_THRESHOLD_DEFAULT);
+    printf("  --profile-sampling=<file>\n"
+           "                           Sample the wasm call stacks and write them to file\n"
+           "                           as folded stacks (flamegraph.pl input) at exit\n");
+    printf("  --profile-sampling-rate=n\n"
+           "                           Take n samples per second of CPU time, default is %u\n", PROFILE_SAMPLING_RATE_DEFAULT);
+    printf("  --profile-source-map=<file>\n"
+           "                           Map the sampled frames to source lines with file,\n"
+           "                           default is the wasm file name followed by .map\n");
+    printf("  --heap-snapshot-signal   Write a heap snapshot of every instance to\n"
+           "                           heap-<pid>-<seq>.heapsnapshot on SIGUSR2\n");
     printf("  --repl                   Start a very simple REPL (read-eval-print-loop) mode\n"
            "                           that runs commands in the form of \"FUNC ARG...\"\n");
+    printf("  --server                 Start a server that runs requests read from stdin,\n"
+           "                           one per line in the form of \"FUNC ARG...\", or the\n"
+           "                           arguments of the function given by -f. Each worker\n"
+           "                           thread has its own instance of the module\n");
+    printf("  --workers=n              Set the worker thread number of the server, default\n"
+           "                           is the number of online CPUs\n");
+    printf("  --pool-size=n            Run every server job on a fresh instance, each worker\n"
+           "                           keeps n instances initialized ahead, default is 0\n"
+           "                           which runs all the jobs of a worker on one instance\n");
+    printf("  --socket=<path>          Start the server on a unix domain socket rather than\n"
+           "                           stdin, the lines of a connection are run in order and\n"
+           "                           console.log output is sent back on the connection\n");
 #if WASM_ENABLE_LIBC_WASI != 0
     printf("  --env=<env>              Pass wasi environment variables with \"key=value\"\n");
     printf("                           to the program, for example:\n");
@@ -372,15 +514,52 @@ moudle_destroyer(uint8 *buffer, uint32_t size)
 }
 #endif /* WASM_ENABLE_MULTI_MODULE */
 
+#define STDOUT_BUF_SIZE (64 * 1024)
+
 #if WASM_ENABLE_GLOBAL_HEAP_POOL != 0
 static char global_heap_buf[WASM_GLOBAL_HEAP_SIZE] = { 0 };
 #endif
 
+#if WASM_ENABLE_GC != 0
+/* the tuner of the main instance, NULL in server mode */
+static GCTuner *gc_tuner = NULL;
+
+static void
+dump_gc_telemetry(wasm_module_inst_t module_inst)
+{
+    GCTelemetryStats stats;
+
+    if (gc_telemetry_get_stats(module_inst, &stats)) {
+        fprintf(stderr,
+                "gc: at least %" PRIu64 " bytes reclaimed, %" PRIu64
+                " finalizers run\n",
+                stats.reclaimed_size, stats.finalizers_run);
+    }
+}
+#endif
+
 int
 events_poll(wasm_exec_env_t exec_env)
 {
-    /* TODO: not detect macro tasks yet */
-    return -1;
+    int ret;
+
+#if WASM_ENABLE_GC != 0
+    /* the turns of the event loop are the safe points to resize the heap */
+    if (gc_tuner) {
+        gc_tuner_update(gc_tuner, wasm_runtime_get_module_inst(exec_env));
+    }
+    /* and to notice the collections of the instance */
+    gc_telemetry_update(wasm_runtime_get_module_inst(exec_env));
+#endif
+    /* the snapshots requested with SIGUSR2 */
+    heap_snapshot_poll(exec_env);
+    /* messages from and to workers first, waiting for them no longer than
+     * the next timer is due */
+    if ((ret = worker_events_poll(exec_env, timer_events_next_deadline()))
+        <= 0) {
+        return ret;
+    }
+    return timer_events_poll(exec_env);
 }
 
 void
@@ -405,6 +584,499 @@ execute_micro_tasks(wasm_exec_env_t exec_env, dyn_ctx_t ctx)
     }
 }
 
+/* Server mode: the module is loaded and validated once, every worker thread
+ * takes instances, each with its own exec env and dyntype context, from an
+ * instance pool of its own and runs the jobs of a shared queue. A job from
+ * stdin is a single request line, a job from the unix domain socket is a
+ * whole connection, whose lines are run in order by the worker that took
+ * it. */
+
+#define SERVER_QUEUE_MAX_JOBS 1024
+#define SERVER_WORKER_STACK_SIZE (8 * 1024 * 1024)
+
+typedef struct ServerJob {
+    struct ServerJob *next;
+    /* the accepted connection, or -1 for the request line read from stdin */
+    int conn_fd;
+    char line[1];
+} ServerJob;
+
+typedef struct Server {
+    wasm_module_t module;
+    uint32_t stack_size;
+    uint32_t heap_size;
+    /* run every request with this function rather than "FUNC ARG..." */
+    const char *func_name;
+    /* ready instances per worker, 0 runs all the jobs of a worker on the
+     * same instance */
+    uint32_t pool_size;
+    korp_mutex lock;
+    /* signaled when a job is queued or the server is closing */
+    korp_cond job_cond;
+    /* signaled when a job is taken or a worker exits */
+    korp_cond space_cond;
+    ServerJob *head;
+    ServerJob *tail;
+    uint32_t job_count;
+    uint32_t live_workers;
+    bool closing;
+} Server;
+
+static volatile sig_atomic_t server_interrupted = 0;
+
+static void
+server_signal_handler(int sig)
+{
+    (void)sig;
+    server_interrupted = 1;
+}
+
+static bool
+server_push_job(Server *server, int conn_fd, const char *line, size_t len)
+{
+    ServerJob *job;
+
+    if (!(job = malloc(offsetof(ServerJob, line) + len + 1))) {
+        printf("Allocate server job failed.\n");
+        return false;
+    }
+    job->next = NULL;
+    job->conn_fd = conn_fd;
+    bh_memcpy_s(job->line, (uint32)len + 1, line, (uint32)len);
+    job->line[len] = '\0';
+
+    os_mutex_lock(&server->lock);
+    while (server->job_count >= SERVER_QUEUE_MAX_JOBS
+           && server->live_workers > 0) {
+        os_cond_wait(&server->space_cond, &server->lock);
+    }
+    if (server->live_workers == 0) {
+        os_mutex_unlock(&server->lock);
+        free(job);
+        printf("No server worker is running.\n");
+        return false;
+    }
+    if (server->tail) {
+        server->tail->next = job;
+    }
+    else {
+        server->head = job;
+    }
+    server->tail = job;
+    server->job_count++;
+    os_cond_signal(&server->job_cond);
+    os_mutex_unlock(&server->lock);
+
+    return true;
+}
+
+/* Returns NULL once the server is closing and the queue is drained */
+static ServerJob *
+server_take_job(Server *server)
+{
+    ServerJob *job;
+
+    os_mutex_lock(&server->lock);
+    while (!server->head && !server->closing) {
+        os_cond_wait(&server->job_cond, &server->lock);
+    }
+    if ((job = server->head)) {
+        if (!(server->head = job->next)) {
+            server->tail = NULL;
+        }
+        server->job_count--;
+        os_cond_signal(&server->space_cond);
+    }
+    os_mutex_unlock(&server->lock);
+
+    return job;
+}
+
+static void
+server_free_job(ServerJob *job)
+{
+    if (job->conn_fd >= 0) {
+        close(job->conn_fd);
+    }
+    free(job);
+}
+
+/* WAMR already printed the exception to stdout, a connection gets its own
+ * copy, then the instance is ready for the next request */
+static void
+server_report_exception(wasm_module_inst_t module_inst, FILE *out)
+{
+    const char *exception = wasm_runtime_get_exception(module_inst);
+
+    if (exception) {
+        if (out != stdout) {
+            fprintf(out, "%s\n", exception);
+        }
+        wasm_runtime_clear_exception(module_inst);
+    }
+}
+
+static void
+server_run_request(Server *server, PooledInstance *instance, char *line,
+                   FILE *out)
+{
+    wasm_module_inst_t module_inst = instance->module_inst;
+    char **args = NULL;
+    int arg_count = 0;
+    bool arena_opened;
+
+    if (line[strspn(line, " ")] != '\0'
+        && !(args = split_string(line, &arg_count))) {
+        fprintf(out, "Wasm prepare param failed: split string failed.\n");
+        return;
+    }
+
+    /* the dynamic values of the request are freed together, the ones kept
+     * by the instance stay valid */
+    arena_opened =
+        dyntype_arena_begin(instance->dyn_ctx) == DYNTYPE_SUCCESS;
+
+    if (server->func_name) {
+        wasm_application_execute_func(module_inst, server->func_name,
+                                      arg_count, args);
+    }
+    else if (arg_count != 0) {
+        wasm_application_execute_func(module_inst, args[0], arg_count - 1,
+                                      args + 1);
+    }
+    free(args);
+    server_report_exception(module_inst, out);
+
+    /* the request is done once its micro tasks and timers are */
+    execute_micro_tasks(instance->exec_env, instance->dyn_ctx);
+    server_report_exception(module_inst, out);
+
+    if (arena_opened) {
+        dyntype_arena_end(instance->dyn_ctx);
+    }
+}
+
+static void
+server_serve_connection(Server *server, PooledInstance *instance, int conn_fd)
+{
+    FILE *in, *out;
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t n;
+    int out_fd;
+
+    if (!(in = fdopen(conn_fd, "r"))) {
+        close(conn_fd);
+        return;
+    }
+    /* a socket stream can't switch between reading and writing */
+    if ((out_fd = dup(conn_fd)) < 0 || !(out = fdopen(out_fd, "w"))) {
+        if (out_fd >= 0) {
+            close(out_fd);
+        }
+        fclose(in);
+        return;
+    }
+
+    console_set_output(out);
+    while ((n = getline(&line, &len, in)) != -1) {
+        if (line[n - 1] == '\n') {
+            line[n - 1] = '\0';
+        }
+        server_run_request(server, instance, line, out);
+        if (fflush(out) != 0) {
+            /* the client went away */
+            break;
+        }
+    }
+    console_set_output(NULL);
+
+    free(line);
+    fclose(out);
+    fclose(in);
+}
+
+static void
+server_run_job(Server *server, PooledInstance *instance, ServerJob *job)
+{
+    sampling_profiler_attach(instance->exec_env);
+    if (job->conn_fd >= 0) {
+        server_serve_connection(server, instance, job->conn_fd);
+        /* closed by server_serve_connection */
+        job->conn_fd = -1;
+    }
+    else {
+        server_run_request(server, instance, job->line, stdout);
+        fflush(stdout);
+    }
+    sampling_profiler_attach(NULL);
+    server_free_job(job);
+}
+
+static void *
+server_worker(void *arg)
+{
+    Server *server = (Server *)arg;
+    InstancePool *pool = NULL;
+    PooledInstance *instance = NULL;
+    ServerJob *job;
+    bool prewarm = true;
+    char error_buf[128] = { 0 };
+
+    if (!wasm_runtime_init_thread_env()) {
+        printf("Init thread environment failed.\n");
+        goto exit;
+    }
+
+    /* the dyntype contexts, console buffers and timers are per thread */
+    dyntype_set_callback_dispatcher(dyntype_callback_wasm_dispatcher);
+
+    if (!(pool = instance_pool_create(server->module, server->stack_size,
+                                      server->heap_size, server->pool_size,
+                                      execute_micro_tasks))) {
+        printf("Create instance pool failed.\n");
+        goto fail;
+    }
+
+    if (server->pool_size == 0) {
+        /* one instance serves all the requests of the worker */
+        if (!(instance = instance_pool_acquire(pool, error_buf,
+                                               sizeof(error_buf)))) {
+            printf("%s\n", error_buf);
+            goto fail;
+        }
+    }
+    while (!instance_pool_is_full(pool)) {
+        if (!instance_pool_prewarm(pool, error_buf, sizeof(error_buf))) {
+            printf("%s\n", error_buf);
+            goto fail;
+        }
+    }
+
+    for (;;) {
+        if (!(job = server_take_job(server))) {
+            break;
+        }
+
+        if (server->pool_size == 0) {
+            server_run_job(server, instance, job);
+            continue;
+        }
+
+        /* every job gets a fresh instance */
+        if (!(instance = instance_pool_acquire(pool, error_buf,
+                                               sizeof(error_buf)))) {
+            printf("%s\n", error_buf);
+            server_free_job(job);
+            continue;
+        }
+        server_run_job(server, instance, job);
+        instance_pool_release(pool, instance);
+        instance = NULL;
+
+        /* the output of the job is flushed, replace the retired instance
+         * before taking the next job, so that under sustained load the pool
+         * stays full and acquiring never instantiates while a request
+         * waits */
+        if (prewarm
+            && !instance_pool_prewarm(pool, error_buf, sizeof(error_buf))) {
+            printf("%s\n", error_buf);
+            prewarm = false;
+        }
+    }
+
+fail:
+    if (instance) {
+        instance_pool_release(pool, instance);
+    }
+    if (pool) {
+        instance_pool_destroy(pool);
+    }
+    wasm_runtime_destroy_thread_env();
+
+exit:
+    os_mutex_lock(&server->lock);
+    server->live_workers--;
+    /* a producer waiting for space must not wait for a dead worker */
+    os_cond_broadcast(&server->space_cond);
+    os_mutex_unlock(&server->lock);
+    return NULL;
+}
+
+static int
+server_read_lines(Server *server)
+{
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t n;
+    int ret = 0;
+
+    /* getline fails with EINTR on SIGINT or SIGTERM */
+    while ((n = getline(&line, &len, stdin)) != -1) {
+        if (line[n - 1] == '\n') {
+            n--;
+        }
+        if (!server_push_job(server, -1, line, (size_t)n)) {
+            ret = -1;
+            break;
+        }
+    }
+
+    free(line);
+    return ret;
+}
+
+static int
+server_accept_connections(Server *server, const char *socket_path)
+{
+    struct sockaddr_un addr;
+    size_t path_len = strlen(socket_path);
+    int listen_fd, conn_fd, ret = 0;
+
+    if (path_len >= sizeof(addr.sun_path)) {
+        printf("Socket path is too long: %s\n", socket_path);
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    bh_memcpy_s(addr.sun_path, sizeof(addr.sun_path), socket_path,
+                (uint32)path_len);
+
+    if ((listen_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        printf("Create socket failed: %s\n", strerror(errno));
+        return -1;
+    }
+    /* the socket file of a previous server */
+    unlink(socket_path);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || listen(listen_fd, SOMAXCONN) < 0) {
+        printf("Listen on %s failed: %s\n", socket_path, strerror(errno));
+        close(listen_fd);
+        return -1;
+    }
+
+    while (!server_interrupted) {
+        if ((conn_fd = accept(listen_fd, NULL, NULL)) < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            printf("Accept connection failed: %s\n", strerror(errno));
+            ret = -1;
+            break;
+        }
+        if (!server_push_job(server, conn_fd, "", 0)) {
+            close(conn_fd);
+            ret = -1;
+            break;
+        }
+    }
+
+    close(listen_fd);
+    unlink(socket_path);
+    return ret;
+}
+
+static int
+server_run(wasm_module_t module, uint32_t stack_size, uint32_t heap_size,
+           const char *func_name, uint32_t worker_count, uint32_t pool_size,
+           const char *socket_path)
+{
+    Server server;
+    korp_tid *workers;
+    struct sigaction action;
+    sigset_t signals, old_signals;
+    ServerJob *job;
+    uint32_t i, started = 0;
+    int ret = -1;
+
+    memset(&server, 0, sizeof(Server));
+    server.module = module;
+    server.stack_size = stack_size;
+    server.heap_size = heap_size;
+    server.func_name = func_name;
+    server.pool_size = pool_size;
+
+    if (!(workers = malloc(sizeof(korp_tid) * worker_count))) {
+        printf("Allocate server workers failed.\n");
+        return -1;
+    }
+    if (os_mutex_init(&server.lock) != BHT_OK) {
+        free(workers);
+        return -1;
+    }
+    if (os_cond_init(&server.job_cond) != BHT_OK) {
+        goto fail1;
+    }
+    if (os_cond_init(&server.space_cond) != BHT_OK) {
+        goto fail2;
+    }
+
+    /* stop reading requests on the first SIGINT or SIGTERM, the second one
+     * terminates the process */
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = server_signal_handler;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    /* a client closing its connection early must not kill the server */
+    signal(SIGPIPE, SIG_IGN);
+
+    /* the signals must interrupt the reading thread, not a worker */
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, &old_signals);
+
+    for (i = 0; i < worker_count; i++) {
+        os_mutex_lock(&server.lock);
+        server.live_workers++;
+        os_mutex_unlock(&server.lock);
+
+        if (os_thread_create(&workers[started], server_worker, &server,
+                             SERVER_WORKER_STACK_SIZE)
+            != BHT_OK) {
+            printf("Create server worker failed.\n");
+            os_mutex_lock(&server.lock);
+            server.live_workers--;
+            os_mutex_unlock(&server.lock);
+            break;
+        }
+        started++;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old_signals, NULL);
+
+    if (started > 0) {
+        ret = socket_path ? server_accept_connections(&server, socket_path)
+                          : server_read_lines(&server);
+    }
+
+    /* let the workers drain the queue and exit */
+    os_mutex_lock(&server.lock);
+    server.closing = true;
+    os_cond_broadcast(&server.job_cond);
+    os_mutex_unlock(&server.lock);
+
+    for (i = 0; i < started; i++) {
+        os_thread_join(workers[i], NULL);
+    }
+
+    /* left over when all the workers failed */
+    while ((job = server.head)) {
+        server.head = job->next;
+        server_free_job(job);
+    }
+
+    os_cond_destroy(&server.space_cond);
+fail2:
+    os_cond_destroy(&server.job_cond);
+fail1:
+    os_mutex_destroy(&server.lock);
+    free(workers);
+    return ret;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -412,14 +1084,25 @@ main(int argc, char *argv[])
     int32 ret = -1;
     char *wasm_file = NULL;
     const char *func_name = NULL;
+    ModuleFile module_file = { 0 };
     uint8 *wasm_file_buf = NULL;
     uint32_t wasm_file_size;
+#if WASM_ENABLE_AOT != 0
+    const char *aot_cache_dir = NULL;
+    const char *aot_compiler = "wamrc";
+    char aot_file_path[512];
+    ModuleFile aot_file;
+    bool is_aot_cached = false;
+#endif
     uint32_t stack_size = 8 * 1024, heap_size = 4 * 1024;
 #if WASM_ENABLE_FAST_JIT != 0
     uint32_t jit_code_cache_size = FAST_JIT_DEFAULT_CODE_CACHE_SIZE;
 #endif
 #if WASM_ENABLE_GC != 0
     uint32_t gc_heap_size = GC_HEAP_SIZE_DEFAULT;
+    uint32_t gc_heap_max = 0, gc_pause_target = GC_PAUSE_TARGET_DEFAULT;
+    bool is_gc_stats = false;
+    GCTuner tuner;
 #endif
 #if WASM_ENABLE_JIT != 0
     uint32_t llvm_jit_size_level = 3;
@@ -435,7 +1118,18 @@ main(int argc, char *argv[])
 #if WASM_ENABLE_LOG != 0
     int log_verbose_level = 2;
 #endif
+    bool is_profile_natives = false;
+    const char *profile_trace_file = NULL;
+    uint32_t profile_trace_threshold = PROFILE_TRACE_THRESHOLD_DEFAULT;
+    const char *profile_sampling_file = NULL;
+    uint32_t profile_sampling_rate = PROFILE_SAMPLING_RATE_DEFAULT;
+    const char *profile_source_map = NULL;
+    char source_map_path[512];
+    bool is_heap_snapshot_signal = false;
     bool is_repl_mode = false;
+    bool is_server_mode = false;
+    uint32_t server_workers = 0, server_pool_size = 0;
+    const char *server_socket = NULL;
     bool is_xip_file = false;
     const char *exception = NULL;
 #if WASM_ENABLE_LIBC_WASI != 0
@@ -496,9 +1190,74 @@ main(int argc, char *argv[])
                 return print_help();
         }
 #endif
+        else if (!strcmp(argv[0], "--profile-natives")) {
+            is_profile_natives = true;
+        }
+        else if (!strncmp(argv[0], "--profile-natives=", 18)) {
+            if (argv[0][18] == '\0')
+                return print_help();
+            is_profile_natives = true;
+            profile_trace_file = argv[0] + 18;
+        }
+        else if (!strncmp(argv[0], "--profile-trace-threshold=", 26)) {
+            if (argv[0][26] == '\0')
+                return print_help();
+            profile_trace_threshold = atoi(argv[0] + 26);
+        }
+        else if (!strncmp(argv[0], "--profile-sampling=", 19)) {
+            if (argv[0][19] == '\0')
+                return print_help();
+            profile_sampling_file = argv[0] + 19;
+        }
+        else if (!strncmp(argv[0], "--profile-sampling-rate=", 24)) {
+            if (argv[0][24] == '\0')
+                return print_help();
+            profile_sampling_rate = atoi(argv[0] + 24);
+        }
+        else if (!strncmp(argv[0], "--profile-source-map=", 21)) {
+            if (argv[0][21] == '\0')
+                return print_help();
+            profile_source_map = argv[0] + 21;
+        }
+        else if (!strcmp(argv[0], "--heap-snapshot-signal")) {
+            is_heap_snapshot_signal = true;
+        }
         else if (!strcmp(argv[0], "--repl")) {
             is_repl_mode = true;
         }
+        else if (!strcmp(argv[0], "--server")) {
+            is_server_mode = true;
+        }
+        else if (!strncmp(argv[0], "--workers=", 10)) {
+            if (argv[0][10] == '\0')
+                return print_help();
+            server_workers = atoi(argv[0] + 10);
+            if (server_workers == 0)
+                return print_help();
+        }
+        else if (!strncmp(argv[0], "--pool-size=", 12)) {
+            if (argv[0][12] == '\0')
+                return print_help();
+            server_pool_size = atoi(argv[0] + 12);
+        }
+        else if (!strncmp(argv[0], "--socket=", 9)) {
+            if (argv[0][9] == '\0')
+                return print_help();
+            server_socket = argv[0] + 9;
+            is_server_mode = true;
+        }
+#if WASM_ENABLE_AOT != 0
+        else if (!strncmp(argv[0], "--aot-cache=", 12)) {
+            if (argv[0][12] == '\0')
+                return print_help();
+            aot_cache_dir = argv[0] + 12;
+        }
+        else if (!strncmp(argv[0], "--aot-compiler=", 15)) {
+            if (argv[0][15] == '\0')
+                return print_help();
+            aot_compiler = argv[0] + 15;
+        }
+#endif
         else if (!strncmp(argv[0], "--stack-size=", 13)) {
             if (argv[0][13] == '\0')
                 return print_help();
@@ -522,6 +1281,19 @@ main(int argc, char *argv[])
                 return print_help();
             gc_heap_size = atoi(argv[0] + 15);
         }
+        else if (!strncmp(argv[0], "--gc-heap-max=", 14)) {
+            if (argv[0][14] == '\0')
+                return print_help();
+            gc_heap_max = atoi(argv[0] + 14);
+        }
+        else if (!strncmp(argv[0], "--gc-pause-target=", 18)) {
+            if (argv[0][18] == '\0')
+                return print_help();
+            gc_pause_target = atoi(argv[0] + 18);
+        }
+        else if (!strcmp(argv[0], "--gc-stats")) {
+            is_gc_stats = true;
+        }
 #endif
 #if WASM_ENABLE_JIT != 0
         else if (!strncmp(argv[0], "--llvm-jit-size-level=", 22)) {
@@ -678,6 +1450,12 @@ main(int argc, char *argv[])
     app_argc = argc;
     app_argv = argv;
 
+    /* console lines are written with one fwrite each, let stdio batch them
+       into large writes unless the output is interactive */
+    if (!isatty(fileno(stdout))) {
+        setvbuf(stdout, NULL, _IOFBF, STDOUT_BUF_SIZE);
+    }
+
     memset(&init_args, 0, sizeof(RuntimeInitArgs));
 
     init_args.running_mode = running_mode;
@@ -697,7 +1475,10 @@ main(int argc, char *argv[])
 #endif
 
 #if WASM_ENABLE_GC != 0
-    init_args.gc_heap_size = gc_heap_size;
+    /* the pool is reserved at its maximum size, its pages are committed
+       by the allocator once the heap grows into them */
+    init_args.gc_heap_size =
+        gc_heap_max > gc_heap_size ? gc_heap_max : gc_heap_size;
 #endif
 
 #if WASM_ENABLE_JIT != 0
@@ -720,6 +1501,17 @@ main(int argc, char *argv[])
     /* initialize dyntype context and set callback dispatcher */
     dyn_ctx = dyntype_context_init();
     dyntype_set_callback_dispatcher(dyntype_callback_wasm_dispatcher);
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+    dyntype_alloc_profile_set_site_func(wamr_utils_get_caller_func_index);
+#endif
+
+    /* workers run instances of the module with the same sizes */
+    if (!worker_runtime_init(stack_size, heap_size, execute_micro_tasks)) {
+        printf("Init worker environment failed.\n");
+        dyntype_context_destroy(dyn_ctx);
+        wasm_runtime_destroy();
+        return -1;
+    }
 
 #if WASM_ENABLE_LOG != 0
     bh_log_set_verbose_level(log_verbose_level);
@@ -735,47 +1527,136 @@ main(int argc, char *argv[])
     char *module_name;
     uint32_t symbol_count;
 
+    if (is_profile_natives
+        && !native_profiler_init(profile_trace_file,
+                                 profile_trace_threshold)) {
+        printf("Open native trace file %s failed.\n", profile_trace_file);
+        goto fail1;
+    }
+
     symbol_count = get_libdyntype_symbols(&module_name, &native_symbols);
-    if (!wasm_runtime_register_natives(module_name, native_symbols,
-                                       symbol_count)) {
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
         printf("Register libdyntype APIs failed.\n");
         goto fail1;
     }
 
     symbol_count = get_lib_console_symbols(&module_name, &native_symbols);
-    if (!wasm_runtime_register_natives(module_name, native_symbols,
-                                       symbol_count)) {
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
         printf("Register stdlib APIs failed.\n");
         goto fail1;
     }
 
     symbol_count = get_lib_array_symbols(&module_name, &native_symbols);
-    if (!wasm_runtime_register_natives(module_name, native_symbols,
-                                       symbol_count)) {
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
         printf("Register stdlib APIs failed.\n");
         goto fail1;
     }
 
     symbol_count = get_lib_timer_symbols(&module_name, &native_symbols);
-    if (!wasm_runtime_register_natives(module_name, native_symbols,
-                                       symbol_count)) {
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
+        printf("Register stdlib APIs failed.\n");
+        goto fail1;
+    }
+
+    symbol_count = get_lib_worker_symbols(&module_name, &native_symbols);
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
+        printf("Register stdlib APIs failed.\n");
+        goto fail1;
+    }
+
+    symbol_count = get_lib_math_symbols(&module_name, &native_symbols);
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
+        printf("Register stdlib APIs failed.\n");
+        goto fail1;
+    }
+
+    symbol_count = get_lib_dataview_symbols(&module_name, &native_symbols);
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
+        printf("Register stdlib APIs failed.\n");
+        goto fail1;
+    }
+
+    symbol_count = get_lib_collection_symbols(&module_name, &native_symbols);
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
+        printf("Register stdlib APIs failed.\n");
+        goto fail1;
+    }
+
+    symbol_count = get_lib_number_symbols(&module_name, &native_symbols);
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
+        printf("Register stdlib APIs failed.\n");
+        goto fail1;
+    }
+
+#if WASMNIZER_ENABLE_REGEXP != 0
+    symbol_count = get_lib_regexp_symbols(&module_name, &native_symbols);
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
+        printf("Register stdlib APIs failed.\n");
+        goto fail1;
+    }
+#endif
+
+    symbol_count = get_lib_heap_snapshot_symbols(&module_name, &native_symbols);
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
+        printf("Register stdlib APIs failed.\n");
+        goto fail1;
+    }
+
+    symbol_count = get_lib_gc_memory_symbols(&module_name, &native_symbols);
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
         printf("Register stdlib APIs failed.\n");
         goto fail1;
     }
 
     symbol_count = get_struct_indirect_symbols(&module_name, &native_symbols);
-    if (!wasm_runtime_register_natives(module_name, native_symbols,
-                                       symbol_count)) {
+    if (!native_profiler_register_natives(module_name, native_symbols,
+                                          symbol_count)) {
         printf("Register struct-dyn APIs failed.\n");
         goto fail1;
     }
 
-    /* load WASM byte buffer from WASM bin file */
-    if (!(wasm_file_buf =
-              (uint8 *)bh_read_file_to_buffer(wasm_file, &wasm_file_size)))
+    /* map the WASM bin file, pages are only read as the loader needs them */
+    if (!module_file_open(wasm_file, &module_file))
         goto fail1;
+    wasm_file_buf = module_file.buf;
+    wasm_file_size = module_file.size;
 
 #if WASM_ENABLE_AOT != 0
+    if (aot_cache_dir && module_file_is_wasm(&module_file)) {
+        if (!module_file_aot_cache_path(aot_cache_dir, aot_compiler,
+                                        &module_file, aot_file_path,
+                                        sizeof(aot_file_path))) {
+            LOG_WARNING("warning: can't use AOT cache directory %s",
+                        aot_cache_dir);
+        }
+        else if (access(aot_file_path, R_OK) != 0) {
+            /* interpret this run, the next one loads native code */
+            if (!module_file_aot_compile(aot_compiler, wasm_file,
+                                         aot_file_path))
+                LOG_WARNING("warning: failed to start AOT compiler %s",
+                            aot_compiler);
+        }
+        else if (module_file_open(aot_file_path, &aot_file)) {
+            module_file_close(&module_file);
+            module_file = aot_file;
+            wasm_file_buf = module_file.buf;
+            wasm_file_size = module_file.size;
+            is_aot_cached = true;
+        }
+    }
+
     if (wasm_runtime_is_xip_file(wasm_file_buf, wasm_file_size)) {
         uint8 *wasm_file_mapped;
         int map_prot = MMAP_PROT_READ | MMAP_PROT_WRITE | MMAP_PROT_EXEC;
@@ -784,13 +1665,13 @@ main(int argc, char *argv[])
         if (!(wasm_file_mapped = os_mmap(NULL, (uint32)wasm_file_size, map_prot,
                                          map_flags, os_get_invalid_handle()))) {
             printf("mmap memory failed\n");
-            wasm_runtime_free(wasm_file_buf);
+            module_file_close(&module_file);
             goto fail1;
         }
 
         bh_memcpy_s(wasm_file_mapped, wasm_file_size, wasm_file_buf,
                     wasm_file_size);
-        wasm_runtime_free(wasm_file_buf);
+        module_file_close(&module_file);
         wasm_file_buf = wasm_file_mapped;
         is_xip_file = true;
     }
@@ -801,12 +1682,51 @@ main(int argc, char *argv[])
 #endif
 
     /* load WASM module */
-    if (!(wasm_module = wasm_runtime_load(wasm_file_buf, wasm_file_size,
-                                          error_buf, sizeof(error_buf)))) {
+    wasm_module = wasm_runtime_load(wasm_file_buf, wasm_file_size, error_buf,
+                                    sizeof(error_buf));
+#if WASM_ENABLE_AOT != 0
+    if (!wasm_module && is_aot_cached && !is_xip_file) {
+        /* e.g. compiled for another target, go on with the wasm bytes and
+           let the next run compile it again */
+        LOG_WARNING("warning: drop cached AOT module %s: %s", aot_file_path,
+                    error_buf);
+        unlink(aot_file_path);
+        module_file_close(&module_file);
+        if (!module_file_open(wasm_file, &module_file))
+            goto fail1;
+        wasm_file_buf = module_file.buf;
+        wasm_file_size = module_file.size;
+        wasm_module = wasm_runtime_load(wasm_file_buf, wasm_file_size,
+                                        error_buf, sizeof(error_buf));
+    }
+#endif
+    if (!wasm_module) {
         printf("%s\n", error_buf);
         goto fail2;
     }
 
+    if (profile_sampling_file) {
+        /* as the compiler writes it with --sourceMap */
+        if (!profile_source_map) {
+            snprintf(source_map_path, sizeof(source_map_path), "%s.map",
+                     wasm_file);
+            if (access(source_map_path, R_OK) == 0)
+                profile_source_map = source_map_path;
+        }
+        if (!sampling_profiler_init(profile_sampling_file,
+                                    profile_sampling_rate, wasm_file,
+                                    profile_source_map, wasm_file_buf,
+                                    wasm_file_size)) {
+            printf("Start sampling profiler failed.\n");
+            goto fail3;
+        }
+    }
+
+    if (is_heap_snapshot_signal && !heap_snapshot_handle_signal()) {
+        printf("Handle SIGUSR2 failed.\n");
+        goto fail3;
+    }
+
 #if WASM_ENABLE_LIBC_WASI != 0
     wasm_runtime_set_wasi_args(wasm_module, dir_list, dir_list_size, NULL, 0,
                                env_list, env_list_size, argv, argc);
@@ -816,6 +1736,20 @@ main(int argc, char *argv[])
                                          ns_lookup_pool_size);
 #endif
 
+    if (is_server_mode) {
+        if (server_workers == 0) {
+            long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+            server_workers = cpu_count > 0 ? (uint32_t)cpu_count : 1;
+        }
+        /* the instances are created by the workers */
+        ret = server_run(wasm_module, stack_size, heap_size, func_name,
+                         server_workers, server_pool_size, server_socket);
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+        dump_alloc_profile(dyn_ctx, wasm_file);
+#endif
+        goto fail3;
+    }
+
     /* instantiate the module */
     if (!(wasm_module_inst =
               wasm_runtime_instantiate(wasm_module, stack_size, heap_size,
@@ -828,6 +1762,7 @@ main(int argc, char *argv[])
     if (exec_env == NULL) {
         printf("%s\n", wasm_runtime_get_exception(wasm_module_inst));
     }
+    sampling_profiler_attach(exec_env);
 
 #if WASM_ENABLE_DEBUG_INTERP != 0
     if (ip_addr != NULL) {
@@ -840,6 +1775,15 @@ main(int argc, char *argv[])
     }
 #endif
 
+#if WASM_ENABLE_GC != 0
+    if (gc_heap_max > gc_heap_size || is_gc_stats) {
+        gc_tuner_init(&tuner, wasm_module_inst,
+                      gc_heap_max > gc_heap_size ? gc_heap_size : 0,
+                      gc_pause_target);
+        gc_tuner = &tuner;
+    }
+#endif
+
     ret = 0;
 
     start_func = wasm_runtime_lookup_function(wasm_module_inst, "_entry");
@@ -874,21 +1818,47 @@ main(int argc, char *argv[])
     }
 #endif
 
-    /* run micro tasks */
+    /* run micro tasks and timers until there is no more work */
     execute_micro_tasks(exec_env, dyn_ctx);
 
 fail4:
+    sampling_profiler_attach(NULL);
+
+    /* stop the workers and drop timers still pending, e.g. after an
+     * uncaught exception */
+    worker_events_destroy();
+    timer_events_destroy();
+
+#if WASM_ENABLE_GC != 0
+    if (gc_tuner) {
+        if (is_gc_stats) {
+            gc_tuner_update(gc_tuner, wasm_module_inst);
+            gc_tuner_dump_stats(gc_tuner, stderr);
+            dump_gc_telemetry(wasm_module_inst);
+        }
+        gc_tuner = NULL;
+    }
+#endif
+
+#if DYNTYPE_ENABLE_ALLOC_PROFILE != 0
+    /* before the instance is destroyed, its live values are reported */
+    dump_alloc_profile(dyn_ctx, wasm_file);
+#endif
+
     /* destroy the module instance */
     wasm_runtime_deinstantiate(wasm_module_inst);
 
 fail3:
+    /* write the samples, the instances are gone */
+    sampling_profiler_destroy();
+
     /* unload the module */
     wasm_runtime_unload(wasm_module);
 
 fail2:
-    /* free the file buffer */
+    /* release the file content */
     if (!is_xip_file) {
-        wasm_runtime_free(wasm_file_buf);
+        module_file_close(&module_file);
     }
 #if WASM_ENABLE_AOT != 0
     else {
@@ -902,11 +1872,19 @@ fail1:
     unregister_and_unload_native_libs(native_handle_count, native_handle_list);
 #endif
 
+    worker_runtime_destroy();
+
     /* destroy dynamic ctx */
     dyntype_context_destroy(dyn_ctx);
 
     /* destroy runtime environment */
     wasm_runtime_destroy();
 
+    /* after the workers are done */
+    if (is_profile_natives) {
+        native_profiler_dump(stderr);
+    }
+    native_profiler_destroy();
+
     return ret;
 }
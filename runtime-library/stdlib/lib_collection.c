@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include "gc_export.h"
+#include "bh_platform.h"
+
+/* Identity hash of the object keys of static Map and Set, wasm has no way
+ * to hash a reference, the GC never moves objects so the address is stable
+ * for the lifetime of the key */
+static int32_t
+collection_ref_hash(wasm_exec_env_t exec_env, void *obj)
+{
+    uint64_t addr = (uint64_t)(uintptr_t)obj;
+
+    /* objects are aligned, drop the low bits and fold the high half */
+    addr >>= 3;
+    addr ^= addr >> 32;
+
+    return (int32_t)(addr & 0x7fffffff);
+}
+
+/* clang-format off */
+#define REG_NATIVE_FUNC(func_name, signature) \
+    { #func_name, func_name, signature, NULL }
+
+static NativeSymbol native_symbols[] = {
+    REG_NATIVE_FUNC(collection_ref_hash, "(r)i"),
+};
+/* clang-format on */
+
+uint32_t
+get_lib_collection_symbols(char **p_module_name,
+                           NativeSymbol **p_native_symbols)
+{
+    *p_module_name = "env";
+    *p_native_symbols = native_symbols;
+
+    return sizeof(native_symbols) / sizeof(NativeSymbol);
+}
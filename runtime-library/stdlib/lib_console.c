@@ -3,18 +3,272 @@
  * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
  */
 
+#include <float.h>
+#include <inttypes.h>
+#include <math.h>
+
+#if WASM_ENABLE_STRINGREF != 0
+#include "string_object.h"
+#endif
+
 #include "gc_export.h"
 #include "bh_platform.h"
 #include "libdyntype_export.h"
 
-void *
-Console_constructor(wasm_exec_env_t exec_env, void *obj)
+/* A line is assembled in the stream buffer and handed to stdio with a
+ * single fwrite once it is complete, stdio then batches the lines of a
+ * fully buffered stdout (see main.c) */
+#define CONSOLE_LINE_BUF_SIZE 1024
+/* enough for any number formatted by console_format_number */
+#define CONSOLE_NUMBER_BUF_SIZE 32
+
+enum console_stream_id {
+    CONSOLE_STDOUT = 0,
+    CONSOLE_STDERR = 1,
+    CONSOLE_STREAM_COUNT,
+};
+
+typedef struct ConsoleStream {
+    uint32_t len;
+    /* a separator is needed before the next argument */
+    bool has_arg;
+    char buf[CONSOLE_LINE_BUF_SIZE];
+} ConsoleStream;
+
+/* per thread, so the lines of instances running on different threads are
+ * never mixed up */
+static os_thread_local_attribute ConsoleStream
+    console_streams[CONSOLE_STREAM_COUNT];
+/* replaces stdout for the calling thread, see console_set_output */
+static os_thread_local_attribute FILE *console_output;
+
+static inline FILE *
+console_file(int32_t stream_id)
 {
-    return obj;
+    if (stream_id == CONSOLE_STDERR) {
+        return stderr;
+    }
+    return console_output ? console_output : stdout;
+}
+
+static inline ConsoleStream *
+console_stream(int32_t stream_id)
+{
+    return &console_streams[stream_id == CONSOLE_STDERR ? CONSOLE_STDERR
+                                                        : CONSOLE_STDOUT];
+}
+
+static void
+console_flush(int32_t stream_id)
+{
+    ConsoleStream *stream = console_stream(stream_id);
+
+    if (stream->len > 0) {
+        fwrite(stream->buf, 1, stream->len, console_file(stream_id));
+        stream->len = 0;
+    }
 }
 
+static void
+console_append(int32_t stream_id, const char *data, uint32_t len)
+{
+    ConsoleStream *stream = console_stream(stream_id);
+
+    if (len > CONSOLE_LINE_BUF_SIZE - stream->len) {
+        console_flush(stream_id);
+        if (len > CONSOLE_LINE_BUF_SIZE) {
+            fwrite(data, 1, len, console_file(stream_id));
+            return;
+        }
+    }
+    bh_memcpy_s(stream->buf + stream->len, CONSOLE_LINE_BUF_SIZE - stream->len,
+                data, len);
+    stream->len += len;
+}
+
+static void
+console_begin_arg(int32_t stream_id)
+{
+    ConsoleStream *stream = console_stream(stream_id);
+
+    if (stream->has_arg) {
+        console_append(stream_id, " ", 1);
+    }
+    stream->has_arg = true;
+}
+
+static void
+console_end_line(int32_t stream_id)
+{
+    console_append(stream_id, "\n", 1);
+    console_flush(stream_id);
+    console_stream(stream_id)->has_arg = false;
+}
+
+/* Redirect console.log of the calling thread to the given file, NULL goes
+ * back to stdout. Used by the server mode of the host to answer a request on
+ * its connection. */
 void
-Console_log(wasm_exec_env_t exec_env, void *thiz, void *obj)
+console_set_output(FILE *output)
+{
+    console_flush(CONSOLE_STDOUT);
+    console_output = output;
+}
+
+/* Format the number as Number.prototype.toString() does: the shortest
+ * digits that round trip, in decimal notation for exponents in [-7, 21) */
+static uint32_t
+console_format_number(double value, char *buf)
+{
+    char tmp[CONSOLE_NUMBER_BUF_SIZE], digits[20];
+    uint32_t k = 0, len = 0;
+    int precision, n;
+    char *p;
+
+    if (isnan(value)) {
+        return (uint32_t)snprintf(buf, CONSOLE_NUMBER_BUF_SIZE, "NaN");
+    }
+    if (isinf(value)) {
+        return (uint32_t)snprintf(buf, CONSOLE_NUMBER_BUF_SIZE, "%s",
+                                  value < 0 ? "-Infinity" : "Infinity");
+    }
+    if (value == 0) {
+        /* -0 is printed as 0 too */
+        buf[0] = '0';
+        return 1;
+    }
+    if (value == trunc(value) && fabs(value) < 9007199254740992.0) {
+        return (uint32_t)snprintf(buf, CONSOLE_NUMBER_BUF_SIZE, "%" PRId64,
+                                  (int64_t)value);
+    }
+
+    /* a 15 digits result that round trips is also the shortest one, except
+     * for subnormals which have less precision */
+    for (precision = fabs(value) < DBL_MIN ? 1 : 15; precision < 17;
+         precision++) {
+        snprintf(tmp, sizeof(tmp), "%.*e", precision - 1, value);
+        if (strtod(tmp, NULL) == value) {
+            break;
+        }
+    }
+    if (precision == 17) {
+        snprintf(tmp, sizeof(tmp), "%.16e", value);
+    }
+
+    /* tmp is [-]d.ddde[+-]xx */
+    p = tmp;
+    if (*p == '-') {
+        buf[len++] = '-';
+        p++;
+    }
+    for (; *p != 'e'; p++) {
+        if (*p != '.') {
+            digits[k++] = *p;
+        }
+    }
+    n = atoi(p + 1) + 1;
+    while (k > 1 && digits[k - 1] == '0') {
+        k--;
+    }
+
+    if ((int)k <= n && n <= 21) {
+        memcpy(buf + len, digits, k);
+        len += k;
+        for (; (int)k < n; k++) {
+            buf[len++] = '0';
+        }
+    }
+    else if (0 < n && n <= 21) {
+        memcpy(buf + len, digits, n);
+        len += n;
+        buf[len++] = '.';
+        memcpy(buf + len, digits + n, k - n);
+        len += k - n;
+    }
+    else if (-6 < n && n <= 0) {
+        buf[len++] = '0';
+        buf[len++] = '.';
+        for (; n < 0; n++) {
+            buf[len++] = '0';
+        }
+        memcpy(buf + len, digits, k);
+        len += k;
+    }
+    else {
+        buf[len++] = digits[0];
+        if (k > 1) {
+            buf[len++] = '.';
+            memcpy(buf + len, digits + 1, k - 1);
+            len += k - 1;
+        }
+        len += snprintf(buf + len, CONSOLE_NUMBER_BUF_SIZE - len, "e%c%d",
+                        n - 1 < 0 ? '-' : '+', abs(n - 1));
+    }
+
+    return len;
+}
+
+static void
+console_write_number(int32_t stream_id, double value)
+{
+    char buf[CONSOLE_NUMBER_BUF_SIZE];
+
+    console_append(stream_id, buf, console_format_number(value, buf));
+}
+
+static void
+console_write_boolean(int32_t stream_id, bool value)
+{
+    if (value) {
+        console_append(stream_id, "true", 4);
+    }
+    else {
+        console_append(stream_id, "false", 5);
+    }
+}
+
+static void
+console_write_dyn_value(int32_t stream_id, dyn_value_t value)
+{
+    dyn_ctx_t ctx = dyntype_get_context();
+    char *str = NULL;
+
+    if (dyntype_is_extref(ctx, value)) {
+        console_append(stream_id, "[wasm object]", 13);
+    }
+    else if (dyntype_is_number(ctx, value)) {
+        double number = 0;
+
+        dyntype_to_number(ctx, value, &number);
+        console_write_number(stream_id, number);
+    }
+    else if (dyntype_is_bool(ctx, value)) {
+        bool boolean = false;
+
+        dyntype_to_bool(ctx, value, &boolean);
+        console_write_boolean(stream_id, boolean);
+    }
+    else if (dyntype_to_cstring(ctx, value, &str) == DYNTYPE_SUCCESS) {
+        bool is_array = dyntype_is_array(ctx, value);
+
+        if (is_array) {
+            console_append(stream_id, "[", 1);
+        }
+        console_append(stream_id, str, strlen(str));
+        if (is_array) {
+            console_append(stream_id, "]", 1);
+        }
+        dyntype_free_cstring(ctx, str);
+    }
+    else {
+        /* the dynamic backend can't convert it, let it print to stdout */
+        console_flush(stream_id);
+        dyntype_dump_value(ctx, value);
+    }
+}
+
+static void
+console_write_values(int32_t stream_id, void *obj)
 {
     uint32_t i, len;
     wasm_value_t wasm_array_data = { 0 }, wasm_array_len = { 0 };
@@ -34,18 +288,105 @@ Console_log(wasm_exec_env_t exec_env, void *thiz, void *obj)
         wasm_anyref_obj_t anyref = *((wasm_anyref_obj_t *)addr);
         dyn_value_t dynamic_val =
             (dyn_value_t)wasm_anyref_obj_get_value(anyref);
-        if (dyntype_is_extref(dyntype_get_context(), dynamic_val)) {
-            printf("[wasm object]");
-        }
-        else {
-            dyntype_dump_value(dyntype_get_context(), dynamic_val);
-        }
 
-        if (i < len - 1) {
-            printf(" ");
-        }
+        console_begin_arg(stream_id);
+        console_write_dyn_value(stream_id, dynamic_val);
+    }
+    console_end_line(stream_id);
+}
+
+void *
+Console_constructor(wasm_exec_env_t exec_env, void *obj)
+{
+    return obj;
+}
+
+void
+Console_log(wasm_exec_env_t exec_env, void *thiz, void *obj)
+{
+    console_write_values(CONSOLE_STDOUT, obj);
+}
+
+void
+Console_error(wasm_exec_env_t exec_env, void *thiz, void *obj)
+{
+    console_write_values(CONSOLE_STDERR, obj);
+}
+
+void
+Console_warn(wasm_exec_env_t exec_env, void *thiz, void *obj)
+{
+    console_write_values(CONSOLE_STDERR, obj);
+}
+
+/* The typed entry points below are called by the compiled code for each
+ * statically typed argument, followed by Console_writeEnd */
+
+void
+Console_writeNumber(wasm_exec_env_t exec_env, int32_t stream_id, double value)
+{
+    console_begin_arg(stream_id);
+    console_write_number(stream_id, value);
+}
+
+void
+Console_writeBoolean(wasm_exec_env_t exec_env, int32_t stream_id,
+                     int32_t value)
+{
+    console_begin_arg(stream_id);
+    console_write_boolean(stream_id, value != 0);
+}
+
+/* str_obj is the i8 array of the string */
+void
+Console_writeString(wasm_exec_env_t exec_env, int32_t stream_id,
+                    void *str_obj)
+{
+    wasm_array_obj_t str_arr = (wasm_array_obj_t)str_obj;
+
+    console_begin_arg(stream_id);
+    console_append(stream_id, wasm_array_obj_first_elem_addr(str_arr),
+                   wasm_array_obj_length(str_arr));
+}
+
+#if WASM_ENABLE_STRINGREF != 0
+void
+Console_writeStringref(wasm_exec_env_t exec_env, int32_t stream_id,
+                       wasm_stringref_obj_t str_obj)
+{
+    WASMString str = (WASMString)wasm_stringref_obj_get_value(str_obj);
+    ConsoleStream *stream = console_stream(stream_id);
+    int32 len;
+    char *data;
+
+    console_begin_arg(stream_id);
+    len = wasm_string_encode(str, 0, 0, NULL, NULL, WTF8);
+    if (len <= 0) {
+        return;
     }
-    printf("\n");
+    if ((uint32_t)len > CONSOLE_LINE_BUF_SIZE - stream->len) {
+        console_flush(stream_id);
+    }
+    if ((uint32_t)len <= CONSOLE_LINE_BUF_SIZE) {
+        /* encode straight into the line buffer */
+        wasm_string_encode(str, 0, 0, stream->buf + stream->len, NULL, WTF8);
+        stream->len += len;
+        return;
+    }
+
+    /* too long for the line buffer */
+    if ((data = wasm_runtime_malloc(len))) {
+        wasm_string_encode(str, 0, 0, data, NULL, WTF8);
+        fwrite(data, 1, len, console_file(stream_id));
+        wasm_runtime_free(data);
+    }
+}
+#endif
+
+void
+Console_writeEnd(wasm_exec_env_t exec_env, int32_t stream_id)
+{
+    console_end_line(stream_id);
 }
 
 /* clang-format off */
@@ -55,7 +396,15 @@ Console_log(wasm_exec_env_t exec_env, void *thiz, void *obj)
 static NativeSymbol native_symbols[] = {
     REG_NATIVE_FUNC(Console_constructor, "(r)r"),
     REG_NATIVE_FUNC(Console_log, "(rr)"),
-    /* TODO */
+    REG_NATIVE_FUNC(Console_error, "(rr)"),
+    REG_NATIVE_FUNC(Console_warn, "(rr)"),
+    REG_NATIVE_FUNC(Console_writeNumber, "(iF)"),
+    REG_NATIVE_FUNC(Console_writeBoolean, "(ii)"),
+    REG_NATIVE_FUNC(Console_writeString, "(ir)"),
+#if WASM_ENABLE_STRINGREF != 0
+    REG_NATIVE_FUNC(Console_writeStringref, "(ir)"),
+#endif
+    REG_NATIVE_FUNC(Console_writeEnd, "(i)"),
 };
 /* clang-format on */
 
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include "gc_export.h"
+#include "bh_platform.h"
+
+/* Multi-byte DataView accessors, the compiler has already checked the
+ * offset against the view, these natives copy the whole element from or to
+ * the payload of the ArrayBuffer's i8 array (see addDataViewNativeImports) */
+
+static bool
+is_host_little_endian(void)
+{
+    const uint16_t probe = 1;
+
+    return *(const uint8_t *)&probe == 1;
+}
+
+static uint8_t *
+get_elem_addr(wasm_exec_env_t exec_env, void *obj, int32_t offset,
+              uint32_t size)
+{
+    wasm_array_obj_t arr_ref = (wasm_array_obj_t)obj;
+    uint32_t len = wasm_array_obj_length(arr_ref);
+
+    if (offset < 0 || (uint32_t)offset > len
+        || len - (uint32_t)offset < size) {
+        wasm_runtime_set_exception(wasm_runtime_get_module_inst(exec_env),
+                                   "offset is outside the bounds of the "
+                                   "DataView");
+        return NULL;
+    }
+
+    return (uint8_t *)wasm_array_obj_first_elem_addr(arr_ref) + offset;
+}
+
+static void
+copy_elem(uint8_t *dst, const uint8_t *src, uint32_t size, int little_endian)
+{
+    uint32_t i;
+
+    if ((little_endian != 0) == is_host_little_endian()) {
+        memcpy(dst, src, size);
+        return;
+    }
+
+    for (i = 0; i < size; i++) {
+        dst[i] = src[size - 1 - i];
+    }
+}
+
+#define DATAVIEW_ACCESS_FUNC(bits, type, ret_type)                            \
+    static ret_type dataview_load_i##bits(wasm_exec_env_t exec_env,           \
+                                          void *obj, int32_t offset,          \
+                                          int little_endian)                  \
+    {                                                                         \
+        type value = 0;                                                       \
+        uint8_t *addr = get_elem_addr(exec_env, obj, offset, sizeof(type));   \
+                                                                              \
+        if (addr) {                                                           \
+            copy_elem((uint8_t *)&value, addr, sizeof(type), little_endian);  \
+        }                                                                     \
+        return (ret_type)value;                                               \
+    }                                                                         \
+                                                                              \
+    static void dataview_store_i##bits(wasm_exec_env_t exec_env, void *obj,   \
+                                       int32_t offset, ret_type value,        \
+                                       int little_endian)                     \
+    {                                                                         \
+        type elem = (type)value;                                              \
+        uint8_t *addr = get_elem_addr(exec_env, obj, offset, sizeof(type));   \
+                                                                              \
+        if (addr) {                                                           \
+            copy_elem(addr, (uint8_t *)&elem, sizeof(type), little_endian);   \
+        }                                                                     \
+    }
+
+DATAVIEW_ACCESS_FUNC(16, uint16_t, int32_t)
+DATAVIEW_ACCESS_FUNC(32, uint32_t, int32_t)
+DATAVIEW_ACCESS_FUNC(64, uint64_t, int64_t)
+
+/* clang-format off */
+#define REG_NATIVE_FUNC(func_name, signature) \
+    { #func_name, func_name, signature, NULL }
+
+static NativeSymbol native_symbols[] = {
+    REG_NATIVE_FUNC(dataview_load_i16, "(rii)i"),
+    REG_NATIVE_FUNC(dataview_load_i32, "(rii)i"),
+    REG_NATIVE_FUNC(dataview_load_i64, "(rii)I"),
+    REG_NATIVE_FUNC(dataview_store_i16, "(riii)"),
+    REG_NATIVE_FUNC(dataview_store_i32, "(riii)"),
+    REG_NATIVE_FUNC(dataview_store_i64, "(riIi)"),
+};
+/* clang-format on */
+
+uint32_t
+get_lib_dataview_symbols(char **p_module_name, NativeSymbol **p_native_symbols)
+{
+    *p_module_name = "env";
+    *p_native_symbols = native_symbols;
+
+    return sizeof(native_symbols) / sizeof(NativeSymbol);
+}
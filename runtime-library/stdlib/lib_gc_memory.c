@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include "bh_platform.h"
+#include "gc_export.h"
+#include "gc_telemetry.h"
+#include "libdyntype_export.h"
+#include "object_utils.h"
+#include "type_utils.h"
+
+static bool
+set_number_property(dyn_ctx_t ctx, dyn_value_t obj, const char *name,
+                    double number)
+{
+    dyn_value_t prop;
+
+    if (!(prop = dyntype_new_number(ctx, number))) {
+        return false;
+    }
+    dyntype_set_property(ctx, obj, name, prop);
+    dyntype_release(ctx, prop);
+    return true;
+}
+
+void *
+getGCMemoryInfo(wasm_exec_env_t exec_env)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    dyn_ctx_t dyn_ctx = dyntype_get_context();
+    GCTelemetryStats stats;
+    dyn_value_t info;
+
+    if (!gc_telemetry_get_stats(module_inst, &stats)) {
+        wasm_runtime_set_exception(module_inst,
+                                   "gc statistics not available");
+        return NULL;
+    }
+
+    if (!(info = dyntype_new_object(dyn_ctx))) {
+        wasm_runtime_set_exception(module_inst, "alloc memory failed");
+        return NULL;
+    }
+
+    if (!set_number_property(dyn_ctx, info, "usedHeapSize",
+                             stats.used_heap_size)
+        || !set_number_property(dyn_ctx, info, "heapSizeLimit",
+                                stats.heap_size_limit)
+        || !set_number_property(dyn_ctx, info, "peakHeapSize",
+                                stats.peak_heap_size)
+        || !set_number_property(dyn_ctx, info, "collections",
+                                stats.collections)
+        || !set_number_property(dyn_ctx, info, "pauseTime", stats.pause_time)
+        || !set_number_property(dyn_ctx, info, "maxPauseTime",
+                                stats.max_pause_time)
+        || !set_number_property(dyn_ctx, info, "reclaimedBytes",
+                                (double)stats.reclaimed_size)
+        || !set_number_property(dyn_ctx, info, "finalizersRun",
+                                (double)stats.finalizers_run)) {
+        dyntype_release(dyn_ctx, info);
+        wasm_runtime_set_exception(module_inst, "alloc memory failed");
+        return NULL;
+    }
+
+    RETURN_BOX_ANYREF(info, dyn_ctx);
+}
+
+/* clang-format off */
+#define REG_NATIVE_FUNC(func_name, signature) \
+    { #func_name, func_name, signature, NULL }
+
+static NativeSymbol native_symbols[] = {
+    REG_NATIVE_FUNC(getGCMemoryInfo, "()r"),
+};
+/* clang-format on */
+
+uint32_t
+get_lib_gc_memory_symbols(char **p_module_name,
+                          NativeSymbol **p_native_symbols)
+{
+    *p_module_name = "env";
+    *p_native_symbols = native_symbols;
+
+    return sizeof(native_symbols) / sizeof(NativeSymbol);
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include "bh_platform.h"
+#include "gc_export.h"
+#include "heap_snapshot.h"
+#include "type_utils.h"
+
+static char *
+string_dup(void *str_obj)
+{
+    char *str;
+#if WASM_ENABLE_STRINGREF != 0
+    uint32_t len = wasm_string_get_length((wasm_stringref_obj_t)str_obj);
+
+    if ((str = wasm_runtime_malloc(len))) {
+        wasm_string_to_cstring((wasm_stringref_obj_t)str_obj, str, len);
+    }
+#else
+    const char *value = get_str_from_string_struct((wasm_struct_obj_t)str_obj);
+    uint32_t len = get_str_length_from_string_struct((wasm_struct_obj_t)str_obj);
+
+    if ((str = wasm_runtime_malloc(len + 1))) {
+        bh_memcpy_s(str, len + 1, value, len);
+        str[len] = '\0';
+    }
+#endif
+    return str;
+}
+
+void
+writeHeapSnapshot(wasm_exec_env_t exec_env, void *path_obj)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    char *path;
+
+    if (!(path = string_dup(path_obj))) {
+        wasm_runtime_set_exception(module_inst, "alloc memory failed");
+        return;
+    }
+    if (!heap_snapshot_write(exec_env, path)) {
+        wasm_runtime_set_exception(module_inst,
+                                   "write heap snapshot failed");
+    }
+    wasm_runtime_free(path);
+}
+
+/* clang-format off */
+#define REG_NATIVE_FUNC(func_name, signature) \
+    { #func_name, func_name, signature, NULL }
+
+static NativeSymbol native_symbols[] = {
+    REG_NATIVE_FUNC(writeHeapSnapshot, "(r)"),
+};
+/* clang-format on */
+
+uint32_t
+get_lib_heap_snapshot_symbols(char **p_module_name,
+                              NativeSymbol **p_native_symbols)
+{
+    *p_module_name = "env";
+    *p_native_symbols = native_symbols;
+
+    return sizeof(native_symbols) / sizeof(NativeSymbol);
+}
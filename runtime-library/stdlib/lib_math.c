@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include <math.h>
+#include <time.h>
+
+#include "bh_platform.h"
+#include "wasm_export.h"
+
+/* Math methods which can't be expressed by a single wasm instruction,
+ * the compiler forwards them to these natives (see callBuiltInAPIs) */
+
+#define MATH_UNARY_FUNC(name)                                     \
+    static double Math_##name(wasm_exec_env_t exec_env, double x) \
+    {                                                             \
+        return name(x);                                           \
+    }
+
+#define MATH_BINARY_FUNC(name)                                              \
+    static double Math_##name(wasm_exec_env_t exec_env, double x, double y) \
+    {                                                                       \
+        return name(x, y);                                                  \
+    }
+
+MATH_UNARY_FUNC(exp)
+MATH_UNARY_FUNC(log)
+MATH_UNARY_FUNC(log2)
+MATH_UNARY_FUNC(log10)
+MATH_UNARY_FUNC(sin)
+MATH_UNARY_FUNC(cos)
+MATH_UNARY_FUNC(tan)
+MATH_UNARY_FUNC(asin)
+MATH_UNARY_FUNC(acos)
+MATH_UNARY_FUNC(atan)
+MATH_UNARY_FUNC(cbrt)
+MATH_BINARY_FUNC(atan2)
+MATH_BINARY_FUNC(hypot)
+
+static double
+Math_pow(wasm_exec_env_t exec_env, double x, double y)
+{
+    /* differs from C: pow(1, NaN) and pow(-1, +-Infinity) are NaN in JS */
+    if (isnan(y) || (isinf(y) && fabs(x) == 1.0)) {
+        return NAN;
+    }
+    return pow(x, y);
+}
+
+/* xorshift128+, seeded once per thread */
+static os_thread_local_attribute uint64_t random_state[2];
+static os_thread_local_attribute bool random_seeded = false;
+
+static uint64_t
+random_splitmix64(uint64_t *seed)
+{
+    uint64_t z = (*seed += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static double
+Math_random(wasm_exec_env_t exec_env)
+{
+    uint64_t s0, s1;
+
+    if (!random_seeded) {
+        uint64_t seed = (uint64_t)time(NULL) ^ (uint64_t)(uintptr_t)&seed;
+
+        random_state[0] = random_splitmix64(&seed);
+        random_state[1] = random_splitmix64(&seed);
+        random_seeded = true;
+    }
+
+    s1 = random_state[0];
+    s0 = random_state[1];
+    random_state[0] = s0;
+    s1 ^= s1 << 23;
+    random_state[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+
+    /* use the high 53 bits as the mantissa of a double in [0, 1) */
+    return (double)((random_state[1] + s0) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* clang-format off */
+#define REG_NATIVE_FUNC(func_name, signature) \
+    { #func_name, func_name, signature, NULL }
+
+static NativeSymbol native_symbols[] = {
+    REG_NATIVE_FUNC(Math_pow, "(FF)F"),
+    REG_NATIVE_FUNC(Math_exp, "(F)F"),
+    REG_NATIVE_FUNC(Math_log, "(F)F"),
+    REG_NATIVE_FUNC(Math_log2, "(F)F"),
+    REG_NATIVE_FUNC(Math_log10, "(F)F"),
+    REG_NATIVE_FUNC(Math_sin, "(F)F"),
+    REG_NATIVE_FUNC(Math_cos, "(F)F"),
+    REG_NATIVE_FUNC(Math_tan, "(F)F"),
+    REG_NATIVE_FUNC(Math_asin, "(F)F"),
+    REG_NATIVE_FUNC(Math_acos, "(F)F"),
+    REG_NATIVE_FUNC(Math_atan, "(F)F"),
+    REG_NATIVE_FUNC(Math_cbrt, "(F)F"),
+    REG_NATIVE_FUNC(Math_atan2, "(FF)F"),
+    REG_NATIVE_FUNC(Math_hypot, "(FF)F"),
+    REG_NATIVE_FUNC(Math_random, "()F"),
+};
+/* clang-format on */
+
+uint32_t
+get_lib_math_symbols(char **p_module_name, NativeSymbol **p_native_symbols)
+{
+    *p_module_name = "env";
+    *p_native_symbols = native_symbols;
+
+    return sizeof(native_symbols) / sizeof(NativeSymbol);
+}
@@ -0,0 +1,682 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include <pthread.h>
+
+#include "gc_export.h"
+#include "bh_platform.h"
+#include "libregexp.h"
+#include "type.h"
+
+/* RegExp natives backed by libregexp of QuickJS.
+ *
+ * A pattern is compiled once per (source, flags) pair, the bytecode is kept
+ * in a cache and the compiler refers to it by the returned pattern id. Regex
+ * literals additionally keep the id in a wasm global, so evaluating a literal
+ * again doesn't even hash the source (see addRegExpFunctions). The entries of
+ * literals are pinned for the lifetime of the process.
+ *
+ * Patterns built by `new RegExp` are unbounded, so their entries are counted:
+ * regexp_compile_dynamic takes a reference for the new RegExp object and
+ * regexp_bind hands it to a GC finalizer of the object. An entry nobody
+ * refers to stays cached for the next `new RegExp` of the same pattern, only
+ * the REGEXP_UNUSED_MAX most recently released ones are kept and the others
+ * are freed, their ids are reused. The id of a live RegExp object is always
+ * valid. The cache is shared by the instances of all threads and guarded by
+ * regexp_lock, the bytecode of published entries is immutable.
+ *
+ * Strings are UTF-8 and indexed by byte, the same as the other string
+ * methods. libregexp parses the pattern as UTF-8 and matches UTF-16 code
+ * units, so a subject with non-ASCII characters is decoded to UTF-16 before
+ * matching (see decode_subject), lastIndex and the capture offsets are
+ * mapped between byte offsets and code unit indexes. ASCII subjects are
+ * matched as 8-bit buffers directly. */
+
+#define REGEXP_HASH_SIZE 256
+#define REGEXP_CAPTURE_MAX 255
+#define REGEXP_UNUSED_MAX 64
+
+typedef struct RegExpEntry {
+    struct RegExpEntry *next;
+    /* unused entries of dynamic patterns, least recently released first */
+    struct RegExpEntry *lru_prev;
+    struct RegExpEntry *lru_next;
+    int32_t id;
+    uint32_t hash;
+    /* RegExp objects of dynamic patterns referring to the entry */
+    uint32_t ref_count;
+    /* compiled for a literal, never freed */
+    bool pinned;
+    int32_t re_flags;
+    int32_t capture_count;
+    uint8_t *bytecode;
+    uint32_t source_len;
+    /* NUL terminated, lre_compile may look one byte past the end */
+    uint8_t source[1];
+} RegExpEntry;
+
+static RegExpEntry *regexp_buckets[REGEXP_HASH_SIZE];
+static RegExpEntry **regexp_entries;
+static uint32_t regexp_entry_count;
+static uint32_t regexp_entry_capacity;
+/* ids of the freed entries, regexp_entry_capacity elements */
+static int32_t *regexp_free_ids;
+static uint32_t regexp_free_id_count;
+static RegExpEntry *regexp_lru_head;
+static RegExpEntry *regexp_lru_tail;
+static uint32_t regexp_unused_count;
+static pthread_mutex_t regexp_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static JSContext *
+get_js_context(void)
+{
+    dyn_ctx_t dyn_ctx = dyntype_get_context();
+
+    return dyn_ctx ? dyn_ctx->js_ctx : NULL;
+}
+
+static int32_t
+parse_flags(const uint8_t *flags, uint32_t len)
+{
+    int32_t re_flags = 0, mask;
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        switch (flags[i]) {
+            case 'g':
+                mask = LRE_FLAG_GLOBAL;
+                break;
+            case 'i':
+                mask = LRE_FLAG_IGNORECASE;
+                break;
+            case 'm':
+                mask = LRE_FLAG_MULTILINE;
+                break;
+            case 's':
+                mask = LRE_FLAG_DOTALL;
+                break;
+            case 'u':
+                mask = LRE_FLAG_UTF16;
+                break;
+            case 'y':
+                mask = LRE_FLAG_STICKY;
+                break;
+            default:
+                return -1;
+        }
+        if (re_flags & mask) {
+            return -1;
+        }
+        re_flags |= mask;
+    }
+
+    return re_flags;
+}
+
+static uint32_t
+hash_pattern(const uint8_t *source, uint32_t len, int32_t re_flags)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261u ^ (uint32_t)re_flags;
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        hash = (hash ^ source[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+static RegExpEntry *
+get_entry(wasm_exec_env_t exec_env, int32_t pattern_id)
+{
+    RegExpEntry *entry = NULL;
+
+    /* the entry array may be reallocated by a compile on another thread */
+    pthread_mutex_lock(&regexp_lock);
+    if (pattern_id >= 0 && (uint32_t)pattern_id < regexp_entry_count) {
+        entry = regexp_entries[pattern_id];
+    }
+    pthread_mutex_unlock(&regexp_lock);
+
+    if (!entry) {
+        wasm_runtime_set_exception(wasm_runtime_get_module_inst(exec_env),
+                                   "invalid regular expression id");
+    }
+    return entry;
+}
+
+/* decode the UTF-8 sequence at str, returns its length, 0 if invalid */
+static uint32_t
+utf8_decode(const uint8_t *str, uint32_t len, uint32_t *p_cp)
+{
+    uint32_t cp, size, min, i;
+
+    if (str[0] < 0x80) {
+        *p_cp = str[0];
+        return 1;
+    }
+    if (str[0] >= 0xc2 && str[0] <= 0xdf) {
+        cp = str[0] & 0x1f;
+        size = 2;
+        min = 0x80;
+    }
+    else if (str[0] >= 0xe0 && str[0] <= 0xef) {
+        cp = str[0] & 0x0f;
+        size = 3;
+        min = 0x800;
+    }
+    else if (str[0] >= 0xf0 && str[0] <= 0xf4) {
+        cp = str[0] & 0x07;
+        size = 4;
+        min = 0x10000;
+    }
+    else {
+        return 0;
+    }
+    if (size > len) {
+        return 0;
+    }
+    for (i = 1; i < size; i++) {
+        if ((str[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+        cp = (cp << 6) | (str[i] & 0x3f);
+    }
+    if (cp < min || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff)) {
+        return 0;
+    }
+    *p_cp = cp;
+    return size;
+}
+
+/* the 3-byte encoding of a surrogate code unit */
+static uint8_t *
+put_surrogate(uint8_t *p, uint32_t unit)
+{
+    *p++ = 0xe0 | (unit >> 12);
+    *p++ = 0x80 | ((unit >> 6) & 0x3f);
+    *p++ = 0x80 | (unit & 0x3f);
+    return p;
+}
+
+/* A NUL terminated copy of the pattern for lre_compile. Without the u flag
+ * libregexp expects characters above U+FFFF as two surrogates (CESU-8, as
+ * QuickJS passes them), with it as one UTF-8 sequence. */
+static uint8_t *
+copy_source(const uint8_t *src, uint32_t len, int32_t re_flags,
+            uint32_t *p_copy_len)
+{
+    bool cesu8 = !(re_flags & LRE_FLAG_UTF16);
+    uint32_t i, size, cp;
+    uint8_t *copy, *p;
+
+    /* a 4-byte sequence becomes two 3-byte ones */
+    if (!(copy = wasm_runtime_malloc(len + len / 2 + 1))) {
+        return NULL;
+    }
+    for (i = 0, p = copy; i < len; i += size) {
+        if (cesu8 && src[i] >= 0xf0
+            && (size = utf8_decode(src + i, len - i, &cp)) == 4) {
+            cp -= 0x10000;
+            p = put_surrogate(p, 0xd800 + (cp >> 10));
+            p = put_surrogate(p, 0xdc00 + (cp & 0x3ff));
+            continue;
+        }
+        size = 1;
+        *p++ = src[i];
+    }
+    *p = '\0';
+    *p_copy_len = (uint32_t)(p - copy);
+
+    return copy;
+}
+
+/* Decode a UTF-8 subject into UTF-16 code units, offsets[k] is the byte
+ * offset of the character of unit k (both surrogates of a pair map to its
+ * first byte) and offsets[unit_count] the length. An invalid byte decodes
+ * to U+FFFD. There are never more units than bytes. */
+static bool
+decode_subject(const uint8_t *str, uint32_t len, uint16_t **p_units,
+               uint32_t **p_offsets, uint32_t *p_unit_count)
+{
+    uint16_t *units;
+    uint32_t *offsets;
+    uint32_t i, n, size, cp;
+
+    units = wasm_runtime_malloc(sizeof(uint16_t) * (len ? len : 1));
+    offsets = wasm_runtime_malloc(sizeof(uint32_t) * (len + 1));
+    if (!units || !offsets) {
+        if (units) {
+            wasm_runtime_free(units);
+        }
+        if (offsets) {
+            wasm_runtime_free(offsets);
+        }
+        return false;
+    }
+
+    for (i = 0, n = 0; i < len; i += size) {
+        if (!(size = utf8_decode(str + i, len - i, &cp))) {
+            cp = 0xfffd;
+            size = 1;
+        }
+        if (cp >= 0x10000) {
+            cp -= 0x10000;
+            offsets[n] = i;
+            units[n++] = 0xd800 + (cp >> 10);
+            cp = 0xdc00 + (cp & 0x3ff);
+        }
+        offsets[n] = i;
+        units[n++] = (uint16_t)cp;
+    }
+    offsets[n] = len;
+
+    *p_units = units;
+    *p_offsets = offsets;
+    *p_unit_count = n;
+    return true;
+}
+
+/* the first unit whose character starts at or after the byte offset */
+static uint32_t
+unit_index_of(const uint32_t *offsets, uint32_t unit_count, uint32_t offset)
+{
+    uint32_t low = 0, high = unit_count;
+
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (offsets[mid] < offset) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static RegExpEntry *
+compile_entry(wasm_module_inst_t module_inst, const uint8_t *source,
+              uint32_t source_len, int32_t re_flags, uint32_t hash)
+{
+    JSContext *js_ctx = get_js_context();
+    RegExpEntry *entry;
+    char error_msg[64], exception_msg[128];
+    uint8_t *source_copy, *bytecode;
+    uint32_t source_copy_len;
+    int bytecode_len;
+
+    if (!js_ctx) {
+        wasm_runtime_set_exception(module_inst,
+                                   "regular expression engine not ready");
+        return NULL;
+    }
+
+    if (!(source_copy =
+              copy_source(source, source_len, re_flags, &source_copy_len))) {
+        wasm_runtime_set_exception(module_inst, "allocate memory failed");
+        return NULL;
+    }
+    bytecode = lre_compile(&bytecode_len, error_msg, sizeof(error_msg),
+                           (const char *)source_copy, source_copy_len,
+                           re_flags, js_ctx);
+    wasm_runtime_free(source_copy);
+    if (!bytecode) {
+        snprintf(exception_msg, sizeof(exception_msg),
+                 "Invalid regular expression: %s", error_msg);
+        wasm_runtime_set_exception(module_inst, exception_msg);
+        return NULL;
+    }
+
+    /* keep a private copy, the bytecode is allocated by the JS runtime */
+    if (!(entry = wasm_runtime_malloc(offsetof(RegExpEntry, source)
+                                      + source_len + 1 + bytecode_len))) {
+        lre_realloc(js_ctx, bytecode, 0);
+        wasm_runtime_set_exception(module_inst, "allocate memory failed");
+        return NULL;
+    }
+    memset(entry, 0, offsetof(RegExpEntry, source));
+    entry->hash = hash;
+    entry->re_flags = re_flags;
+    entry->capture_count = lre_get_capture_count(bytecode);
+    entry->source_len = source_len;
+    bh_memcpy_s(entry->source, source_len + 1, source, source_len);
+    entry->source[source_len] = '\0';
+    entry->bytecode = entry->source + source_len + 1;
+    bh_memcpy_s(entry->bytecode, bytecode_len, bytecode, bytecode_len);
+    lre_realloc(js_ctx, bytecode, 0);
+
+    return entry;
+}
+
+static bool
+append_entry(RegExpEntry *entry)
+{
+    RegExpEntry **entries;
+    int32_t *free_ids;
+    uint32_t capacity;
+
+    if (regexp_free_id_count > 0) {
+        entry->id = regexp_free_ids[--regexp_free_id_count];
+        regexp_entries[entry->id] = entry;
+        return true;
+    }
+
+    if (regexp_entry_count == regexp_entry_capacity) {
+        capacity = regexp_entry_capacity ? regexp_entry_capacity * 2 : 16;
+        if (!(entries =
+                  wasm_runtime_malloc(sizeof(RegExpEntry *) * capacity))) {
+            return false;
+        }
+        if (!(free_ids = wasm_runtime_malloc(sizeof(int32_t) * capacity))) {
+            wasm_runtime_free(entries);
+            return false;
+        }
+        if (regexp_entry_count > 0) {
+            bh_memcpy_s(entries, sizeof(RegExpEntry *) * capacity,
+                        regexp_entries,
+                        sizeof(RegExpEntry *) * regexp_entry_count);
+            wasm_runtime_free(regexp_entries);
+            wasm_runtime_free(regexp_free_ids);
+        }
+        regexp_entries = entries;
+        regexp_free_ids = free_ids;
+        regexp_entry_capacity = capacity;
+    }
+    entry->id = (int32_t)regexp_entry_count;
+    regexp_entries[regexp_entry_count++] = entry;
+
+    return true;
+}
+
+static void
+lru_unlink(RegExpEntry *entry)
+{
+    if (entry->lru_prev) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    }
+    else {
+        regexp_lru_head = entry->lru_next;
+    }
+    if (entry->lru_next) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    }
+    else {
+        regexp_lru_tail = entry->lru_prev;
+    }
+    entry->lru_prev = entry->lru_next = NULL;
+    regexp_unused_count--;
+}
+
+static void
+lru_append(RegExpEntry *entry)
+{
+    entry->lru_prev = regexp_lru_tail;
+    entry->lru_next = NULL;
+    if (regexp_lru_tail) {
+        regexp_lru_tail->lru_next = entry;
+    }
+    else {
+        regexp_lru_head = entry;
+    }
+    regexp_lru_tail = entry;
+    regexp_unused_count++;
+}
+
+/* an entry is in the LRU list iff it isn't pinned and isn't referred to */
+static bool
+is_unused(RegExpEntry *entry)
+{
+    return !entry->pinned && entry->ref_count == 0;
+}
+
+static void
+evict_entry(RegExpEntry *entry)
+{
+    RegExpEntry **p_entry = &regexp_buckets[entry->hash % REGEXP_HASH_SIZE];
+
+    while (*p_entry != entry) {
+        p_entry = &(*p_entry)->next;
+    }
+    *p_entry = entry->next;
+    lru_unlink(entry);
+    regexp_entries[entry->id] = NULL;
+    regexp_free_ids[regexp_free_id_count++] = entry->id;
+    wasm_runtime_free(entry);
+}
+
+/* look the pattern up or compile it, called with regexp_lock held, a cached
+ * entry is taken out of the LRU list, the caller pins it or refers to it */
+static RegExpEntry *
+find_or_compile_entry(wasm_module_inst_t module_inst, void *source_obj,
+                      void *flags_obj)
+{
+    wasm_array_obj_t source_arr = (wasm_array_obj_t)source_obj;
+    wasm_array_obj_t flags_arr = (wasm_array_obj_t)flags_obj;
+    const uint8_t *source = wasm_array_obj_first_elem_addr(source_arr);
+    uint32_t source_len = wasm_array_obj_length(source_arr);
+    RegExpEntry *entry;
+    int32_t re_flags;
+    uint32_t hash;
+
+    re_flags = parse_flags(wasm_array_obj_first_elem_addr(flags_arr),
+                           wasm_array_obj_length(flags_arr));
+    if (re_flags < 0) {
+        wasm_runtime_set_exception(module_inst,
+                                   "Invalid regular expression flags");
+        return NULL;
+    }
+
+    hash = hash_pattern(source, source_len, re_flags);
+    for (entry = regexp_buckets[hash % REGEXP_HASH_SIZE]; entry;
+         entry = entry->next) {
+        if (entry->hash == hash && entry->re_flags == re_flags
+            && entry->source_len == source_len
+            && memcmp(entry->source, source, source_len) == 0) {
+            if (is_unused(entry)) {
+                lru_unlink(entry);
+            }
+            return entry;
+        }
+    }
+
+    if (!(entry = compile_entry(module_inst, source, source_len, re_flags,
+                                hash))) {
+        return NULL;
+    }
+    if (!append_entry(entry)) {
+        wasm_runtime_free(entry);
+        wasm_runtime_set_exception(module_inst, "allocate memory failed");
+        return NULL;
+    }
+    entry->next = regexp_buckets[hash % REGEXP_HASH_SIZE];
+    regexp_buckets[hash % REGEXP_HASH_SIZE] = entry;
+
+    return entry;
+}
+
+/* compile a regex literal, returns the id of its pinned entry, the source
+ * and flags are the i8 arrays of the strings */
+static int32_t
+regexp_compile(wasm_exec_env_t exec_env, void *source_obj, void *flags_obj)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    RegExpEntry *entry;
+
+    pthread_mutex_lock(&regexp_lock);
+    if ((entry = find_or_compile_entry(module_inst, source_obj, flags_obj))) {
+        entry->pinned = true;
+    }
+    pthread_mutex_unlock(&regexp_lock);
+
+    return entry ? entry->id : -1;
+}
+
+/* compile the pattern of `new RegExp`, returns the id with a reference
+ * taken, the caller passes it on to the new object by regexp_bind */
+static int32_t
+regexp_compile_dynamic(wasm_exec_env_t exec_env, void *source_obj,
+                       void *flags_obj)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    RegExpEntry *entry;
+
+    pthread_mutex_lock(&regexp_lock);
+    if ((entry = find_or_compile_entry(module_inst, source_obj, flags_obj))) {
+        entry->ref_count++;
+    }
+    pthread_mutex_unlock(&regexp_lock);
+
+    return entry ? entry->id : -1;
+}
+
+static void
+release_entry(int32_t pattern_id)
+{
+    RegExpEntry *entry;
+
+    pthread_mutex_lock(&regexp_lock);
+    entry = regexp_entries[pattern_id];
+    bh_assert(entry && entry->ref_count > 0);
+    if (--entry->ref_count == 0 && !entry->pinned) {
+        lru_append(entry);
+        if (regexp_unused_count > REGEXP_UNUSED_MAX) {
+            evict_entry(regexp_lru_head);
+        }
+    }
+    pthread_mutex_unlock(&regexp_lock);
+}
+
+static void
+regexp_object_finalizer(wasm_obj_t obj, void *data)
+{
+    release_entry((int32_t)(intptr_t)data);
+}
+
+/* the RegExp object owns the reference taken by regexp_compile_dynamic */
+static void
+regexp_bind(wasm_exec_env_t exec_env, void *re_obj, int32_t pattern_id)
+{
+    wasm_obj_set_gc_finalizer(exec_env, (wasm_obj_t)re_obj,
+                              (wasm_obj_finalizer_t)regexp_object_finalizer,
+                              (void *)(intptr_t)pattern_id);
+}
+
+static int32_t
+regexp_capture_count(wasm_exec_env_t exec_env, int32_t pattern_id)
+{
+    RegExpEntry *entry = get_entry(exec_env, pattern_id);
+
+    return entry ? entry->capture_count : 0;
+}
+
+static int32_t
+regexp_get_flags(wasm_exec_env_t exec_env, int32_t pattern_id)
+{
+    RegExpEntry *entry = get_entry(exec_env, pattern_id);
+
+    return entry ? entry->re_flags : 0;
+}
+
+/* match the subject from last_index, on success the start and end offsets
+ * of every capture are written to the i32 array, -1 for groups which didn't
+ * participate in the match, all of them byte offsets */
+static int32_t
+regexp_exec(wasm_exec_env_t exec_env, int32_t pattern_id, void *str_obj,
+            int32_t last_index, void *captures_obj)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    wasm_array_obj_t str_arr = (wasm_array_obj_t)str_obj;
+    wasm_array_obj_t captures_arr = (wasm_array_obj_t)captures_obj;
+    const uint8_t *str = wasm_array_obj_first_elem_addr(str_arr);
+    uint32_t str_len = wasm_array_obj_length(str_arr);
+    uint8_t *capture[REGEXP_CAPTURE_MAX * 2];
+    const uint8_t *cbuf = str;
+    uint16_t *units = NULL;
+    uint32_t *unit_offsets = NULL;
+    uint32_t i, clen = str_len, cindex = (uint32_t)last_index;
+    RegExpEntry *entry;
+    int32_t *offsets;
+    int32_t ret;
+
+    if (!(entry = get_entry(exec_env, pattern_id))) {
+        return 0;
+    }
+    if (last_index < 0 || (uint32_t)last_index > str_len) {
+        return 0;
+    }
+    if (entry->capture_count > REGEXP_CAPTURE_MAX
+        || wasm_array_obj_length(captures_arr)
+               < (uint32_t)entry->capture_count * 2) {
+        wasm_runtime_set_exception(module_inst,
+                                   "regular expression capture overflow");
+        return 0;
+    }
+
+    for (i = 0; i < str_len && str[i] < 0x80; i++) {
+    }
+    if (i < str_len) {
+        if (!decode_subject(str, str_len, &units, &unit_offsets, &clen)) {
+            wasm_runtime_set_exception(module_inst, "allocate memory failed");
+            return 0;
+        }
+        cbuf = (const uint8_t *)units;
+        cindex = unit_index_of(unit_offsets, clen, (uint32_t)last_index);
+    }
+
+    /* cbuf_type 1 is a 16-bit buffer, lre_exec matches surrogate pairs as
+     * one character (its cbuf_type 2) for unicode patterns */
+    ret = lre_exec(capture, entry->bytecode, cbuf, (int)cindex, (int)clen,
+                   units ? 1 : 0, get_js_context());
+    if (ret < 0) {
+        wasm_runtime_set_exception(module_inst,
+                                   "regular expression execution failed");
+    }
+    else if (ret == 1) {
+        offsets = wasm_array_obj_first_elem_addr(captures_arr);
+        for (i = 0; i < (uint32_t)entry->capture_count * 2; i++) {
+            if (!capture[i]) {
+                offsets[i] = -1;
+            }
+            else if (units) {
+                offsets[i] = (int32_t)
+                    unit_offsets[(capture[i] - cbuf) / sizeof(uint16_t)];
+            }
+            else {
+                offsets[i] = (int32_t)(capture[i] - cbuf);
+            }
+        }
+    }
+
+    if (units) {
+        wasm_runtime_free(units);
+        wasm_runtime_free(unit_offsets);
+    }
+    return ret < 0 ? 0 : ret;
+}
+
+/* clang-format off */
+#define REG_NATIVE_FUNC(func_name, signature) \
+    { #func_name, func_name, signature, NULL }
+
+static NativeSymbol native_symbols[] = {
+    REG_NATIVE_FUNC(regexp_compile, "(rr)i"),
+    REG_NATIVE_FUNC(regexp_compile_dynamic, "(rr)i"),
+    REG_NATIVE_FUNC(regexp_bind, "(ri)"),
+    REG_NATIVE_FUNC(regexp_capture_count, "(i)i"),
+    REG_NATIVE_FUNC(regexp_get_flags, "(i)i"),
+    REG_NATIVE_FUNC(regexp_exec, "(irir)i"),
+};
+/* clang-format on */
+
+uint32_t
+get_lib_regexp_symbols(char **p_module_name, NativeSymbol **p_native_symbols)
+{
+    *p_module_name = "env";
+    *p_native_symbols = native_symbols;
+
+    return sizeof(native_symbols) / sizeof(NativeSymbol);
+}
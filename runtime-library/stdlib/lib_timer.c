@@ -3,39 +3,528 @@
  * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
  */
 
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
+
 #include "bh_hashmap.h"
-#include "wasm_export.h"
+#include "bh_platform.h"
+#include "gc_export.h"
+#include "type_utils.h"
+#include "wamr_utils.h"
 
-wasm_exec_env_t env;
-HashMap *timer_map;
-void *(*_createTimer)(uint64_t timeout);
-bool (*_destroyTimer)(void *timer_id);
+#define NS_PER_MS 1000000ULL
+#define NS_PER_SEC 1000000000ULL
+/* keep deadlines far away from uint64 overflow (~31 years) */
+#define TIMER_MAX_DELAY_MS 1e12
+#define TIMER_MAP_INIT_SIZE 64
+#define TIMER_HEAP_INIT_CAPACITY 16
+#define TIMER_NOT_IN_HEAP ((uint32_t)-1)
 
-double
-setTimeout(wasm_exec_env_t exec_env, void *closure, double delay, void *args)
+typedef struct Timer {
+    uint32_t id;
+    /* slot of the callback closure in the extref table, the table keeps the
+     * closure alive while the timer is pending */
+    uint32_t closure_slot;
+    uint64_t deadline;
+    /* 0 for setTimeout */
+    uint64_t interval;
+    /* tie breaker, timers with the same deadline fire in creation order */
+    uint64_t seq;
+    uint32_t heap_index;
+    bool cancelled;
+} Timer;
+
+/* Timers are kept in a binary min-heap ordered by deadline, the id map is
+ * only used for cancellation. Every thread running a module instance has its
+ * own loop. */
+typedef struct TimerLoop {
+    Timer **heap;
+    uint32_t size;
+    uint32_t capacity;
+    HashMap *id_map;
+    uint32_t next_id;
+    uint64_t next_seq;
+#if defined(__linux__)
+    int epoll_fd;
+    int timer_fd;
+#endif
+} TimerLoop;
+
+static os_thread_local_attribute TimerLoop timer_loop = {
+#if defined(__linux__)
+    .epoll_fd = -1,
+    .timer_fd = -1,
+#endif
+};
+
+static uint64_t
+monotonic_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t
+timer_id_hash(const void *key)
+{
+    return (uint32_t)(uintptr_t)key;
+}
+
+static bool
+timer_id_equal(void *key1, void *key2)
+{
+    return key1 == key2;
+}
+
+static bool
+timer_loop_init(TimerLoop *loop)
+{
+    if (loop->id_map) {
+        return true;
+    }
+
+    if (!(loop->id_map =
+              bh_hash_map_create(TIMER_MAP_INIT_SIZE, false, timer_id_hash,
+                                 timer_id_equal, NULL, NULL))) {
+        return false;
+    }
+    loop->next_id = 1;
+
+    return true;
+}
+
+static inline bool
+timer_before(const Timer *a, const Timer *b)
+{
+    return a->deadline < b->deadline
+           || (a->deadline == b->deadline && a->seq < b->seq);
+}
+
+static inline void
+heap_place(TimerLoop *loop, uint32_t index, Timer *timer)
+{
+    loop->heap[index] = timer;
+    timer->heap_index = index;
+}
+
+static void
+heap_sift_up(TimerLoop *loop, uint32_t index)
+{
+    Timer *timer = loop->heap[index];
+
+    while (index > 0) {
+        uint32_t parent = (index - 1) / 2;
+
+        if (!timer_before(timer, loop->heap[parent])) {
+            break;
+        }
+        heap_place(loop, index, loop->heap[parent]);
+        index = parent;
+    }
+    heap_place(loop, index, timer);
+}
+
+static void
+heap_sift_down(TimerLoop *loop, uint32_t index)
+{
+    Timer *timer = loop->heap[index];
+
+    for (;;) {
+        uint32_t child = index * 2 + 1;
+
+        if (child >= loop->size) {
+            break;
+        }
+        if (child + 1 < loop->size
+            && timer_before(loop->heap[child + 1], loop->heap[child])) {
+            child++;
+        }
+        if (!timer_before(loop->heap[child], timer)) {
+            break;
+        }
+        heap_place(loop, index, loop->heap[child]);
+        index = child;
+    }
+    heap_place(loop, index, timer);
+}
+
+static bool
+heap_push(TimerLoop *loop, Timer *timer)
+{
+    if (loop->size == loop->capacity) {
+        uint32_t new_capacity = loop->capacity ? loop->capacity * 2
+                                               : TIMER_HEAP_INIT_CAPACITY;
+        Timer **new_heap =
+            wasm_runtime_malloc(sizeof(Timer *) * new_capacity);
+
+        if (!new_heap) {
+            return false;
+        }
+        if (loop->heap) {
+            bh_memcpy_s(new_heap, sizeof(Timer *) * new_capacity, loop->heap,
+                        sizeof(Timer *) * loop->size);
+            wasm_runtime_free(loop->heap);
+        }
+        loop->heap = new_heap;
+        loop->capacity = new_capacity;
+    }
+
+    heap_place(loop, loop->size++, timer);
+    heap_sift_up(loop, timer->heap_index);
+    return true;
+}
+
+static void
+heap_remove(TimerLoop *loop, Timer *timer)
+{
+    uint32_t index = timer->heap_index;
+    Timer *last = loop->heap[--loop->size];
+
+    timer->heap_index = TIMER_NOT_IN_HEAP;
+    if (index == loop->size) {
+        return;
+    }
+
+    heap_place(loop, index, last);
+    if (index > 0 && timer_before(last, loop->heap[(index - 1) / 2])) {
+        heap_sift_up(loop, index);
+    }
+    else {
+        heap_sift_down(loop, index);
+    }
+}
+
+static bool
+call_extref_slot_func(wasm_exec_env_t exec_env, const char *name,
+                      uint32_t argc, uint32_t *argv)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    wasm_function_inst_t func = wasm_runtime_lookup_function(module_inst, name);
+
+    bh_assert(func);
+    return wasm_runtime_call_wasm(exec_env, func, argc, argv);
+}
+
+static void
+timer_destroy(wasm_exec_env_t exec_env, TimerLoop *loop, Timer *timer)
+{
+    uint32_t argv[1] = { timer->closure_slot };
+
+    bh_hash_map_remove(loop->id_map, (void *)(uintptr_t)timer->id, NULL, NULL);
+    if (exec_env) {
+        call_extref_slot_func(exec_env, "freeExtRefTableSlot", 1, argv);
+    }
+    wasm_runtime_free(timer);
+}
+
+static double
+timer_new(wasm_exec_env_t exec_env, void *closure, double delay, bool repeat)
+{
+    TimerLoop *loop = &timer_loop;
+    uint32_t argv[sizeof(void *) / sizeof(uint32_t)] = { 0 };
+    uint64_t delay_ns;
+    Timer *timer;
+
+    if (!timer_loop_init(loop)) {
+        wasm_runtime_set_exception(wasm_runtime_get_module_inst(exec_env),
+                                   "create timer failed: out of memory");
+        return 0;
+    }
+
+    /* NaN and negative delays fire as soon as possible */
+    if (!(delay > 0)) {
+        delay = 0;
+    }
+    if (delay > TIMER_MAX_DELAY_MS) {
+        delay = TIMER_MAX_DELAY_MS;
+    }
+    delay_ns = (uint64_t)(delay * NS_PER_MS);
+    /* a zero interval would starve everything else in the loop */
+    if (repeat && delay_ns < NS_PER_MS) {
+        delay_ns = NS_PER_MS;
+    }
+
+    if (!(timer = wasm_runtime_malloc(sizeof(Timer)))) {
+        wasm_runtime_set_exception(wasm_runtime_get_module_inst(exec_env),
+                                   "create timer failed: out of memory");
+        return 0;
+    }
+
+    bh_memcpy_s(argv, sizeof(argv), &closure, sizeof(void *));
+    if (!call_extref_slot_func(exec_env, "allocExtRefTableSlot",
+                               sizeof(argv) / sizeof(uint32_t), argv)) {
+        wasm_runtime_free(timer);
+        return 0;
+    }
+
+    timer->id = loop->next_id++;
+    timer->closure_slot = argv[0];
+    timer->deadline = monotonic_now_ns() + delay_ns;
+    timer->interval = repeat ? delay_ns : 0;
+    timer->seq = loop->next_seq++;
+    timer->heap_index = TIMER_NOT_IN_HEAP;
+    timer->cancelled = false;
+
+    if (!bh_hash_map_insert(loop->id_map, (void *)(uintptr_t)timer->id,
+                            timer)) {
+        timer_destroy(exec_env, loop, timer);
+        return 0;
+    }
+    if (!heap_push(loop, timer)) {
+        timer_destroy(exec_env, loop, timer);
+        wasm_runtime_set_exception(wasm_runtime_get_module_inst(exec_env),
+                                   "create timer failed: out of memory");
+        return 0;
+    }
+
+    return (double)timer->id;
+}
+
+static void
+timer_cancel(wasm_exec_env_t exec_env, double id)
+{
+    TimerLoop *loop = &timer_loop;
+    Timer *timer;
+
+    if (!loop->id_map || !(id >= 1 && id <= UINT32_MAX)) {
+        return;
+    }
+
+    timer = bh_hash_map_find(loop->id_map, (void *)(uintptr_t)(uint32_t)id);
+    if (!timer) {
+        return;
+    }
+
+    if (timer->heap_index == TIMER_NOT_IN_HEAP) {
+        /* cancelled from its own callback, released once the call returns */
+        timer->cancelled = true;
+        return;
+    }
+
+    heap_remove(loop, timer);
+    timer_destroy(exec_env, loop, timer);
+}
+
+#if defined(__linux__)
+static bool
+timer_loop_init_fds(TimerLoop *loop)
+{
+    struct epoll_event ev = { 0 };
+
+    if (loop->epoll_fd >= 0) {
+        return true;
+    }
+
+    if ((loop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC)) < 0) {
+        return false;
+    }
+    if ((loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        close(loop->timer_fd);
+        loop->timer_fd = -1;
+        return false;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.fd = loop->timer_fd;
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->timer_fd, &ev) < 0) {
+        close(loop->epoll_fd);
+        close(loop->timer_fd);
+        loop->epoll_fd = loop->timer_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+/* Block until the monotonic clock reaches deadline */
+static void
+timer_loop_wait_until(TimerLoop *loop, uint64_t deadline)
+{
+#if defined(__linux__)
+    if (timer_loop_init_fds(loop)) {
+        struct itimerspec its = { 0 };
+        struct epoll_event ev;
+        uint64_t expirations;
+        int n;
+
+        its.it_value.tv_sec = (time_t)(deadline / NS_PER_SEC);
+        its.it_value.tv_nsec = (long)(deadline % NS_PER_SEC);
+        if (timerfd_settime(loop->timer_fd, TFD_TIMER_ABSTIME, &its, NULL)
+            == 0) {
+            do {
+                n = epoll_wait(loop->epoll_fd, &ev, 1, -1);
+            } while (n < 0 && errno == EINTR);
+
+            if (n > 0) {
+                /* drain the expiration count, the caller rechecks the
+                 * deadline anyway */
+                ssize_t bytes =
+                    read(loop->timer_fd, &expirations, sizeof(uint64_t));
+                (void)bytes;
+            }
+            return;
+        }
+    }
+#endif
+    for (;;) {
+        uint64_t now = monotonic_now_ns();
+        struct timespec ts;
+
+        if (now >= deadline) {
+            return;
+        }
+        ts.tv_sec = (time_t)((deadline - now) / NS_PER_SEC);
+        ts.tv_nsec = (long)((deadline - now) % NS_PER_SEC);
+        nanosleep(&ts, NULL);
+    }
+}
+
+/**
+ * Run the earliest expired timer, sleeping until its deadline if needed.
+ * Only one callback runs per call so the caller can drain microtasks
+ * between macrotasks.
+ *
+ * @return 0 if the loop should continue, -1 if no timer is pending or a
+ * callback raised an exception
+ */
+int
+timer_events_poll(wasm_exec_env_t exec_env)
 {
-    void *timer_id = NULL;
+    TimerLoop *loop = &timer_loop;
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    uint32_t argv[ENV_PARAM_LEN * sizeof(void *) / sizeof(uint32_t)];
+    uint32_t occupied_slots = 0;
+    wasm_obj_t closure;
+    Timer *timer;
+    bool ok;
+
+    if (loop->size == 0) {
+        return -1;
+    }
+
+    timer = loop->heap[0];
+    if (timer->deadline > monotonic_now_ns()) {
+        timer_loop_wait_until(loop, timer->deadline);
+        return 0;
+    }
+
+    heap_remove(loop, timer);
+
+    closure = wamr_utils_get_table_element(exec_env, timer->closure_slot);
+    {
+        GET_ELEM_FROM_CLOSURE((wasm_struct_obj_t)closure);
+        POPULATE_ENV_ARGS(argv, sizeof(argv), occupied_slots, context, thiz);
+        ok = wasm_runtime_call_func_ref(
+            exec_env, (wasm_func_obj_t)func_obj.gc_obj, occupied_slots, argv);
+    }
+
+    if (!ok) {
+        printf("%s\n", wasm_runtime_get_exception(module_inst));
+        timer_destroy(exec_env, loop, timer);
+        return -1;
+    }
+
+    if (timer->interval && !timer->cancelled) {
+        /* schedule from the previous deadline to avoid drift, but never in
+         * the past, missed ticks are skipped */
+        uint64_t now = monotonic_now_ns();
 
-    env = exec_env;
-    if (_createTimer != NULL) {
-        timer_id = _createTimer(delay);
-        bh_hash_map_insert(timer_map, timer_id, closure);
-        return (double)(uintptr_t)(timer_id);
+        timer->deadline += timer->interval;
+        if (timer->deadline <= now) {
+            timer->deadline = now + timer->interval;
+        }
+        timer->seq = loop->next_seq++;
+        if (heap_push(loop, timer)) {
+            return 0;
+        }
     }
+
+    timer_destroy(exec_env, loop, timer);
     return 0;
 }
 
+/**
+ * Get the deadline of the earliest pending timer, so that a caller waiting
+ * for other events knows when to come back to timer_events_poll
+ *
+ * @return the deadline in ns of CLOCK_MONOTONIC, 0 if no timer is pending
+ */
+uint64_t
+timer_events_next_deadline(void)
+{
+    TimerLoop *loop = &timer_loop;
+
+    return loop->size > 0 ? loop->heap[0]->deadline : 0;
+}
+
+/**
+ * Release all pending timers, called before the module instance is
+ * destroyed
+ */
 void
-clearTimeout(wasm_exec_env_t exec_env, double id)
+timer_events_destroy(void)
 {
-    void *timer_id = (void *)(uintptr_t)id;
+    TimerLoop *loop = &timer_loop;
 
-    if (id == 0) {
-        return;
+    while (loop->size > 0) {
+        Timer *timer = loop->heap[loop->size - 1];
+
+        heap_remove(loop, timer);
+        /* the table goes away together with the module instance */
+        timer_destroy(NULL, loop, timer);
+    }
+
+    if (loop->heap) {
+        wasm_runtime_free(loop->heap);
+    }
+    if (loop->id_map) {
+        bh_hash_map_destroy(loop->id_map);
     }
-    if (_destroyTimer != NULL) {
-        _destroyTimer(timer_id);
+#if defined(__linux__)
+    if (loop->epoll_fd >= 0) {
+        close(loop->epoll_fd);
     }
+    if (loop->timer_fd >= 0) {
+        close(loop->timer_fd);
+    }
+#endif
+
+    memset(loop, 0, sizeof(TimerLoop));
+#if defined(__linux__)
+    loop->epoll_fd = loop->timer_fd = -1;
+#endif
+}
+
+double
+setTimeout(wasm_exec_env_t exec_env, void *closure, double delay, void *args)
+{
+    return timer_new(exec_env, closure, delay, false);
+}
+
+double
+setInterval(wasm_exec_env_t exec_env, void *closure, double delay, void *args)
+{
+    return timer_new(exec_env, closure, delay, true);
+}
+
+void
+clearTimeout(wasm_exec_env_t exec_env, double id)
+{
+    timer_cancel(exec_env, id);
+}
+
+void
+clearInterval(wasm_exec_env_t exec_env, double id)
+{
+    timer_cancel(exec_env, id);
 }
 
 /* clang-format off */
@@ -44,7 +533,9 @@ clearTimeout(wasm_exec_env_t exec_env, double id)
 
 static NativeSymbol native_symbols[] = {
     REG_NATIVE_FUNC(setTimeout, "(rFr)F"),
+    REG_NATIVE_FUNC(setInterval, "(rFr)F"),
     REG_NATIVE_FUNC(clearTimeout, "(F)"),
+    REG_NATIVE_FUNC(clearInterval, "(F)"),
 };
 /* clang-format on */
 
@@ -0,0 +1,742 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* Workers run the exported function of a new instance of the module on
+ * their own thread, with their own GC heap, dyntype context and event loop.
+ * Every thread has one message queue, a message carries the id of the
+ * worker that sent it, or 0 when the parent sent it, and a structured clone
+ * of the value posted. */
+
+#include <time.h>
+
+#include "bh_platform.h"
+#include "gc_export.h"
+#include "instance_pool.h"
+#include "libdyntype_export.h"
+#include "object_utils.h"
+#include "sampling_profiler.h"
+#include "structured_clone.h"
+#include "type_utils.h"
+#include "wamr_utils.h"
+
+#define NS_PER_US 1000ULL
+#define NS_PER_SEC 1000000000ULL
+#define WORKER_THREAD_STACK_SIZE (8 * 1024 * 1024)
+
+extern dyn_value_t
+dyntype_callback_wasm_dispatcher(void *exec_env_v, dyn_ctx_t ctx, void *vfunc,
+                                 dyn_value_t this_obj, int argc,
+                                 dyn_value_t *args);
+
+typedef struct WorkerMessage {
+    struct WorkerMessage *next;
+    /* the sending worker, 0 for the parent */
+    uint32_t source;
+    /* NULL for the notice that the sending worker has exited */
+    StructuredClone *data;
+} WorkerMessage;
+
+typedef struct MessageQueue {
+    WorkerMessage *head;
+    WorkerMessage *tail;
+    korp_cond cond;
+} MessageQueue;
+
+typedef struct Worker {
+    /* in the list of the parent */
+    struct Worker *next;
+    uint32_t id;
+    korp_tid thread;
+    wasm_module_t module;
+    char *entry;
+    /* the queue of the worker thread, owned by the parent */
+    MessageQueue *inbox;
+    MessageQueue *parent_inbox;
+    /* allocated ahead so that the parent always learns about the exit */
+    WorkerMessage *exit_notice;
+    /* set while the instance runs, so that the parent can terminate it */
+    wasm_module_inst_t module_inst;
+    bool terminated;
+    /* the workerOnMessage callback, in the extref table of the parent */
+    uint32_t handler_slot;
+    bool has_handler;
+} Worker;
+
+typedef struct WorkerScope {
+    MessageQueue *inbox;
+    /* the workers created by the thread and not reaped yet */
+    Worker *workers;
+    uint32_t next_id;
+    /* the worker run by the thread, NULL for the main thread */
+    Worker *self;
+    bool closing;
+    /* the onMessage callback */
+    uint32_t handler_slot;
+    bool has_handler;
+} WorkerScope;
+
+static os_thread_local_attribute WorkerScope worker_scope;
+
+/* guards the message queues and the terminated flags */
+static korp_mutex worker_lock;
+static bool worker_enabled = false;
+static uint32_t worker_stack_size;
+static uint32_t worker_heap_size;
+static instance_pool_drain_func_t worker_run_loop;
+
+static uint64_t
+monotonic_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static bool
+call_extref_slot_func(wasm_exec_env_t exec_env, const char *name,
+                      uint32_t argc, uint32_t *argv)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    wasm_function_inst_t func = wasm_runtime_lookup_function(module_inst, name);
+
+    bh_assert(func);
+    return wasm_runtime_call_wasm(exec_env, func, argc, argv);
+}
+
+/* Root the closure in the extref table, replacing the previous handler */
+static bool
+set_handler(wasm_exec_env_t exec_env, void *closure, uint32_t *p_slot,
+            bool *p_has_handler)
+{
+    uint32_t argv[sizeof(void *) / sizeof(uint32_t)] = { 0 };
+
+    bh_memcpy_s(argv, sizeof(argv), &closure, sizeof(void *));
+    if (!call_extref_slot_func(exec_env, "allocExtRefTableSlot",
+                               sizeof(argv) / sizeof(uint32_t), argv)) {
+        return false;
+    }
+    if (*p_has_handler) {
+        call_extref_slot_func(exec_env, "freeExtRefTableSlot", 1, p_slot);
+    }
+    *p_slot = argv[0];
+    *p_has_handler = true;
+    return true;
+}
+
+static void
+clear_handler(wasm_exec_env_t exec_env, uint32_t *p_slot, bool *p_has_handler)
+{
+    /* the table goes away together with the module instance */
+    if (*p_has_handler && exec_env) {
+        call_extref_slot_func(exec_env, "freeExtRefTableSlot", 1, p_slot);
+    }
+    *p_has_handler = false;
+}
+
+static MessageQueue *
+message_queue_create(void)
+{
+    MessageQueue *queue;
+
+    if (!(queue = wasm_runtime_malloc(sizeof(MessageQueue)))) {
+        return NULL;
+    }
+    memset(queue, 0, sizeof(MessageQueue));
+    if (os_cond_init(&queue->cond) != BHT_OK) {
+        wasm_runtime_free(queue);
+        return NULL;
+    }
+    return queue;
+}
+
+/* Called with worker_lock held */
+static void
+message_queue_push(MessageQueue *queue, WorkerMessage *message)
+{
+    message->next = NULL;
+    if (queue->tail) {
+        queue->tail->next = message;
+    }
+    else {
+        queue->head = message;
+    }
+    queue->tail = message;
+    os_cond_signal(&queue->cond);
+}
+
+/* Called with worker_lock held */
+static WorkerMessage *
+message_queue_pop(MessageQueue *queue)
+{
+    WorkerMessage *message = queue->head;
+
+    if (message) {
+        queue->head = message->next;
+        if (!queue->head) {
+            queue->tail = NULL;
+        }
+    }
+    return message;
+}
+
+static void
+message_free(WorkerMessage *message)
+{
+    if (message->data) {
+        structured_clone_destroy(message->data);
+    }
+    wasm_runtime_free(message);
+}
+
+static void
+message_queue_clear(MessageQueue *queue)
+{
+    WorkerMessage *message;
+
+    os_mutex_lock(&worker_lock);
+    while ((message = message_queue_pop(queue))) {
+        message_free(message);
+    }
+    os_mutex_unlock(&worker_lock);
+}
+
+static void
+message_queue_destroy(MessageQueue *queue)
+{
+    message_queue_clear(queue);
+    os_cond_destroy(&queue->cond);
+    wasm_runtime_free(queue);
+}
+
+static void
+worker_free(Worker *worker)
+{
+    if (worker->inbox) {
+        message_queue_destroy(worker->inbox);
+    }
+    if (worker->exit_notice) {
+        wasm_runtime_free(worker->exit_notice);
+    }
+    if (worker->entry) {
+        wasm_runtime_free(worker->entry);
+    }
+    wasm_runtime_free(worker);
+}
+
+static Worker *
+find_worker(WorkerScope *scope, double id)
+{
+    Worker *worker;
+
+    for (worker = scope->workers; worker; worker = worker->next) {
+        if (worker->id == id) {
+            return worker;
+        }
+    }
+    return NULL;
+}
+
+/* Called with worker_lock held. A worker busy in wasm code is stopped at the
+ * next point where the runtime checks for exceptions, one waiting for
+ * messages or timers is woken up. */
+static void
+worker_terminate(Worker *worker)
+{
+    worker->terminated = true;
+    if (worker->module_inst) {
+        wasm_runtime_terminate(worker->module_inst);
+    }
+    os_cond_signal(&worker->inbox->cond);
+}
+
+/* Join a worker which has exited, or is about to */
+static void
+worker_reap(wasm_exec_env_t exec_env, WorkerScope *scope, Worker *worker)
+{
+    Worker **p_worker;
+
+    os_thread_join(worker->thread, NULL);
+
+    for (p_worker = &scope->workers; *p_worker; p_worker = &(*p_worker)->next) {
+        if (*p_worker == worker) {
+            *p_worker = worker->next;
+            break;
+        }
+    }
+    clear_handler(exec_env, &worker->handler_slot, &worker->has_handler);
+    /* the exit notice has been sent */
+    worker->exit_notice = NULL;
+    worker_free(worker);
+}
+
+static void *
+worker_thread(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    WorkerScope *scope = &worker_scope;
+    InstancePool *pool = NULL;
+    PooledInstance *instance = NULL;
+    const char *exception;
+    char error_buf[128] = { 0 };
+
+    if (!wasm_runtime_init_thread_env()) {
+        printf("Init thread environment failed.\n");
+        goto exit;
+    }
+
+    scope->self = worker;
+    scope->inbox = worker->inbox;
+    dyntype_set_callback_dispatcher(dyntype_callback_wasm_dispatcher);
+
+    if (!(pool = instance_pool_create(worker->module, worker_stack_size,
+                                      worker_heap_size, 0, worker_run_loop))) {
+        printf("Create worker failed: out of memory\n");
+        goto fail;
+    }
+    if (!(instance =
+              instance_pool_acquire(pool, error_buf, sizeof(error_buf)))) {
+        printf("Create worker failed: %s\n", error_buf);
+        goto fail;
+    }
+
+    os_mutex_lock(&worker_lock);
+    if (!worker->terminated) {
+        worker->module_inst = instance->module_inst;
+    }
+    os_mutex_unlock(&worker_lock);
+
+    if (worker->module_inst) {
+        sampling_profiler_attach(instance->exec_env);
+        wasm_application_execute_func(instance->module_inst, worker->entry, 0,
+                                      NULL);
+        if (!(exception = wasm_runtime_get_exception(instance->module_inst))) {
+            /* the messages, then the other events, until the worker is
+             * closed or terminated, or nothing is left to wait for */
+            worker_run_loop(instance->exec_env, instance->dyn_ctx);
+            exception = wasm_runtime_get_exception(instance->module_inst);
+        }
+        if (exception && !worker->terminated) {
+            printf("%s\n", exception);
+        }
+        sampling_profiler_attach(NULL);
+    }
+
+    os_mutex_lock(&worker_lock);
+    worker->module_inst = NULL;
+    os_mutex_unlock(&worker_lock);
+
+    /* terminates the workers of the worker too */
+    instance_pool_release(pool, instance);
+
+fail:
+    if (pool) {
+        instance_pool_destroy(pool);
+    }
+    wasm_runtime_destroy_thread_env();
+
+exit:
+    /* after the last message of the worker */
+    os_mutex_lock(&worker_lock);
+    worker->exit_notice->source = worker->id;
+    worker->exit_notice->data = NULL;
+    message_queue_push(worker->parent_inbox, worker->exit_notice);
+    os_mutex_unlock(&worker_lock);
+    return NULL;
+}
+
+/**
+ * Enable workers, the host calls it once before running the module
+ *
+ * @param stack_size the stack size of the worker instances
+ * @param heap_size the app heap size of the worker instances
+ * @param run_loop runs the micro tasks and the events of an instance until
+ * no event is left, see worker_events_poll
+ * @return true if success, false otherwise
+ */
+bool
+worker_runtime_init(uint32_t stack_size, uint32_t heap_size,
+                    instance_pool_drain_func_t run_loop)
+{
+    if (os_mutex_init(&worker_lock) != BHT_OK) {
+        return false;
+    }
+    worker_stack_size = stack_size;
+    worker_heap_size = heap_size;
+    worker_run_loop = run_loop;
+    worker_enabled = true;
+    return true;
+}
+
+void
+worker_runtime_destroy(void)
+{
+    if (worker_enabled) {
+        os_mutex_destroy(&worker_lock);
+        worker_enabled = false;
+    }
+}
+
+/**
+ * Run the handler of one message sent to the calling thread, waiting for
+ * it if none is queued. The wait stops at deadline, as other events are due
+ * then.
+ *
+ * @param deadline the deadline in ns of CLOCK_MONOTONIC, 0 if none
+ * @return 0 if a message was handled, 1 if no message is expected or the
+ * deadline has passed, -1 if a handler raised an exception or the worker is
+ * closed or terminated
+ */
+int
+worker_events_poll(wasm_exec_env_t exec_env, uint64_t deadline)
+{
+    WorkerScope *scope = &worker_scope;
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    uint32_t argv[(ENV_PARAM_LEN + 1) * sizeof(void *) / sizeof(uint32_t)];
+    uint32_t occupied_slots = 0, handler_slot;
+    WorkerMessage *message = NULL;
+    Worker *worker = NULL;
+    wasm_anyref_obj_t value_obj = NULL;
+    dyn_value_t value;
+    wasm_obj_t closure;
+    bool has_handler, ok = false;
+
+    if (!scope->inbox) {
+        return 1;
+    }
+
+    os_mutex_lock(&worker_lock);
+    for (;;) {
+        uint64_t now;
+
+        if (scope->closing || (scope->self && scope->self->terminated)) {
+            os_mutex_unlock(&worker_lock);
+            return -1;
+        }
+        if ((message = message_queue_pop(scope->inbox))) {
+            break;
+        }
+        if (!deadline) {
+            /* the workers may still send messages, and so may the parent
+             * once a handler is set */
+            if (!scope->workers && !(scope->self && scope->has_handler)) {
+                os_mutex_unlock(&worker_lock);
+                return 1;
+            }
+            os_cond_wait(&scope->inbox->cond, &worker_lock);
+            continue;
+        }
+        /* the thread would sleep until the deadline anyway */
+        if ((now = monotonic_now_ns()) >= deadline) {
+            os_mutex_unlock(&worker_lock);
+            return 1;
+        }
+        os_cond_reltimedwait(&scope->inbox->cond, &worker_lock,
+                             (deadline - now + NS_PER_US - 1) / NS_PER_US);
+    }
+    os_mutex_unlock(&worker_lock);
+
+    if (message->source == 0) {
+        has_handler = scope->has_handler;
+        handler_slot = scope->handler_slot;
+    }
+    else {
+        worker = find_worker(scope, message->source);
+        bh_assert(worker);
+        if (!message->data) {
+            worker_reap(exec_env, scope, worker);
+            wasm_runtime_free(message);
+            return 0;
+        }
+        has_handler = worker->has_handler;
+        handler_slot = worker->handler_slot;
+    }
+
+    if (!has_handler) {
+        message_free(message);
+        return 0;
+    }
+
+    value = structured_clone_read(exec_env, dyntype_get_context(),
+                                  message->data);
+    message_free(message);
+    if (value
+        && (value_obj =
+                box_ptr_to_anyref(exec_env, dyntype_get_context(), value))) {
+        closure = wamr_utils_get_table_element(exec_env, handler_slot);
+        GET_ELEM_FROM_CLOSURE((wasm_struct_obj_t)closure);
+        POPULATE_ENV_ARGS(argv, sizeof(argv), occupied_slots, context, thiz);
+        bh_memcpy_s(argv + occupied_slots,
+                    sizeof(argv) - occupied_slots * sizeof(uint32),
+                    &value_obj, sizeof(void *));
+        occupied_slots += sizeof(void *) / sizeof(uint32);
+        ok = wasm_runtime_call_func_ref(
+            exec_env, (wasm_func_obj_t)func_obj.gc_obj, occupied_slots, argv);
+    }
+    else if (value) {
+        dyntype_release(dyntype_get_context(), value);
+    }
+
+    if (!ok) {
+        printf("%s\n", wasm_runtime_get_exception(module_inst));
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Terminate and join the workers created by the calling thread and drop
+ * the messages left, called before the module instance is destroyed
+ */
+void
+worker_events_destroy(void)
+{
+    WorkerScope *scope = &worker_scope;
+    Worker *worker;
+
+    if (!scope->inbox) {
+        return;
+    }
+
+    /* all of them stop in parallel */
+    os_mutex_lock(&worker_lock);
+    for (worker = scope->workers; worker; worker = worker->next) {
+        worker_terminate(worker);
+    }
+    os_mutex_unlock(&worker_lock);
+
+    while ((worker = scope->workers)) {
+        worker_reap(NULL, scope, worker);
+    }
+
+    if (scope->self) {
+        /* the queue belongs to the parent */
+        message_queue_clear(scope->inbox);
+    }
+    else {
+        message_queue_destroy(scope->inbox);
+        scope->inbox = NULL;
+    }
+    scope->has_handler = false;
+    scope->closing = false;
+}
+
+static char *
+string_dup(void *str_obj)
+{
+    char *str;
+#if WASM_ENABLE_STRINGREF != 0
+    uint32_t len = wasm_string_get_length((wasm_stringref_obj_t)str_obj);
+
+    if ((str = wasm_runtime_malloc(len))) {
+        wasm_string_to_cstring((wasm_stringref_obj_t)str_obj, str, len);
+    }
+#else
+    const char *value = get_str_from_string_struct((wasm_struct_obj_t)str_obj);
+    uint32_t len = get_str_length_from_string_struct((wasm_struct_obj_t)str_obj);
+
+    if ((str = wasm_runtime_malloc(len + 1))) {
+        bh_memcpy_s(str, len + 1, value, len);
+        str[len] = '\0';
+    }
+#endif
+    return str;
+}
+
+static bool
+post_message(wasm_exec_env_t exec_env, MessageQueue *queue, uint32_t source,
+             void *message, void *transfer)
+{
+    wasm_struct_obj_t transfer_list = (wasm_struct_obj_t)transfer;
+    WorkerMessage *msg;
+    StructuredClone *data;
+
+    if (transfer_list && get_array_length(transfer_list) == 0) {
+        transfer_list = NULL;
+    }
+    if (!(data = structured_clone_write(exec_env, dyntype_get_context(),
+                                        UNBOX_ANYREF(message),
+                                        transfer_list))) {
+        return false;
+    }
+    if (!(msg = wasm_runtime_malloc(sizeof(WorkerMessage)))) {
+        structured_clone_destroy(data);
+        wasm_runtime_set_exception(wasm_runtime_get_module_inst(exec_env),
+                                   "post message failed: out of memory");
+        return false;
+    }
+    msg->source = source;
+    msg->data = data;
+
+    os_mutex_lock(&worker_lock);
+    message_queue_push(queue, msg);
+    os_mutex_unlock(&worker_lock);
+    return true;
+}
+
+double
+createWorker(wasm_exec_env_t exec_env, void *entry)
+{
+    WorkerScope *scope = &worker_scope;
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    Worker *worker;
+
+    if (!worker_enabled) {
+        wasm_runtime_set_exception(
+            module_inst, "create worker failed: workers aren't enabled");
+        return 0;
+    }
+
+    if (!(worker = wasm_runtime_malloc(sizeof(Worker)))) {
+        goto oom;
+    }
+    memset(worker, 0, sizeof(Worker));
+
+    if (!(worker->entry = string_dup(entry))) {
+        goto oom;
+    }
+    if (!wasm_runtime_lookup_function(module_inst, worker->entry)) {
+        wasm_runtime_set_exception(
+            module_inst, "create worker failed: entry function not found");
+        worker_free(worker);
+        return 0;
+    }
+
+    if (!scope->inbox && !(scope->inbox = message_queue_create())) {
+        goto oom;
+    }
+    if (!(worker->inbox = message_queue_create())
+        || !(worker->exit_notice = wasm_runtime_malloc(sizeof(WorkerMessage)))) {
+        goto oom;
+    }
+    worker->id = ++scope->next_id;
+    worker->module = wasm_runtime_get_module(module_inst);
+    worker->parent_inbox = scope->inbox;
+
+    if (os_thread_create(&worker->thread, worker_thread, worker,
+                         WORKER_THREAD_STACK_SIZE)
+        != BHT_OK) {
+        wasm_runtime_set_exception(module_inst,
+                                   "create worker failed: create thread failed");
+        worker_free(worker);
+        return 0;
+    }
+
+    worker->next = scope->workers;
+    scope->workers = worker;
+    return (double)worker->id;
+
+oom:
+    wasm_runtime_set_exception(module_inst,
+                               "create worker failed: out of memory");
+    if (worker) {
+        worker_free(worker);
+    }
+    return 0;
+}
+
+void
+workerPostMessage(wasm_exec_env_t exec_env, double id, void *message,
+                  void *transfer)
+{
+    Worker *worker = find_worker(&worker_scope, id);
+
+    /* messages to workers gone are dropped */
+    if (worker) {
+        post_message(exec_env, worker->inbox, 0, message, transfer);
+    }
+}
+
+void
+workerOnMessage(wasm_exec_env_t exec_env, double id, void *closure)
+{
+    Worker *worker = find_worker(&worker_scope, id);
+
+    if (worker && !worker->terminated) {
+        set_handler(exec_env, closure, &worker->handler_slot,
+                    &worker->has_handler);
+    }
+}
+
+void
+terminateWorker(wasm_exec_env_t exec_env, double id)
+{
+    Worker *worker = find_worker(&worker_scope, id);
+
+    if (!worker) {
+        return;
+    }
+    /* the messages already queued are dropped too */
+    clear_handler(exec_env, &worker->handler_slot, &worker->has_handler);
+    os_mutex_lock(&worker_lock);
+    worker_terminate(worker);
+    os_mutex_unlock(&worker_lock);
+}
+
+void
+postMessage(wasm_exec_env_t exec_env, void *message, void *transfer)
+{
+    WorkerScope *scope = &worker_scope;
+
+    if (!scope->self) {
+        wasm_runtime_set_exception(
+            wasm_runtime_get_module_inst(exec_env),
+            "post message failed: not running in a worker");
+        return;
+    }
+    if (!scope->closing) {
+        post_message(exec_env, scope->self->parent_inbox, scope->self->id,
+                     message, transfer);
+    }
+}
+
+void
+onMessage(wasm_exec_env_t exec_env, void *closure)
+{
+    WorkerScope *scope = &worker_scope;
+
+    if (!scope->self) {
+        wasm_runtime_set_exception(
+            wasm_runtime_get_module_inst(exec_env),
+            "set message handler failed: not running in a worker");
+        return;
+    }
+    set_handler(exec_env, closure, &scope->handler_slot, &scope->has_handler);
+}
+
+void
+closeWorker(wasm_exec_env_t exec_env)
+{
+    WorkerScope *scope = &worker_scope;
+
+    /* the event loop stops once the running task returns */
+    if (scope->self) {
+        scope->closing = true;
+    }
+}
+
+/* clang-format off */
+#define REG_NATIVE_FUNC(func_name, signature) \
+    { #func_name, func_name, signature, NULL }
+
+static NativeSymbol native_symbols[] = {
+    REG_NATIVE_FUNC(createWorker, "(r)F"),
+    REG_NATIVE_FUNC(workerPostMessage, "(Frr)"),
+    REG_NATIVE_FUNC(workerOnMessage, "(Fr)"),
+    REG_NATIVE_FUNC(terminateWorker, "(F)"),
+    REG_NATIVE_FUNC(postMessage, "(rr)"),
+    REG_NATIVE_FUNC(onMessage, "(r)"),
+    REG_NATIVE_FUNC(closeWorker, "()"),
+};
+/* clang-format on */
+
+uint32_t
+get_lib_worker_symbols(char **p_module_name, NativeSymbol **p_native_symbols)
+{
+    *p_module_name = "env";
+    *p_native_symbols = native_symbols;
+
+    return sizeof(native_symbols) / sizeof(NativeSymbol);
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include <string.h>
+
+#include "bh_platform.h"
+#include "gc_telemetry.h"
+#include "wamr_utils.h"
+
+/* The instance followed by a thread */
+typedef struct GCTelemetry {
+    wasm_module_inst_t module_inst;
+    uint32_t last_gc_count;
+    uint32_t last_gc_time;
+    /* the heap in use at the last update */
+    uint32_t last_used_size;
+    uint32_t max_pause_time;
+    uint64_t reclaimed_size;
+    uint64_t last_finalizers_run;
+} GCTelemetry;
+
+static os_thread_local_attribute GCTelemetry telemetry;
+/* the finalizers run on the thread of the heap collected */
+static os_thread_local_attribute uint64_t finalizers_run;
+
+static gc_event_callback_t event_callback = NULL;
+static void *event_user_data = NULL;
+
+void
+gc_telemetry_set_callback(gc_event_callback_t callback, void *user_data)
+{
+    event_callback = callback;
+    event_user_data = user_data;
+}
+
+void
+gc_telemetry_count_finalizer(void)
+{
+    finalizers_run++;
+}
+
+static void
+follow_instance(GCTelemetry *t, wasm_module_inst_t module_inst,
+                const WamrGCHeapStats *stats)
+{
+    memset(t, 0, sizeof(GCTelemetry));
+    t->module_inst = module_inst;
+    t->last_gc_count = stats->gc_count;
+    t->last_gc_time = stats->gc_time;
+    t->last_used_size = stats->total_size - stats->free_size;
+    t->last_finalizers_run = finalizers_run;
+}
+
+void
+gc_telemetry_update(wasm_module_inst_t module_inst)
+{
+    GCTelemetry *t = &telemetry;
+    WamrGCHeapStats stats;
+    GCEvent event;
+    uint32_t used, pause;
+
+    if (!wamr_utils_get_gc_heap_stats(module_inst, &stats)) {
+        return;
+    }
+    if (module_inst != t->module_inst) {
+        follow_instance(t, module_inst, &stats);
+        return;
+    }
+
+    used = stats.total_size - stats.free_size;
+    if (stats.gc_count == t->last_gc_count) {
+        t->last_used_size = used;
+        return;
+    }
+
+    event.collections = stats.gc_count - t->last_gc_count;
+    event.pause_time = stats.gc_time - t->last_gc_time;
+    event.reclaimed_size =
+        t->last_used_size > used ? t->last_used_size - used : 0;
+    event.used_heap_size = used;
+    event.heap_size_limit = stats.total_size;
+    event.finalizers_run = (uint32_t)(finalizers_run - t->last_finalizers_run);
+
+    pause = event.pause_time / event.collections;
+    if (pause > t->max_pause_time) {
+        t->max_pause_time = pause;
+    }
+    t->reclaimed_size += event.reclaimed_size;
+    t->last_gc_count = stats.gc_count;
+    t->last_gc_time = stats.gc_time;
+    t->last_used_size = used;
+    t->last_finalizers_run = finalizers_run;
+
+    if (event_callback) {
+        event_callback(module_inst, &event, event_user_data);
+    }
+}
+
+bool
+gc_telemetry_get_stats(wasm_module_inst_t module_inst,
+                       GCTelemetryStats *stats)
+{
+    GCTelemetry *t = &telemetry;
+    WamrGCHeapStats heap_stats;
+
+    gc_telemetry_update(module_inst);
+    if (!wamr_utils_get_gc_heap_stats(module_inst, &heap_stats)) {
+        return false;
+    }
+
+    memset(stats, 0, sizeof(GCTelemetryStats));
+    stats->collections = heap_stats.gc_count;
+    stats->pause_time = heap_stats.gc_time;
+    stats->heap_size_limit = heap_stats.total_size;
+    stats->used_heap_size = heap_stats.total_size - heap_stats.free_size;
+    stats->peak_heap_size = heap_stats.highmark_size;
+    stats->finalizers_run = finalizers_run;
+    if (module_inst == t->module_inst) {
+        stats->max_pause_time = t->max_pause_time;
+        stats->reclaimed_size = t->reclaimed_size;
+    }
+    return true;
+}
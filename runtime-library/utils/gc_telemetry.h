@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef __GC_TELEMETRY_H_
+#define __GC_TELEMETRY_H_
+
+#include "wasm_export.h"
+
+/* The GC counters of a module instance. WAMR has no hook in the collector,
+ * the collections are noticed at the safe points of the host, see
+ * gc_telemetry_update. */
+typedef struct GCTelemetryStats {
+    uint32_t collections;
+    /* total pause time of the collections, in ms */
+    uint32_t pause_time;
+    /* the longest mean pause of the collections between two safe points */
+    uint32_t max_pause_time;
+    /* a lower bound of the bytes freed by the collections: the drop of the
+     * heap in use across them, the allocations in between hide the rest */
+    uint64_t reclaimed_size;
+    /* size of the heap pool, the heap can't grow over it */
+    uint32_t heap_size_limit;
+    uint32_t used_heap_size;
+    uint32_t peak_heap_size;
+    /* finalizers of boxed dynamic values run on the calling thread, they
+     * release the values when the boxes are collected */
+    uint64_t finalizers_run;
+} GCTelemetryStats;
+
+/* The collections noticed at a safe point */
+typedef struct GCEvent {
+    uint32_t collections;
+    /* in ms */
+    uint32_t pause_time;
+    uint32_t reclaimed_size;
+    uint32_t used_heap_size;
+    uint32_t heap_size_limit;
+    uint32_t finalizers_run;
+} GCEvent;
+
+typedef void (*gc_event_callback_t)(wasm_module_inst_t module_inst,
+                                    const GCEvent *event, void *user_data);
+
+/**
+ * @brief Set the function called, on the thread of the instance, once
+ * collections happened, NULL to remove it. Set it before any thread runs
+ * wasm code.
+ *
+ * @param callback the callback
+ * @param user_data passed to callback
+ */
+void
+gc_telemetry_set_callback(gc_event_callback_t callback, void *user_data);
+
+/**
+ * @brief Look at the collections since the last update on the calling
+ * thread and call the callback if any happened, called by the host at its
+ * safe points (e.g. the turns of the event loop)
+ *
+ * The last instance updated is followed, updating another one starts
+ * counting its collections from there.
+ *
+ * @param module_inst the running instance
+ */
+void
+gc_telemetry_update(wasm_module_inst_t module_inst);
+
+/**
+ * @brief Get the GC counters of a module instance running on the calling
+ * thread, updated first
+ *
+ * @param module_inst the module instance
+ * @param stats receives the counters
+ * @return true if success, false if the instance has no GC heap
+ */
+bool
+gc_telemetry_get_stats(wasm_module_inst_t module_inst,
+                       GCTelemetryStats *stats);
+
+/**
+ * @brief Count a finalizer run on the calling thread
+ */
+void
+gc_telemetry_count_finalizer(void);
+
+#endif /* end of __GC_TELEMETRY_H_ */
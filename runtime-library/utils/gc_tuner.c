@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "gc_tuner.h"
+#include "wamr_utils.h"
+
+#define GC_TUNER_FACTOR_MIN 50
+#define GC_TUNER_FACTOR_MAX 950
+#define GC_TUNER_FACTOR_STEP 50
+/* more live data than this, in percent of the heap in use at collection,
+ * makes collections worthless, the heap grows */
+#define GC_TUNER_GROW_SURVIVAL 60
+/* less than this lets the heap shrink back */
+#define GC_TUNER_SHRINK_SURVIVAL 20
+
+static void
+set_factor(GCTuner *tuner, uint32_t factor)
+{
+    if (factor < GC_TUNER_FACTOR_MIN) {
+        factor = GC_TUNER_FACTOR_MIN;
+    }
+    else if (factor > GC_TUNER_FACTOR_MAX) {
+        factor = GC_TUNER_FACTOR_MAX;
+    }
+    if (factor != tuner->factor
+        && wamr_utils_set_gc_threshold_factor(tuner->module_inst, factor)) {
+        tuner->factor = factor;
+    }
+}
+
+void
+gc_tuner_init(GCTuner *tuner, wasm_module_inst_t module_inst,
+              uint32_t initial_size, uint32_t pause_target)
+{
+    WamrGCHeapStats stats;
+
+    memset(tuner, 0, sizeof(GCTuner));
+    tuner->module_inst = module_inst;
+    tuner->pause_target = pause_target;
+
+    if (!wamr_utils_get_gc_heap_stats(module_inst, &stats)) {
+        return;
+    }
+    tuner->last_gc_count = stats.gc_count;
+    tuner->last_gc_time = stats.gc_time;
+
+    if (initial_size > 0 && initial_size < stats.total_size) {
+        /* the first collection runs once about initial_size is in use */
+        tuner->adaptive = true;
+        set_factor(tuner, (uint32_t)(1000 - (uint64_t)initial_size * 1000
+                                                / stats.total_size));
+    }
+}
+
+void
+gc_tuner_update(GCTuner *tuner, wasm_module_inst_t module_inst)
+{
+    WamrGCHeapStats stats;
+    uint32_t count, pause, used, in_use_at_collection, survival;
+
+    if (module_inst != tuner->module_inst
+        || !wamr_utils_get_gc_heap_stats(module_inst, &stats)
+        || stats.gc_count == tuner->last_gc_count) {
+        return;
+    }
+
+    count = stats.gc_count - tuner->last_gc_count;
+    pause = (stats.gc_time - tuner->last_gc_time) / count;
+    tuner->last_gc_count = stats.gc_count;
+    tuner->last_gc_time = stats.gc_time;
+    if (pause > tuner->max_pause) {
+        tuner->max_pause = pause;
+    }
+
+    if (!tuner->adaptive) {
+        return;
+    }
+
+    /* the free size is about the one left by the last collection, so the
+     * next one runs once the heap in use reaches the size below */
+    used = stats.total_size - stats.free_size;
+    in_use_at_collection =
+        stats.total_size
+        - (uint32_t)((uint64_t)stats.free_size * tuner->factor / 1000);
+    survival = in_use_at_collection > 0
+                   ? (uint32_t)((uint64_t)used * 100 / in_use_at_collection)
+                   : 100;
+
+    if (pause > tuner->pause_target || survival < GC_TUNER_SHRINK_SURVIVAL) {
+        /* collect sooner, less garbage to sweep and less memory touched */
+        set_factor(tuner, tuner->factor + GC_TUNER_FACTOR_STEP);
+        tuner->shrink_count++;
+    }
+    else if (survival > GC_TUNER_GROW_SURVIVAL) {
+        /* collect later, a collection frees too little to be worth it */
+        set_factor(tuner, tuner->factor - GC_TUNER_FACTOR_STEP);
+        tuner->grow_count++;
+    }
+}
+
+void
+gc_tuner_dump_stats(GCTuner *tuner, FILE *out)
+{
+    WamrGCHeapStats stats;
+
+    if (!wamr_utils_get_gc_heap_stats(tuner->module_inst, &stats)) {
+        fprintf(out, "gc: statistics not available\n");
+        return;
+    }
+
+    fprintf(out,
+            "gc: %" PRIu32 " collections, %" PRIu32 " ms paused, %.2f ms per "
+            "collection, longest mean pause %" PRIu32 " ms\n",
+            stats.gc_count, stats.gc_time,
+            stats.gc_count ? (double)stats.gc_time / stats.gc_count : 0.0,
+            tuner->max_pause);
+    fprintf(out,
+            "gc: heap %" PRIu32 " bytes reserved, %" PRIu32 " bytes peak, "
+            "%" PRIu32 " bytes in use at exit\n",
+            stats.total_size, stats.highmark_size,
+            stats.total_size - stats.free_size);
+    if (tuner->adaptive) {
+        fprintf(out,
+                "gc: threshold factor %" PRIu32 ", grown %" PRIu32
+                " times, shrunk %" PRIu32 " times\n",
+                tuner->factor, tuner->grow_count, tuner->shrink_count);
+    }
+}
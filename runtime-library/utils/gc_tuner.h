@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef __GC_TUNER_H_
+#define __GC_TUNER_H_
+
+#include <stdio.h>
+
+#include "wasm_export.h"
+
+/* Sizes the GC heap of one module instance. The heap pool is reserved at its
+ * maximum size and its pages are only committed once touched, the tuner
+ * moves the collection threshold so that the part in use grows while most
+ * of it survives collections and shrinks when pauses exceed the target or
+ * little survives. */
+typedef struct GCTuner {
+    wasm_module_inst_t module_inst;
+    bool adaptive;
+    /* in ms */
+    uint32_t pause_target;
+    /* see wamr_utils_set_gc_threshold_factor */
+    uint32_t factor;
+    uint32_t last_gc_count;
+    uint32_t last_gc_time;
+    /* the longest mean pause of the collections between two updates */
+    uint32_t max_pause;
+    uint32_t grow_count;
+    uint32_t shrink_count;
+} GCTuner;
+
+/**
+ * @brief Start tuning the GC heap of a module instance
+ *
+ * @param tuner the tuner to initialize
+ * @param module_inst the module instance
+ * @param initial_size the heap size to collect at first, 0 or the size of the
+ * whole heap only collects statistics
+ * @param pause_target the longest mean pause wished, in ms
+ */
+void
+gc_tuner_init(GCTuner *tuner, wasm_module_inst_t module_inst,
+              uint32_t initial_size, uint32_t pause_target);
+
+/**
+ * @brief Look at the collections since the last update and move the
+ * threshold, called by the host at its safe points (e.g. the turns of the
+ * event loop)
+ *
+ * @param tuner the tuner
+ * @param module_inst the running instance, other instances are ignored
+ */
+void
+gc_tuner_update(GCTuner *tuner, wasm_module_inst_t module_inst);
+
+/**
+ * @brief Print the collection count, pause times and heap sizes
+ *
+ * @param tuner the tuner
+ * @param out the output file
+ */
+void
+gc_tuner_dump_stats(GCTuner *tuner, FILE *out);
+
+#endif /* end of __GC_TUNER_H_ */
@@ -0,0 +1,931 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* The snapshot is built in memory, then written as the JSON of the V8 heap
+ * snapshots: flat arrays of nodes and edges, the edges of a node following
+ * the ones of the previous node, and a table of the strings they name. The
+ * GC doesn't move objects, so the ids, derived from the addresses, match the
+ * same objects across the snapshots of a run. */
+
+#include <signal.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "bh_hashmap.h"
+#include "bh_platform.h"
+#include "gc_export.h"
+#include "heap_snapshot.h"
+#include "libdyntype_export.h"
+#include "type_utils.h"
+#include "wamr_utils.h"
+
+#define SNAPSHOT_MAP_INIT_SIZE 1024
+/* the contents of strings shown as names are cut to this length */
+#define SNAPSHOT_MAX_STRING_LEN 80
+#define SNAPSHOT_PATH_MAX_LEN 64
+
+/* in the order of node_types and edge_types of SNAPSHOT_META */
+enum node_type {
+    NODE_HIDDEN,
+    NODE_ARRAY,
+    NODE_STRING,
+    NODE_OBJECT,
+    NODE_CODE,
+    NODE_CLOSURE,
+    NODE_REGEXP,
+    NODE_NUMBER,
+    NODE_NATIVE,
+    NODE_SYNTHETIC,
+    NODE_CONCATENATED_STRING,
+    NODE_SLICED_STRING,
+    NODE_SYMBOL,
+    NODE_BIGINT,
+};
+
+enum edge_type {
+    EDGE_CONTEXT,
+    EDGE_ELEMENT,
+    EDGE_PROPERTY,
+    EDGE_INTERNAL,
+    EDGE_HIDDEN,
+    EDGE_SHORTCUT,
+    EDGE_WEAK,
+};
+
+/* the synthetic nodes come first, the root must be the first node */
+enum root_node {
+    ROOT_NODE,
+    GLOBALS_NODE,
+    TABLES_NODE,
+    OTHER_ROOTS_NODE,
+    ROOT_NODE_COUNT,
+};
+
+#define NODE_FIELD_COUNT 6
+
+/* clang-format off */
+#define SNAPSHOT_META                                                        \
+    "{\"node_fields\":[\"type\",\"name\",\"id\",\"self_size\","             \
+    "\"edge_count\",\"trace_node_id\"],"                                     \
+    "\"node_types\":[[\"hidden\",\"array\",\"string\",\"object\",\"code\","  \
+    "\"closure\",\"regexp\",\"number\",\"native\",\"synthetic\","            \
+    "\"concatenated string\",\"sliced string\",\"symbol\",\"bigint\"],"      \
+    "\"string\",\"number\",\"number\",\"number\",\"number\"],"               \
+    "\"edge_fields\":[\"type\",\"name_or_index\",\"to_node\"],"              \
+    "\"edge_types\":[[\"context\",\"element\",\"property\",\"internal\","    \
+    "\"hidden\",\"shortcut\",\"weak\"],\"string_or_number\",\"node\"],"      \
+    "\"trace_function_info_fields\":[\"function_id\",\"name\","              \
+    "\"script_name\",\"script_id\",\"line\",\"column\"],"                    \
+    "\"trace_node_fields\":[\"id\",\"function_info_index\",\"count\","       \
+    "\"size\",\"children\"],"                                                \
+    "\"sample_fields\":[\"timestamp_us\",\"last_assigned_id\"],"             \
+    "\"location_fields\":[\"object_index\",\"script_id\",\"line\","          \
+    "\"column\"]}"
+/* clang-format on */
+
+typedef struct SnapshotNode {
+    /* the wasm object or dynamic value, NULL for the synthetic nodes */
+    void *ref;
+    uint8_t type;
+    /* referred to by another node */
+    bool has_referrer;
+    uint32_t name;
+    uint32_t self_size;
+    uint32_t edge_count;
+} SnapshotNode;
+
+typedef struct SnapshotEdge {
+    uint32_t from;
+    uint8_t type;
+    /* the index for element edges, a string otherwise */
+    uint32_t name_or_index;
+    uint32_t to;
+} SnapshotEdge;
+
+typedef struct HeapSnapshot {
+    wasm_exec_env_t exec_env;
+    wasm_module_inst_t module_inst;
+    wasm_module_t module;
+    dyn_ctx_t dyn_ctx;
+    SnapshotNode *nodes;
+    uint32_t node_count;
+    uint32_t node_capacity;
+    SnapshotEdge *edges;
+    uint32_t edge_count;
+    uint32_t edge_capacity;
+    /* node index + 1 of the wasm objects and dynamic values */
+    HashMap *node_map;
+    char **strings;
+    uint32_t string_count;
+    uint32_t string_capacity;
+    /* string index + 1 of the strings */
+    HashMap *string_map;
+    bool oom;
+} HeapSnapshot;
+
+static atomic_uint snapshot_requests;
+static atomic_uint snapshot_seq;
+static os_thread_local_attribute unsigned snapshot_requests_seen;
+static os_thread_local_attribute bool snapshot_requests_seen_valid;
+
+static uint32_t
+ref_hash(const void *key)
+{
+    return (uint32_t)((uintptr_t)key >> 3);
+}
+
+static bool
+ref_equal(void *key1, void *key2)
+{
+    return key1 == key2;
+}
+
+static uint32_t
+string_hash(const void *key)
+{
+    const uint8_t *p = (const uint8_t *)key;
+    uint32_t hash = 2166136261u;
+
+    while (*p) {
+        hash = (hash ^ *p++) * 16777619u;
+    }
+    return hash;
+}
+
+static bool
+string_equal(void *key1, void *key2)
+{
+    return strcmp((const char *)key1, (const char *)key2) == 0;
+}
+
+static bool
+grow_array(void **p_array, uint32_t *p_capacity, uint32_t count,
+           uint32_t elem_size)
+{
+    uint32_t capacity;
+    void *array;
+
+    if (count < *p_capacity) {
+        return true;
+    }
+    capacity = *p_capacity ? *p_capacity * 2 : 256;
+    if ((uint64_t)capacity * elem_size > UINT32_MAX
+        || !(array = realloc(*p_array, (size_t)capacity * elem_size))) {
+        return false;
+    }
+    *p_array = array;
+    *p_capacity = capacity;
+    return true;
+}
+
+/* Return the index of the string, the empty string on failure */
+static uint32_t
+add_string_with_len(HeapSnapshot *snapshot, const char *str, uint32_t len)
+{
+    uintptr_t index;
+    char *copy;
+
+    if (!(copy = malloc(len + 1))) {
+        snapshot->oom = true;
+        return 0;
+    }
+    bh_memcpy_s(copy, len + 1, str, len);
+    copy[len] = '\0';
+
+    if ((index = (uintptr_t)bh_hash_map_find(snapshot->string_map, copy))) {
+        free(copy);
+        return (uint32_t)(index - 1);
+    }
+    if (!grow_array((void **)&snapshot->strings, &snapshot->string_capacity,
+                    snapshot->string_count, sizeof(char *))) {
+        free(copy);
+        snapshot->oom = true;
+        return 0;
+    }
+    index = snapshot->string_count;
+    if (!bh_hash_map_insert(snapshot->string_map, copy, (void *)(index + 1))) {
+        free(copy);
+        snapshot->oom = true;
+        return 0;
+    }
+    snapshot->strings[snapshot->string_count++] = copy;
+    return (uint32_t)index;
+}
+
+static uint32_t
+add_string(HeapSnapshot *snapshot, const char *str)
+{
+    return add_string_with_len(snapshot, str, (uint32_t)strlen(str));
+}
+
+/* The contents of a string, cut without splitting a UTF-8 sequence */
+static uint32_t
+add_string_contents(HeapSnapshot *snapshot, const char *str, uint32_t len)
+{
+    if (len > SNAPSHOT_MAX_STRING_LEN) {
+        len = SNAPSHOT_MAX_STRING_LEN;
+        while (len > 0 && ((uint8_t)str[len] & 0xC0) == 0x80) {
+            len--;
+        }
+    }
+    return add_string_with_len(snapshot, str, len);
+}
+
+/* Return the index of the node, UINT32_MAX if out of memory */
+static uint32_t
+add_node(HeapSnapshot *snapshot, void *ref, uint8_t type, uint32_t name,
+         uint32_t self_size)
+{
+    SnapshotNode *node;
+    uintptr_t index = snapshot->node_count;
+
+    if (!grow_array((void **)&snapshot->nodes, &snapshot->node_capacity,
+                    snapshot->node_count, sizeof(SnapshotNode))
+        || (ref
+            && !bh_hash_map_insert(snapshot->node_map, ref,
+                                   (void *)(index + 1)))) {
+        snapshot->oom = true;
+        return UINT32_MAX;
+    }
+
+    node = &snapshot->nodes[snapshot->node_count++];
+    memset(node, 0, sizeof(SnapshotNode));
+    node->ref = ref;
+    node->type = type;
+    node->name = name;
+    node->self_size = self_size;
+    return (uint32_t)index;
+}
+
+static uint32_t
+find_node(HeapSnapshot *snapshot, void *ref)
+{
+    uintptr_t index = (uintptr_t)bh_hash_map_find(snapshot->node_map, ref);
+
+    return index ? (uint32_t)(index - 1) : UINT32_MAX;
+}
+
+static void
+add_edge(HeapSnapshot *snapshot, uint32_t from, uint8_t type,
+         uint32_t name_or_index, uint32_t to)
+{
+    SnapshotEdge *edge;
+
+    if (to == UINT32_MAX) {
+        return;
+    }
+    if (!grow_array((void **)&snapshot->edges, &snapshot->edge_capacity,
+                    snapshot->edge_count, sizeof(SnapshotEdge))) {
+        snapshot->oom = true;
+        return;
+    }
+
+    edge = &snapshot->edges[snapshot->edge_count++];
+    edge->from = from;
+    edge->type = type;
+    edge->name_or_index = name_or_index;
+    edge->to = to;
+    snapshot->nodes[from].edge_count++;
+    if (from != to) {
+        snapshot->nodes[to].has_referrer = true;
+    }
+}
+
+static void
+add_obj_edge(HeapSnapshot *snapshot, uint32_t from, uint8_t type,
+             uint32_t name_or_index, wasm_obj_t obj)
+{
+    if (obj && !wasm_obj_is_i31_obj(obj)) {
+        add_edge(snapshot, from, type, name_or_index, find_node(snapshot, obj));
+    }
+}
+
+static bool
+is_ref_type(uint8_t value_type)
+{
+    switch (value_type) {
+        case VALUE_TYPE_I32:
+        case VALUE_TYPE_I64:
+        case VALUE_TYPE_F32:
+        case VALUE_TYPE_F64:
+        case VALUE_TYPE_V128:
+        case PACKED_TYPE_I8:
+        case PACKED_TYPE_I16:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/* A class instance holds its vtable first, which holds the offset of the
+ * Meta of the class first */
+static void *
+get_instance_meta(HeapSnapshot *snapshot, wasm_struct_obj_t obj)
+{
+    wasm_struct_type_t struct_type =
+        (wasm_struct_type_t)wasm_obj_get_defined_type((wasm_obj_t)obj);
+    wasm_struct_type_t vtable_type;
+    wasm_value_t vtable = { 0 }, meta = { 0 };
+    bool is_mutable;
+
+    if (wasm_struct_type_get_field_count(struct_type) == 0
+        || !is_ref_type(
+            wasm_struct_type_get_field_type(struct_type, 0, &is_mutable)
+                .value_type)) {
+        return NULL;
+    }
+    wasm_struct_obj_get_field(obj, 0, false, &vtable);
+    if (!vtable.gc_obj || wasm_obj_is_i31_obj(vtable.gc_obj)
+        || !wasm_obj_is_struct_obj(vtable.gc_obj)) {
+        return NULL;
+    }
+
+    vtable_type = (wasm_struct_type_t)wasm_obj_get_defined_type(vtable.gc_obj);
+    if (wasm_struct_type_get_field_count(vtable_type) == 0
+        || wasm_struct_type_get_field_type(vtable_type, 0, &is_mutable)
+                   .value_type
+               != VALUE_TYPE_I32) {
+        return NULL;
+    }
+    wasm_struct_obj_get_field((wasm_struct_obj_t)vtable.gc_obj, 0, false,
+                              &meta);
+    /* the name, type id, impl id and count */
+    if (!wasm_runtime_validate_app_addr(snapshot->module_inst,
+                                        (uint64_t)(uint32_t)meta.i32 - 4, 16)) {
+        return NULL;
+    }
+    return wasm_runtime_addr_app_to_native(snapshot->module_inst,
+                                           (uint64_t)(uint32_t)meta.i32);
+}
+
+static uint32_t
+add_class_name(HeapSnapshot *snapshot, void *meta, const char *format)
+{
+    const char *name = get_class_name_from_meta(snapshot->exec_env, meta);
+    const char *short_name;
+    char buf[256];
+
+    if (!name) {
+        name = "(object)";
+    }
+    /* drop the path of the module from the mangled name */
+    if ((short_name = strrchr(name, '|'))) {
+        name = short_name + 1;
+    }
+    snprintf(buf, sizeof(buf), format, name);
+    return add_string(snapshot, buf);
+}
+
+static void
+describe_struct(HeapSnapshot *snapshot, SnapshotNode *node)
+{
+    wasm_struct_obj_t obj = (wasm_struct_obj_t)node->ref;
+    wasm_defined_type_t type = wasm_obj_get_defined_type((wasm_obj_t)obj);
+    void *meta;
+
+    if ((meta = get_instance_meta(snapshot, obj))) {
+        node->type = NODE_OBJECT;
+        node->name = add_class_name(snapshot, meta, "%s");
+    }
+#if WASM_ENABLE_STRINGREF == 0
+    else if (is_ts_string_type(snapshot->module, type)) {
+        node->type = NODE_STRING;
+        node->name = add_string_contents(
+            snapshot, get_str_from_string_struct(obj),
+            get_str_length_from_string_struct(obj));
+    }
+#endif
+    else if (is_ts_array_type(snapshot->module, type)) {
+        node->type = NODE_ARRAY;
+        node->name = add_string(snapshot, "Array");
+    }
+    else if (is_ts_closure_type(snapshot->module, type)) {
+        node->type = NODE_CLOSURE;
+        node->name = add_string(snapshot, "(closure)");
+    }
+    else {
+        node->type = NODE_HIDDEN;
+        node->name = add_string(snapshot, "(struct)");
+    }
+}
+
+static void
+describe_object(HeapSnapshot *snapshot, SnapshotNode *node)
+{
+    wasm_obj_t obj = (wasm_obj_t)node->ref;
+
+    if (wasm_obj_is_struct_obj(obj)) {
+        describe_struct(snapshot, node);
+    }
+    else if (wasm_obj_is_array_obj(obj)) {
+        node->type = NODE_ARRAY;
+        node->name = add_string(snapshot, "(array)");
+    }
+#if WASM_ENABLE_STRINGREF != 0
+    else if (wasm_obj_is_stringref_obj(obj)) {
+        uint32_t len = wasm_string_get_length((wasm_stringref_obj_t)obj);
+        char *str;
+
+        node->type = NODE_STRING;
+        if (!(str = malloc(len))) {
+            snapshot->oom = true;
+            return;
+        }
+        wasm_string_to_cstring((wasm_stringref_obj_t)obj, str, len);
+        node->name = add_string_contents(snapshot, str, (uint32_t)strlen(str));
+        free(str);
+    }
+#endif
+    else if (wasm_obj_is_anyref_obj(obj)) {
+        node->type = NODE_HIDDEN;
+        node->name = add_string(snapshot, "(anyref)");
+    }
+    else if (wasm_obj_is_externref_obj(obj)) {
+        node->type = NODE_HIDDEN;
+        node->name = add_string(snapshot, "(externref)");
+    }
+    else if (wasm_obj_is_func_obj(obj)) {
+        node->type = NODE_CODE;
+        node->name = add_string(snapshot, "(function)");
+    }
+    else {
+        node->type = NODE_HIDDEN;
+        node->name = add_string(snapshot, "(internal)");
+    }
+}
+
+static void
+describe_dyn_value(HeapSnapshot *snapshot, uint32_t node_index)
+{
+    dyn_ctx_t ctx = snapshot->dyn_ctx;
+    dyn_value_t value = (dyn_value_t)snapshot->nodes[node_index].ref;
+    uint8_t type = NODE_HIDDEN;
+    uint32_t name;
+    char *str = NULL;
+    void *extref = NULL;
+    uint32_t table_index;
+
+    if (value == (dyn_value_t)ctx) {
+        name = add_string(snapshot, "(dyntype context)");
+        goto done;
+    }
+
+    switch (dyntype_typeof(ctx, value)) {
+        case DynNull:
+            name = add_string(snapshot, "null");
+            break;
+        case DynUndefined:
+            name = add_string(snapshot, "undefined");
+            break;
+        case DynBoolean:
+            name = add_string(snapshot, "boolean");
+            break;
+        case DynNumber:
+            type = NODE_NUMBER;
+            name = add_string(snapshot, "number");
+            break;
+        case DynString:
+            type = NODE_STRING;
+            if (dyntype_to_cstring(ctx, value, &str) != DYNTYPE_SUCCESS
+                || !str) {
+                name = add_string(snapshot, "(string)");
+                break;
+            }
+            name = add_string_contents(snapshot, str, (uint32_t)strlen(str));
+            dyntype_free_cstring(ctx, str);
+            break;
+        case DynObject:
+            if (dyntype_is_array(ctx, value)) {
+                type = NODE_ARRAY;
+                name = add_string(snapshot, "Array (dynamic)");
+            }
+            else {
+                type = NODE_OBJECT;
+                name = add_string(snapshot, "Object (dynamic)");
+            }
+            break;
+        case DynFunction:
+            type = NODE_CLOSURE;
+            name = add_string(snapshot, "Function (dynamic)");
+            break;
+        case DynSymbol:
+            type = NODE_SYMBOL;
+            name = add_string(snapshot, "symbol");
+            break;
+        case DynBigInt:
+            type = NODE_BIGINT;
+            name = add_string(snapshot, "bigint");
+            break;
+        case DynExtRefObj:
+        case DynExtRefFunc:
+        case DynExtRefArray:
+            type = NODE_OBJECT;
+            name = add_string(snapshot, "(extref)");
+            /* the static object is held by the slot of the extref table */
+            if (dyntype_to_extref(ctx, value, &extref) < 0) {
+                break;
+            }
+            table_index = (uint32_t)(uintptr_t)extref;
+            if (table_index < wamr_utils_get_table_size(snapshot->exec_env)) {
+                add_obj_edge(snapshot, node_index, EDGE_INTERNAL,
+                             add_string(snapshot, "(extref)"),
+                             wamr_utils_get_table_element(snapshot->exec_env,
+                                                          table_index));
+            }
+            break;
+        default:
+            name = add_string(snapshot, "(dynamic)");
+            break;
+    }
+
+done:
+    snapshot->nodes[node_index].type = type;
+    snapshot->nodes[node_index].name = name;
+}
+
+/* The dynamic values have no size known out of libdyntype, and no identity
+ * that lasts across the backends, so only the boxed value is a node, the
+ * properties of dynamic objects aren't followed */
+static uint32_t
+add_dyn_node(HeapSnapshot *snapshot, dyn_value_t value)
+{
+    uint32_t node_index;
+
+    if (!value) {
+        return UINT32_MAX;
+    }
+    if ((node_index = find_node(snapshot, value)) != UINT32_MAX) {
+        return node_index;
+    }
+    if ((node_index = add_node(snapshot, value, NODE_HIDDEN, 0, 0))
+        != UINT32_MAX) {
+        describe_dyn_value(snapshot, node_index);
+    }
+    return node_index;
+}
+
+static void
+add_struct_edges(HeapSnapshot *snapshot, uint32_t node_index)
+{
+    wasm_struct_obj_t obj = (wasm_struct_obj_t)snapshot->nodes[node_index].ref;
+    wasm_struct_type_t struct_type =
+        (wasm_struct_type_t)wasm_obj_get_defined_type((wasm_obj_t)obj);
+    uint32_t field_count = wasm_struct_type_get_field_count(struct_type);
+    void *meta = get_instance_meta(snapshot, obj);
+    const char *field_name;
+    char buf[32];
+    uint32_t i, vtable_node;
+    bool is_mutable;
+
+    for (i = 0; i < field_count; i++) {
+        wasm_value_t value = { 0 };
+
+        if (!is_ref_type(
+                wasm_struct_type_get_field_type(struct_type, i, &is_mutable)
+                    .value_type)) {
+            continue;
+        }
+        wasm_struct_obj_get_field(obj, i, false, &value);
+        if (i == 0 && meta) {
+            add_obj_edge(snapshot, node_index, EDGE_INTERNAL,
+                         add_string(snapshot, "(vtable)"), value.gc_obj);
+            /* named after the class of its instances */
+            if ((vtable_node = find_node(snapshot, value.gc_obj))
+                != UINT32_MAX) {
+                snapshot->nodes[vtable_node].type = NODE_HIDDEN;
+                snapshot->nodes[vtable_node].name =
+                    add_class_name(snapshot, meta, "(vtable %s)");
+            }
+        }
+        else if (meta
+                 && (field_name = get_field_name_from_field_index(
+                         snapshot->exec_env, meta, i))) {
+            add_obj_edge(snapshot, node_index, EDGE_PROPERTY,
+                         add_string(snapshot, field_name), value.gc_obj);
+        }
+        else {
+            snprintf(buf, sizeof(buf), "(field %" PRIu32 ")", i);
+            add_obj_edge(snapshot, node_index, EDGE_INTERNAL,
+                         add_string(snapshot, buf), value.gc_obj);
+        }
+    }
+}
+
+static void
+add_array_edges(HeapSnapshot *snapshot, uint32_t node_index)
+{
+    wasm_array_obj_t obj = (wasm_array_obj_t)snapshot->nodes[node_index].ref;
+    wasm_array_type_t array_type =
+        (wasm_array_type_t)wasm_obj_get_defined_type((wasm_obj_t)obj);
+    uint32_t len = wasm_array_obj_length(obj);
+    uint32_t i;
+    bool is_mutable;
+
+    if (!is_ref_type(
+            wasm_array_type_get_elem_type(array_type, &is_mutable).value_type)) {
+        return;
+    }
+    for (i = 0; i < len; i++) {
+        wasm_value_t value = { 0 };
+
+        wasm_array_obj_get_elem(obj, i, false, &value);
+        add_obj_edge(snapshot, node_index, EDGE_ELEMENT, i, value.gc_obj);
+    }
+}
+
+static void
+add_object_edges(HeapSnapshot *snapshot, uint32_t node_index)
+{
+    wasm_obj_t obj = (wasm_obj_t)snapshot->nodes[node_index].ref;
+
+    if (wasm_obj_is_struct_obj(obj)) {
+        add_struct_edges(snapshot, node_index);
+    }
+    else if (wasm_obj_is_array_obj(obj)) {
+        add_array_edges(snapshot, node_index);
+    }
+    else if (wasm_obj_is_anyref_obj(obj)) {
+        add_edge(snapshot, node_index, EDGE_INTERNAL,
+                 add_string(snapshot, "(value)"),
+                 add_dyn_node(snapshot,
+                              (dyn_value_t)wasm_anyref_obj_get_value(
+                                  (wasm_anyref_obj_t)obj)));
+    }
+    else if (wasm_obj_is_externref_obj(obj)) {
+        add_obj_edge(snapshot, node_index, EDGE_INTERNAL,
+                     add_string(snapshot, "(value)"),
+                     wasm_externref_obj_to_internal_obj(
+                         (wasm_externref_obj_t)obj));
+    }
+}
+
+static void
+visit_heap_obj(void *obj, uint32_t size, void *user_data)
+{
+    add_node((HeapSnapshot *)user_data, obj, NODE_HIDDEN, 0, size);
+}
+
+typedef struct GlobalRootVisitor {
+    HeapSnapshot *snapshot;
+    uint32_t index;
+} GlobalRootVisitor;
+
+static bool
+visit_global_obj(void *obj, void *user_data)
+{
+    GlobalRootVisitor *visitor = (GlobalRootVisitor *)user_data;
+
+    add_obj_edge(visitor->snapshot, GLOBALS_NODE, EDGE_ELEMENT,
+                 visitor->index++, (wasm_obj_t)obj);
+    return false;
+}
+
+static void
+add_roots(HeapSnapshot *snapshot, uint32_t object_end)
+{
+    GlobalRootVisitor visitor = { snapshot, 0 };
+    uint32_t table_size = wamr_utils_get_table_size(snapshot->exec_env);
+    uint32_t i, other_count = 0;
+
+    add_edge(snapshot, ROOT_NODE, EDGE_ELEMENT, 0, GLOBALS_NODE);
+    add_edge(snapshot, ROOT_NODE, EDGE_ELEMENT, 1, TABLES_NODE);
+    add_edge(snapshot, ROOT_NODE, EDGE_ELEMENT, 2, OTHER_ROOTS_NODE);
+
+    wamr_utils_find_global_obj(snapshot->module_inst, visit_global_obj,
+                               &visitor);
+    for (i = 0; i < table_size; i++) {
+        add_obj_edge(snapshot, TABLES_NODE, EDGE_ELEMENT, i,
+                     wamr_utils_get_table_element(snapshot->exec_env, i));
+    }
+
+    /* held by the wasm stack, or by the natives through local refs */
+    for (i = ROOT_NODE_COUNT; i < object_end; i++) {
+        if (!snapshot->nodes[i].has_referrer) {
+            add_edge(snapshot, OTHER_ROOTS_NODE, EDGE_ELEMENT, other_count++,
+                     i);
+        }
+    }
+}
+
+static void
+write_json_string(FILE *file, const char *str)
+{
+    const uint8_t *p = (const uint8_t *)str;
+
+    fputc('"', file);
+    for (; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', file);
+            fputc(*p, file);
+        }
+        else if (*p < 0x20) {
+            fprintf(file, "\\u%04x", *p);
+        }
+        else {
+            fputc(*p, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static uint64_t
+get_node_id(const SnapshotNode *node, uint32_t node_index)
+{
+    /* odd like the ids of V8, the references are at least 2-byte aligned */
+    return node->ref ? (uint64_t)(uintptr_t)node->ref + 1
+                     : (uint64_t)node_index * 2 + 1;
+}
+
+static bool
+write_snapshot(HeapSnapshot *snapshot, const char *path)
+{
+    SnapshotEdge *edges = NULL;
+    uint32_t *next_edge = NULL;
+    uint32_t i, edge_index = 0;
+    FILE *file;
+    bool ret = false;
+
+    /* sort the edges by the node they start from */
+    if (!(next_edge = malloc(sizeof(uint32_t) * snapshot->node_count))
+        || (snapshot->edge_count > 0
+            && !(edges = malloc(sizeof(SnapshotEdge) * snapshot->edge_count)))) {
+        goto fail;
+    }
+    for (i = 0; i < snapshot->node_count; i++) {
+        next_edge[i] = edge_index;
+        edge_index += snapshot->nodes[i].edge_count;
+    }
+    for (i = 0; i < snapshot->edge_count; i++) {
+        edges[next_edge[snapshot->edges[i].from]++] = snapshot->edges[i];
+    }
+
+    if (!(file = fopen(path, "w"))) {
+        goto fail;
+    }
+
+    fprintf(file,
+            "{\"snapshot\":{\"meta\":" SNAPSHOT_META ",\"node_count\":%" PRIu32
+            ",\"edge_count\":%" PRIu32 ",\"trace_function_count\":0},\n",
+            snapshot->node_count, snapshot->edge_count);
+
+    fputs("\"nodes\":[", file);
+    for (i = 0; i < snapshot->node_count; i++) {
+        const SnapshotNode *node = &snapshot->nodes[i];
+
+        fprintf(file, "%s%u,%" PRIu32 ",%" PRIu64 ",%" PRIu32 ",%" PRIu32 ",0",
+                i > 0 ? ",\n" : "", node->type, node->name,
+                get_node_id(node, i), node->self_size, node->edge_count);
+    }
+
+    fputs("],\n\"edges\":[", file);
+    for (i = 0; i < snapshot->edge_count; i++) {
+        fprintf(file, "%s%u,%" PRIu32 ",%" PRIu64, i > 0 ? ",\n" : "",
+                edges[i].type, edges[i].name_or_index,
+                (uint64_t)edges[i].to * NODE_FIELD_COUNT);
+    }
+
+    fputs("],\n\"trace_function_infos\":[],\"trace_tree\":[],\"samples\":[],"
+          "\"locations\":[],\n\"strings\":[",
+          file);
+    for (i = 0; i < snapshot->string_count; i++) {
+        if (i > 0) {
+            fputs(",\n", file);
+        }
+        write_json_string(file, snapshot->strings[i]);
+    }
+    fputs("]}\n", file);
+
+    ret = !ferror(file);
+    if (fclose(file) != 0) {
+        ret = false;
+    }
+
+fail:
+    free(edges);
+    free(next_edge);
+    return ret;
+}
+
+static void
+heap_snapshot_destroy(HeapSnapshot *snapshot)
+{
+    uint32_t i;
+
+    if (snapshot->node_map) {
+        bh_hash_map_destroy(snapshot->node_map);
+    }
+    if (snapshot->string_map) {
+        bh_hash_map_destroy(snapshot->string_map);
+    }
+    for (i = 0; i < snapshot->string_count; i++) {
+        free(snapshot->strings[i]);
+    }
+    free(snapshot->strings);
+    free(snapshot->nodes);
+    free(snapshot->edges);
+}
+
+bool
+heap_snapshot_write(wasm_exec_env_t exec_env, const char *path)
+{
+    HeapSnapshot snapshot;
+    uint32_t i, object_end;
+    bool ret = false;
+
+    memset(&snapshot, 0, sizeof(HeapSnapshot));
+    snapshot.exec_env = exec_env;
+    snapshot.module_inst = wasm_runtime_get_module_inst(exec_env);
+    snapshot.module = wasm_runtime_get_module(snapshot.module_inst);
+    snapshot.dyn_ctx = dyntype_get_context();
+
+    if (!(snapshot.node_map = bh_hash_map_create(
+              SNAPSHOT_MAP_INIT_SIZE, false, ref_hash, ref_equal, NULL, NULL))
+        || !(snapshot.string_map =
+                 bh_hash_map_create(SNAPSHOT_MAP_INIT_SIZE, false, string_hash,
+                                    string_equal, NULL, NULL))) {
+        goto fail;
+    }
+
+    /* the empty string names the root, and whatever failed to be named */
+    add_string(&snapshot, "");
+    add_node(&snapshot, NULL, NODE_SYNTHETIC, 0, 0);
+    add_node(&snapshot, NULL, NODE_SYNTHETIC, add_string(&snapshot, "(Globals)"),
+             0);
+    add_node(&snapshot, NULL, NODE_SYNTHETIC, add_string(&snapshot, "(Tables)"),
+             0);
+    add_node(&snapshot, NULL, NODE_SYNTHETIC,
+             add_string(&snapshot, "(Other roots)"), 0);
+
+    if (!wamr_utils_traverse_gc_heap(snapshot.module_inst, true,
+                                     visit_heap_obj, &snapshot)
+        || snapshot.oom) {
+        goto fail;
+    }
+    /* the dynamic values are appended while adding the edges */
+    object_end = snapshot.node_count;
+
+    for (i = ROOT_NODE_COUNT; i < object_end; i++) {
+        describe_object(&snapshot, &snapshot.nodes[i]);
+    }
+    for (i = ROOT_NODE_COUNT; i < object_end; i++) {
+        add_object_edges(&snapshot, i);
+    }
+    add_roots(&snapshot, object_end);
+
+    if (!snapshot.oom) {
+        ret = write_snapshot(&snapshot, path);
+    }
+
+fail:
+    heap_snapshot_destroy(&snapshot);
+    return ret;
+}
+
+static void
+heap_snapshot_signal_handler(int sig)
+{
+    (void)sig;
+    atomic_fetch_add(&snapshot_requests, 1);
+}
+
+bool
+heap_snapshot_handle_signal(void)
+{
+    struct sigaction action;
+
+    /* the requests before are not for the calling thread */
+    snapshot_requests_seen = atomic_load(&snapshot_requests);
+    snapshot_requests_seen_valid = true;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = heap_snapshot_signal_handler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    return sigaction(SIGUSR2, &action, NULL) == 0;
+}
+
+void
+heap_snapshot_poll(wasm_exec_env_t exec_env)
+{
+    unsigned requests = atomic_load(&snapshot_requests);
+    char path[SNAPSHOT_PATH_MAX_LEN];
+
+    /* a thread started after a request doesn't answer it */
+    if (!snapshot_requests_seen_valid) {
+        snapshot_requests_seen = requests;
+        snapshot_requests_seen_valid = true;
+        return;
+    }
+    if (requests == snapshot_requests_seen) {
+        return;
+    }
+    snapshot_requests_seen = requests;
+
+    snprintf(path, sizeof(path), "heap-%d-%u.heapsnapshot", (int)getpid(),
+             atomic_fetch_add(&snapshot_seq, 1) + 1);
+    if (!heap_snapshot_write(exec_env, path)) {
+        fprintf(stderr, "Write heap snapshot %s failed.\n", path);
+    }
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef __HEAP_SNAPSHOT_H_
+#define __HEAP_SNAPSHOT_H_
+
+#include "wasm_export.h"
+
+/**
+ * @brief Write a snapshot of the GC heap of the instance running on exec_env
+ * in the .heapsnapshot format of Chrome DevTools
+ *
+ * The garbage is collected first. Every wasm object is a node with its size
+ * and references, named after its TS class when its Meta holds the name.
+ * The dynamic values boxed in the heap are nodes too, an extref among them
+ * refers to the static object held by the extref table. The globals and the
+ * table are the roots, objects only held by the wasm stack are linked to a
+ * root of their own.
+ *
+ * @param exec_env the execution environment, must be on the calling thread
+ * @param path the file to write
+ * @return true if success, false otherwise
+ */
+bool
+heap_snapshot_write(wasm_exec_env_t exec_env, const char *path);
+
+/**
+ * @brief Request a snapshot of every thread running an event loop on
+ * SIGUSR2, see heap_snapshot_poll
+ *
+ * @return true if success, false otherwise
+ */
+bool
+heap_snapshot_handle_signal(void);
+
+/**
+ * @brief Write the snapshot requested with SIGUSR2 since the last call on
+ * the calling thread, to heap-<pid>-<seq>.heapsnapshot of the current
+ * directory. To be called at the safe points of the event loop, when no
+ * wasm code runs on exec_env.
+ */
+void
+heap_snapshot_poll(wasm_exec_env_t exec_env);
+
+#endif /* end of __HEAP_SNAPSHOT_H_ */
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* Instances can't be rewound to their post-start state in place: the GC
+ * heap, the globals and the extref table reference objects of the dyntype
+ * context and host resources such as timers, so restoring a copy of them
+ * would leave dangling references. A used instance is dropped as a whole
+ * instead, which is cheap, and the pool keeps instances initialized ahead of
+ * time so that a request never pays for instantiation and _entry. */
+
+#include "bh_platform.h"
+#include "instance_pool.h"
+#include "libdyntype_export.h"
+#include "sampling_profiler.h"
+
+extern void
+timer_events_destroy(void);
+
+extern void
+worker_events_destroy(void);
+
+struct InstancePool {
+    wasm_module_t module;
+    uint32_t stack_size;
+    uint32_t heap_size;
+    instance_pool_drain_func_t drain_tasks;
+    /* ready instances, used as a stack */
+    PooledInstance **ready;
+    uint32_t ready_count;
+    uint32_t pool_size;
+};
+
+/* bound_ctx is left bound to the thread afterwards */
+static void
+pooled_instance_free(PooledInstance *instance, dyn_ctx_t bound_ctx)
+{
+    /* finalizers of the GC heap release values of the instance context */
+    dyntype_context_bind(instance->dyn_ctx);
+    /* pending timers and workers hold slots of the extref table of the
+     * instance */
+    worker_events_destroy();
+    timer_events_destroy();
+    if (instance->module_inst) {
+        wasm_runtime_deinstantiate(instance->module_inst);
+    }
+    /* unbound first, so destroying it leaves the thread state alone */
+    dyntype_context_bind(bound_ctx);
+    if (instance->dyn_ctx) {
+        dyntype_context_destroy(instance->dyn_ctx);
+    }
+    wasm_runtime_free(instance);
+}
+
+static PooledInstance *
+pooled_instance_new(InstancePool *pool, char *error_buf,
+                    uint32_t error_buf_size)
+{
+    PooledInstance *instance;
+    wasm_function_inst_t start_func;
+    dyn_ctx_t bound_ctx = dyntype_get_context();
+    wasm_exec_env_t sampled_exec_env;
+    const char *exception;
+
+    if (!(instance = wasm_runtime_malloc(sizeof(PooledInstance)))) {
+        snprintf(error_buf, error_buf_size, "allocate memory failed");
+        return NULL;
+    }
+    memset(instance, 0, sizeof(PooledInstance));
+
+    if (!(instance->dyn_ctx = dyntype_context_create())) {
+        snprintf(error_buf, error_buf_size, "create dyntype context failed");
+        goto fail;
+    }
+    /* _entry creates the dynamic objects of the instance in its context */
+    dyntype_context_bind(instance->dyn_ctx);
+
+    if (!(instance->module_inst =
+              wasm_runtime_instantiate(pool->module, pool->stack_size,
+                                       pool->heap_size, error_buf,
+                                       error_buf_size))) {
+        goto fail;
+    }
+
+    if (!(instance->exec_env =
+              wasm_runtime_get_exec_env_singleton(instance->module_inst))) {
+        snprintf(error_buf, error_buf_size, "%s",
+                 wasm_runtime_get_exception(instance->module_inst));
+        goto fail;
+    }
+
+    if (!(start_func =
+              wasm_runtime_lookup_function(instance->module_inst, "_entry"))) {
+        snprintf(error_buf, error_buf_size,
+                 "Missing '_entry' function in wasm module");
+        goto fail;
+    }
+    /* _entry is sampled as the code of the instance, not of the host */
+    sampled_exec_env = sampling_profiler_attach(instance->exec_env);
+    if (!wasm_runtime_call_wasm(instance->exec_env, start_func, 0, NULL)) {
+        sampling_profiler_attach(sampled_exec_env);
+        snprintf(error_buf, error_buf_size, "%s",
+                 wasm_runtime_get_exception(instance->module_inst));
+        goto fail;
+    }
+    pool->drain_tasks(instance->exec_env, instance->dyn_ctx);
+    sampling_profiler_attach(sampled_exec_env);
+    if ((exception = wasm_runtime_get_exception(instance->module_inst))) {
+        snprintf(error_buf, error_buf_size, "%s", exception);
+        goto fail;
+    }
+
+    dyntype_context_bind(bound_ctx);
+    return instance;
+
+fail:
+    pooled_instance_free(instance, bound_ctx);
+    return NULL;
+}
+
+InstancePool *
+instance_pool_create(wasm_module_t module, uint32_t stack_size,
+                     uint32_t heap_size, uint32_t pool_size,
+                     instance_pool_drain_func_t drain_tasks)
+{
+    InstancePool *pool;
+
+    if (!(pool = wasm_runtime_malloc(sizeof(InstancePool)))) {
+        return NULL;
+    }
+    memset(pool, 0, sizeof(InstancePool));
+
+    if (pool_size > 0
+        && !(pool->ready =
+                 wasm_runtime_malloc(sizeof(PooledInstance *) * pool_size))) {
+        wasm_runtime_free(pool);
+        return NULL;
+    }
+
+    pool->module = module;
+    pool->stack_size = stack_size;
+    pool->heap_size = heap_size;
+    pool->pool_size = pool_size;
+    pool->drain_tasks = drain_tasks;
+    return pool;
+}
+
+void
+instance_pool_destroy(InstancePool *pool)
+{
+    dyn_ctx_t bound_ctx = dyntype_get_context();
+
+    while (pool->ready_count > 0) {
+        pooled_instance_free(pool->ready[--pool->ready_count], bound_ctx);
+    }
+    if (pool->ready) {
+        wasm_runtime_free(pool->ready);
+    }
+    wasm_runtime_free(pool);
+}
+
+PooledInstance *
+instance_pool_acquire(InstancePool *pool, char *error_buf,
+                      uint32_t error_buf_size)
+{
+    PooledInstance *instance;
+
+    if (pool->ready_count > 0) {
+        instance = pool->ready[--pool->ready_count];
+    }
+    else if (!(instance =
+                   pooled_instance_new(pool, error_buf, error_buf_size))) {
+        return NULL;
+    }
+
+    dyntype_context_bind(instance->dyn_ctx);
+    return instance;
+}
+
+void
+instance_pool_release(InstancePool *pool, PooledInstance *instance)
+{
+    dyn_ctx_t bound_ctx = dyntype_get_context();
+
+    (void)pool;
+    pooled_instance_free(instance,
+                         bound_ctx == instance->dyn_ctx ? NULL : bound_ctx);
+}
+
+bool
+instance_pool_prewarm(InstancePool *pool, char *error_buf,
+                      uint32_t error_buf_size)
+{
+    PooledInstance *instance;
+
+    if (instance_pool_is_full(pool)) {
+        return false;
+    }
+    if (!(instance = pooled_instance_new(pool, error_buf, error_buf_size))) {
+        return false;
+    }
+
+    pool->ready[pool->ready_count++] = instance;
+    return true;
+}
+
+bool
+instance_pool_is_full(InstancePool *pool)
+{
+    return pool->ready_count >= pool->pool_size;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef __INSTANCE_POOL_H_
+#define __INSTANCE_POOL_H_
+
+#include "wasm_export.h"
+#include "libdyntype.h"
+
+/* A module instance in the state right after _entry, with its own exec env
+ * and dyntype context */
+typedef struct PooledInstance {
+    wasm_module_inst_t module_inst;
+    wasm_exec_env_t exec_env;
+    dyn_ctx_t dyn_ctx;
+} PooledInstance;
+
+/* Runs the micro tasks and timers queued by _entry */
+typedef void (*instance_pool_drain_func_t)(wasm_exec_env_t exec_env,
+                                           dyn_ctx_t ctx);
+
+typedef struct InstancePool InstancePool;
+
+/**
+ * @brief Create a pool keeping up to pool_size initialized instances of the
+ * module, the pool starts empty, see instance_pool_prewarm
+ *
+ * @note the pool and its instances belong to the calling thread, the same as
+ * the dyntype context and the timers
+ *
+ * @param module the loaded module
+ * @param stack_size the stack size of the instances
+ * @param heap_size the app heap size of the instances
+ * @param pool_size the number of ready instances to keep
+ * @param drain_tasks runs the tasks queued by _entry of a new instance
+ * @return the pool if success, NULL otherwise
+ */
+InstancePool *
+instance_pool_create(wasm_module_t module, uint32_t stack_size,
+                     uint32_t heap_size, uint32_t pool_size,
+                     instance_pool_drain_func_t drain_tasks);
+
+/**
+ * @brief Destroy the pool and the ready instances it keeps, acquired
+ * instances must have been released before
+ *
+ * @param pool the pool to destroy
+ */
+void
+instance_pool_destroy(InstancePool *pool);
+
+/**
+ * @brief Take a ready instance out of the pool, or create one if the pool is
+ * empty, and bind its dyntype context to the calling thread
+ *
+ * @param pool the pool
+ * @param error_buf buffer for the error message
+ * @param error_buf_size size of error_buf
+ * @return the instance if success, NULL otherwise
+ */
+PooledInstance *
+instance_pool_acquire(InstancePool *pool, char *error_buf,
+                      uint32_t error_buf_size);
+
+/**
+ * @brief Retire an acquired instance: drop its timers, its GC heap together
+ * with the globals and the extref table, and its dyntype context. It's never
+ * handed out again, instance_pool_prewarm replaces it with a fresh one.
+ *
+ * @param pool the pool
+ * @param instance the instance returned by instance_pool_acquire
+ */
+void
+instance_pool_release(InstancePool *pool, PooledInstance *instance);
+
+/**
+ * @brief Initialize one more ready instance, the host calls it after each
+ * release, once the response of the request is out, so that acquiring
+ * doesn't pay the instantiation
+ *
+ * @param pool the pool
+ * @param error_buf buffer for the error message
+ * @param error_buf_size size of error_buf
+ * @return true if an instance was added, false if the pool is full or the
+ * instance failed to initialize
+ */
+bool
+instance_pool_prewarm(InstancePool *pool, char *error_buf,
+                      uint32_t error_buf_size);
+
+/**
+ * @brief Check whether the pool keeps pool_size ready instances
+ *
+ * @param pool the pool
+ * @return true if the pool is full
+ */
+bool
+instance_pool_is_full(InstancePool *pool);
+
+#endif /* end of __INSTANCE_POOL_H_ */
@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "bh_platform.h"
+#include "bh_read_file.h"
+#include "wasm_export.h"
+#include "module_file.h"
+
+#define FNV64_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV64_PRIME 0x100000001b3ULL
+#define AOT_CACHE_TMP_PATH_SIZE 512
+
+/* features the artifact is compiled for */
+static const char *aot_cache_features =
+#if WASM_ENABLE_GC != 0
+    "gc;"
+#endif
+#if WASM_ENABLE_STRINGREF != 0
+    "stringref;"
+#endif
+    "";
+
+bool
+module_file_open(const char *path, ModuleFile *file)
+{
+    struct stat st;
+    void *buf;
+    int fd;
+
+    memset(file, 0, sizeof(ModuleFile));
+
+    if ((fd = open(path, O_RDONLY)) >= 0) {
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0
+            && (uint64_t)st.st_size <= UINT32_MAX) {
+            buf = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE, fd, 0);
+            if (buf != MAP_FAILED) {
+                file->buf = (uint8_t *)buf;
+                file->size = (uint32_t)st.st_size;
+                file->mapped = true;
+            }
+        }
+        close(fd);
+        if (file->mapped) {
+            return true;
+        }
+    }
+
+    /* e.g. a pipe, or a file that doesn't exist, reported by the reader */
+    file->buf = (uint8_t *)bh_read_file_to_buffer(path, &file->size);
+    return file->buf != NULL;
+}
+
+void
+module_file_close(ModuleFile *file)
+{
+    if (file->buf) {
+        if (file->mapped) {
+            munmap(file->buf, file->size);
+        }
+        else {
+            wasm_runtime_free(file->buf);
+        }
+    }
+    memset(file, 0, sizeof(ModuleFile));
+}
+
+bool
+module_file_is_wasm(const ModuleFile *file)
+{
+    return file->size >= 4 && memcmp(file->buf, "\0asm", 4) == 0;
+}
+
+static uint64_t
+fnv1a_64(uint64_t hash, const uint8_t *data, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= FNV64_PRIME;
+    }
+    return hash;
+}
+
+bool
+module_file_aot_cache_path(const char *cache_dir, const char *compiler,
+                           const ModuleFile *file, char *path_buf,
+                           uint32_t path_buf_size)
+{
+    char config[256];
+    uint32_t major, minor, patch;
+    uint64_t module_hash, config_hash;
+    int len;
+
+    if (mkdir(cache_dir, 0755) != 0 && errno != EEXIST) {
+        return false;
+    }
+
+    wasm_runtime_get_version(&major, &minor, &patch);
+    snprintf(config, sizeof(config),
+             "wamr %" PRIu32 ".%" PRIu32 ".%" PRIu32 ";%sptr %u;%s", major,
+             minor, patch, aot_cache_features, (unsigned)sizeof(void *),
+             compiler);
+
+    module_hash = fnv1a_64(FNV64_OFFSET_BASIS, file->buf, file->size);
+    config_hash = fnv1a_64(FNV64_OFFSET_BASIS, (const uint8_t *)config,
+                           strlen(config));
+
+    len = snprintf(path_buf, path_buf_size,
+                   "%s/%016" PRIx64 "-%08" PRIx32 "-%016" PRIx64 ".aot",
+                   cache_dir, module_hash, file->size, config_hash);
+    return len > 0 && (uint32_t)len < path_buf_size;
+}
+
+static void
+aot_compile_and_publish(const char *compiler, const char *wasm_path,
+                        const char *aot_path, const char *tmp_path)
+{
+    pid_t pid;
+    int status, fd;
+
+    /* the compiler must not write over the output of the host */
+    if ((fd = open("/dev/null", O_RDWR)) >= 0) {
+        dup2(fd, STDIN_FILENO);
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+    }
+
+    if ((pid = fork()) < 0) {
+        return;
+    }
+    if (pid == 0) {
+#if WASM_ENABLE_GC != 0
+        execlp(compiler, compiler, "--enable-gc", "-o", tmp_path, wasm_path,
+               (char *)NULL);
+#else
+        execlp(compiler, compiler, "-o", tmp_path, wasm_path, (char *)NULL);
+#endif
+        _exit(127);
+    }
+
+    if (waitpid(pid, &status, 0) == pid && WIFEXITED(status)
+        && WEXITSTATUS(status) == 0) {
+        /* atomic, a concurrent run sees either nothing or the whole file */
+        if (rename(tmp_path, aot_path) == 0) {
+            return;
+        }
+    }
+    unlink(tmp_path);
+}
+
+bool
+module_file_aot_compile(const char *compiler, const char *wasm_path,
+                        const char *aot_path)
+{
+    char tmp_path[AOT_CACHE_TMP_PATH_SIZE];
+    pid_t pid;
+    int len, status;
+
+    len = snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", aot_path,
+                   (int)getpid());
+    if (len < 0 || (size_t)len >= sizeof(tmp_path)) {
+        return false;
+    }
+
+    /* stdio buffers are copied by fork, the children leave with _exit so
+     * that they are never flushed twice */
+    if ((pid = fork()) < 0) {
+        return false;
+    }
+    if (pid == 0) {
+        /* detach, the compiler may outlive the host */
+        setsid();
+        if ((pid = fork()) != 0) {
+            _exit(pid < 0 ? 1 : 0);
+        }
+        aot_compile_and_publish(compiler, wasm_path, aot_path, tmp_path);
+        _exit(0);
+    }
+
+    return waitpid(pid, &status, 0) == pid && WIFEXITED(status)
+           && WEXITSTATUS(status) == 0;
+}
+
+static bool
+read_leb_u32(const uint8_t **p_buf, const uint8_t *buf_end, uint32_t *p_value)
+{
+    const uint8_t *p = *p_buf;
+    uint32_t value = 0, shift = 0;
+    uint8_t byte;
+
+    do {
+        if (p >= buf_end || shift > 28) {
+            return false;
+        }
+        byte = *p++;
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    *p_buf = p;
+    *p_value = value;
+    return true;
+}
+
+static bool
+func_names_set(ModuleFuncNames *names, uint32_t func_index, const uint8_t *name,
+               uint32_t name_len)
+{
+    char **new_names, *str;
+    uint32_t new_count;
+
+    if (func_index >= names->count) {
+        new_count = names->count ? names->count : 64;
+        while (new_count <= func_index) {
+            new_count *= 2;
+        }
+        if (!(new_names = realloc(names->names, sizeof(char *) * new_count))) {
+            return false;
+        }
+        memset(new_names + names->count, 0,
+               sizeof(char *) * (new_count - names->count));
+        names->names = new_names;
+        names->count = new_count;
+    }
+    if (!(str = malloc(name_len + 1))) {
+        return false;
+    }
+    memcpy(str, name, name_len);
+    str[name_len] = '\0';
+    free(names->names[func_index]);
+    names->names[func_index] = str;
+    return true;
+}
+
+/* The subsections of the name section, only the function names are read */
+static bool
+read_name_section(const uint8_t *p, const uint8_t *p_end,
+                  ModuleFuncNames *names)
+{
+    const uint8_t *sub_end;
+    uint32_t sub_size, count, func_index, name_len, i;
+    uint8_t sub_id;
+
+    while (p < p_end) {
+        sub_id = *p++;
+        if (!read_leb_u32(&p, p_end, &sub_size)
+            || sub_size > (uint32_t)(p_end - p)) {
+            return false;
+        }
+        sub_end = p + sub_size;
+
+        if (sub_id == 1) {
+            if (!read_leb_u32(&p, sub_end, &count)) {
+                return false;
+            }
+            for (i = 0; i < count; i++) {
+                if (!read_leb_u32(&p, sub_end, &func_index)
+                    || !read_leb_u32(&p, sub_end, &name_len)
+                    || name_len > (uint32_t)(sub_end - p)
+                    /* more functions than a module can have */
+                    || func_index >= (1 << 24)
+                    || !func_names_set(names, func_index, p, name_len)) {
+                    return false;
+                }
+                p += name_len;
+            }
+        }
+        p = sub_end;
+    }
+    return true;
+}
+
+bool
+module_file_read_func_names(const ModuleFile *file, ModuleFuncNames *names)
+{
+    const uint8_t *p, *p_end, *section_end;
+    uint32_t section_size, name_len;
+    uint8_t section_id;
+
+    memset(names, 0, sizeof(ModuleFuncNames));
+    /* the magic and the version */
+    if (!module_file_is_wasm(file) || file->size < 8) {
+        return false;
+    }
+    p = file->buf + 8;
+    p_end = file->buf + file->size;
+
+    while (p < p_end) {
+        section_id = *p++;
+        if (!read_leb_u32(&p, p_end, &section_size)
+            || section_size > (uint32_t)(p_end - p)) {
+            goto fail;
+        }
+        section_end = p + section_size;
+
+        if (section_id == 0) {
+            if (!read_leb_u32(&p, section_end, &name_len)
+                || name_len > (uint32_t)(section_end - p)) {
+                goto fail;
+            }
+            if (name_len == 4 && memcmp(p, "name", 4) == 0
+                && !read_name_section(p + 4, section_end, names)) {
+                goto fail;
+            }
+        }
+        p = section_end;
+    }
+    return true;
+
+fail:
+    module_func_names_destroy(names);
+    return false;
+}
+
+const char *
+module_func_names_get(const ModuleFuncNames *names, uint32_t func_index)
+{
+    return func_index < names->count ? names->names[func_index] : NULL;
+}
+
+void
+module_func_names_destroy(ModuleFuncNames *names)
+{
+    uint32_t i;
+
+    for (i = 0; i < names->count; i++) {
+        free(names->names[i]);
+    }
+    free(names->names);
+    memset(names, 0, sizeof(ModuleFuncNames));
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef __MODULE_FILE_H_
+#define __MODULE_FILE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* The bytes of a module file, wasm_runtime_load requires them to stay
+ * writable and alive until the module is unloaded */
+typedef struct ModuleFile {
+    uint8_t *buf;
+    uint32_t size;
+    /* mapped copy-on-write rather than read into a heap buffer */
+    bool mapped;
+} ModuleFile;
+
+/**
+ * @brief Map the module file privately, the pages are read on demand and only
+ * copied when the loader writes them. Files that can't be mapped are read.
+ *
+ * @param path the file path
+ * @param file receives the file content
+ * @return true if success, false otherwise
+ */
+bool
+module_file_open(const char *path, ModuleFile *file);
+
+/**
+ * @brief Release the content of a module file
+ *
+ * @param file the file opened by module_file_open
+ */
+void
+module_file_close(ModuleFile *file);
+
+/**
+ * @brief Check whether the content is a wasm binary (not an AOT file)
+ *
+ * @param file the opened file
+ * @return true if the file starts with the wasm magic
+ */
+bool
+module_file_is_wasm(const ModuleFile *file);
+
+/**
+ * @brief Get the path of the AOT artifact cached for the wasm bytes. The
+ * name is a hash of the bytes and of the runtime configuration, so a module
+ * compiled for another runtime version or by another compiler isn't reused.
+ * The cache directory is created when missing.
+ *
+ * @param cache_dir the cache directory
+ * @param compiler the AOT compiler command, part of the configuration
+ * @param file the wasm file
+ * @param path_buf receives the path of the artifact
+ * @param path_buf_size size of path_buf
+ * @return true if success, false if the directory can't be used
+ */
+bool
+module_file_aot_cache_path(const char *cache_dir, const char *compiler,
+                           const ModuleFile *file, char *path_buf,
+                           uint32_t path_buf_size);
+
+/**
+ * @brief Compile the wasm file into the AOT artifact in a detached process,
+ * the artifact is renamed into place once complete so a concurrent run never
+ * sees a partial file. Errors of the compiler are ignored, the module simply
+ * keeps being interpreted.
+ *
+ * @param compiler the AOT compiler command, e.g. wamrc
+ * @param wasm_path the wasm file
+ * @param aot_path the path returned by module_file_aot_cache_path
+ * @return true if the compilation was started
+ */
+bool
+module_file_aot_compile(const char *compiler, const char *wasm_path,
+                        const char *aot_path);
+
+/* The function names of a wasm module, read from its name section */
+typedef struct ModuleFuncNames {
+    /* indexed by function index, NULL for the functions without name */
+    char **names;
+    uint32_t count;
+} ModuleFuncNames;
+
+/**
+ * @brief Read the function names of the name section of a wasm file
+ *
+ * @param file the opened file
+ * @param names receives the names, free them with module_func_names_destroy
+ * @return true if success, false if the file is not wasm, is malformed or
+ * out of memory. A module without name section has no names.
+ */
+bool
+module_file_read_func_names(const ModuleFile *file, ModuleFuncNames *names);
+
+/**
+ * @brief Get the name of a function
+ *
+ * @return the name, NULL if the function has none
+ */
+const char *
+module_func_names_get(const ModuleFuncNames *names, uint32_t func_index);
+
+void
+module_func_names_destroy(ModuleFuncNames *names);
+
+#endif /* end of __MODULE_FILE_H_ */
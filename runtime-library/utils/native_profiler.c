@@ -0,0 +1,405 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* A profiled native is registered as a raw native whose attachment is its
+ * ProfiledNative: the runtime passes the arguments in 64-bit slots, with app
+ * addresses already converted as the signature says, and the wrapper calls
+ * the original function with them through the runtime's native invoker. */
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bh_platform.h"
+#include "native_profiler.h"
+#include "wamr_utils.h"
+
+/* natives with more params are registered without profiling */
+#define PROFILED_NATIVE_MAX_PARAMS 16
+
+typedef struct ProfiledNative {
+    const char *module_name;
+    const char *name;
+    void *func_ptr;
+    void *attachment;
+    void *func_type;
+    uint32_t param_count;
+    uint32_t cell_num;
+    wasm_valkind_t param_types[PROFILED_NATIVE_MAX_PARAMS];
+    bool has_result;
+    wasm_valkind_t result_type;
+    atomic_uint_fast64_t calls;
+    atomic_uint_fast64_t total_ns;
+    /* the total time minus the time of the natives called from this one */
+    atomic_uint_fast64_t self_ns;
+} ProfiledNative;
+
+typedef struct ProfiledTable {
+    struct ProfiledTable *next;
+    ProfiledNative *natives;
+    uint32_t native_count;
+    NativeSymbol *raw_symbols;
+    /* the natives that can't be wrapped */
+    NativeSymbol *plain_symbols;
+} ProfiledTable;
+
+/* a native being called on the thread */
+typedef struct ProfileFrame {
+    struct ProfileFrame *parent;
+    uint64_t child_ns;
+} ProfileFrame;
+
+static bool profiler_enabled = false;
+static ProfiledTable *profiled_tables = NULL;
+static os_thread_local_attribute ProfileFrame *current_frame = NULL;
+
+static FILE *trace_out = NULL;
+static korp_mutex trace_lock;
+static uint64_t trace_threshold_ns;
+static uint64_t trace_start_ns;
+static bool trace_has_event = false;
+static uint32_t trace_tid_count = 0;
+static os_thread_local_attribute uint32_t trace_tid = 0;
+
+static uint64_t
+monotonic_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static wasm_valkind_t
+pointer_kind(void)
+{
+    return sizeof(void *) == sizeof(uint64_t) ? WASM_I64 : WASM_I32;
+}
+
+static uint32_t
+kind_cell_num(wasm_valkind_t kind)
+{
+    return kind == WASM_I64 || kind == WASM_F64 ? 2 : 1;
+}
+
+static uint32_t
+kind_size(wasm_valkind_t kind)
+{
+    return kind_cell_num(kind) * sizeof(uint32_t);
+}
+
+/* Get the kinds of the arguments as the original native receives them:
+ * app addresses and references are native pointers */
+static bool
+parse_signature(const char *signature, ProfiledNative *native)
+{
+    const char *p = signature;
+    wasm_valkind_t kind;
+
+    if (!p || *p++ != '(') {
+        return false;
+    }
+    for (; *p && *p != ')'; p++) {
+        switch (*p) {
+            case 'i':
+            case '~':
+                kind = WASM_I32;
+                break;
+            case 'I':
+                kind = WASM_I64;
+                break;
+            case 'f':
+                kind = WASM_F32;
+                break;
+            case 'F':
+                kind = WASM_F64;
+                break;
+            case '*':
+            case '$':
+            case 'r':
+                kind = pointer_kind();
+                break;
+            default:
+                return false;
+        }
+        if (native->param_count == PROFILED_NATIVE_MAX_PARAMS) {
+            return false;
+        }
+        native->param_types[native->param_count++] = kind;
+        native->cell_num += kind_cell_num(kind);
+    }
+    if (*p++ != ')') {
+        return false;
+    }
+
+    switch (*p) {
+        case '\0':
+            return true;
+        case 'i':
+            native->result_type = WASM_I32;
+            break;
+        case 'I':
+            native->result_type = WASM_I64;
+            break;
+        case 'f':
+            native->result_type = WASM_F32;
+            break;
+        case 'F':
+            native->result_type = WASM_F64;
+            break;
+        case 'r':
+            native->result_type = pointer_kind();
+            break;
+        default:
+            return false;
+    }
+    native->has_result = true;
+    return p[1] == '\0';
+}
+
+static void
+trace_event(ProfiledNative *native, uint64_t start_ns, uint64_t elapsed_ns)
+{
+    os_mutex_lock(&trace_lock);
+    if (trace_tid == 0) {
+        trace_tid = ++trace_tid_count;
+    }
+    fprintf(trace_out,
+            "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,"
+            "\"dur\":%.3f,\"pid\":%d,\"tid\":%" PRIu32 "}",
+            trace_has_event ? ",\n" : "", native->name, native->module_name,
+            (double)(start_ns - trace_start_ns) / 1000,
+            (double)elapsed_ns / 1000, (int)getpid(), trace_tid);
+    trace_has_event = true;
+    os_mutex_unlock(&trace_lock);
+}
+
+static void
+profiled_native_raw(wasm_exec_env_t exec_env, uint64_t *args)
+{
+    ProfiledNative *native = wasm_runtime_get_function_attachment(exec_env);
+    uint32_t argv[PROFILED_NATIVE_MAX_PARAMS * 2], ret[2] = { 0 };
+    uint32_t argc = 0, i;
+    ProfileFrame frame;
+    uint64_t start_ns, elapsed_ns;
+    bool ok;
+
+    /* each argument is at the start of its slot */
+    for (i = 0; i < native->param_count; i++) {
+        memcpy(argv + argc, args + i, kind_size(native->param_types[i]));
+        argc += kind_cell_num(native->param_types[i]);
+    }
+
+    frame.parent = current_frame;
+    frame.child_ns = 0;
+    current_frame = &frame;
+
+    start_ns = monotonic_now_ns();
+    ok = wamr_utils_invoke_native(exec_env, native->func_ptr,
+                                  native->func_type, native->attachment, argv,
+                                  argc, ret);
+    elapsed_ns = monotonic_now_ns() - start_ns;
+
+    current_frame = frame.parent;
+    if (frame.parent) {
+        frame.parent->child_ns += elapsed_ns;
+    }
+
+    atomic_fetch_add_explicit(&native->calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&native->total_ns, elapsed_ns,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&native->self_ns, elapsed_ns - frame.child_ns,
+                              memory_order_relaxed);
+    if (trace_out && elapsed_ns >= trace_threshold_ns) {
+        trace_event(native, start_ns, elapsed_ns);
+    }
+
+    if (ok && native->has_result) {
+        memcpy(args, ret, kind_size(native->result_type));
+    }
+}
+
+bool
+native_profiler_init(const char *trace_file, uint32_t trace_threshold)
+{
+    if (trace_file) {
+        if (os_mutex_init(&trace_lock) != BHT_OK) {
+            return false;
+        }
+        if (!(trace_out = fopen(trace_file, "w"))) {
+            os_mutex_destroy(&trace_lock);
+            return false;
+        }
+        fprintf(trace_out, "{\"traceEvents\":[\n");
+        trace_threshold_ns = (uint64_t)trace_threshold * 1000;
+        trace_start_ns = monotonic_now_ns();
+    }
+    profiler_enabled = true;
+    return true;
+}
+
+static void
+profiled_table_free(ProfiledTable *table)
+{
+    uint32_t i;
+
+    if (table->natives) {
+        for (i = 0; i < table->native_count; i++) {
+            if (table->natives[i].func_type) {
+                wamr_utils_func_type_free(table->natives[i].func_type);
+            }
+        }
+    }
+    free(table->natives);
+    free(table->raw_symbols);
+    free(table->plain_symbols);
+    free(table);
+}
+
+bool
+native_profiler_register_natives(const char *module_name,
+                                 NativeSymbol *native_symbols,
+                                 uint32_t n_native_symbols)
+{
+    ProfiledTable *table;
+    uint32_t raw_count = 0, plain_count = 0, i;
+
+    if (!profiler_enabled) {
+        return wasm_runtime_register_natives(module_name, native_symbols,
+                                             n_native_symbols);
+    }
+
+    if (!(table = calloc(1, sizeof(ProfiledTable)))
+        || !(table->natives = calloc(n_native_symbols, sizeof(ProfiledNative)))
+        || !(table->raw_symbols = calloc(n_native_symbols, sizeof(NativeSymbol)))
+        || !(table->plain_symbols =
+                 calloc(n_native_symbols, sizeof(NativeSymbol)))) {
+        goto fail;
+    }
+
+    for (i = 0; i < n_native_symbols; i++) {
+        NativeSymbol *symbol = native_symbols + i;
+        ProfiledNative *native = table->natives + raw_count;
+
+        memset(native, 0, sizeof(ProfiledNative));
+        if (!parse_signature(symbol->signature, native)) {
+            table->plain_symbols[plain_count++] = *symbol;
+            continue;
+        }
+        if (!(native->func_type = wamr_utils_func_type_new(
+                  native->param_types, native->param_count,
+                  &native->result_type, native->has_result ? 1 : 0))) {
+            goto fail;
+        }
+        native->module_name = module_name;
+        native->name = symbol->symbol;
+        native->func_ptr = symbol->func_ptr;
+        native->attachment = symbol->attachment;
+
+        table->raw_symbols[raw_count].symbol = symbol->symbol;
+        table->raw_symbols[raw_count].func_ptr = profiled_native_raw;
+        table->raw_symbols[raw_count].signature = symbol->signature;
+        table->raw_symbols[raw_count].attachment = native;
+        table->native_count = ++raw_count;
+    }
+
+    if ((raw_count > 0
+         && !wasm_runtime_register_natives_raw(module_name, table->raw_symbols,
+                                               raw_count))
+        || (plain_count > 0
+            && !wasm_runtime_register_natives(
+                module_name, table->plain_symbols, plain_count))) {
+        /* kept, the runtime may refer to the raw symbols */
+        table->next = profiled_tables;
+        profiled_tables = table;
+        return false;
+    }
+
+    table->next = profiled_tables;
+    profiled_tables = table;
+    return true;
+
+fail:
+    if (table) {
+        profiled_table_free(table);
+    }
+    return false;
+}
+
+static int
+compare_self_time(const void *a, const void *b)
+{
+    uint64_t self_a = atomic_load(&(*(ProfiledNative **)a)->self_ns);
+    uint64_t self_b = atomic_load(&(*(ProfiledNative **)b)->self_ns);
+
+    return self_a < self_b ? 1 : self_a > self_b ? -1 : 0;
+}
+
+void
+native_profiler_dump(FILE *out)
+{
+    ProfiledTable *table;
+    ProfiledNative **natives;
+    uint64_t calls = 0, total_ns = 0;
+    uint32_t count = 0, i;
+
+    for (table = profiled_tables; table; table = table->next) {
+        count += table->native_count;
+    }
+    if (!(natives = malloc(sizeof(ProfiledNative *) * (count ? count : 1)))) {
+        fprintf(out, "natives: statistics not available\n");
+        return;
+    }
+
+    count = 0;
+    for (table = profiled_tables; table; table = table->next) {
+        for (i = 0; i < table->native_count; i++) {
+            ProfiledNative *native = table->natives + i;
+
+            if (atomic_load(&native->calls) > 0) {
+                natives[count++] = native;
+                calls += atomic_load(&native->calls);
+                /* the self times add up to the time spent in natives */
+                total_ns += atomic_load(&native->self_ns);
+            }
+        }
+    }
+    qsort(natives, count, sizeof(ProfiledNative *), compare_self_time);
+
+    fprintf(out, "natives: %" PRIu64 " calls, %.3f ms\n", calls,
+            (double)total_ns / 1000000);
+    fprintf(out, "natives: %12s %12s %12s  %s\n", "calls", "total ms",
+            "self ms", "name");
+    for (i = 0; i < count; i++) {
+        fprintf(out, "natives: %12" PRIu64 " %12.3f %12.3f  %s.%s\n",
+                (uint64_t)atomic_load(&natives[i]->calls),
+                (double)atomic_load(&natives[i]->total_ns) / 1000000,
+                (double)atomic_load(&natives[i]->self_ns) / 1000000,
+                natives[i]->module_name, natives[i]->name);
+    }
+    free(natives);
+}
+
+void
+native_profiler_destroy(void)
+{
+    ProfiledTable *table;
+
+    while ((table = profiled_tables)) {
+        profiled_tables = table->next;
+        profiled_table_free(table);
+    }
+
+    if (trace_out) {
+        fprintf(trace_out, "\n]}\n");
+        fclose(trace_out);
+        trace_out = NULL;
+        os_mutex_destroy(&trace_lock);
+    }
+    profiler_enabled = false;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef __NATIVE_PROFILER_H_
+#define __NATIVE_PROFILER_H_
+
+#include <stdio.h>
+
+#include "wasm_export.h"
+
+/**
+ * @brief Enable the profiling of the natives registered afterwards
+ *
+ * Every profiled native counts its calls, the time spent in it, and its self
+ * time, which leaves out the natives it calls through wasm callbacks.
+ *
+ * @param trace_file if not NULL, a Chrome trace event file receiving a
+ * complete event per call lasting at least trace_threshold
+ * @param trace_threshold in us
+ * @return true if success, false otherwise
+ */
+bool
+native_profiler_init(const char *trace_file, uint32_t trace_threshold);
+
+/**
+ * @brief Register natives like wasm_runtime_register_natives, wrapped with
+ * the profiler when it is enabled
+ *
+ * The natives are registered as raw natives calling the original ones, the
+ * symbol table is kept registered until native_profiler_destroy.
+ */
+bool
+native_profiler_register_natives(const char *module_name,
+                                 NativeSymbol *native_symbols,
+                                 uint32_t n_native_symbols);
+
+/**
+ * @brief Print the natives called, by self time
+ */
+void
+native_profiler_dump(FILE *out);
+
+/**
+ * @brief Close the trace file and free the profiler, after the runtime is
+ * destroyed
+ */
+void
+native_profiler_destroy(void);
+
+#endif /* end of __NATIVE_PROFILER_H_ */
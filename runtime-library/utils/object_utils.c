@@ -8,6 +8,7 @@
 #endif
 
 #include "gc_object.h"
+#include "gc_telemetry.h"
 #include "libdyntype.h"
 #include "object_utils.h"
 #include "type_utils.h"
@@ -21,6 +22,7 @@ dynamic_object_finalizer(wasm_anyref_obj_t obj, void *data)
 {
     dyn_value_t value = (dyn_value_t)wasm_anyref_obj_get_value(obj);
     dyntype_release((dyn_ctx_t)data, value);
+    gc_telemetry_count_finalizer();
 }
 
 wasm_anyref_obj_t
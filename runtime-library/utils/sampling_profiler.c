@@ -0,0 +1,465 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* The SIGPROF handler copies the wasm frames of the interrupted thread into
+ * a ring of samples, claiming a slot the way the producers of the send
+ * queue of the app framework do: it can't allocate nor lock. A collector
+ * thread takes the samples every few ms, maps the frames to their source
+ * lines and counts the distinct stacks, which are written out at the end. */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "bh_platform.h"
+#include "module_file.h"
+#include "sampling_profiler.h"
+#include "source_map.h"
+#include "wamr_utils.h"
+
+/* deeper stacks are cut, keeping the innermost frames */
+#define SAMPLE_MAX_FRAMES 64
+/* must be a power of 2 */
+#define SAMPLE_RING_SIZE 256
+#define SAMPLE_COLLECT_INTERVAL_US 10000
+#define SAMPLE_RATE_MAX 10000
+
+#define FNV64_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV64_PRIME 0x100000001b3ULL
+
+typedef struct SampleFrame {
+    uint32_t func_index;
+    /* offset in the module buffer, UINT32_MAX if unknown */
+    uint32_t offset;
+} SampleFrame;
+
+typedef struct SampleSlot {
+    atomic_size_t seq;
+    uint32_t depth;
+    bool truncated;
+    /* innermost first */
+    SampleFrame frames[SAMPLE_MAX_FRAMES];
+} SampleSlot;
+
+typedef struct SampleRing {
+    SampleSlot slots[SAMPLE_RING_SIZE];
+    atomic_size_t tail;
+    /* only the collector uses it */
+    size_t head;
+    /* samples lost because the ring was full */
+    atomic_uint_fast64_t dropped;
+} SampleRing;
+
+/* A frame as written out */
+typedef struct StackFrame {
+    uint32_t func_index;
+    uint32_t line;
+    /* NULL if the frame has no source line */
+    const char *source;
+} StackFrame;
+
+typedef struct StackEntry {
+    uint64_t hash;
+    /* 0 for an empty entry */
+    uint64_t count;
+    uint32_t depth;
+    bool truncated;
+    StackFrame *frames;
+} StackEntry;
+
+typedef struct StackTable {
+    StackEntry *entries;
+    uint32_t capacity;
+    uint32_t count;
+} StackTable;
+
+/* the ring is static: a handler may still run on another thread while the
+ * profiler is destroyed */
+static SampleRing sample_ring;
+static const uint8_t *module_start = NULL;
+static const uint8_t *module_end = NULL;
+static os_thread_local_attribute wasm_exec_env_t sampled_exec_env = NULL;
+
+static bool profiler_enabled = false;
+static FILE *profile_out = NULL;
+static const char *profile_file = NULL;
+static korp_tid collector;
+static atomic_bool collector_stopping;
+static ModuleFuncNames func_names;
+static SourceMap source_map;
+static bool has_source_map = false;
+static StackTable stacks;
+static uint64_t sample_count = 0;
+
+static inline SampleSlot *
+ring_slot(SampleRing *ring, size_t pos)
+{
+    return &ring->slots[pos & (SAMPLE_RING_SIZE - 1)];
+}
+
+static uint32_t
+frame_offset(const uint8_t *ip)
+{
+    return ip && ip >= module_start && ip < module_end
+               ? (uint32_t)(ip - module_start)
+               : UINT32_MAX;
+}
+
+static void
+sigprof_handler(int sig)
+{
+    SampleRing *ring = &sample_ring;
+    WamrUtilsFrame frames[SAMPLE_MAX_FRAMES + 1];
+    wasm_exec_env_t exec_env = sampled_exec_env;
+    SampleSlot *slot;
+    uint32_t count = 0, i;
+    size_t pos, seq;
+    int saved_errno = errno;
+
+    (void)sig;
+
+    if (exec_env) {
+        count = wamr_utils_get_call_stack(exec_env, frames,
+                                          SAMPLE_MAX_FRAMES + 1);
+    }
+
+    pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    for (;;) {
+        slot = ring_slot(ring, pos);
+        seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq == pos) {
+            if (atomic_compare_exchange_weak_explicit(
+                    &ring->tail, &pos, pos + 1, memory_order_relaxed,
+                    memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if ((intptr_t)(seq - pos) < 0) {
+            /* the collector is a whole ring behind */
+            atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+            errno = saved_errno;
+            return;
+        }
+        else {
+            pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+    }
+
+    slot->truncated = count > SAMPLE_MAX_FRAMES;
+    slot->depth = slot->truncated ? SAMPLE_MAX_FRAMES : count;
+    for (i = 0; i < slot->depth; i++) {
+        slot->frames[i].func_index = frames[i].func_index;
+        slot->frames[i].offset = frame_offset(frames[i].ip);
+    }
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+
+    errno = saved_errno;
+}
+
+static uint64_t
+stack_hash(const StackFrame *frames, uint32_t depth, bool truncated)
+{
+    const uint8_t *p = (const uint8_t *)frames;
+    uint64_t hash = FNV64_OFFSET_BASIS ^ depth ^ ((uint64_t)truncated << 32);
+    size_t i;
+
+    for (i = 0; i < sizeof(StackFrame) * depth; i++) {
+        hash = (hash ^ p[i]) * FNV64_PRIME;
+    }
+    return hash;
+}
+
+static bool
+stack_table_grow(StackTable *table)
+{
+    StackEntry *entries, *entry;
+    uint32_t capacity = table->capacity ? table->capacity * 2 : 256, i;
+
+    if (!(entries = calloc(capacity, sizeof(StackEntry)))) {
+        return false;
+    }
+    for (i = 0; i < table->capacity; i++) {
+        if (table->entries[i].count == 0) {
+            continue;
+        }
+        entry = &entries[table->entries[i].hash & (capacity - 1)];
+        while (entry->count > 0) {
+            entry = entry + 1 < entries + capacity ? entry + 1 : entries;
+        }
+        *entry = table->entries[i];
+    }
+    free(table->entries);
+    table->entries = entries;
+    table->capacity = capacity;
+    return true;
+}
+
+static bool
+stack_table_add(StackTable *table, const StackFrame *frames, uint32_t depth,
+                bool truncated)
+{
+    uint64_t hash = stack_hash(frames, depth, truncated);
+    StackEntry *entry;
+
+    if ((table->count + 1) * 2 > table->capacity && !stack_table_grow(table)) {
+        return false;
+    }
+
+    entry = &table->entries[hash & (table->capacity - 1)];
+    while (entry->count > 0) {
+        if (entry->hash == hash && entry->depth == depth
+            && entry->truncated == truncated
+            && !memcmp(entry->frames, frames, sizeof(StackFrame) * depth)) {
+            entry->count++;
+            return true;
+        }
+        entry = entry + 1 < table->entries + table->capacity ? entry + 1
+                                                             : table->entries;
+    }
+
+    if (depth > 0 && !(entry->frames = malloc(sizeof(StackFrame) * depth))) {
+        return false;
+    }
+    if (depth > 0) {
+        memcpy(entry->frames, frames, sizeof(StackFrame) * depth);
+    }
+    entry->hash = hash;
+    entry->count = 1;
+    entry->depth = depth;
+    entry->truncated = truncated;
+    table->count++;
+    return true;
+}
+
+static void
+collect_sample(const SampleSlot *slot)
+{
+    StackFrame frames[SAMPLE_MAX_FRAMES];
+    uint32_t i;
+
+    for (i = 0; i < slot->depth; i++) {
+        frames[i].func_index = slot->frames[i].func_index;
+        frames[i].line = 0;
+        frames[i].source = NULL;
+        /* the frame points after the current instruction, e.g. a call */
+        if (has_source_map && slot->frames[i].offset != UINT32_MAX
+            && slot->frames[i].offset > 0) {
+            frames[i].source = source_map_lookup(
+                &source_map, slot->frames[i].offset - 1, &frames[i].line);
+        }
+    }
+
+    if (!stack_table_add(&stacks, frames, slot->depth, slot->truncated)) {
+        atomic_fetch_add_explicit(&sample_ring.dropped, 1,
+                                  memory_order_relaxed);
+        return;
+    }
+    sample_count++;
+}
+
+static void
+collect_samples(void)
+{
+    SampleRing *ring = &sample_ring;
+    SampleSlot *slot;
+
+    for (;;) {
+        slot = ring_slot(ring, ring->head);
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire)
+            != ring->head + 1) {
+            break;
+        }
+        collect_sample(slot);
+        /* hand the slot back to the handlers */
+        atomic_store_explicit(&slot->seq, ring->head + SAMPLE_RING_SIZE,
+                              memory_order_release);
+        ring->head++;
+    }
+}
+
+static void *
+collector_thread(void *arg)
+{
+    (void)arg;
+
+    while (!atomic_load(&collector_stopping)) {
+        collect_samples();
+        os_usleep(SAMPLE_COLLECT_INTERVAL_US);
+    }
+    return NULL;
+}
+
+bool
+sampling_profiler_init(const char *out_file, uint32_t rate,
+                       const char *wasm_file, const char *source_map_file,
+                       const uint8_t *module_buf, uint32_t module_size)
+{
+    struct sigaction action;
+    struct itimerval timer;
+    ModuleFile file;
+    size_t i;
+
+    if (rate == 0 || rate > SAMPLE_RATE_MAX) {
+        return false;
+    }
+
+    if (source_map_file) {
+        if (!source_map_load(source_map_file, &source_map)) {
+            return false;
+        }
+        has_source_map = true;
+    }
+    /* the functions are numbered without names otherwise */
+    if (module_file_open(wasm_file, &file)) {
+        module_file_read_func_names(&file, &func_names);
+        module_file_close(&file);
+    }
+    if (!(profile_out = fopen(out_file, "w"))) {
+        goto fail;
+    }
+    profile_file = out_file;
+
+    for (i = 0; i < SAMPLE_RING_SIZE; i++) {
+        atomic_init(&sample_ring.slots[i].seq, i);
+    }
+    atomic_init(&sample_ring.tail, 0);
+    atomic_init(&sample_ring.dropped, 0);
+    sample_ring.head = 0;
+    module_start = module_buf;
+    module_end = module_buf + module_size;
+
+    atomic_init(&collector_stopping, false);
+    if (os_thread_create(&collector, collector_thread, NULL,
+                         BH_APPLET_PRESERVED_STACK_SIZE)
+        != BHT_OK) {
+        goto fail;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = sigprof_handler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, NULL);
+
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = 1000000 / rate;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, NULL);
+
+    profiler_enabled = true;
+    return true;
+
+fail:
+    if (profile_out) {
+        fclose(profile_out);
+        profile_out = NULL;
+    }
+    module_func_names_destroy(&func_names);
+    if (has_source_map) {
+        source_map_destroy(&source_map);
+        has_source_map = false;
+    }
+    return false;
+}
+
+wasm_exec_env_t
+sampling_profiler_attach(wasm_exec_env_t exec_env)
+{
+    wasm_exec_env_t prev = sampled_exec_env;
+
+    sampled_exec_env = exec_env;
+    return prev;
+}
+
+/* Write a name without the separators of the folded format */
+static void
+write_name(FILE *out, const char *name)
+{
+    for (; *name; name++) {
+        fputc(*name == ';' || *name == '\n' ? '_' : *name, out);
+    }
+}
+
+static void
+write_frame(FILE *out, const StackFrame *frame)
+{
+    const char *name = module_func_names_get(&func_names, frame->func_index);
+
+    if (name) {
+        write_name(out, name);
+    }
+    else {
+        fprintf(out, "func %" PRIu32, frame->func_index);
+    }
+    if (frame->source) {
+        fprintf(out, " (");
+        write_name(out, frame->source);
+        fprintf(out, ":%" PRIu32 ")", frame->line);
+    }
+}
+
+void
+sampling_profiler_destroy(void)
+{
+    struct itimerval timer;
+    StackEntry *entry;
+    uint32_t i, j;
+
+    if (!profiler_enabled) {
+        return;
+    }
+
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, NULL);
+    /* a signal still pending mustn't terminate the process */
+    signal(SIGPROF, SIG_IGN);
+
+    atomic_store(&collector_stopping, true);
+    os_thread_join(collector, NULL);
+    collect_samples();
+
+    /* root first, as flamegraph.pl reads them */
+    for (i = 0; i < stacks.capacity; i++) {
+        entry = &stacks.entries[i];
+        if (entry->count == 0) {
+            continue;
+        }
+        if (entry->truncated) {
+            fprintf(profile_out, "[truncated];");
+        }
+        if (entry->depth == 0) {
+            fprintf(profile_out, "[host]");
+        }
+        for (j = entry->depth; j > 0; j--) {
+            write_frame(profile_out, &entry->frames[j - 1]);
+            if (j > 1) {
+                fputc(';', profile_out);
+            }
+        }
+        fprintf(profile_out, " %" PRIu64 "\n", entry->count);
+        free(entry->frames);
+    }
+    fclose(profile_out);
+    profile_out = NULL;
+
+    fprintf(stderr,
+            "sampling: %" PRIu64 " samples, %" PRIu64
+            " dropped, %" PRIu32 " stacks written to %s\n",
+            sample_count, (uint64_t)atomic_load(&sample_ring.dropped),
+            stacks.count, profile_file);
+
+    free(stacks.entries);
+    memset(&stacks, 0, sizeof(StackTable));
+    module_func_names_destroy(&func_names);
+    if (has_source_map) {
+        source_map_destroy(&source_map);
+        has_source_map = false;
+    }
+    profiler_enabled = false;
+}
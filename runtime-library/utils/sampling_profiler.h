@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef __SAMPLING_PROFILER_H_
+#define __SAMPLING_PROFILER_H_
+
+#include "wasm_export.h"
+
+/**
+ * @brief Start sampling the wasm call stacks of the threads attached with
+ * sampling_profiler_attach
+ *
+ * The process is interrupted with SIGPROF rate times per second of CPU time,
+ * a sample taken on a thread without wasm frames counts as [host].
+ *
+ * @param out_file receives the stacks in the folded format of flamegraph.pl
+ * when the profiler is destroyed
+ * @param rate the samples per second, at most 10000
+ * @param wasm_file the wasm file, its name section names the functions
+ * @param source_map_file the source map of the wasm file, NULL for none
+ * @param module_buf the buffer the module is loaded from, the frames of the
+ * classic interpreter point into it
+ * @param module_size the size of module_buf
+ * @return true if success, false otherwise
+ */
+bool
+sampling_profiler_init(const char *out_file, uint32_t rate,
+                       const char *wasm_file, const char *source_map_file,
+                       const uint8_t *module_buf, uint32_t module_size);
+
+/**
+ * @brief Set the exec env sampled on the calling thread, NULL to stop
+ * sampling it. May be called whether the profiler is enabled or not.
+ *
+ * @return the exec env attached before
+ */
+wasm_exec_env_t
+sampling_profiler_attach(wasm_exec_env_t exec_env);
+
+/**
+ * @brief Stop sampling, write the stacks sampled and free the profiler
+ */
+void
+sampling_profiler_destroy(void);
+
+#endif /* end of __SAMPLING_PROFILER_H_ */
@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* Only the "sources" and "mappings" of the map are read. The generated
+ * positions of a wasm source map are all on line 1, the column of a segment
+ * being the offset of the code in the wasm file. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bh_platform.h"
+#include "bh_read_file.h"
+#include "wasm_export.h"
+#include "source_map.h"
+
+static const char *
+skip_space(const char *p, const char *p_end)
+{
+    while (p < p_end
+           && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        p++;
+    }
+    return p;
+}
+
+/* p is at the opening quote, return the position after the closing one */
+static const char *
+skip_string(const char *p, const char *p_end)
+{
+    for (p++; p < p_end; p++) {
+        if (*p == '\\') {
+            p++;
+        }
+        else if (*p == '"') {
+            return p + 1;
+        }
+    }
+    return NULL;
+}
+
+static const char *
+skip_value(const char *p, const char *p_end)
+{
+    uint32_t depth = 0;
+
+    do {
+        if ((p = skip_space(p, p_end)) >= p_end) {
+            return NULL;
+        }
+        if (*p == '"') {
+            if (!(p = skip_string(p, p_end))) {
+                return NULL;
+            }
+            continue;
+        }
+        if (*p == '{' || *p == '[') {
+            depth++;
+        }
+        else if (*p == '}' || *p == ']') {
+            if (depth == 0) {
+                return NULL;
+            }
+            depth--;
+        }
+        else if (depth == 0) {
+            /* a number or a literal */
+            while (p < p_end && *p != ',' && *p != '}' && *p != ']') {
+                p++;
+            }
+            return p;
+        }
+        p++;
+    } while (depth > 0);
+
+    return p;
+}
+
+/* Copy the string at p, the escapes of other than ASCII are kept as is */
+static char *
+dup_string(const char *p, const char *p_end)
+{
+    const char *p_str_end;
+    char *str, *q;
+
+    if (!(p_str_end = skip_string(p, p_end))
+        || !(str = q = malloc(p_str_end - p))) {
+        return NULL;
+    }
+    for (p++; p < p_str_end - 1; p++) {
+        if (*p != '\\') {
+            *q++ = *p;
+            continue;
+        }
+        switch (*++p) {
+            case 'n':
+                *q++ = '\n';
+                break;
+            case 't':
+                *q++ = '\t';
+                break;
+            case 'r':
+                *q++ = '\r';
+                break;
+            case 'b':
+                *q++ = '\b';
+                break;
+            case 'f':
+                *q++ = '\f';
+                break;
+            case 'u':
+                *q++ = '\\';
+                *q++ = 'u';
+                break;
+            default:
+                *q++ = *p;
+                break;
+        }
+    }
+    *q = '\0';
+    return str;
+}
+
+static const char *
+read_sources(const char *p, const char *p_end, SourceMap *map)
+{
+    char **sources;
+
+    if (p >= p_end || *p++ != '[') {
+        return NULL;
+    }
+    for (;;) {
+        if ((p = skip_space(p, p_end)) >= p_end) {
+            return NULL;
+        }
+        if (*p == ']') {
+            return p + 1;
+        }
+        if (*p == ',') {
+            p++;
+            continue;
+        }
+        if (*p != '"') {
+            return NULL;
+        }
+        if (!(sources = realloc(map->sources,
+                                sizeof(char *) * (map->source_count + 1)))) {
+            return NULL;
+        }
+        map->sources = sources;
+        if (!(map->sources[map->source_count] = dup_string(p, p_end))) {
+            return NULL;
+        }
+        map->source_count++;
+        p = skip_string(p, p_end);
+    }
+}
+
+static int
+base64_value(char c)
+{
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    return c == '+' ? 62 : c == '/' ? 63 : -1;
+}
+
+static bool
+read_vlq(const char **p_buf, const char *buf_end, int64_t *p_value)
+{
+    const char *p = *p_buf;
+    uint64_t result = 0;
+    uint32_t shift = 0;
+    int digit;
+
+    do {
+        if (p >= buf_end || (digit = base64_value(*p++)) < 0 || shift > 60) {
+            return false;
+        }
+        result |= (uint64_t)(digit & 31) << shift;
+        shift += 5;
+    } while (digit & 32);
+
+    *p_value = result & 1 ? -(int64_t)(result >> 1) : (int64_t)(result >> 1);
+    *p_buf = p;
+    return true;
+}
+
+static bool
+add_entry(SourceMap *map, uint32_t *p_capacity, uint32_t offset,
+          uint32_t source, uint32_t line)
+{
+    SourceMapEntry *entries;
+    uint32_t capacity;
+
+    if (map->entry_count == *p_capacity) {
+        capacity = *p_capacity ? *p_capacity * 2 : 1024;
+        if (!(entries =
+                  realloc(map->entries, sizeof(SourceMapEntry) * capacity))) {
+            return false;
+        }
+        map->entries = entries;
+        *p_capacity = capacity;
+    }
+    map->entries[map->entry_count].offset = offset;
+    map->entries[map->entry_count].source = source;
+    map->entries[map->entry_count].line = line;
+    map->entry_count++;
+    return true;
+}
+
+static int
+compare_entry_offset(const void *a, const void *b)
+{
+    uint32_t offset_a = ((const SourceMapEntry *)a)->offset;
+    uint32_t offset_b = ((const SourceMapEntry *)b)->offset;
+
+    return offset_a < offset_b ? -1 : offset_a > offset_b ? 1 : 0;
+}
+
+static const char *
+read_mappings(const char *p, const char *p_end, SourceMap *map)
+{
+    /* the fields are relative to the previous segment */
+    int64_t offset = 0, source = 0, line = 0, column = 0, name = 0;
+    int64_t *fields[5] = { &offset, &source, &line, &column, &name };
+    int64_t delta;
+    uint32_t capacity = 0, field_count;
+    bool sorted = true;
+
+    if (p >= p_end || *p++ != '"') {
+        return NULL;
+    }
+    while (p < p_end && *p != '"') {
+        if (*p == ',' || *p == ';') {
+            if (*p == ';') {
+                /* not emitted for wasm, a new line restarts the columns */
+                offset = 0;
+            }
+            p++;
+            continue;
+        }
+        for (field_count = 0;
+             field_count < 5 && p < p_end && *p != ',' && *p != ';'
+             && *p != '"';
+             field_count++) {
+            if (!read_vlq(&p, p_end, &delta)) {
+                return NULL;
+            }
+            *fields[field_count] += delta;
+        }
+        if (offset < 0 || offset > UINT32_MAX || source < 0 || line < 0
+            || (field_count != 1 && field_count < 4)) {
+            return NULL;
+        }
+        if (map->entry_count > 0
+            && map->entries[map->entry_count - 1].offset > offset) {
+            sorted = false;
+        }
+        if (!add_entry(map, &capacity, (uint32_t)offset,
+                       field_count == 1 ? UINT32_MAX : (uint32_t)source,
+                       (uint32_t)line + 1)) {
+            return NULL;
+        }
+    }
+    if (p >= p_end) {
+        return NULL;
+    }
+
+    if (!sorted) {
+        qsort(map->entries, map->entry_count, sizeof(SourceMapEntry),
+              compare_entry_offset);
+    }
+    return p + 1;
+}
+
+bool
+source_map_load(const char *path, SourceMap *map)
+{
+    const char *p, *p_end, *p_key;
+    char *buf;
+    uint32_t size, i;
+    bool ret = false;
+
+    memset(map, 0, sizeof(SourceMap));
+
+    if (!(buf = bh_read_file_to_buffer(path, &size))) {
+        return false;
+    }
+    p = buf;
+    p_end = buf + size;
+
+    if ((p = skip_space(p, p_end)) >= p_end || *p++ != '{') {
+        goto fail;
+    }
+    for (;;) {
+        if ((p = skip_space(p, p_end)) >= p_end) {
+            goto fail;
+        }
+        if (*p == '}') {
+            break;
+        }
+        if (*p == ',') {
+            p++;
+            continue;
+        }
+        p_key = p;
+        if (*p != '"' || !(p = skip_string(p, p_end))
+            || (p = skip_space(p, p_end)) >= p_end || *p++ != ':') {
+            goto fail;
+        }
+        p = skip_space(p, p_end);
+        if (!strncmp(p_key, "\"sources\"", 9)) {
+            p = read_sources(p, p_end, map);
+        }
+        else if (!strncmp(p_key, "\"mappings\"", 10)) {
+            p = read_mappings(p, p_end, map);
+        }
+        else {
+            p = skip_value(p, p_end);
+        }
+        if (!p) {
+            goto fail;
+        }
+    }
+
+    /* a mapping can't refer to a source that isn't listed */
+    for (i = 0; i < map->entry_count; i++) {
+        if (map->entries[i].source != UINT32_MAX
+            && map->entries[i].source >= map->source_count) {
+            goto fail;
+        }
+    }
+    ret = true;
+
+fail:
+    wasm_runtime_free(buf);
+    if (!ret) {
+        source_map_destroy(map);
+    }
+    return ret;
+}
+
+const char *
+source_map_lookup(const SourceMap *map, uint32_t offset, uint32_t *p_line)
+{
+    uint32_t low = 0, high = map->entry_count, mid;
+    const SourceMapEntry *entry;
+
+    /* the last entry at or before offset */
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (map->entries[mid].offset <= offset) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    if (low == 0) {
+        return NULL;
+    }
+    entry = &map->entries[low - 1];
+    if (entry->source == UINT32_MAX) {
+        return NULL;
+    }
+    *p_line = entry->line;
+    return map->sources[entry->source];
+}
+
+void
+source_map_destroy(SourceMap *map)
+{
+    uint32_t i;
+
+    for (i = 0; i < map->source_count; i++) {
+        free(map->sources[i]);
+    }
+    free(map->sources);
+    free(map->entries);
+    memset(map, 0, sizeof(SourceMap));
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef __SOURCE_MAP_H_
+#define __SOURCE_MAP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* A mapping of the wasm binary, valid up to the offset of the next one */
+typedef struct SourceMapEntry {
+    /* offset in the wasm file */
+    uint32_t offset;
+    /* index in sources, UINT32_MAX if the code has no source */
+    uint32_t source;
+    /* 1-based */
+    uint32_t line;
+} SourceMapEntry;
+
+/* The source map of a wasm file, as emitted with --sourceMap */
+typedef struct SourceMap {
+    char **sources;
+    uint32_t source_count;
+    /* sorted by offset */
+    SourceMapEntry *entries;
+    uint32_t entry_count;
+} SourceMap;
+
+/**
+ * @brief Load a source map (version 3) whose generated positions are offsets
+ * in a wasm file
+ *
+ * @param path the path of the source map file
+ * @param map receives the mappings, free them with source_map_destroy
+ * @return true if success, false if the file can't be read, is malformed or
+ * out of memory
+ */
+bool
+source_map_load(const char *path, SourceMap *map);
+
+/**
+ * @brief Get the source position of an offset in the wasm file
+ *
+ * @param map the source map
+ * @param offset the offset of an instruction
+ * @param p_line receives the line of the instruction
+ * @return the source file, NULL if the offset is not mapped
+ */
+const char *
+source_map_lookup(const SourceMap *map, uint32_t offset, uint32_t *p_line);
+
+void
+source_map_destroy(SourceMap *map);
+
+#endif /* end of __SOURCE_MAP_H_ */
@@ -0,0 +1,1146 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* The sender writes the value into a flat buffer, the receiver rebuilds it
+ * in its own heap. Both instances are instances of the same module, so the
+ * defined types written as pointers are valid on both ends, and so are the
+ * offsets of the Meta in the linear memory. Vtables are globals of each
+ * instance, the receiver looks its own ones up by type and Meta. */
+
+#include "bh_hashmap.h"
+#include "bh_platform.h"
+#include "gc_export.h"
+#include "libdyntype_export.h"
+#include "object_utils.h"
+#include "structured_clone.h"
+#include "type_utils.h"
+#include "wamr_utils.h"
+
+#define CLONE_INIT_CAPACITY 256
+#define CLONE_OBJECT_MAP_INIT_SIZE 64
+/* deep enough for data, and far from overflowing the native stack */
+#define CLONE_MAX_DEPTH 10000
+#define CLONE_MAX_VTABLES 32
+
+enum clone_tag {
+    /* dynamic values */
+    CLONE_UNDEFINED,
+    CLONE_NULL,
+    CLONE_FALSE,
+    CLONE_TRUE,
+    CLONE_NUMBER,
+    CLONE_STRING,
+    CLONE_ARRAY,
+    CLONE_OBJECT,
+    CLONE_EXTREF,
+    /* references held by static objects */
+    CLONE_REF_NULL,
+    CLONE_REF_BACK,
+    CLONE_REF_STRUCT,
+    CLONE_REF_ARRAY,
+    CLONE_REF_VTABLE,
+    CLONE_REF_I31,
+    CLONE_REF_ANY,
+    CLONE_REF_STRING,
+};
+
+struct StructuredClone {
+    wasm_module_t module;
+    uint8_t *data;
+    uint32_t size;
+    uint32_t capacity;
+    /* static objects written, the reader keeps all of them rooted */
+    uint32_t object_count;
+};
+
+typedef struct CloneWriter {
+    wasm_exec_env_t exec_env;
+    wasm_module_t module;
+    dyn_ctx_t ctx;
+    StructuredClone *clone;
+    /* static object -> index + 1 */
+    HashMap *objects;
+    uint32_t depth;
+    const char *error;
+} CloneWriter;
+
+typedef struct CloneVtable {
+    wasm_defined_type_t type;
+    int32_t meta;
+    wasm_obj_t obj;
+} CloneVtable;
+
+typedef struct CloneReader {
+    wasm_exec_env_t exec_env;
+    wasm_module_t module;
+    dyn_ctx_t ctx;
+    const uint8_t *p;
+    const uint8_t *end;
+    /* index -> static object read */
+    wasm_local_obj_ref_t *objects;
+    uint32_t object_count;
+    uint32_t max_object_count;
+    CloneVtable vtables[CLONE_MAX_VTABLES];
+    uint32_t vtable_count;
+    const char *error;
+} CloneReader;
+
+static uint32_t
+object_hash(const void *key)
+{
+    return (uint32_t)((uintptr_t)key >> 3);
+}
+
+static bool
+object_equal(void *key1, void *key2)
+{
+    return key1 == key2;
+}
+
+/********************************* Writer *********************************/
+
+static bool
+write_bytes(CloneWriter *writer, const void *data, uint32_t size)
+{
+    StructuredClone *clone = writer->clone;
+
+    if ((uint64_t)clone->size + size > clone->capacity) {
+        uint64_t new_capacity =
+            clone->capacity ? clone->capacity : CLONE_INIT_CAPACITY;
+        uint8_t *new_data;
+
+        while (new_capacity < (uint64_t)clone->size + size) {
+            new_capacity *= 2;
+        }
+        if (new_capacity > UINT32_MAX
+            || !(new_data = wasm_runtime_realloc(clone->data,
+                                                 (uint32_t)new_capacity))) {
+            writer->error = "out of memory";
+            return false;
+        }
+        clone->data = new_data;
+        clone->capacity = (uint32_t)new_capacity;
+    }
+
+    bh_memcpy_s(clone->data + clone->size, clone->capacity - clone->size,
+                data, size);
+    clone->size += size;
+    return true;
+}
+
+static inline bool
+write_u8(CloneWriter *writer, uint8_t value)
+{
+    return write_bytes(writer, &value, sizeof(uint8_t));
+}
+
+static inline bool
+write_u32(CloneWriter *writer, uint32_t value)
+{
+    return write_bytes(writer, &value, sizeof(uint32_t));
+}
+
+static inline bool
+write_ptr(CloneWriter *writer, const void *ptr)
+{
+    return write_bytes(writer, &ptr, sizeof(void *));
+}
+
+/* strings keep their terminator so that the reader uses them in place */
+static bool
+write_string(CloneWriter *writer, const char *str, uint32_t len)
+{
+    return write_u32(writer, len) && write_bytes(writer, str, len)
+           && write_u8(writer, '\0');
+}
+
+static bool
+write_dyn(CloneWriter *writer, dyn_value_t value);
+
+static bool
+write_ref(CloneWriter *writer, wasm_obj_t obj);
+
+static bool
+is_ref_type(uint8_t value_type)
+{
+    switch (value_type) {
+        case VALUE_TYPE_I32:
+        case VALUE_TYPE_I64:
+        case VALUE_TYPE_F32:
+        case VALUE_TYPE_F64:
+        case VALUE_TYPE_V128:
+        case PACKED_TYPE_I8:
+        case PACKED_TYPE_I16:
+            return false;
+        default:
+            return true;
+    }
+}
+
+static bool
+is_func_ref_type(wasm_module_t module, wasm_ref_type_t type)
+{
+    if (type.heap_type >= 0) {
+        return wasm_defined_type_is_func_type(
+            wasm_get_defined_type(module, type.heap_type));
+    }
+    return type.heap_type == HEAP_TYPE_FUNC;
+}
+
+/* A vtable holds the offset of the Meta of the class, then the methods */
+static bool
+is_vtable(wasm_module_t module, wasm_obj_t obj)
+{
+    wasm_struct_type_t struct_type;
+    uint32_t field_count, i;
+    bool is_mutable;
+
+    if (!obj || !wasm_obj_is_struct_obj(obj)) {
+        return false;
+    }
+
+    struct_type = (wasm_struct_type_t)wasm_obj_get_defined_type(obj);
+    field_count = wasm_struct_type_get_field_count(struct_type);
+    if (field_count == 0
+        || wasm_struct_type_get_field_type(struct_type, 0, &is_mutable)
+                   .value_type
+               != VALUE_TYPE_I32) {
+        return false;
+    }
+    for (i = 1; i < field_count; i++) {
+        wasm_ref_type_t field_type =
+            wasm_struct_type_get_field_type(struct_type, i, &is_mutable);
+
+        if (!is_ref_type(field_type.value_type)
+            || !is_func_ref_type(module, field_type)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+write_vtable(CloneWriter *writer, wasm_obj_t vtable)
+{
+    wasm_value_t meta = { 0 };
+
+    wasm_struct_obj_get_field((wasm_struct_obj_t)vtable, 0, false, &meta);
+    return write_u8(writer, CLONE_REF_VTABLE)
+           && write_ptr(writer, wasm_obj_get_defined_type(vtable))
+           && write_u32(writer, (uint32_t)meta.i32);
+}
+
+static bool
+write_struct(CloneWriter *writer, wasm_struct_obj_t obj)
+{
+    wasm_struct_type_t struct_type =
+        (wasm_struct_type_t)wasm_obj_get_defined_type((wasm_obj_t)obj);
+    uint32_t field_count = wasm_struct_type_get_field_count(struct_type);
+    uint32_t i;
+    bool is_mutable;
+
+    if (!write_u8(writer, CLONE_REF_STRUCT) || !write_ptr(writer, struct_type)) {
+        return false;
+    }
+
+    for (i = 0; i < field_count; i++) {
+        wasm_ref_type_t field_type =
+            wasm_struct_type_get_field_type(struct_type, i, &is_mutable);
+        wasm_value_t value = { 0 };
+
+        wasm_struct_obj_get_field(obj, i, false, &value);
+        if (!is_ref_type(field_type.value_type)) {
+            if (!write_bytes(writer, &value, sizeof(wasm_value_t))) {
+                return false;
+            }
+        }
+        else if (is_func_ref_type(writer->module, field_type)) {
+            writer->error = "functions can't be cloned";
+            return false;
+        }
+        else if (i == 0 && is_vtable(writer->module, value.gc_obj)) {
+            if (!write_vtable(writer, value.gc_obj)) {
+                return false;
+            }
+        }
+        else if (!write_ref(writer, value.gc_obj)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool
+write_array(CloneWriter *writer, wasm_array_obj_t obj)
+{
+    wasm_array_type_t array_type =
+        (wasm_array_type_t)wasm_obj_get_defined_type((wasm_obj_t)obj);
+    uint32_t len = wasm_array_obj_length(obj);
+    bool is_mutable;
+    wasm_ref_type_t elem_type =
+        wasm_array_type_get_elem_type(array_type, &is_mutable);
+    uint32_t i;
+
+    if (!write_u8(writer, CLONE_REF_ARRAY) || !write_ptr(writer, array_type)
+        || !write_u32(writer, len)) {
+        return false;
+    }
+
+    if (!is_ref_type(elem_type.value_type)) {
+        uint64_t size = (uint64_t)len << wasm_array_obj_elem_size_log(obj);
+
+        if (size > UINT32_MAX) {
+            writer->error = "out of memory";
+            return false;
+        }
+        return write_bytes(writer, wasm_array_obj_first_elem_addr(obj),
+                           (uint32_t)size);
+    }
+
+    if (is_func_ref_type(writer->module, elem_type)) {
+        writer->error = "functions can't be cloned";
+        return false;
+    }
+    for (i = 0; i < len; i++) {
+        wasm_value_t value = { 0 };
+
+        wasm_array_obj_get_elem(obj, i, false, &value);
+        if (!write_ref(writer, value.gc_obj)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+write_ref(CloneWriter *writer, wasm_obj_t obj)
+{
+    uintptr_t index;
+    bool ret;
+
+    if (!obj) {
+        return write_u8(writer, CLONE_REF_NULL);
+    }
+    if (wasm_obj_is_i31_obj(obj)) {
+        return write_u8(writer, CLONE_REF_I31)
+               && write_u32(writer, wasm_i31_obj_get_value(
+                                        (wasm_i31_obj_t)obj, false));
+    }
+#if WASM_ENABLE_STRINGREF != 0
+    if (wasm_obj_is_stringref_obj(obj)) {
+        uint32_t len = wasm_string_get_length((wasm_stringref_obj_t)obj);
+        char *str;
+
+        if (!(str = wasm_runtime_malloc(len))) {
+            writer->error = "out of memory";
+            return false;
+        }
+        wasm_string_to_cstring((wasm_stringref_obj_t)obj, str, len);
+        ret = write_u8(writer, CLONE_REF_STRING)
+              && write_string(writer, str, (uint32_t)strlen(str));
+        wasm_runtime_free(str);
+        return ret;
+    }
+#endif
+    if (wasm_obj_is_anyref_obj(obj)) {
+        return write_u8(writer, CLONE_REF_ANY)
+               && write_dyn(writer, (dyn_value_t)wasm_anyref_obj_get_value(
+                                        (wasm_anyref_obj_t)obj));
+    }
+    if (!wasm_obj_is_struct_obj(obj) && !wasm_obj_is_array_obj(obj)) {
+        writer->error = "functions and host objects can't be cloned";
+        return false;
+    }
+
+    if ((index = (uintptr_t)bh_hash_map_find(writer->objects, obj))) {
+        return write_u8(writer, CLONE_REF_BACK)
+               && write_u32(writer, (uint32_t)(index - 1));
+    }
+    index = ++writer->clone->object_count;
+    if (!bh_hash_map_insert(writer->objects, obj, (void *)index)) {
+        writer->error = "out of memory";
+        return false;
+    }
+
+    if (++writer->depth > CLONE_MAX_DEPTH) {
+        writer->error = "the value is nested too deeply";
+        return false;
+    }
+    ret = wasm_obj_is_struct_obj(obj)
+              ? write_struct(writer, (wasm_struct_obj_t)obj)
+              : write_array(writer, (wasm_array_obj_t)obj);
+    writer->depth--;
+    return ret;
+}
+
+static bool
+write_dyn_string(CloneWriter *writer, dyn_value_t value)
+{
+    char *str = NULL;
+    bool ret;
+
+    if (dyntype_to_cstring(writer->ctx, value, &str) != DYNTYPE_SUCCESS) {
+        writer->error = "out of memory";
+        return false;
+    }
+    ret = write_string(writer, str, (uint32_t)strlen(str));
+    dyntype_free_cstring(writer->ctx, str);
+    return ret;
+}
+
+static bool
+write_dyn_array(CloneWriter *writer, dyn_value_t value)
+{
+    int len = dyntype_get_array_length(writer->ctx, value), i;
+
+    if (len < 0) {
+        writer->error = "sparse and huge arrays can't be cloned";
+        return false;
+    }
+    if (!write_u8(writer, CLONE_ARRAY) || !write_u32(writer, (uint32_t)len)) {
+        return false;
+    }
+    for (i = 0; i < len; i++) {
+        dyn_value_t elem = dyntype_get_elem(writer->ctx, value, i);
+        bool ret;
+
+        if (!elem) {
+            writer->error = "get array element failed";
+            return false;
+        }
+        ret = write_dyn(writer, elem);
+        dyntype_release(writer->ctx, elem);
+        if (!ret) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+write_dyn_object(CloneWriter *writer, dyn_value_t value)
+{
+    dyn_value_t keys = dyntype_get_keys(writer->ctx, value);
+    int count, i;
+    bool ret = false;
+
+    if (!keys || (count = dyntype_get_array_length(writer->ctx, keys)) < 0) {
+        writer->error = "get object keys failed";
+        goto done;
+    }
+    if (!write_u8(writer, CLONE_OBJECT) || !write_u32(writer, (uint32_t)count)) {
+        goto done;
+    }
+    for (i = 0; i < count; i++) {
+        dyn_value_t key = dyntype_get_elem(writer->ctx, keys, i), prop;
+        char *name = NULL;
+
+        if (!key
+            || dyntype_to_cstring(writer->ctx, key, &name) != DYNTYPE_SUCCESS) {
+            dyntype_release(writer->ctx, key);
+            writer->error = "get object keys failed";
+            goto done;
+        }
+        dyntype_release(writer->ctx, key);
+
+        if (!write_string(writer, name, (uint32_t)strlen(name))
+            || !(prop = dyntype_get_property(writer->ctx, value, name))) {
+            dyntype_free_cstring(writer->ctx, name);
+            goto done;
+        }
+        dyntype_free_cstring(writer->ctx, name);
+
+        ret = write_dyn(writer, prop);
+        dyntype_release(writer->ctx, prop);
+        if (!ret) {
+            goto done;
+        }
+    }
+    ret = true;
+
+done:
+    if (keys) {
+        dyntype_release(writer->ctx, keys);
+    }
+    return ret;
+}
+
+static bool
+write_dyn(CloneWriter *writer, dyn_value_t value)
+{
+    dyn_ctx_t ctx = writer->ctx;
+    bool ret;
+
+    if (++writer->depth > CLONE_MAX_DEPTH) {
+        writer->error = "the value is nested too deeply";
+        return false;
+    }
+
+    if (dyntype_is_undefined(ctx, value)) {
+        ret = write_u8(writer, CLONE_UNDEFINED);
+    }
+    else if (dyntype_is_null(ctx, value)) {
+        ret = write_u8(writer, CLONE_NULL);
+    }
+    else if (dyntype_is_bool(ctx, value)) {
+        bool b = false;
+
+        dyntype_to_bool(ctx, value, &b);
+        ret = write_u8(writer, b ? CLONE_TRUE : CLONE_FALSE);
+    }
+    else if (dyntype_is_number(ctx, value)) {
+        double number = 0;
+
+        dyntype_to_number(ctx, value, &number);
+        ret = write_u8(writer, CLONE_NUMBER)
+              && write_bytes(writer, &number, sizeof(double));
+    }
+    else if (dyntype_is_string(ctx, value)) {
+        ret = write_u8(writer, CLONE_STRING) && write_dyn_string(writer, value);
+    }
+    else if (dyntype_is_extref(ctx, value)) {
+        void *table_index = NULL;
+        int tag = dyntype_to_extref(ctx, value, &table_index);
+
+        if (tag == ExtFunc) {
+            writer->error = "functions can't be cloned";
+            ret = false;
+        }
+        else {
+            ret = write_u8(writer, CLONE_EXTREF) && write_u8(writer, tag)
+                  && write_ref(writer, wamr_utils_get_table_element(
+                                           writer->exec_env,
+                                           (uint32_t)(uintptr_t)table_index));
+        }
+    }
+    else if (dyntype_is_function(ctx, value)) {
+        writer->error = "functions can't be cloned";
+        ret = false;
+    }
+    else if (dyntype_is_array(ctx, value)) {
+        ret = write_dyn_array(writer, value);
+    }
+    else if (dyntype_is_object(ctx, value)) {
+        ret = write_dyn_object(writer, value);
+    }
+    else {
+        writer->error = "symbols and bigints can't be cloned";
+        ret = false;
+    }
+
+    writer->depth--;
+    return ret;
+}
+
+/* An ArrayBuffer is struct(array(i8), i32) */
+static bool
+is_array_buffer(wasm_obj_t obj)
+{
+    wasm_struct_type_t struct_type;
+    wasm_value_t data = { 0 };
+    bool is_mutable;
+
+    if (!obj || !wasm_obj_is_struct_obj(obj)) {
+        return false;
+    }
+    struct_type = (wasm_struct_type_t)wasm_obj_get_defined_type(obj);
+    if (wasm_struct_type_get_field_count(struct_type) != 2
+        || wasm_struct_type_get_field_type(struct_type, 1, &is_mutable)
+                   .value_type
+               != VALUE_TYPE_I32) {
+        return false;
+    }
+    wasm_struct_obj_get_field((wasm_struct_obj_t)obj, 0, false, &data);
+    return data.gc_obj && wasm_obj_is_array_obj(data.gc_obj)
+           && wasm_array_type_get_elem_type(
+                  (wasm_array_type_t)wasm_obj_get_defined_type(data.gc_obj),
+                  &is_mutable)
+                      .value_type
+                  == PACKED_TYPE_I8;
+}
+
+static bool
+check_transfer_list(CloneWriter *writer, wasm_struct_obj_t transfer_list)
+{
+    wasm_array_obj_t buffers = get_array_ref(transfer_list);
+    uint32_t len = get_array_length(transfer_list), i;
+
+    for (i = 0; i < len; i++) {
+        wasm_value_t buffer = { 0 };
+
+        wasm_array_obj_get_elem(buffers, i, false, &buffer);
+        if (!is_array_buffer(buffer.gc_obj)) {
+            writer->error = "only ArrayBuffers can be transferred";
+            return false;
+        }
+    }
+    return true;
+}
+
+/* The backing array of a transferred buffer is swapped for an empty one,
+ * the sender can't observe later changes of the receiver's copy */
+static bool
+detach_array_buffers(CloneWriter *writer, wasm_struct_obj_t transfer_list)
+{
+    wasm_array_obj_t buffers = get_array_ref(transfer_list);
+    uint32_t len = get_array_length(transfer_list), i;
+
+    for (i = 0; i < len; i++) {
+        wasm_value_t buffer = { 0 }, data = { 0 }, init = { 0 };
+        wasm_value_t byte_length = { .i32 = 0 };
+
+        wasm_array_obj_get_elem(buffers, i, false, &buffer);
+        wasm_struct_obj_get_field((wasm_struct_obj_t)buffer.gc_obj, 0, false,
+                                  &data);
+        data.gc_obj = (wasm_obj_t)wasm_array_obj_new_with_type(
+            writer->exec_env,
+            (wasm_array_type_t)wasm_obj_get_defined_type(data.gc_obj), 0,
+            &init);
+        if (!data.gc_obj) {
+            writer->error = "out of memory";
+            return false;
+        }
+        wasm_struct_obj_set_field((wasm_struct_obj_t)buffer.gc_obj, 0, &data);
+        wasm_struct_obj_set_field((wasm_struct_obj_t)buffer.gc_obj, 1,
+                                  &byte_length);
+    }
+    return true;
+}
+
+StructuredClone *
+structured_clone_write(wasm_exec_env_t exec_env, dyn_ctx_t ctx,
+                       dyn_value_t value, wasm_struct_obj_t transfer_list)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    CloneWriter writer = { 0 };
+    char error_buf[128];
+
+    writer.exec_env = exec_env;
+    writer.module = wasm_runtime_get_module(module_inst);
+    writer.ctx = ctx;
+
+    if (!(writer.clone = wasm_runtime_malloc(sizeof(StructuredClone)))) {
+        writer.error = "out of memory";
+        goto fail;
+    }
+    memset(writer.clone, 0, sizeof(StructuredClone));
+    writer.clone->module = writer.module;
+
+    if (!(writer.objects = bh_hash_map_create(CLONE_OBJECT_MAP_INIT_SIZE,
+                                              false, object_hash,
+                                              object_equal, NULL, NULL))) {
+        writer.error = "out of memory";
+        goto fail;
+    }
+
+    if ((transfer_list && !check_transfer_list(&writer, transfer_list))
+        || !write_dyn(&writer, value)
+        || (transfer_list && !detach_array_buffers(&writer, transfer_list))) {
+        goto fail;
+    }
+
+    bh_hash_map_destroy(writer.objects);
+    return writer.clone;
+
+fail:
+    if (writer.objects) {
+        bh_hash_map_destroy(writer.objects);
+    }
+    if (writer.clone) {
+        structured_clone_destroy(writer.clone);
+    }
+    snprintf(error_buf, sizeof(error_buf), "DataCloneError: %s",
+             writer.error ? writer.error : "out of memory");
+    wasm_runtime_set_exception(module_inst, error_buf);
+    return NULL;
+}
+
+void
+structured_clone_destroy(StructuredClone *clone)
+{
+    if (clone->data) {
+        wasm_runtime_free(clone->data);
+    }
+    wasm_runtime_free(clone);
+}
+
+/********************************* Reader *********************************/
+
+static bool
+read_bytes(CloneReader *reader, void *data, uint32_t size)
+{
+    if ((uint32_t)(reader->end - reader->p) < size) {
+        reader->error = "truncated message";
+        return false;
+    }
+    bh_memcpy_s(data, size, reader->p, size);
+    reader->p += size;
+    return true;
+}
+
+static inline bool
+read_u8(CloneReader *reader, uint8_t *value)
+{
+    return read_bytes(reader, value, sizeof(uint8_t));
+}
+
+static inline bool
+read_u32(CloneReader *reader, uint32_t *value)
+{
+    return read_bytes(reader, value, sizeof(uint32_t));
+}
+
+static inline bool
+read_ptr(CloneReader *reader, void **ptr)
+{
+    return read_bytes(reader, ptr, sizeof(void *));
+}
+
+static const char *
+read_string(CloneReader *reader, uint32_t *p_len)
+{
+    const char *str;
+    uint32_t len;
+
+    if (!read_u32(reader, &len)
+        || (uint32_t)(reader->end - reader->p) <= len) {
+        reader->error = "truncated message";
+        return NULL;
+    }
+    str = (const char *)reader->p;
+    reader->p += len + 1;
+    *p_len = len;
+    return str;
+}
+
+static dyn_value_t
+read_dyn(CloneReader *reader);
+
+static bool
+read_ref(CloneReader *reader, wasm_obj_t *p_obj);
+
+/* Root a new static object until the whole value is rebuilt */
+static bool
+add_object(CloneReader *reader, wasm_obj_t obj)
+{
+    wasm_local_obj_ref_t *local_ref;
+
+    if (!obj) {
+        reader->error = "out of memory";
+        return false;
+    }
+    if (reader->object_count == reader->max_object_count) {
+        reader->error = "corrupted message";
+        return false;
+    }
+    local_ref = reader->objects + reader->object_count++;
+    local_ref->val = obj;
+    wasm_runtime_push_local_obj_ref(reader->exec_env, local_ref);
+    return true;
+}
+
+static bool
+match_vtable(void *obj, void *user_data)
+{
+    CloneVtable *vtable = (CloneVtable *)user_data;
+    wasm_value_t meta = { 0 };
+
+    if (!wasm_obj_is_struct_obj((wasm_obj_t)obj)
+        || wasm_obj_get_defined_type((wasm_obj_t)obj) != vtable->type) {
+        return false;
+    }
+    wasm_struct_obj_get_field((wasm_struct_obj_t)obj, 0, false, &meta);
+    return meta.i32 == vtable->meta;
+}
+
+static wasm_obj_t
+find_vtable(CloneReader *reader, wasm_defined_type_t type, int32_t meta)
+{
+    CloneVtable *vtable;
+    uint32_t i;
+
+    for (i = 0; i < reader->vtable_count; i++) {
+        if (reader->vtables[i].type == type && reader->vtables[i].meta == meta) {
+            return reader->vtables[i].obj;
+        }
+    }
+
+    /* remembered for the other objects of the class in the value */
+    vtable = reader->vtables
+             + (reader->vtable_count < CLONE_MAX_VTABLES
+                    ? reader->vtable_count++
+                    : CLONE_MAX_VTABLES - 1);
+    vtable->type = type;
+    vtable->meta = meta;
+    vtable->obj = wamr_utils_find_global_obj(
+        wasm_runtime_get_module_inst(reader->exec_env), match_vtable, vtable);
+    return vtable->obj;
+}
+
+static bool
+read_struct(CloneReader *reader, wasm_obj_t *p_obj)
+{
+    wasm_struct_type_t struct_type;
+    wasm_struct_obj_t obj;
+    uint32_t field_count, i;
+    bool is_mutable;
+
+    if (!read_ptr(reader, (void **)&struct_type)) {
+        return false;
+    }
+    obj = wasm_struct_obj_new_with_type(reader->exec_env, struct_type);
+    if (!add_object(reader, (wasm_obj_t)obj)) {
+        return false;
+    }
+
+    field_count = wasm_struct_type_get_field_count(struct_type);
+    for (i = 0; i < field_count; i++) {
+        wasm_ref_type_t field_type =
+            wasm_struct_type_get_field_type(struct_type, i, &is_mutable);
+        wasm_value_t value = { 0 };
+
+        if (!is_ref_type(field_type.value_type)) {
+            if (!read_bytes(reader, &value, sizeof(wasm_value_t))) {
+                return false;
+            }
+        }
+        else if (!read_ref(reader, &value.gc_obj)) {
+            return false;
+        }
+        wasm_struct_obj_set_field(obj, i, &value);
+    }
+
+    *p_obj = (wasm_obj_t)obj;
+    return true;
+}
+
+static bool
+read_array(CloneReader *reader, wasm_obj_t *p_obj)
+{
+    wasm_array_type_t array_type;
+    wasm_array_obj_t obj;
+    wasm_value_t init = { 0 };
+    wasm_ref_type_t elem_type;
+    uint32_t len, i;
+    bool is_mutable;
+
+    if (!read_ptr(reader, (void **)&array_type) || !read_u32(reader, &len)) {
+        return false;
+    }
+    obj = wasm_array_obj_new_with_type(reader->exec_env, array_type, len,
+                                       &init);
+    if (!add_object(reader, (wasm_obj_t)obj)) {
+        return false;
+    }
+
+    elem_type = wasm_array_type_get_elem_type(array_type, &is_mutable);
+    if (!is_ref_type(elem_type.value_type)) {
+        if (!read_bytes(reader, wasm_array_obj_first_elem_addr(obj),
+                        len << wasm_array_obj_elem_size_log(obj))) {
+            return false;
+        }
+    }
+    else {
+        for (i = 0; i < len; i++) {
+            wasm_value_t value = { 0 };
+
+            if (!read_ref(reader, &value.gc_obj)) {
+                return false;
+            }
+            wasm_array_obj_set_elem(obj, i, &value);
+        }
+    }
+
+    *p_obj = (wasm_obj_t)obj;
+    return true;
+}
+
+static bool
+read_ref(CloneReader *reader, wasm_obj_t *p_obj)
+{
+    uint8_t tag;
+
+    if (!read_u8(reader, &tag)) {
+        return false;
+    }
+
+    switch (tag) {
+        case CLONE_REF_NULL:
+            *p_obj = NULL;
+            return true;
+        case CLONE_REF_BACK:
+        {
+            uint32_t index;
+
+            if (!read_u32(reader, &index)) {
+                return false;
+            }
+            if (index >= reader->object_count) {
+                reader->error = "corrupted message";
+                return false;
+            }
+            *p_obj = reader->objects[index].val;
+            return true;
+        }
+        case CLONE_REF_STRUCT:
+            return read_struct(reader, p_obj);
+        case CLONE_REF_ARRAY:
+            return read_array(reader, p_obj);
+        case CLONE_REF_VTABLE:
+        {
+            wasm_defined_type_t type;
+            uint32_t meta;
+
+            if (!read_ptr(reader, (void **)&type)
+                || !read_u32(reader, &meta)) {
+                return false;
+            }
+            if (!(*p_obj = find_vtable(reader, type, (int32_t)meta))) {
+                reader->error = "class not found in the receiver";
+                return false;
+            }
+            return true;
+        }
+        case CLONE_REF_I31:
+        {
+            uint32_t value;
+
+            if (!read_u32(reader, &value)) {
+                return false;
+            }
+            *p_obj = (wasm_obj_t)wasm_i31_obj_new(value);
+            return true;
+        }
+        case CLONE_REF_ANY:
+        {
+            dyn_value_t value = read_dyn(reader);
+
+            if (!value) {
+                return false;
+            }
+            /* the anyref releases the value once collected */
+            *p_obj = (wasm_obj_t)box_ptr_to_anyref(reader->exec_env,
+                                                   reader->ctx, value);
+            return *p_obj != NULL;
+        }
+#if WASM_ENABLE_STRINGREF != 0
+        case CLONE_REF_STRING:
+        {
+            const char *str;
+            uint32_t len;
+
+            if (!(str = read_string(reader, &len))) {
+                return false;
+            }
+            *p_obj = (wasm_obj_t)create_wasm_string_with_len(reader->exec_env,
+                                                             str, len);
+            if (!*p_obj) {
+                reader->error = "out of memory";
+                return false;
+            }
+            return true;
+        }
+#endif
+        default:
+            reader->error = "corrupted message";
+            return false;
+    }
+}
+
+static dyn_value_t
+new_dyn_string(CloneReader *reader, const char *str, uint32_t len)
+{
+#if WASM_ENABLE_STRINGREF != 0
+    wasm_stringref_obj_t str_obj =
+        create_wasm_string_with_len(reader->exec_env, str, len);
+
+    if (!str_obj) {
+        return NULL;
+    }
+    return dyntype_new_string(reader->ctx,
+                              (void *)wasm_stringref_obj_get_value(str_obj));
+#else
+    return dyntype_new_string(reader->ctx, str, (int)len);
+#endif
+}
+
+static dyn_value_t
+read_dyn_array(CloneReader *reader)
+{
+    dyn_value_t array;
+    uint32_t len, i;
+
+    if (!read_u32(reader, &len)) {
+        return NULL;
+    }
+    if (!(array = dyntype_new_array(reader->ctx, (int)len))) {
+        reader->error = "out of memory";
+        return NULL;
+    }
+    for (i = 0; i < len; i++) {
+        dyn_value_t elem = read_dyn(reader);
+
+        if (!elem) {
+            dyntype_release(reader->ctx, array);
+            return NULL;
+        }
+        dyntype_set_elem(reader->ctx, array, (int)i, elem);
+        dyntype_release(reader->ctx, elem);
+    }
+    return array;
+}
+
+static dyn_value_t
+read_dyn_object(CloneReader *reader)
+{
+    dyn_value_t object;
+    uint32_t count, i;
+
+    if (!read_u32(reader, &count)) {
+        return NULL;
+    }
+    if (!(object = dyntype_new_object(reader->ctx))) {
+        reader->error = "out of memory";
+        return NULL;
+    }
+    for (i = 0; i < count; i++) {
+        const char *name;
+        dyn_value_t prop;
+        uint32_t len;
+
+        if (!(name = read_string(reader, &len))
+            || !(prop = read_dyn(reader))) {
+            dyntype_release(reader->ctx, object);
+            return NULL;
+        }
+        dyntype_set_property(reader->ctx, object, name, prop);
+        dyntype_release(reader->ctx, prop);
+    }
+    return object;
+}
+
+static dyn_value_t
+read_extref(CloneReader *reader)
+{
+    wasm_function_inst_t alloc_extref_table_slot;
+    uint32_t argv[sizeof(void *) / sizeof(uint32_t)] = { 0 };
+    wasm_obj_t obj = NULL;
+    uint8_t tag;
+
+    if (!read_u8(reader, &tag) || !read_ref(reader, &obj)) {
+        return NULL;
+    }
+
+    /* the extref table keeps the object alive */
+    alloc_extref_table_slot = wasm_runtime_lookup_function(
+        wasm_runtime_get_module_inst(reader->exec_env),
+        "allocExtRefTableSlot");
+    bh_assert(alloc_extref_table_slot);
+    bh_memcpy_s(argv, sizeof(argv), &obj, sizeof(void *));
+    if (!wasm_runtime_call_wasm(reader->exec_env, alloc_extref_table_slot,
+                                sizeof(argv) / sizeof(uint32_t), argv)) {
+        return NULL;
+    }
+    return dyntype_new_extref(reader->ctx, (void *)(uintptr_t)argv[0],
+                              (external_ref_tag)tag, NULL);
+}
+
+static dyn_value_t
+read_dyn(CloneReader *reader)
+{
+    dyn_value_t value = NULL;
+    const char *str;
+    uint32_t len;
+    double number;
+    uint8_t tag;
+
+    if (!read_u8(reader, &tag)) {
+        return NULL;
+    }
+
+    switch (tag) {
+        case CLONE_UNDEFINED:
+            value = dyntype_new_undefined(reader->ctx);
+            break;
+        case CLONE_NULL:
+            value = dyntype_new_null(reader->ctx);
+            break;
+        case CLONE_FALSE:
+        case CLONE_TRUE:
+            value = dyntype_new_boolean(reader->ctx, tag == CLONE_TRUE);
+            break;
+        case CLONE_NUMBER:
+            if (!read_bytes(reader, &number, sizeof(double))) {
+                return NULL;
+            }
+            value = dyntype_new_number(reader->ctx, number);
+            break;
+        case CLONE_STRING:
+            if (!(str = read_string(reader, &len))) {
+                return NULL;
+            }
+            value = new_dyn_string(reader, str, len);
+            break;
+        case CLONE_ARRAY:
+            return read_dyn_array(reader);
+        case CLONE_OBJECT:
+            return read_dyn_object(reader);
+        case CLONE_EXTREF:
+            return read_extref(reader);
+        default:
+            reader->error = "corrupted message";
+            return NULL;
+    }
+
+    if (!value) {
+        reader->error = "out of memory";
+    }
+    return value;
+}
+
+dyn_value_t
+structured_clone_read(wasm_exec_env_t exec_env, dyn_ctx_t ctx,
+                      const StructuredClone *clone)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    CloneReader reader = { 0 };
+    dyn_value_t value = NULL;
+    char error_buf[128];
+
+    reader.exec_env = exec_env;
+    reader.module = wasm_runtime_get_module(module_inst);
+    reader.ctx = ctx;
+    reader.p = clone->data;
+    reader.end = clone->data + clone->size;
+    reader.max_object_count = clone->object_count;
+
+    if (reader.module != clone->module) {
+        reader.error = "the receiver runs another module";
+        goto done;
+    }
+    if (clone->object_count > 0
+        && !(reader.objects = wasm_runtime_malloc(
+                 sizeof(wasm_local_obj_ref_t) * clone->object_count))) {
+        reader.error = "out of memory";
+        goto done;
+    }
+
+    value = read_dyn(&reader);
+
+done:
+    if (reader.object_count > 0) {
+        wasm_runtime_pop_local_obj_refs(exec_env, reader.object_count);
+    }
+    if (reader.objects) {
+        wasm_runtime_free(reader.objects);
+    }
+    if (!value && reader.error) {
+        snprintf(error_buf, sizeof(error_buf), "DataCloneError: %s",
+                 reader.error);
+        wasm_runtime_set_exception(module_inst, error_buf);
+    }
+    return value;
+}
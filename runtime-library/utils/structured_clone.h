@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef __STRUCTURED_CLONE_H_
+#define __STRUCTURED_CLONE_H_
+
+#include "gc_export.h"
+#include "libdyntype.h"
+
+/* A value serialized out of a module instance, to be rebuilt in another
+ * instance of the same module, which may run on another thread with its own
+ * GC heap and dyntype context */
+typedef struct StructuredClone StructuredClone;
+
+/**
+ * @brief Serialize a value
+ *
+ * Dynamic values (primitives, arrays and plain objects) are copied by value.
+ * Static objects and arrays are copied field by field following their wasm
+ * types, the vtable of an object is identified by the Meta it points to.
+ * Sharing and cycles between static objects are preserved. Functions and
+ * closures can't be cloned.
+ *
+ * @param exec_env the exec env of the sender
+ * @param ctx the dyntype context of the sender
+ * @param value the value to serialize
+ * @param transfer_list an array of ArrayBuffers, detached from the sender
+ * once the value is serialized, NULL if none
+ * @return the clone if success, NULL with an exception set otherwise
+ */
+StructuredClone *
+structured_clone_write(wasm_exec_env_t exec_env, dyn_ctx_t ctx,
+                       dyn_value_t value, wasm_struct_obj_t transfer_list);
+
+/**
+ * @brief Rebuild a serialized value
+ *
+ * @param exec_env the exec env of the receiver, its module instance must be
+ * an instance of the module of the sender
+ * @param ctx the dyntype context of the receiver
+ * @param clone the serialized value
+ * @return the value if success, NULL with an exception set otherwise
+ */
+dyn_value_t
+structured_clone_read(wasm_exec_env_t exec_env, dyn_ctx_t ctx,
+                      const StructuredClone *clone);
+
+/**
+ * @brief Free a serialized value, from any thread
+ *
+ * @param clone the serialized value
+ */
+void
+structured_clone_destroy(StructuredClone *clone);
+
+#endif /* end of __STRUCTURED_CLONE_H_ */
@@ -14,6 +14,8 @@
 #include "wamr_utils.h"
 #include "libdyntype_export.h"
 
+/* the word before the meta holds the offset of the class name */
+#define OFFSET_OF_CLASS_NAME -4
 #define OFFSET_OF_TYPE_ID 0
 #define OFFSET_OF_IMPL_ID 4
 #define OFFSET_OF_COUNT 8
@@ -1330,3 +1332,45 @@ get_field_name_from_meta_index(wasm_exec_env_t exec_env, void *meta,
     }
     return NULL;
 }
+
+const char *
+get_field_name_from_field_index(wasm_exec_env_t exec_env, void *meta,
+                                uint32_t field_index)
+{
+    int32 count;
+    void *meta_field;
+    int32 meta_field_name_offset;
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+
+    count = get_meta_fields_count(meta);
+
+    for (int index = 0; index < count; index++) {
+        meta_field = get_meta_field_by_index(meta, index);
+        if (get_meta_field_flag(meta_field) != FIELD
+            || get_meta_field_index(meta_field) != (int32)field_index) {
+            continue;
+        }
+        meta_field_name_offset = get_meta_field_name(meta_field);
+        if (!wasm_runtime_validate_app_str_addr(
+                module_inst, (uint64_t)(uint32_t)meta_field_name_offset)) {
+            return NULL;
+        }
+        return wasm_runtime_addr_app_to_native(module_inst,
+                                               meta_field_name_offset);
+    }
+    return NULL;
+}
+
+const char *
+get_class_name_from_meta(wasm_exec_env_t exec_env, void *meta)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    int32 name_offset = *(int32 *)(meta + OFFSET_OF_CLASS_NAME);
+
+    /* the metas of modules built before the name was added to them */
+    if (!wasm_runtime_validate_app_str_addr(module_inst,
+                                            (uint64_t)(uint32_t)name_offset)) {
+        return NULL;
+    }
+    return wasm_runtime_addr_app_to_native(module_inst, name_offset);
+}
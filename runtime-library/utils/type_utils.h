@@ -273,4 +273,22 @@ const char *
 get_field_name_from_meta_index(wasm_exec_env_t exec_env, void *meta,
                                enum field_flag flag, uint32_t index);
 
+/**
+ * @brief get the name of the field stored at a struct field index
+ * @param meta meta pointer
+ * @param field_index the index of the field in the object struct
+ * @result : return field name if found or return NULL.
+ */
+const char *
+get_field_name_from_field_index(wasm_exec_env_t exec_env, void *meta,
+                                uint32_t field_index);
+
+/**
+ * @brief get the mangled name of the class described by a meta
+ * @param meta meta pointer
+ * @result : return "path|ClassName", or NULL if the meta has no name
+ */
+const char *
+get_class_name_from_meta(wasm_exec_env_t exec_env, void *meta);
+
 #endif /* end of __TYPE_UTILS_H_ */
@@ -12,6 +12,8 @@
 #include "aot_runtime.h"
 #endif
 #include "wasm_runtime_common.h"
+#include "ems/ems_gc.h"
+#include "ems/ems_gc_internal.h"
 
 void *
 wamr_utils_get_table_element(WASMExecEnv *exec_env, uint32_t index)
@@ -40,3 +42,318 @@ wamr_utils_get_table_element(WASMExecEnv *exec_env, uint32_t index)
 
     return NULL;
 }
+
+uint32_t
+wamr_utils_get_table_size(WASMExecEnv *exec_env)
+{
+    WASMModuleInstanceCommon *module_inst =
+        wasm_exec_env_get_module_inst(exec_env);
+
+#if WASM_ENABLE_INTERP != 0
+    if (module_inst->module_type == Wasm_Module_Bytecode) {
+        WASMModuleInstance *wasm_module_inst =
+            (WASMModuleInstance *)module_inst;
+
+        if (wasm_module_inst->table_count == 0) {
+            return 0;
+        }
+        return wasm_module_inst->tables[0]->cur_size;
+    }
+#endif
+#if WASM_ENABLE_AOT != 0
+    if (module_inst->module_type == Wasm_Module_AoT) {
+        WASMModuleInstance *aot_module_inst = (WASMModuleInstance *)module_inst;
+        AOTModule *module = (AOTModule *)aot_module_inst->module;
+        AOTTableInstance *table_inst =
+            (AOTTableInstance *)(aot_module_inst->global_data
+                                 + module->global_data_size);
+
+        if (aot_module_inst->table_count == 0) {
+            return 0;
+        }
+        return table_inst->cur_size;
+    }
+#endif
+
+    return 0;
+}
+
+static void *
+get_gc_heap_handle(wasm_module_inst_t inst)
+{
+    WASMModuleInstanceCommon *module_inst = (WASMModuleInstanceCommon *)inst;
+
+#if WASM_ENABLE_INTERP != 0
+    if (module_inst->module_type == Wasm_Module_Bytecode) {
+        return ((WASMModuleInstance *)module_inst)->e->common.gc_heap_handle;
+    }
+#endif
+#if WASM_ENABLE_AOT != 0
+    if (module_inst->module_type == Wasm_Module_AoT) {
+        AOTModuleInstanceExtra *e =
+            (AOTModuleInstanceExtra *)((AOTModuleInstance *)module_inst)->e;
+        return e->common.gc_heap_handle;
+    }
+#endif
+
+    return NULL;
+}
+
+bool
+wamr_utils_get_gc_heap_stats(wasm_module_inst_t module_inst,
+                             WamrGCHeapStats *stats)
+{
+    void *heap = get_gc_heap_handle(module_inst);
+    uint32 heap_stats[GC_STAT_MAX];
+
+    if (!heap || gc_heap_stats(heap, heap_stats, GC_STAT_MAX) != GC_SUCCESS) {
+        return false;
+    }
+
+    stats->total_size = heap_stats[GC_STAT_TOTAL];
+    stats->free_size = heap_stats[GC_STAT_FREE];
+    stats->highmark_size = heap_stats[GC_STAT_HIGHMARK];
+    stats->gc_count = heap_stats[GC_STAT_COUNT];
+    stats->gc_time = heap_stats[GC_STAT_TIME];
+    return true;
+}
+
+bool
+wamr_utils_set_gc_threshold_factor(wasm_module_inst_t module_inst,
+                                   uint32_t factor)
+{
+    void *heap = get_gc_heap_handle(module_inst);
+
+    return heap && gc_set_threshold_factor(heap, factor) == GC_SUCCESS;
+}
+
+bool
+wamr_utils_traverse_gc_heap(wasm_module_inst_t module_inst, bool collect,
+                            wamr_utils_heap_obj_visitor_t visit,
+                            void *user_data)
+{
+    gc_heap_t *heap = (gc_heap_t *)get_gc_heap_handle(module_inst);
+    hmu_t *hmu, *hmu_end;
+    gc_size_t size;
+    bool ret = true;
+
+    if (!heap) {
+        return false;
+    }
+
+    /* takes the lock of the heap itself */
+    if (collect && gci_gc_heap(heap) != GC_SUCCESS) {
+        return false;
+    }
+
+    os_mutex_lock(&heap->lock);
+    /* the chunks, used or free, tile the heap pool */
+    hmu = (hmu_t *)heap->base_addr;
+    hmu_end = (hmu_t *)(heap->base_addr + heap->current_size);
+    while (hmu < hmu_end) {
+        if ((size = hmu_get_size(hmu)) == 0) {
+            ret = false;
+            break;
+        }
+        if (hmu_get_ut(hmu) == HMU_WO) {
+            visit(hmu_to_obj(hmu), size, user_data);
+        }
+        hmu = (hmu_t *)((gc_uint8 *)hmu + size);
+    }
+    os_mutex_unlock(&heap->lock);
+
+    return ret;
+}
+
+void *
+wamr_utils_find_global_obj(wasm_module_inst_t inst,
+                           wamr_utils_global_obj_match_t match,
+                           void *user_data)
+{
+    WASMModuleInstance *module_inst = (WASMModuleInstance *)inst;
+    void *obj;
+    uint32 i;
+
+#if WASM_ENABLE_INTERP != 0
+    if (module_inst->module_type == Wasm_Module_Bytecode) {
+        for (i = 0; i < module_inst->e->global_count; i++) {
+            WASMGlobalInstance *global = module_inst->e->globals + i;
+
+            if (!wasm_is_type_reftype(global->type)) {
+                continue;
+            }
+            obj = *(void **)(module_inst->global_data + global->data_offset);
+            if (obj && match(obj, user_data)) {
+                return obj;
+            }
+        }
+    }
+#endif
+#if WASM_ENABLE_AOT != 0
+    if (module_inst->module_type == Wasm_Module_AoT) {
+        AOTModule *module = (AOTModule *)module_inst->module;
+
+        /* imported globals aren't created by the module */
+        for (i = 0; i < module->global_count; i++) {
+            AOTGlobal *global = module->globals + i;
+
+            if (!wasm_is_type_reftype(global->type.val_type)) {
+                continue;
+            }
+            obj = *(void **)(module_inst->global_data + global->data_offset);
+            if (obj && match(obj, user_data)) {
+                return obj;
+            }
+        }
+    }
+#endif
+
+    return NULL;
+}
+
+static uint8
+valkind_to_type(wasm_valkind_t kind, uint32 *p_cell_num)
+{
+    switch (kind) {
+        case WASM_I64:
+            *p_cell_num += 2;
+            return VALUE_TYPE_I64;
+        case WASM_F32:
+            *p_cell_num += 1;
+            return VALUE_TYPE_F32;
+        case WASM_F64:
+            *p_cell_num += 2;
+            return VALUE_TYPE_F64;
+        default:
+            *p_cell_num += 1;
+            return VALUE_TYPE_I32;
+    }
+}
+
+void *
+wamr_utils_func_type_new(const wasm_valkind_t *param_types,
+                         uint32_t param_count,
+                         const wasm_valkind_t *result_types,
+                         uint32_t result_count)
+{
+    WASMFuncType *type;
+    uint32 param_cell_num = 0, ret_cell_num = 0, i;
+    size_t size = offsetof(WASMFuncType, types) + param_count + result_count;
+
+    if (!(type = malloc(size))) {
+        return NULL;
+    }
+    memset(type, 0, size);
+#if WASM_ENABLE_GC != 0
+    type->base_type.type_flag = WASM_TYPE_FUNC;
+#endif
+    type->param_count = (uint16)param_count;
+    type->result_count = (uint16)result_count;
+    for (i = 0; i < param_count; i++) {
+        type->types[i] = valkind_to_type(param_types[i], &param_cell_num);
+    }
+    for (i = 0; i < result_count; i++) {
+        type->types[param_count + i] =
+            valkind_to_type(result_types[i], &ret_cell_num);
+    }
+    type->param_cell_num = (uint16)param_cell_num;
+    type->ret_cell_num = (uint16)ret_cell_num;
+    return type;
+}
+
+void
+wamr_utils_func_type_free(void *func_type)
+{
+    free(func_type);
+}
+
+bool
+wamr_utils_invoke_native(wasm_exec_env_t exec_env, void *func_ptr,
+                         void *func_type, void *attachment, uint32_t *argv,
+                         uint32_t argc, uint32_t *ret)
+{
+    /* no signature: the arguments are passed as they are */
+    return wasm_runtime_invoke_native(exec_env, func_ptr,
+                                      (const WASMFuncType *)func_type, NULL,
+                                      attachment, argv, argc, ret);
+}
+
+uint32_t
+wamr_utils_get_caller_func_index(void *exec_env_v)
+{
+    WASMExecEnv *exec_env = (WASMExecEnv *)exec_env_v;
+    WASMModuleInstance *module_inst =
+        (WASMModuleInstance *)wasm_exec_env_get_module_inst(exec_env);
+
+#if WASM_ENABLE_INTERP != 0
+    if (module_inst->module_type == Wasm_Module_Bytecode) {
+        WASMInterpFrame *frame = wasm_exec_env_get_cur_frame(exec_env);
+
+        /* the frame of the native itself, and the dummy frame of the entry
+         * have no wasm function */
+        while (frame
+               && (!frame->function || frame->function->is_import_func)) {
+            frame = frame->prev_frame;
+        }
+        if (frame) {
+            return (uint32)(frame->function - module_inst->e->functions);
+        }
+    }
+#endif
+#if WASM_ENABLE_AOT != 0 && WASM_ENABLE_AOT_STACK_FRAME != 0
+    if (module_inst->module_type == Wasm_Module_AoT) {
+        AOTModule *module = (AOTModule *)module_inst->module;
+        AOTFrame *frame = (AOTFrame *)wasm_exec_env_get_cur_frame(exec_env);
+
+        while (frame && frame->func_index < module->import_func_count) {
+            frame = frame->prev_frame;
+        }
+        if (frame) {
+            return frame->func_index;
+        }
+    }
+#endif
+
+    return UINT32_MAX;
+}
+
+uint32_t
+wamr_utils_get_call_stack(void *exec_env_v, WamrUtilsFrame *frames,
+                          uint32_t max_frames)
+{
+    WASMExecEnv *exec_env = (WASMExecEnv *)exec_env_v;
+    WASMModuleInstance *module_inst =
+        (WASMModuleInstance *)wasm_exec_env_get_module_inst(exec_env);
+    uint32_t count = 0;
+
+#if WASM_ENABLE_INTERP != 0
+    if (module_inst->module_type == Wasm_Module_Bytecode) {
+        WASMInterpFrame *frame = wasm_exec_env_get_cur_frame(exec_env);
+
+        for (; frame && count < max_frames; frame = frame->prev_frame) {
+            /* the dummy frame of the entry */
+            if (!frame->function) {
+                continue;
+            }
+            frames[count].func_index =
+                (uint32)(frame->function - module_inst->e->functions);
+            frames[count].ip =
+                frame->function->is_import_func ? NULL : frame->ip;
+            count++;
+        }
+    }
+#endif
+#if WASM_ENABLE_AOT != 0 && WASM_ENABLE_AOT_STACK_FRAME != 0
+    if (module_inst->module_type == Wasm_Module_AoT) {
+        AOTFrame *frame = (AOTFrame *)wasm_exec_env_get_cur_frame(exec_env);
+
+        for (; frame && count < max_frames; frame = frame->prev_frame) {
+            frames[count].func_index = frame->func_index;
+            frames[count].ip = NULL;
+            count++;
+        }
+    }
+#endif
+
+    return count;
+}
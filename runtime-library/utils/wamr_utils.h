@@ -15,3 +15,168 @@
  */
 void *
 wamr_utils_get_table_element(wasm_exec_env_t exec_env, uint32_t index);
+
+/**
+ * @brief Get the number of elements of the wasm table
+ *
+ * @param exec_env wasm execution environment
+ *
+ * @return the current size of the table, 0 if the module has no table
+ */
+uint32_t
+wamr_utils_get_table_size(wasm_exec_env_t exec_env);
+
+/* Statistics of the GC heap of a module instance */
+typedef struct WamrGCHeapStats {
+    /* size of the heap pool */
+    uint32_t total_size;
+    uint32_t free_size;
+    /* the most bytes ever in use */
+    uint32_t highmark_size;
+    uint32_t gc_count;
+    /* total time spent in collections, in ms */
+    uint32_t gc_time;
+} WamrGCHeapStats;
+
+/**
+ * @brief Get the statistics of the GC heap of a module instance
+ *
+ * @param module_inst the module instance
+ * @param stats receives the statistics
+ *
+ * @return true if success, false otherwise
+ */
+bool
+wamr_utils_get_gc_heap_stats(wasm_module_inst_t module_inst,
+                             WamrGCHeapStats *stats);
+
+/**
+ * @brief Set when the GC heap of a module instance is collected: a
+ * collection is triggered once the free size drops below
+ * free size after the last collection * factor / 1000
+ *
+ * @param module_inst the module instance
+ * @param factor the threshold factor, in [0, 1000]
+ *
+ * @return true if success, false otherwise
+ */
+bool
+wamr_utils_set_gc_threshold_factor(wasm_module_inst_t module_inst,
+                                   uint32_t factor);
+
+/* Return true to stop the search at obj */
+typedef bool (*wamr_utils_global_obj_match_t)(void *obj, void *user_data);
+
+/**
+ * @brief Find a GC object referenced by a global of a module instance
+ *
+ * @param module_inst the module instance
+ * @param match called with every non-null reference of the globals
+ * @param user_data passed to match
+ *
+ * @return the first object matched, NULL if none
+ */
+void *
+wamr_utils_find_global_obj(wasm_module_inst_t module_inst,
+                           wamr_utils_global_obj_match_t match,
+                           void *user_data);
+
+/* Called with every wasm object of the GC heap and the size of its chunk */
+typedef void (*wamr_utils_heap_obj_visitor_t)(void *obj, uint32_t size,
+                                              void *user_data);
+
+/**
+ * @brief Visit the objects allocated for wasm in the GC heap of a module
+ * instance, in the order of their addresses
+ *
+ * The heap is locked while visiting, visit must not allocate GC objects.
+ *
+ * @param module_inst the module instance
+ * @param collect collect the garbage first, so that only the reachable
+ * objects are visited
+ * @param visit called with every object
+ * @param user_data passed to visit
+ *
+ * @return true if success, false otherwise
+ */
+bool
+wamr_utils_traverse_gc_heap(wasm_module_inst_t module_inst, bool collect,
+                            wamr_utils_heap_obj_visitor_t visit,
+                            void *user_data);
+
+/**
+ * @brief Create a function type for wamr_utils_invoke_native
+ *
+ * @param param_types the kinds of the params
+ * @param param_count the number of params
+ * @param result_types the kinds of the results
+ * @param result_count the number of results, 0 or 1
+ *
+ * @return the function type, NULL if out of memory, free it with
+ * wamr_utils_func_type_free
+ */
+void *
+wamr_utils_func_type_new(const wasm_valkind_t *param_types,
+                         uint32_t param_count,
+                         const wasm_valkind_t *result_types,
+                         uint32_t result_count);
+
+void
+wamr_utils_func_type_free(void *func_type);
+
+/**
+ * @brief Call a native function the way the runtime calls a registered
+ * native, without converting app addresses
+ *
+ * @param exec_env the execution environment, passed as the first argument
+ * @param func_ptr the native function
+ * @param func_type the type of the function without exec_env, see
+ * wamr_utils_func_type_new
+ * @param attachment the attachment seen by the function
+ * @param argv the arguments in cells, i64 and f64 take two of them
+ * @param argc the number of cells of argv
+ * @param ret receives the result, two cells for i64 and f64
+ *
+ * @return true if success, false otherwise
+ */
+bool
+wamr_utils_invoke_native(wasm_exec_env_t exec_env, void *func_ptr,
+                         void *func_type, void *attachment, uint32_t *argv,
+                         uint32_t argc, uint32_t *ret);
+
+/**
+ * @brief Get the wasm function calling the native running on exec_env, the
+ * frames of imported functions are skipped
+ *
+ * @param exec_env the execution environment
+ *
+ * @return the function index, UINT32_MAX if no wasm function is running or
+ * the frames aren't kept, e.g. AOT without stack frames
+ */
+uint32_t
+wamr_utils_get_caller_func_index(void *exec_env);
+
+/* A frame of the wasm call stack */
+typedef struct WamrUtilsFrame {
+    uint32_t func_index;
+    /* the next instruction of the frame, NULL if unknown, e.g. for AOT and
+     * imported functions */
+    const uint8_t *ip;
+} WamrUtilsFrame;
+
+/**
+ * @brief Get the wasm call stack of exec_env, innermost frame first
+ *
+ * Only reads the frames, so it can be called from a signal handler that
+ * interrupted the thread running exec_env.
+ *
+ * @param exec_env the execution environment
+ * @param frames receives the frames
+ * @param max_frames the size of frames, deeper frames are left out
+ *
+ * @return the number of frames stored, 0 if the frames aren't kept, e.g. AOT
+ * without stack frames
+ */
+uint32_t
+wamr_utils_get_call_stack(void *exec_env, WamrUtilsFrame *frames,
+                          uint32_t max_frames);
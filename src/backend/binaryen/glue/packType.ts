@@ -19,6 +19,16 @@ import {
     dataViewType,
     numberArrayStructType,
     i32ArrayType,
+    f32ArrayType,
+    i16ArrayType,
+    float64ArrayType,
+    float32ArrayType,
+    int32ArrayType,
+    uint32ArrayType,
+    int16ArrayType,
+    uint8ArrayType,
+    uint8ClampedArrayType,
+    regExpType,
 } from './transform.js';
 import { typeInfo } from './utils.js';
 
@@ -37,3 +47,13 @@ export const infcTypeInfo = infcType;
 export const arrayBufferTypeInfo = arrayBufferType;
 export const dataViewTypeInfo = dataViewType;
 export const numberArrayStructTypeInfo = numberArrayStructType;
+export const f32ArrayTypeInfo = f32ArrayType;
+export const i16ArrayTypeInfo = i16ArrayType;
+export const float64ArrayTypeInfo = float64ArrayType;
+export const float32ArrayTypeInfo = float32ArrayType;
+export const int32ArrayTypeInfo = int32ArrayType;
+export const uint32ArrayTypeInfo = uint32ArrayType;
+export const int16ArrayTypeInfo = int16ArrayType;
+export const uint8ArrayTypeInfo = uint8ArrayType;
+export const uint8ClampedArrayTypeInfo = uint8ClampedArrayType;
+export const regExpTypeInfo = regExpType;
@@ -20,6 +20,7 @@ export namespace StringRefNewOp {
     export const WTF16 = 3;
     export const UTF8FromArray = 4;
     export const WTF8FromArray = 5;
+    export const WTF16FromArray = 7;
 }
 
 export namespace StringRefMeatureOp {
@@ -244,6 +245,10 @@ export const i8ArrayType = genarateI8ArrayTypeInfo();
 export const numberArrayType = genarateNumberArrayTypeInfo();
 /* array(i32) */
 export const i32ArrayType = genarateI32ArrayTypeInfo();
+/* array(f32) */
+export const f32ArrayType = genarateF32ArrayTypeInfo();
+/* array(i16) */
+export const i16ArrayType = genarateI16ArrayTypeInfo();
 /* array(stringref) */
 export const stringrefArrayType = genarateStringrefArrayTypeInfo(false);
 /* array(i32) */
@@ -273,6 +278,18 @@ export const dataViewType = generateDataViewTypeInfo();
 /* struct(array(f64), i32) */
 export const numberArrayStructType =
     generateArrayStructTypeInfo(numberArrayType);
+/* typed arrays: struct(array(elem), length: i32, byteOffset: i32), kinds
+    sharing the element array are distinct types of one rec group */
+export const [float64ArrayType] = generateTypedArrayTypeInfo(numberArrayType);
+export const [float32ArrayType] = generateTypedArrayTypeInfo(f32ArrayType);
+export const [int32ArrayType, uint32ArrayType] =
+    generateTypedArrayTypeInfo(i32ArrayType, 2);
+export const [int16ArrayType] = generateTypedArrayTypeInfo(i16ArrayType);
+export const [uint8ArrayType, uint8ClampedArrayType] =
+    generateTypedArrayTypeInfo(i8ArrayType, 2);
+/* struct(source, flags, global, sticky, lastIndex: f64, pattern_id: i32,
+    capture_count: i32) */
+export const regExpType = generateRegExpTypeInfo();
 
 export function generateArrayStructTypeInfo(arrayTypeInfo: typeInfo): typeInfo {
     const arrayStructTypeInfo = initStructType(
@@ -370,6 +387,32 @@ function genarateI32ArrayTypeInfo(): typeInfo {
     return i32ArrayTypeInfo;
 }
 
+// generate f32 array type
+function genarateF32ArrayTypeInfo(): typeInfo {
+    const f32ArrayTypeInfo = initArrayType(
+        binaryen.f32,
+        Packed.Not,
+        true,
+        true,
+        -1,
+        binaryenCAPI._TypeBuilderCreate(1),
+    );
+    return f32ArrayTypeInfo;
+}
+
+// generate i16 array type
+function genarateI16ArrayTypeInfo(): typeInfo {
+    const i16ArrayTypeInfo = initArrayType(
+        binaryen.i32,
+        Packed.I16,
+        true,
+        true,
+        -1,
+        binaryenCAPI._TypeBuilderCreate(1),
+    );
+    return i16ArrayTypeInfo;
+}
+
 // generate string array type
 function genarateStringArrayTypeInfo(struct_wrap: boolean): typeInfo {
     const stringTypeInfo = stringType;
@@ -456,6 +499,79 @@ function generateDataViewTypeInfo(): typeInfo {
     return dataViewTypeInfo;
 }
 
+/* the types of one call have the same fields, they are put in a rec group
+    so that casts and instanceof can still tell them apart */
+function generateTypedArrayTypeInfo(
+    arrayTypeInfo: typeInfo,
+    count = 1,
+): typeInfo[] {
+    const tb = binaryenCAPI._TypeBuilderCreate(count);
+    for (let i = 0; i < count; i++) {
+        initStructType(
+            [
+                binaryenCAPI._BinaryenTypeFromHeapType(
+                    arrayTypeInfo.heapTypeRef,
+                    true,
+                ),
+                binaryen.i32,
+                binaryen.i32,
+            ],
+            [Packed.Not, Packed.Not, Packed.Not],
+            [true, true, true],
+            3,
+            true,
+            i,
+            tb,
+        );
+    }
+    if (count > 1) {
+        binaryenCAPI._TypeBuilderCreateRecGroup(tb, 0, count);
+    }
+    const builtHeapType: binaryenCAPI.HeapTypeRef[] = new Array(count);
+    const builtHeapTypePtr = arrayToPtr(builtHeapType);
+    binaryenCAPI._TypeBuilderBuildAndDispose(tb, builtHeapTypePtr.ptr, 0, 0);
+    return ptrToArray(builtHeapTypePtr).map((heapType) => {
+        const typeRef = binaryenCAPI._BinaryenTypeFromHeapType(heapType, true);
+        return {
+            typeRef: typeRef,
+            heapTypeRef: binaryenCAPI._BinaryenTypeGetHeapType(typeRef),
+        };
+    });
+}
+
+function generateRegExpTypeInfo(): typeInfo {
+    const stringTypeRef = binaryenCAPI._BinaryenTypeFromHeapType(
+        stringType.heapTypeRef,
+        true,
+    );
+    const regExpTypeInfo = initStructType(
+        [
+            stringTypeRef,
+            stringTypeRef,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.f64,
+            binaryen.i32,
+            binaryen.i32,
+        ],
+        [
+            Packed.Not,
+            Packed.Not,
+            Packed.Not,
+            Packed.Not,
+            Packed.Not,
+            Packed.Not,
+            Packed.Not,
+        ],
+        [true, true, true, true, true, true, true],
+        7,
+        true,
+        -1,
+        binaryenCAPI._TypeBuilderCreate(1),
+    );
+    return regExpTypeInfo;
+}
+
 export function createSignatureTypeRefAndHeapTypeRef(
     parameterTypes: Array<binaryenCAPI.TypeRef>,
     returnType: binaryenCAPI.TypeRef,
@@ -354,6 +354,13 @@ export class WASMGen extends Ts2wasmBackend {
         this._binaryenModule.setFeatures(binaryen.Features.All);
         this._binaryenModule.autoDrop();
 
+        if (!getConfig().keepUnusedBuiltins) {
+            /* builtins and lib API imports are generated for every module,
+                only keep those reachable from exports, the start function
+                and table elements, also when no optimization is requested */
+            this._binaryenModule.runPasses(['remove-unused-module-elements']);
+        }
+
         if (getConfig().opt > 0) {
             binaryenCAPI._BinaryenSetOptimizeLevel(getConfig().opt);
             binaryenCAPI._BinaryenSetShrinkLevel(0);
@@ -532,6 +539,38 @@ export class WASMGen extends Ts2wasmBackend {
 
         /** declare functions */
         if ((func.ownKind & FunctionOwnKind.DECLARE) !== 0) {
+            const builtinFuncName = BuiltinNames.builtinDeclaredFuncs.get(
+                func.name,
+            );
+            if (builtinFuncName) {
+                /* implemented by the builtin, e.g. parseFloat is
+                    Number.parseFloat */
+                const builtinArgs = [this.emptyRef, this.emptyRef];
+                for (
+                    let i = BuiltinNames.envParamLen;
+                    i < paramWASMTypes.length;
+                    i++
+                ) {
+                    builtinArgs.push(
+                        this.module.local.get(i, paramWASMTypes[i]),
+                    );
+                }
+                this.module.addFunction(
+                    func.name,
+                    binaryen.createType(paramWASMTypes),
+                    returnWASMType,
+                    [],
+                    this.module.call(
+                        UtilFuncs.getFuncName(
+                            BuiltinNames.builtinModuleName,
+                            builtinFuncName,
+                        ),
+                        builtinArgs,
+                        returnWASMType,
+                    ),
+                );
+                return;
+            }
             let skipEnvParamLen = BuiltinNames.envParamLen;
             if ((func.ownKind & FunctionOwnKind.METHOD) !== 0) {
                 /* For method, just skip the @context */
@@ -1058,6 +1097,8 @@ export class WASMGen extends Ts2wasmBackend {
         const members = objType.meta.members;
         let dataLength = members.length;
         dataLength += members.filter((m) => m.hasSetter && m.hasGetter).length;
+        /* the class name precedes the meta, see MetaDataOffset */
+        const namePointer = this.generateRawString(objType.meta.name);
         const buffer = new Uint32Array(3 + 3 * dataLength);
         buffer[0] = objType.typeId;
         buffer[1] = objType.implId;
@@ -1115,6 +1156,9 @@ export class WASMGen extends Ts2wasmBackend {
                 }
             }
         }
+        this.dataSegmentContext!.addData(
+            new Uint8Array(new Uint32Array([namePointer]).buffer),
+        );
         const offset = this.dataSegmentContext!.addData(
             new Uint8Array(buffer.buffer),
         );
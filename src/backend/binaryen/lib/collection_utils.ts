@@ -0,0 +1,1687 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* Map and Set with number, string or object keys are compiled to wasm
+    structs instead of falling back to libdyntype. The table keeps the
+    entries in insertion order (hashes/keys/values arrays, a deleted entry
+    has hash -1), and an open addressing index (linear probing) maps a hash
+    slot to the entry, -1 means empty. Deleted entries keep their index slot
+    until the next rehash compacts the entries.
+
+    The methods are generated for every specialization when they are called
+    the first time, so keys and values are stored with their own wasm types
+    and never boxed to any. */
+
+import binaryen from 'binaryen';
+import * as binaryenCAPI from '../glue/binaryen.js';
+import { BuiltinNames } from '../../../../lib/builtin/builtin_name.js';
+import {
+    arrayToPtr,
+    emptyStructType,
+    initArrayType,
+    initStructType,
+    Packed,
+} from '../glue/transform.js';
+import { i32ArrayTypeInfo, i8ArrayTypeInfo } from '../glue/packType.js';
+import { typeInfo } from '../glue/utils.js';
+import { FunctionalFuncs, UtilFuncs } from '../utils.js';
+import { SemanticsKind } from '../../../semantics/semantics_nodes.js';
+import {
+    EnumType,
+    ValueType,
+    ValueTypeKind,
+} from '../../../semantics/value_types.js';
+import { dyntype } from './dyntype/utils.js';
+
+export interface CollectionTypeInfo {
+    name: string;
+    /* e.g. <number_1,string_2>, used to name the specialized methods */
+    signature: string;
+    keyKind: ValueTypeKind;
+    keyTypeRef: binaryen.Type;
+    keyArrayTypeInfo: typeInfo;
+    /* binaryen.none for Set */
+    valueTypeRef: binaryen.Type;
+    valueArrayTypeInfo?: typeInfo;
+    /* get() of a missing key returns undefined instead of a zero value */
+    isDynValue: boolean;
+    /* used to box the values when converted to any */
+    valueKind: ValueTypeKind;
+    /* Map values which are static collections themselves, set by the type
+        generator */
+    valueCollectionInfo?: CollectionTypeInfo;
+    structTypeInfo: typeInfo;
+}
+
+/* result types of keys/values/entries, provided by the call site */
+export interface CollectionArrayInfo {
+    structTypeInfo: typeInfo;
+    arrayTypeInfo: typeInfo;
+    elemTypeRef: binaryen.Type;
+    /* the [key, value] tuple of entries() */
+    entryTypeInfo?: typeInfo;
+}
+
+/* offsets of the raw strings used to create the dynamic Map or Set when a
+    static one is converted to any */
+export interface CollectionDynNames {
+    map: number;
+    set: number;
+    setMethod: number;
+    addMethod: number;
+}
+
+/* locals of the function iterating the entries, see forEachEntry */
+export interface CollectionLoopLocals {
+    hashes_idx: number;
+    keys_idx: number;
+    /* -1 for Set */
+    values_idx: number;
+    used_idx: number;
+    i_idx: number;
+}
+
+const enum CollectionField {
+    SIZE = 0,
+    USED,
+    INDEX,
+    HASHES,
+    KEYS,
+    VALUES,
+}
+
+const INITIAL_CAPACITY = 8;
+const DELETED_HASH = -1;
+const EMPTY_SLOT = -1;
+
+const collectionTypeInfos = new Map<string, CollectionTypeInfo>();
+
+function getTypeSignature(type: ValueType, typeRef: binaryen.Type) {
+    return `${ValueTypeKind[type.kind].toLowerCase()}_${typeRef}`;
+}
+
+export function getCollectionTypeInfo(
+    name: string,
+    keyType: ValueType,
+    keyTypeRef: binaryen.Type,
+    valueType?: ValueType,
+    valueTypeRef?: binaryen.Type,
+): CollectionTypeInfo {
+    let signature = getTypeSignature(keyType, keyTypeRef);
+    if (valueType) {
+        signature += `,${getTypeSignature(valueType, valueTypeRef!)}`;
+    }
+    signature = `<${signature}>`;
+    const cached = collectionTypeInfos.get(name + signature);
+    if (cached) {
+        return cached;
+    }
+
+    const keyArrayTypeInfo = initArrayType(
+        keyTypeRef,
+        Packed.Not,
+        true,
+        true,
+        -1,
+        binaryenCAPI._TypeBuilderCreate(1),
+    );
+    const fieldTypes = [
+        binaryen.i32,
+        binaryen.i32,
+        i32ArrayTypeInfo.typeRef,
+        i32ArrayTypeInfo.typeRef,
+        keyArrayTypeInfo.typeRef,
+    ];
+    let valueArrayTypeInfo: typeInfo | undefined = undefined;
+    if (valueType) {
+        valueArrayTypeInfo = initArrayType(
+            valueTypeRef!,
+            Packed.Not,
+            true,
+            true,
+            -1,
+            binaryenCAPI._TypeBuilderCreate(1),
+        );
+        fieldTypes.push(valueArrayTypeInfo.typeRef);
+    }
+    const structTypeInfo = initStructType(
+        fieldTypes,
+        new Array<binaryenCAPI.PackedType>(fieldTypes.length).fill(
+            Packed.Not,
+        ),
+        new Array<boolean>(fieldTypes.length).fill(true),
+        fieldTypes.length,
+        true,
+        -1,
+        binaryenCAPI._TypeBuilderCreate(1),
+    );
+
+    const info: CollectionTypeInfo = {
+        name: name,
+        signature: signature,
+        keyKind:
+            keyType.kind == ValueTypeKind.RAW_STRING
+                ? ValueTypeKind.STRING
+                : keyType.kind,
+        keyTypeRef: keyTypeRef,
+        keyArrayTypeInfo: keyArrayTypeInfo,
+        valueTypeRef: valueType ? valueTypeRef! : binaryen.none,
+        valueArrayTypeInfo: valueArrayTypeInfo,
+        isDynValue:
+            !!valueType &&
+            (valueType.kind == ValueTypeKind.ANY ||
+                valueType.kind == ValueTypeKind.UNION),
+        valueKind: !valueType
+            ? ValueTypeKind.VOID
+            : valueType instanceof EnumType
+            ? valueType.memberType.kind
+            : valueType.kind,
+        structTypeInfo: structTypeInfo,
+    };
+    collectionTypeInfos.set(name + signature, info);
+    return info;
+}
+
+function getZeroValue(module: binaryen.Module, typeRef: binaryen.Type) {
+    switch (typeRef) {
+        case binaryen.i32:
+            return module.i32.const(0);
+        case binaryen.i64:
+            return module.i64.const(0, 0);
+        case binaryen.f32:
+            return module.f32.const(0);
+        case binaryen.f64:
+            return module.f64.const(0);
+        default:
+            return binaryenCAPI._BinaryenRefNull(module.ptr, typeRef);
+    }
+}
+
+function getField(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+    ref: binaryen.ExpressionRef,
+    field: CollectionField,
+) {
+    let fieldTypeRef: binaryen.Type = binaryen.i32;
+    switch (field) {
+        case CollectionField.INDEX:
+        case CollectionField.HASHES:
+            fieldTypeRef = i32ArrayTypeInfo.typeRef;
+            break;
+        case CollectionField.KEYS:
+            fieldTypeRef = info.keyArrayTypeInfo.typeRef;
+            break;
+        case CollectionField.VALUES:
+            fieldTypeRef = info.valueArrayTypeInfo!.typeRef;
+            break;
+    }
+    return binaryenCAPI._BinaryenStructGet(
+        module.ptr,
+        field,
+        ref,
+        fieldTypeRef,
+        false,
+    );
+}
+
+function setField(
+    module: binaryen.Module,
+    ref: binaryen.ExpressionRef,
+    field: CollectionField,
+    value: binaryen.ExpressionRef,
+) {
+    return binaryenCAPI._BinaryenStructSet(module.ptr, field, ref, value);
+}
+
+function newI32Array(
+    module: binaryen.Module,
+    length: binaryen.ExpressionRef,
+    init: number,
+) {
+    return binaryenCAPI._BinaryenArrayNew(
+        module.ptr,
+        i32ArrayTypeInfo.heapTypeRef,
+        length,
+        module.i32.const(init),
+    );
+}
+
+function newEntryArray(
+    module: binaryen.Module,
+    arrayTypeInfo: typeInfo,
+    elemTypeRef: binaryen.Type,
+    length: binaryen.ExpressionRef,
+) {
+    return binaryenCAPI._BinaryenArrayNew(
+        module.ptr,
+        arrayTypeInfo.heapTypeRef,
+        length,
+        getZeroValue(module, elemTypeRef),
+    );
+}
+
+function arrayGet(
+    module: binaryen.Module,
+    arrayRef: binaryen.ExpressionRef,
+    index: binaryen.ExpressionRef,
+    elemTypeRef: binaryen.Type,
+) {
+    return binaryenCAPI._BinaryenArrayGet(
+        module.ptr,
+        arrayRef,
+        index,
+        elemTypeRef,
+        false,
+    );
+}
+
+function arraySet(
+    module: binaryen.Module,
+    arrayRef: binaryen.ExpressionRef,
+    index: binaryen.ExpressionRef,
+    value: binaryen.ExpressionRef,
+) {
+    return binaryenCAPI._BinaryenArraySet(module.ptr, arrayRef, index, value);
+}
+
+function forLoop(
+    module: binaryen.Module,
+    label: string,
+    index_idx: number,
+    end: binaryen.ExpressionRef,
+    statements: binaryen.ExpressionRef,
+) {
+    const index = module.local.get(index_idx, binaryen.i32);
+    return module.block(null, [
+        module.local.set(index_idx, module.i32.const(0)),
+        module.loop(
+            label,
+            FunctionalFuncs.flattenLoopStatement(
+                module,
+                {
+                    label: label,
+                    condition: module.i32.lt_s(index, end),
+                    statements: statements,
+                    incrementor: module.local.set(
+                        index_idx,
+                        module.i32.add(index, module.i32.const(1)),
+                    ),
+                },
+                SemanticsKind.FOR,
+            ),
+        ),
+    ]);
+}
+
+/* fibonacci hashing to spread the bits, the result is never negative so
+    it can't be mistaken for DELETED_HASH */
+function mixHash(module: binaryen.Module, hash: binaryen.ExpressionRef) {
+    return module.i32.and(
+        module.i32.mul(hash, module.i32.const(0x9e3779b1 | 0)),
+        module.i32.const(0x7fffffff),
+    );
+}
+
+function getHashFuncName(info: CollectionTypeInfo) {
+    switch (info.keyKind) {
+        case ValueTypeKind.NUMBER:
+            return UtilFuncs.getFuncName(
+                BuiltinNames.builtinModuleName,
+                BuiltinNames.collectionHashNumberFuncName,
+            );
+        case ValueTypeKind.STRING:
+            return UtilFuncs.getFuncName(
+                BuiltinNames.builtinModuleName,
+                BuiltinNames.collectionHashStringFuncName,
+            );
+        default:
+            return BuiltinNames.collectionHashRefFuncName;
+    }
+}
+
+function collection_hashNumber(module: binaryen.Module) {
+    /* params */
+    const key_idx = 0;
+    /* vars */
+    const bits_i64_idx = 1;
+
+    const key = module.local.get(key_idx, binaryen.f64);
+    const bits = module.local.get(bits_i64_idx, binaryen.i64);
+    return module.block(null, [
+        /* SameValueZero: every NaN is the same key */
+        module.if(
+            module.f64.ne(key, key),
+            module.return(module.i32.const(0x7ff80000)),
+        ),
+        /* -0 + 0 is +0 */
+        module.local.set(
+            bits_i64_idx,
+            module.i64.reinterpret(module.f64.add(key, module.f64.const(0))),
+        ),
+        module.return(
+            mixHash(
+                module,
+                module.i32.wrap(
+                    module.i64.xor(
+                        bits,
+                        module.i64.shr_u(bits, module.i64.const(32, 0)),
+                    ),
+                ),
+            ),
+        ),
+    ]);
+}
+
+function collection_hashString(
+    module: binaryen.Module,
+    keyTypeRef: binaryen.Type,
+) {
+    /* params */
+    const key_idx = 0;
+    /* vars */
+    const data_idx = 1;
+    const length_i32_idx = 2;
+    const i_idx = 3;
+    const hash_idx = 4;
+
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const hash = module.local.get(hash_idx, binaryen.i32);
+    /* FNV-1a over the utf8 bytes */
+    return module.block(null, [
+        module.local.set(
+            data_idx,
+            binaryenCAPI._BinaryenStructGet(
+                module.ptr,
+                1,
+                module.local.get(key_idx, keyTypeRef),
+                i8ArrayTypeInfo.typeRef,
+                false,
+            ),
+        ),
+        module.local.set(
+            length_i32_idx,
+            binaryenCAPI._BinaryenArrayLen(module.ptr, data),
+        ),
+        module.local.set(hash_idx, module.i32.const(0x811c9dc5 | 0)),
+        forLoop(
+            module,
+            'hash_loop',
+            i_idx,
+            module.local.get(length_i32_idx, binaryen.i32),
+            module.local.set(
+                hash_idx,
+                module.i32.mul(
+                    module.i32.xor(
+                        hash,
+                        arrayGet(
+                            module,
+                            data,
+                            module.local.get(i_idx, binaryen.i32),
+                            i8ArrayTypeInfo.typeRef,
+                        ),
+                    ),
+                    module.i32.const(0x01000193),
+                ),
+            ),
+        ),
+        module.return(mixHash(module, hash)),
+    ]);
+}
+
+/* SameValueZero of two keys held in locals */
+function keyEquals(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+    left_idx: number,
+    right_idx: number,
+) {
+    const left = module.local.get(left_idx, info.keyTypeRef);
+    const right = module.local.get(right_idx, info.keyTypeRef);
+    switch (info.keyKind) {
+        case ValueTypeKind.NUMBER:
+            return module.i32.or(
+                module.f64.eq(left, right),
+                module.i32.and(
+                    module.f64.ne(left, left),
+                    module.f64.ne(right, right),
+                ),
+            );
+        case ValueTypeKind.STRING:
+            return module.call(
+                UtilFuncs.getFuncName(
+                    BuiltinNames.builtinModuleName,
+                    BuiltinNames.stringEQFuncName,
+                ),
+                [left, right],
+                binaryen.i32,
+            );
+        default:
+            return binaryenCAPI._BinaryenRefEq(module.ptr, left, right);
+    }
+}
+
+function getMethodName(info: CollectionTypeInfo, method: string) {
+    return UtilFuncs.getBuiltinClassMethodName(
+        info.name,
+        method + info.signature,
+    );
+}
+
+function callHash(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+    key: binaryen.ExpressionRef,
+) {
+    return module.call(getHashFuncName(info), [key], binaryen.i32);
+}
+
+function callFind(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+    self: binaryen.ExpressionRef,
+    key: binaryen.ExpressionRef,
+    hash: binaryen.ExpressionRef,
+) {
+    return module.call(
+        getMethodName(info, 'find'),
+        [self, key, hash],
+        binaryen.i32,
+    );
+}
+
+function castThis(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+    this_idx: number,
+    self_idx: number,
+) {
+    return module.local.set(
+        self_idx,
+        binaryenCAPI._BinaryenRefCast(
+            module.ptr,
+            module.local.get(this_idx, emptyStructType.typeRef),
+            info.structTypeInfo.typeRef,
+        ),
+    );
+}
+
+/* (self, key, hash) => entry index or -1 */
+function collection_find(module: binaryen.Module, info: CollectionTypeInfo) {
+    /* params */
+    const self_idx = 0;
+    const key_idx = 1;
+    const hash_idx = 2;
+    /* vars */
+    const index_idx = 3;
+    const mask_idx = 4;
+    const slot_idx = 5;
+    const entry_idx = 6;
+    const entry_key_idx = 7;
+
+    const self = module.local.get(self_idx, info.structTypeInfo.typeRef);
+    const index = module.local.get(index_idx, i32ArrayTypeInfo.typeRef);
+    const slot = module.local.get(slot_idx, binaryen.i32);
+    const entry = module.local.get(entry_idx, binaryen.i32);
+
+    const probeLabel = 'probe_loop';
+    return module.block(null, [
+        module.local.set(
+            index_idx,
+            getField(module, info, self, CollectionField.INDEX),
+        ),
+        module.local.set(
+            mask_idx,
+            module.i32.sub(
+                binaryenCAPI._BinaryenArrayLen(module.ptr, index),
+                module.i32.const(1),
+            ),
+        ),
+        module.local.set(
+            slot_idx,
+            module.i32.and(
+                module.local.get(hash_idx, binaryen.i32),
+                module.local.get(mask_idx, binaryen.i32),
+            ),
+        ),
+        module.loop(
+            probeLabel,
+            module.block(null, [
+                module.local.set(
+                    entry_idx,
+                    arrayGet(module, index, slot, binaryen.i32),
+                ),
+                module.if(
+                    module.i32.eq(entry, module.i32.const(EMPTY_SLOT)),
+                    module.return(module.i32.const(-1)),
+                ),
+                /* deleted entries have DELETED_HASH and never match */
+                module.if(
+                    module.i32.eq(
+                        arrayGet(
+                            module,
+                            getField(
+                                module,
+                                info,
+                                self,
+                                CollectionField.HASHES,
+                            ),
+                            entry,
+                            binaryen.i32,
+                        ),
+                        module.local.get(hash_idx, binaryen.i32),
+                    ),
+                    module.block(null, [
+                        module.local.set(
+                            entry_key_idx,
+                            arrayGet(
+                                module,
+                                getField(
+                                    module,
+                                    info,
+                                    self,
+                                    CollectionField.KEYS,
+                                ),
+                                entry,
+                                info.keyTypeRef,
+                            ),
+                        ),
+                        module.if(
+                            keyEquals(module, info, entry_key_idx, key_idx),
+                            module.return(entry),
+                        ),
+                    ]),
+                ),
+                module.local.set(
+                    slot_idx,
+                    module.i32.and(
+                        module.i32.add(slot, module.i32.const(1)),
+                        module.local.get(mask_idx, binaryen.i32),
+                    ),
+                ),
+                module.br(probeLabel),
+            ]),
+        ),
+        module.unreachable(),
+    ]);
+}
+
+/* put the entry into the first empty slot of the index */
+function insertIndex(
+    module: binaryen.Module,
+    index_idx: number,
+    mask_idx: number,
+    slot_idx: number,
+    hash: binaryen.ExpressionRef,
+    entry: binaryen.ExpressionRef,
+) {
+    const index = module.local.get(index_idx, i32ArrayTypeInfo.typeRef);
+    const mask = module.local.get(mask_idx, binaryen.i32);
+    const slot = module.local.get(slot_idx, binaryen.i32);
+    const probeLabel = 'insert_probe_loop';
+    return module.block(null, [
+        module.local.set(slot_idx, module.i32.and(hash, mask)),
+        module.loop(
+            probeLabel,
+            module.if(
+                module.i32.ne(
+                    arrayGet(module, index, slot, binaryen.i32),
+                    module.i32.const(EMPTY_SLOT),
+                ),
+                module.block(null, [
+                    module.local.set(
+                        slot_idx,
+                        module.i32.and(
+                            module.i32.add(slot, module.i32.const(1)),
+                            mask,
+                        ),
+                    ),
+                    module.br(probeLabel),
+                ]),
+            ),
+        ),
+        arraySet(module, index, slot, entry),
+    ]);
+}
+
+/* (self, capacity) => void, compacts the live entries into arrays of the
+    given capacity (rounded up to a power of two, the index is probed with
+    a mask) and rebuilds the index */
+function collection_rehash(module: binaryen.Module, info: CollectionTypeInfo) {
+    /* params */
+    const self_idx = 0;
+    const capacity_idx = 1;
+    /* vars */
+    const index_idx = 2;
+    const mask_idx = 3;
+    const slot_idx = 4;
+    const i_idx = 5;
+    const j_idx = 6;
+    const hash_idx = 7;
+    const hashes_idx = 8;
+    const keys_idx = 9;
+    const values_idx = 10;
+
+    const self = module.local.get(self_idx, info.structTypeInfo.typeRef);
+    const capacity = module.local.get(capacity_idx, binaryen.i32);
+    const i = module.local.get(i_idx, binaryen.i32);
+    const j = module.local.get(j_idx, binaryen.i32);
+    const hash = module.local.get(hash_idx, binaryen.i32);
+    const hashes = module.local.get(hashes_idx, i32ArrayTypeInfo.typeRef);
+    const keys = module.local.get(keys_idx, info.keyArrayTypeInfo.typeRef);
+    const isMap = !!info.valueArrayTypeInfo;
+
+    const stmts: binaryen.ExpressionRef[] = [];
+    /* capacity is at least INITIAL_CAPACITY, so capacity - 1 is never 0 */
+    stmts.push(
+        module.local.set(
+            capacity_idx,
+            module.i32.shl(
+                module.i32.const(1),
+                module.i32.sub(
+                    module.i32.const(32),
+                    module.i32.clz(
+                        module.i32.sub(capacity, module.i32.const(1)),
+                    ),
+                ),
+            ),
+        ),
+    );
+    stmts.push(
+        module.local.set(
+            index_idx,
+            newI32Array(
+                module,
+                module.i32.shl(capacity, module.i32.const(1)),
+                EMPTY_SLOT,
+            ),
+        ),
+    );
+    stmts.push(
+        module.local.set(
+            mask_idx,
+            module.i32.sub(
+                module.i32.shl(capacity, module.i32.const(1)),
+                module.i32.const(1),
+            ),
+        ),
+    );
+    stmts.push(module.local.set(hashes_idx, newI32Array(module, capacity, 0)));
+    stmts.push(
+        module.local.set(
+            keys_idx,
+            newEntryArray(
+                module,
+                info.keyArrayTypeInfo,
+                info.keyTypeRef,
+                capacity,
+            ),
+        ),
+    );
+    if (isMap) {
+        stmts.push(
+            module.local.set(
+                values_idx,
+                newEntryArray(
+                    module,
+                    info.valueArrayTypeInfo!,
+                    info.valueTypeRef,
+                    capacity,
+                ),
+            ),
+        );
+    }
+    stmts.push(module.local.set(j_idx, module.i32.const(0)));
+
+    const moveStmts: binaryen.ExpressionRef[] = [
+        arraySet(module, hashes, j, hash),
+        arraySet(
+            module,
+            keys,
+            j,
+            arrayGet(
+                module,
+                getField(module, info, self, CollectionField.KEYS),
+                i,
+                info.keyTypeRef,
+            ),
+        ),
+    ];
+    if (isMap) {
+        moveStmts.push(
+            arraySet(
+                module,
+                module.local.get(
+                    values_idx,
+                    info.valueArrayTypeInfo!.typeRef,
+                ),
+                j,
+                arrayGet(
+                    module,
+                    getField(module, info, self, CollectionField.VALUES),
+                    i,
+                    info.valueTypeRef,
+                ),
+            ),
+        );
+    }
+    moveStmts.push(
+        insertIndex(module, index_idx, mask_idx, slot_idx, hash, j),
+    );
+    moveStmts.push(
+        module.local.set(j_idx, module.i32.add(j, module.i32.const(1))),
+    );
+    stmts.push(
+        forLoop(
+            module,
+            'rehash_loop',
+            i_idx,
+            getField(module, info, self, CollectionField.USED),
+            module.block(null, [
+                module.local.set(
+                    hash_idx,
+                    arrayGet(
+                        module,
+                        getField(module, info, self, CollectionField.HASHES),
+                        i,
+                        binaryen.i32,
+                    ),
+                ),
+                module.if(
+                    module.i32.ne(hash, module.i32.const(DELETED_HASH)),
+                    module.block(null, moveStmts),
+                ),
+            ]),
+        ),
+    );
+    stmts.push(
+        setField(
+            module,
+            self,
+            CollectionField.INDEX,
+            module.local.get(index_idx, i32ArrayTypeInfo.typeRef),
+        ),
+    );
+    stmts.push(setField(module, self, CollectionField.HASHES, hashes));
+    stmts.push(setField(module, self, CollectionField.KEYS, keys));
+    if (isMap) {
+        stmts.push(
+            setField(
+                module,
+                self,
+                CollectionField.VALUES,
+                module.local.get(
+                    values_idx,
+                    info.valueArrayTypeInfo!.typeRef,
+                ),
+            ),
+        );
+    }
+    stmts.push(setField(module, self, CollectionField.USED, j));
+    return module.block(null, stmts);
+}
+
+/* get(key) of Map */
+function collection_get(module: binaryen.Module, info: CollectionTypeInfo) {
+    /* params */
+    const this_idx = 1;
+    const key_idx = 2;
+    /* vars */
+    const self_idx = 3;
+    const entry_idx = 4;
+
+    const self = module.local.get(self_idx, info.structTypeInfo.typeRef);
+    const key = module.local.get(key_idx, info.keyTypeRef);
+    const entry = module.local.get(entry_idx, binaryen.i32);
+    /* JS returns undefined, which is NaN as a number */
+    let missingValue: binaryen.ExpressionRef;
+    if (info.isDynValue) {
+        missingValue = FunctionalFuncs.generateDynUndefined(module);
+    } else if (info.valueTypeRef === binaryen.f64) {
+        missingValue = module.f64.const(NaN);
+    } else if (info.valueTypeRef === binaryen.f32) {
+        missingValue = module.f32.const(NaN);
+    } else {
+        missingValue = getZeroValue(module, info.valueTypeRef);
+    }
+    return module.block(null, [
+        castThis(module, info, this_idx, self_idx),
+        module.local.set(
+            entry_idx,
+            callFind(module, info, self, key, callHash(module, info, key)),
+        ),
+        module.if(
+            module.i32.eq(entry, module.i32.const(-1)),
+            module.return(missingValue),
+        ),
+        module.return(
+            arrayGet(
+                module,
+                getField(module, info, self, CollectionField.VALUES),
+                entry,
+                info.valueTypeRef,
+            ),
+        ),
+    ]);
+}
+
+/* has(key) */
+function collection_has(module: binaryen.Module, info: CollectionTypeInfo) {
+    /* params */
+    const this_idx = 1;
+    const key_idx = 2;
+    /* vars */
+    const self_idx = 3;
+
+    const self = module.local.get(self_idx, info.structTypeInfo.typeRef);
+    const key = module.local.get(key_idx, info.keyTypeRef);
+    return module.block(null, [
+        castThis(module, info, this_idx, self_idx),
+        module.return(
+            module.i32.ne(
+                callFind(module, info, self, key, callHash(module, info, key)),
+                module.i32.const(-1),
+            ),
+        ),
+    ]);
+}
+
+/* set(key, value) of Map and add(key) of Set */
+function collection_set(module: binaryen.Module, info: CollectionTypeInfo) {
+    const isMap = !!info.valueArrayTypeInfo;
+    /* params */
+    const this_idx = 1;
+    const key_idx = 2;
+    const value_idx = 3;
+    /* vars */
+    const self_idx = isMap ? 4 : 3;
+    const hash_idx = self_idx + 1;
+    const entry_idx = self_idx + 2;
+    const size_idx = self_idx + 3;
+    const index_idx = self_idx + 4;
+    const mask_idx = self_idx + 5;
+    const slot_idx = self_idx + 6;
+
+    const self = module.local.get(self_idx, info.structTypeInfo.typeRef);
+    const key = module.local.get(key_idx, info.keyTypeRef);
+    const hash = module.local.get(hash_idx, binaryen.i32);
+    const entry = module.local.get(entry_idx, binaryen.i32);
+    const size = module.local.get(size_idx, binaryen.i32);
+
+    const stmts: binaryen.ExpressionRef[] = [];
+    stmts.push(castThis(module, info, this_idx, self_idx));
+    stmts.push(module.local.set(hash_idx, callHash(module, info, key)));
+    stmts.push(
+        module.local.set(entry_idx, callFind(module, info, self, key, hash)),
+    );
+    if (isMap) {
+        stmts.push(
+            module.if(
+                module.i32.ne(entry, module.i32.const(-1)),
+                module.block(null, [
+                    arraySet(
+                        module,
+                        getField(module, info, self, CollectionField.VALUES),
+                        entry,
+                        module.local.get(value_idx, info.valueTypeRef),
+                    ),
+                    module.return(self),
+                ]),
+            ),
+        );
+    } else {
+        stmts.push(
+            module.if(
+                module.i32.ne(entry, module.i32.const(-1)),
+                module.return(self),
+            ),
+        );
+    }
+    stmts.push(
+        module.local.set(
+            size_idx,
+            getField(module, info, self, CollectionField.SIZE),
+        ),
+    );
+    /* the entries are full, compact them or double the capacity */
+    stmts.push(
+        module.if(
+            module.i32.eq(
+                getField(module, info, self, CollectionField.USED),
+                binaryenCAPI._BinaryenArrayLen(
+                    module.ptr,
+                    getField(module, info, self, CollectionField.HASHES),
+                ),
+            ),
+            module.call(
+                getMethodName(info, 'rehash'),
+                [
+                    self,
+                    module.select(
+                        module.i32.lt_s(
+                            module.i32.shl(size, module.i32.const(1)),
+                            module.i32.const(INITIAL_CAPACITY),
+                        ),
+                        module.i32.const(INITIAL_CAPACITY),
+                        module.i32.shl(size, module.i32.const(1)),
+                    ),
+                ],
+                binaryen.none,
+            ),
+        ),
+    );
+    stmts.push(
+        module.local.set(
+            entry_idx,
+            getField(module, info, self, CollectionField.USED),
+        ),
+    );
+    stmts.push(
+        module.local.set(
+            index_idx,
+            getField(module, info, self, CollectionField.INDEX),
+        ),
+    );
+    stmts.push(
+        module.local.set(
+            mask_idx,
+            module.i32.sub(
+                binaryenCAPI._BinaryenArrayLen(
+                    module.ptr,
+                    module.local.get(index_idx, i32ArrayTypeInfo.typeRef),
+                ),
+                module.i32.const(1),
+            ),
+        ),
+    );
+    stmts.push(
+        insertIndex(module, index_idx, mask_idx, slot_idx, hash, entry),
+    );
+    stmts.push(
+        arraySet(
+            module,
+            getField(module, info, self, CollectionField.HASHES),
+            entry,
+            hash,
+        ),
+    );
+    stmts.push(
+        arraySet(
+            module,
+            getField(module, info, self, CollectionField.KEYS),
+            entry,
+            key,
+        ),
+    );
+    if (isMap) {
+        stmts.push(
+            arraySet(
+                module,
+                getField(module, info, self, CollectionField.VALUES),
+                entry,
+                module.local.get(value_idx, info.valueTypeRef),
+            ),
+        );
+    }
+    stmts.push(
+        setField(
+            module,
+            self,
+            CollectionField.USED,
+            module.i32.add(entry, module.i32.const(1)),
+        ),
+    );
+    stmts.push(
+        setField(
+            module,
+            self,
+            CollectionField.SIZE,
+            module.i32.add(size, module.i32.const(1)),
+        ),
+    );
+    stmts.push(module.return(self));
+    return module.block(null, stmts);
+}
+
+/* delete(key) */
+function collection_delete(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+) {
+    /* params */
+    const this_idx = 1;
+    const key_idx = 2;
+    /* vars */
+    const self_idx = 3;
+    const entry_idx = 4;
+
+    const self = module.local.get(self_idx, info.structTypeInfo.typeRef);
+    const key = module.local.get(key_idx, info.keyTypeRef);
+    const entry = module.local.get(entry_idx, binaryen.i32);
+
+    const stmts: binaryen.ExpressionRef[] = [];
+    stmts.push(castThis(module, info, this_idx, self_idx));
+    stmts.push(
+        module.local.set(
+            entry_idx,
+            callFind(module, info, self, key, callHash(module, info, key)),
+        ),
+    );
+    stmts.push(
+        module.if(
+            module.i32.eq(entry, module.i32.const(-1)),
+            module.return(module.i32.const(0)),
+        ),
+    );
+    /* the index slot is kept until the next rehash */
+    stmts.push(
+        arraySet(
+            module,
+            getField(module, info, self, CollectionField.HASHES),
+            entry,
+            module.i32.const(DELETED_HASH),
+        ),
+    );
+    /* don't keep the key and value alive */
+    stmts.push(
+        arraySet(
+            module,
+            getField(module, info, self, CollectionField.KEYS),
+            entry,
+            getZeroValue(module, info.keyTypeRef),
+        ),
+    );
+    if (info.valueArrayTypeInfo) {
+        stmts.push(
+            arraySet(
+                module,
+                getField(module, info, self, CollectionField.VALUES),
+                entry,
+                getZeroValue(module, info.valueTypeRef),
+            ),
+        );
+    }
+    stmts.push(
+        setField(
+            module,
+            self,
+            CollectionField.SIZE,
+            module.i32.sub(
+                getField(module, info, self, CollectionField.SIZE),
+                module.i32.const(1),
+            ),
+        ),
+    );
+    stmts.push(module.return(module.i32.const(1)));
+    return module.block(null, stmts);
+}
+
+/* clear() */
+function collection_clear(module: binaryen.Module, info: CollectionTypeInfo) {
+    /* params */
+    const this_idx = 1;
+    /* vars */
+    const self_idx = 2;
+
+    const self = module.local.get(self_idx, info.structTypeInfo.typeRef);
+    const stmts: binaryen.ExpressionRef[] = [];
+    stmts.push(castThis(module, info, this_idx, self_idx));
+    const fields = getInitialFields(module, info);
+    for (let i = 0; i < fields.length; i++) {
+        stmts.push(setField(module, self, i, fields[i]));
+    }
+    return module.block(null, stmts);
+}
+
+/* keys(), values() and entries(), snapshots of the live entries in
+    insertion order */
+function collection_toArray(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+    method: string,
+    arrayInfo: CollectionArrayInfo,
+) {
+    /* params */
+    const this_idx = 1;
+    /* vars */
+    const self_idx = 2;
+    const array_idx = 3;
+    const i_idx = 4;
+    const j_idx = 5;
+
+    const self = module.local.get(self_idx, info.structTypeInfo.typeRef);
+    const array = module.local.get(array_idx, arrayInfo.arrayTypeInfo.typeRef);
+    const i = module.local.get(i_idx, binaryen.i32);
+    const j = module.local.get(j_idx, binaryen.i32);
+    const key = arrayGet(
+        module,
+        getField(module, info, self, CollectionField.KEYS),
+        i,
+        info.keyTypeRef,
+    );
+
+    let elem: binaryen.ExpressionRef;
+    if (method === 'keys') {
+        elem = key;
+    } else {
+        const value = arrayGet(
+            module,
+            getField(module, info, self, CollectionField.VALUES),
+            i,
+            info.valueTypeRef,
+        );
+        if (method === 'values') {
+            elem = value;
+        } else {
+            elem = binaryenCAPI._BinaryenStructNew(
+                module.ptr,
+                arrayToPtr([key, value]).ptr,
+                2,
+                arrayInfo.entryTypeInfo!.heapTypeRef,
+            );
+        }
+    }
+
+    return module.block(null, [
+        castThis(module, info, this_idx, self_idx),
+        module.local.set(
+            array_idx,
+            newEntryArray(
+                module,
+                arrayInfo.arrayTypeInfo,
+                arrayInfo.elemTypeRef,
+                getField(module, info, self, CollectionField.SIZE),
+            ),
+        ),
+        module.local.set(j_idx, module.i32.const(0)),
+        forLoop(
+            module,
+            'to_array_loop',
+            i_idx,
+            getField(module, info, self, CollectionField.USED),
+            module.if(
+                module.i32.ne(
+                    arrayGet(
+                        module,
+                        getField(module, info, self, CollectionField.HASHES),
+                        i,
+                        binaryen.i32,
+                    ),
+                    module.i32.const(DELETED_HASH),
+                ),
+                module.block(null, [
+                    arraySet(module, array, j, elem),
+                    module.local.set(
+                        j_idx,
+                        module.i32.add(j, module.i32.const(1)),
+                    ),
+                ]),
+            ),
+        ),
+        module.return(
+            binaryenCAPI._BinaryenStructNew(
+                module.ptr,
+                arrayToPtr([array, j]).ptr,
+                2,
+                arrayInfo.structTypeInfo.heapTypeRef,
+            ),
+        ),
+    ]);
+}
+
+/* visits the entries present when the loop starts in insertion order,
+    entries added by the body are not visited, the deleted ones are skipped
+    unless a rehash already replaced the arrays */
+export function forEachEntry(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+    self: binaryen.ExpressionRef,
+    locals: CollectionLoopLocals,
+    label: string,
+    body: (
+        key: binaryen.ExpressionRef,
+        value?: binaryen.ExpressionRef,
+    ) => binaryen.ExpressionRef,
+) {
+    const hashes = module.local.get(
+        locals.hashes_idx,
+        i32ArrayTypeInfo.typeRef,
+    );
+    const i = module.local.get(locals.i_idx, binaryen.i32);
+    const key = arrayGet(
+        module,
+        module.local.get(locals.keys_idx, info.keyArrayTypeInfo.typeRef),
+        i,
+        info.keyTypeRef,
+    );
+    const stmts: binaryen.ExpressionRef[] = [
+        module.local.set(
+            locals.hashes_idx,
+            getField(module, info, self, CollectionField.HASHES),
+        ),
+        module.local.set(
+            locals.keys_idx,
+            getField(module, info, self, CollectionField.KEYS),
+        ),
+        module.local.set(
+            locals.used_idx,
+            getField(module, info, self, CollectionField.USED),
+        ),
+    ];
+    let value: binaryen.ExpressionRef | undefined = undefined;
+    if (info.valueArrayTypeInfo) {
+        stmts.push(
+            module.local.set(
+                locals.values_idx,
+                getField(module, info, self, CollectionField.VALUES),
+            ),
+        );
+        value = arrayGet(
+            module,
+            module.local.get(
+                locals.values_idx,
+                info.valueArrayTypeInfo.typeRef,
+            ),
+            i,
+            info.valueTypeRef,
+        );
+    }
+    stmts.push(
+        forLoop(
+            module,
+            label,
+            locals.i_idx,
+            module.local.get(locals.used_idx, binaryen.i32),
+            module.if(
+                module.i32.ne(
+                    arrayGet(module, hashes, i, binaryen.i32),
+                    module.i32.const(DELETED_HASH),
+                ),
+                body(key, value),
+            ),
+        ),
+    );
+    return module.block(null, stmts);
+}
+
+function boxValueToAny(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+    value: binaryen.ExpressionRef,
+    names: CollectionDynNames,
+) {
+    const valueInfo = info.valueCollectionInfo;
+    if (!valueInfo) {
+        return FunctionalFuncs.boxNonLiteralToAny(
+            module,
+            value,
+            info.valueKind,
+        );
+    }
+    /* nested static collections are converted as well */
+    return module.if(
+        binaryenCAPI._BinaryenRefIsNull(module.ptr, value),
+        FunctionalFuncs.generateDynNull(module),
+        module.call(
+            getCollectionToAnyName(module, valueInfo, names),
+            [module.copyExpression(value)],
+            dyntype.dyn_value_t,
+        ),
+    );
+}
+
+/* (self) => a dynamic Map or Set holding the boxed entries, the entries
+    are copied so later updates of either side are not shared */
+function collection_toAny(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+    names: CollectionDynNames,
+) {
+    /* params */
+    const self_idx = 0;
+    /* vars */
+    const res_idx = 1;
+    const args_idx = 2;
+    const locals: CollectionLoopLocals = {
+        hashes_idx: 3,
+        keys_idx: 4,
+        used_idx: 5,
+        i_idx: 6,
+        values_idx: 7,
+    };
+
+    const self = module.local.get(self_idx, info.structTypeInfo.typeRef);
+    const res = module.local.get(res_idx, dyntype.dyn_value_t);
+    const args = module.local.get(args_idx, dyntype.dyn_value_t);
+    const isMap = !!info.valueArrayTypeInfo;
+
+    return module.block(null, [
+        module.local.set(
+            res_idx,
+            module.call(
+                dyntype.dyntype_new_object_with_class,
+                [
+                    FunctionalFuncs.getDynContextRef(module),
+                    module.i32.const(isMap ? names.map : names.set),
+                    FunctionalFuncs.generateDynArray(
+                        module,
+                        module.i32.const(0),
+                    ),
+                ],
+                dyntype.dyn_value_t,
+            ),
+        ),
+        forEachEntry(
+            module,
+            info,
+            self,
+            locals,
+            'to_any_loop',
+            (key, value) => {
+                const stmts = [
+                    module.local.set(
+                        args_idx,
+                        FunctionalFuncs.generateDynArray(
+                            module,
+                            module.i32.const(isMap ? 2 : 1),
+                        ),
+                    ),
+                    FunctionalFuncs.setDynArrElem(
+                        module,
+                        args,
+                        module.i32.const(0),
+                        FunctionalFuncs.boxNonLiteralToAny(
+                            module,
+                            key,
+                            info.keyKind,
+                        ),
+                    ),
+                ];
+                if (isMap) {
+                    stmts.push(
+                        FunctionalFuncs.setDynArrElem(
+                            module,
+                            args,
+                            module.i32.const(1),
+                            boxValueToAny(module, info, value!, names),
+                        ),
+                    );
+                }
+                stmts.push(
+                    module.drop(
+                        module.call(
+                            dyntype.dyntype_invoke,
+                            [
+                                FunctionalFuncs.getDynContextRef(module),
+                                module.i32.const(
+                                    isMap ? names.setMethod : names.addMethod,
+                                ),
+                                res,
+                                args,
+                            ],
+                            dyntype.dyn_value_t,
+                        ),
+                    ),
+                );
+                return module.block(null, stmts);
+            },
+        ),
+        module.return(res),
+    ]);
+}
+
+/* returns the function converting a static Map or Set to a dynamic one,
+    used where the collection flows into any */
+export function getCollectionToAnyName(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+    names: CollectionDynNames,
+) {
+    const funcName = getMethodName(info, 'toAny');
+    if (module.getFunction(funcName)) {
+        return funcName;
+    }
+    const vars = [
+        dyntype.dyn_value_t,
+        dyntype.dyn_value_t,
+        i32ArrayTypeInfo.typeRef,
+        info.keyArrayTypeInfo.typeRef,
+        binaryen.i32,
+        binaryen.i32,
+    ];
+    if (info.valueArrayTypeInfo) {
+        vars.push(info.valueArrayTypeInfo.typeRef);
+    }
+    module.addFunction(
+        funcName,
+        info.structTypeInfo.typeRef,
+        dyntype.dyn_value_t,
+        vars,
+        collection_toAny(module, info, names),
+    );
+    return funcName;
+}
+
+function getInitialFields(module: binaryen.Module, info: CollectionTypeInfo) {
+    const capacity = module.i32.const(INITIAL_CAPACITY);
+    const fields = [
+        module.i32.const(0),
+        module.i32.const(0),
+        newI32Array(
+            module,
+            module.i32.const(INITIAL_CAPACITY * 2),
+            EMPTY_SLOT,
+        ),
+        newI32Array(module, capacity, 0),
+        newEntryArray(module, info.keyArrayTypeInfo, info.keyTypeRef, capacity),
+    ];
+    if (info.valueArrayTypeInfo) {
+        fields.push(
+            newEntryArray(
+                module,
+                info.valueArrayTypeInfo,
+                info.valueTypeRef,
+                capacity,
+            ),
+        );
+    }
+    return fields;
+}
+
+/* new Map() / new Set() */
+export function newCollection(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+) {
+    const fields = getInitialFields(module, info);
+    return binaryenCAPI._BinaryenStructNew(
+        module.ptr,
+        arrayToPtr(fields).ptr,
+        fields.length,
+        info.structTypeInfo.heapTypeRef,
+    );
+}
+
+function addHashFunctions(module: binaryen.Module, info: CollectionTypeInfo) {
+    const funcName = getHashFuncName(info);
+    if (module.getFunction(funcName)) {
+        return;
+    }
+    switch (info.keyKind) {
+        case ValueTypeKind.NUMBER:
+            module.addFunction(
+                funcName,
+                binaryen.f64,
+                binaryen.i32,
+                [binaryen.i64],
+                collection_hashNumber(module),
+            );
+            break;
+        case ValueTypeKind.STRING:
+            module.addFunction(
+                funcName,
+                info.keyTypeRef,
+                binaryen.i32,
+                [
+                    i8ArrayTypeInfo.typeRef,
+                    binaryen.i32,
+                    binaryen.i32,
+                    binaryen.i32,
+                ],
+                collection_hashString(module, info.keyTypeRef),
+            );
+            break;
+        default:
+            /* wasm has no identity hash, the native hashes the address,
+                objects are never moved by the GC */
+            module.addFunctionImport(
+                funcName,
+                BuiltinNames.externalModuleName,
+                funcName,
+                binaryen.anyref,
+                binaryen.i32,
+            );
+    }
+}
+
+function addCommonFunctions(module: binaryen.Module, info: CollectionTypeInfo) {
+    const findName = getMethodName(info, 'find');
+    if (module.getFunction(findName)) {
+        return;
+    }
+    const structTypeRef = info.structTypeInfo.typeRef;
+    addHashFunctions(module, info);
+    module.addFunction(
+        findName,
+        binaryen.createType([structTypeRef, info.keyTypeRef, binaryen.i32]),
+        binaryen.i32,
+        [
+            i32ArrayTypeInfo.typeRef,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            info.keyTypeRef,
+        ],
+        collection_find(module, info),
+    );
+    const rehashVars = [
+        i32ArrayTypeInfo.typeRef,
+        binaryen.i32,
+        binaryen.i32,
+        binaryen.i32,
+        binaryen.i32,
+        binaryen.i32,
+        i32ArrayTypeInfo.typeRef,
+        info.keyArrayTypeInfo.typeRef,
+    ];
+    if (info.valueArrayTypeInfo) {
+        rehashVars.push(info.valueArrayTypeInfo.typeRef);
+    }
+    module.addFunction(
+        getMethodName(info, 'rehash'),
+        binaryen.createType([structTypeRef, binaryen.i32]),
+        binaryen.none,
+        rehashVars,
+        collection_rehash(module, info),
+    );
+}
+
+/* returns the name of the specialized method, generate it at the first
+    call */
+export function getCollectionMethodName(
+    module: binaryen.Module,
+    info: CollectionTypeInfo,
+    method: string,
+    arrayInfo?: CollectionArrayInfo,
+) {
+    const funcName = getMethodName(info, method);
+    if (module.getFunction(funcName)) {
+        return funcName;
+    }
+    addCommonFunctions(module, info);
+
+    const structTypeRef = info.structTypeInfo.typeRef;
+    const envParams = [emptyStructType.typeRef, emptyStructType.typeRef];
+    switch (method) {
+        case 'get':
+            module.addFunction(
+                funcName,
+                binaryen.createType([...envParams, info.keyTypeRef]),
+                info.valueTypeRef,
+                [structTypeRef, binaryen.i32],
+                collection_get(module, info),
+            );
+            break;
+        case 'has':
+            module.addFunction(
+                funcName,
+                binaryen.createType([...envParams, info.keyTypeRef]),
+                binaryen.i32,
+                [structTypeRef],
+                collection_has(module, info),
+            );
+            break;
+        case 'set':
+        case 'add': {
+            const params = [...envParams, info.keyTypeRef];
+            if (info.valueArrayTypeInfo) {
+                params.push(info.valueTypeRef);
+            }
+            module.addFunction(
+                funcName,
+                binaryen.createType(params),
+                structTypeRef,
+                [
+                    structTypeRef,
+                    binaryen.i32,
+                    binaryen.i32,
+                    binaryen.i32,
+                    i32ArrayTypeInfo.typeRef,
+                    binaryen.i32,
+                    binaryen.i32,
+                ],
+                collection_set(module, info),
+            );
+            break;
+        }
+        case 'delete':
+            module.addFunction(
+                funcName,
+                binaryen.createType([...envParams, info.keyTypeRef]),
+                binaryen.i32,
+                [structTypeRef, binaryen.i32],
+                collection_delete(module, info),
+            );
+            break;
+        case 'clear':
+            module.addFunction(
+                funcName,
+                binaryen.createType(envParams),
+                binaryen.none,
+                [structTypeRef],
+                collection_clear(module, info),
+            );
+            break;
+        case 'keys':
+        case 'values':
+        case 'entries':
+            module.addFunction(
+                funcName,
+                binaryen.createType(envParams),
+                arrayInfo!.structTypeInfo.typeRef,
+                [
+                    structTypeRef,
+                    arrayInfo!.arrayTypeInfo.typeRef,
+                    binaryen.i32,
+                    binaryen.i32,
+                ],
+                collection_toArray(module, info, method, arrayInfo!),
+            );
+            break;
+        default:
+            throw new Error(`${info.name}.${method} is not supported`);
+    }
+    return funcName;
+}
@@ -39,6 +39,7 @@ import {
     numberArrayStructTypeInfo,
     numberArrayTypeInfo,
     i32ArrayTypeInfo,
+    i16ArrayTypeInfo,
 } from '../glue/packType.js';
 import { array_get_data, array_get_length_i32 } from './array_utils.js';
 import { SemanticsKind } from '../../../semantics/semantics_nodes.js';
@@ -2684,7 +2685,7 @@ function string_toLowerCase(module: binaryen.Module) {
 }
 
 function string_toLowerCase_stringref(module: binaryen.Module) {
-    return module.unreachable();
+    return string_toLowerOrUpperCase_stringref(module, true);
 }
 
 function string_toUpperCase(module: binaryen.Module) {
@@ -2692,372 +2693,436 @@ function string_toUpperCase(module: binaryen.Module) {
 }
 
 function string_toUpperCase_stringref(module: binaryen.Module) {
-    return module.unreachable();
+    return string_toLowerOrUpperCase_stringref(module, false);
 }
 
-function string_toLowerOrUpperCase_internal(
+/** whether the character is an ASCII letter to be converted, one unsigned
+ * compare covers both bounds of the range */
+function isCaseConvertible(
     module: binaryen.Module,
+    char: binaryen.ExpressionRef,
     lower: boolean,
 ) {
-    const statementArray: binaryen.ExpressionRef[] = [];
+    return module.i32.lt_u(
+        module.i32.sub(char, module.i32.const(lower ? 65 : 97)),
+        module.i32.const(26),
+    );
+}
+
+/** whether the character is ' ', '\t', '\n', '\v', '\f' or '\r' */
+function isAsciiWhiteSpace(
+    module: binaryen.Module,
+    char: () => binaryen.ExpressionRef,
+) {
+    return module.i32.or(
+        module.i32.eq(char(), module.i32.const(32)),
+        module.i32.lt_u(
+            module.i32.sub(char(), module.i32.const(9)),
+            module.i32.const(5),
+        ),
+    );
+}
 
+/** find the first character to be converted, and return the string itself
+ * if there is none, so the common case of an already converted string
+ * doesn't allocate */
+function string_toLowerOrUpperCase_internal(
+    module: binaryen.Module,
+    lower: boolean,
+) {
     const strIdx = 1;
     const for_i_Idx = 2;
     const newStrArrayIdx = 3;
-    const copyCurLenIdx = 4;
-    const paramIdx = 5;
+    const lenIdx = 4;
+    const charIdx = 5;
     const str = module.local.get(strIdx, stringTypeInfo.typeRef);
-
-    const newStrArrayType = i8ArrayTypeInfo.typeRef;
-
-    const thisStrArray = binaryenCAPI._BinaryenStructGet(
-        module.ptr,
-        1,
-        str,
+    const i = module.local.get(for_i_Idx, binaryen.i32);
+    const len = module.local.get(lenIdx, binaryen.i32);
+    const char = module.local.get(charIdx, binaryen.i32);
+    const newStrArray = module.local.get(
+        newStrArrayIdx,
         i8ArrayTypeInfo.typeRef,
-        false,
     );
+    const thisStrArray = () =>
+        binaryenCAPI._BinaryenStructGet(
+            module.ptr,
+            1,
+            str,
+            i8ArrayTypeInfo.typeRef,
+            false,
+        );
+    const statementArray: binaryen.ExpressionRef[] = [];
 
-    const thisStrLen = binaryenCAPI._BinaryenArrayLen(module.ptr, thisStrArray);
+    statementArray.push(
+        module.local.set(
+            lenIdx,
+            binaryenCAPI._BinaryenArrayLen(module.ptr, thisStrArray()),
+        ),
+    );
+    statementArray.push(module.local.set(for_i_Idx, module.i32.const(0)));
 
-    if (lower == true) {
-        statementArray.push(module.local.set(paramIdx, module.i32.const(1)));
-    } else {
-        statementArray.push(module.local.set(paramIdx, module.i32.const(0)));
-    }
+    /* scan for the first character to be converted */
+    const scan_block = 'case_scan_block';
+    const scan_loop = 'case_scan_loop';
+    statementArray.push(
+        module.block(scan_block, [
+            module.loop(
+                scan_loop,
+                module.block(null, [
+                    module.if(module.i32.ge_u(i, len), module.return(str)),
+                    module.br(
+                        scan_block,
+                        isCaseConvertible(
+                            module,
+                            binaryenCAPI._BinaryenArrayGet(
+                                module.ptr,
+                                thisStrArray(),
+                                i,
+                                i8ArrayTypeInfo.typeRef,
+                                false,
+                            ),
+                            lower,
+                        ),
+                    ),
+                    module.local.set(
+                        for_i_Idx,
+                        module.i32.add(i, module.i32.const(1)),
+                    ),
+                    module.br(scan_loop),
+                ]),
+            ),
+        ]),
+    );
 
+    /* copy once, then convert from the first changed character */
     statementArray.push(
         module.local.set(
             newStrArrayIdx,
             binaryenCAPI._BinaryenArrayNew(
                 module.ptr,
                 i8ArrayTypeInfo.heapTypeRef,
-                thisStrLen,
+                len,
                 module.i32.const(0),
             ),
         ),
     );
-
     statementArray.push(
         binaryenCAPI._BinaryenArrayCopy(
             module.ptr,
-            module.local.get(newStrArrayIdx, i8ArrayTypeInfo.typeRef),
+            newStrArray,
             module.i32.const(0),
-            thisStrArray,
+            thisStrArray(),
             module.i32.const(0),
-            thisStrLen,
+            len,
         ),
     );
-    statementArray.push(module.local.set(copyCurLenIdx, thisStrLen));
 
-    const strArray = binaryenCAPI._BinaryenStructNew(
-        module.ptr,
-        arrayToPtr([
-            module.i32.const(0),
-            module.local.get(newStrArrayIdx, newStrArrayType),
-        ]).ptr,
-        2,
-        stringTypeInfo.heapTypeRef,
+    const convert_loop = 'case_convert_loop';
+    const convert_body = module.block(null, [
+        module.local.set(
+            charIdx,
+            binaryenCAPI._BinaryenArrayGet(
+                module.ptr,
+                newStrArray,
+                i,
+                i8ArrayTypeInfo.typeRef,
+                false,
+            ),
+        ),
+        module.if(
+            isCaseConvertible(module, char, lower),
+            binaryenCAPI._BinaryenArraySet(
+                module.ptr,
+                newStrArray,
+                i,
+                module.i32.xor(char, module.i32.const(32)),
+            ),
+        ),
+    ]);
+    const flattenLoop: FlattenLoop = {
+        label: convert_loop,
+        condition: module.i32.lt_u(i, len),
+        statements: convert_body,
+        incrementor: module.local.set(
+            for_i_Idx,
+            module.i32.add(i, module.i32.const(1)),
+        ),
+    };
+    statementArray.push(
+        module.loop(
+            convert_loop,
+            FunctionalFuncs.flattenLoopStatement(
+                module,
+                flattenLoop,
+                SemanticsKind.FOR,
+            ),
+        ),
     );
 
-    const strLen = binaryenCAPI._BinaryenArrayLen(module.ptr, thisStrArray);
-
-    const for_label_1 = 'for_loop_1_block';
-    const for_init_1 = module.local.set(for_i_Idx, module.i32.const(0));
-    const for_condition_1 = module.i32.lt_u(
-        module.local.get(for_i_Idx, binaryen.i32),
-        strLen,
-    );
-    const for_incrementor_1 = module.local.set(
-        for_i_Idx,
-        module.i32.add(
-            module.local.get(for_i_Idx, binaryen.i32),
-            module.i32.const(1),
+    statementArray.push(
+        module.return(
+            binaryenCAPI._BinaryenStructNew(
+                module.ptr,
+                arrayToPtr([module.i32.const(0), newStrArray]).ptr,
+                2,
+                stringTypeInfo.heapTypeRef,
+            ),
         ),
     );
 
-    const for_body_1 = module.if(
-        module.i32.eq(
-            module.local.get(paramIdx, binaryen.i32),
-            module.i32.const(1),
-        ),
-        module.if(
-            module.i32.ge_u(
-                binaryenCAPI._BinaryenArrayGet(
-                    module.ptr,
-                    module.local.get(newStrArrayIdx, i8ArrayTypeInfo.typeRef),
-                    module.local.get(for_i_Idx, binaryen.i32),
-                    i8ArrayTypeInfo.typeRef,
-                    false,
-                ),
-                module.i32.const(65),
+    return module.block('toLowerOrUpperCaseinternal', statementArray);
+}
+
+function string_toLowerOrUpperCase_stringref(
+    module: binaryen.Module,
+    lower: boolean,
+) {
+    const ref_index = 1;
+    const len_index = 2;
+    const i_index = 3;
+    const char_index = 4;
+    const code_units_index = 5;
+    const ref = module.local.get(
+        ref_index,
+        binaryenCAPI._BinaryenTypeStringref(),
+    );
+    const len = module.local.get(len_index, binaryen.i32);
+    const i = module.local.get(i_index, binaryen.i32);
+    const char = module.local.get(char_index, binaryen.i32);
+    const codeUnits = module.local.get(
+        code_units_index,
+        i16ArrayTypeInfo.typeRef,
+    );
+    const getCodeUnit = () =>
+        binaryenCAPI._BinaryenStringWTF16Get(
+            module.ptr,
+            binaryenCAPI._BinaryenStringAs(
+                module.ptr,
+                StringRefAsOp.WTF16,
+                ref,
             ),
-            module.if(
-                module.i32.le_u(
-                    binaryenCAPI._BinaryenArrayGet(
-                        module.ptr,
-                        module.local.get(
-                            newStrArrayIdx,
-                            i8ArrayTypeInfo.typeRef,
-                        ),
-                        module.local.get(for_i_Idx, binaryen.i32),
-                        i8ArrayTypeInfo.typeRef,
-                        false,
-                    ),
-                    module.i32.const(90),
-                ),
-                binaryenCAPI._BinaryenArraySet(
-                    module.ptr,
-                    module.local.get(newStrArrayIdx, i8ArrayTypeInfo.typeRef),
-                    module.local.get(for_i_Idx, binaryen.i32),
-                    module.i32.add(
-                        binaryenCAPI._BinaryenArrayGet(
-                            module.ptr,
-                            module.local.get(
-                                newStrArrayIdx,
-                                i8ArrayTypeInfo.typeRef,
-                            ),
-                            module.local.get(for_i_Idx, binaryen.i32),
-                            i8ArrayTypeInfo.typeRef,
-                            false,
-                        ),
-                        module.i32.const(32),
-                    ),
-                ),
+            i,
+        );
+    const statementArray: binaryen.ExpressionRef[] = [];
+
+    statementArray.push(
+        module.local.set(
+            len_index,
+            binaryenCAPI._BinaryenStringMeasure(
+                module.ptr,
+                StringRefMeatureOp.WTF16,
+                ref,
             ),
         ),
-        module.if(
-            module.i32.ge_u(
-                binaryenCAPI._BinaryenArrayGet(
-                    module.ptr,
-                    module.local.get(newStrArrayIdx, i8ArrayTypeInfo.typeRef),
-                    module.local.get(for_i_Idx, binaryen.i32),
-                    i8ArrayTypeInfo.typeRef,
-                    false,
-                ),
-                module.i32.const(97),
-            ),
-            module.if(
-                module.i32.le_u(
-                    binaryenCAPI._BinaryenArrayGet(
-                        module.ptr,
-                        module.local.get(
-                            newStrArrayIdx,
-                            i8ArrayTypeInfo.typeRef,
-                        ),
-                        module.local.get(for_i_Idx, binaryen.i32),
-                        i8ArrayTypeInfo.typeRef,
-                        false,
+    );
+    statementArray.push(module.local.set(i_index, module.i32.const(0)));
+
+    /* scan for the first code unit to be converted */
+    const scan_block = 'case_scan_block';
+    const scan_loop = 'case_scan_loop';
+    statementArray.push(
+        module.block(scan_block, [
+            module.loop(
+                scan_loop,
+                module.block(null, [
+                    module.if(module.i32.ge_u(i, len), module.return(ref)),
+                    module.br(
+                        scan_block,
+                        isCaseConvertible(module, getCodeUnit(), lower),
                     ),
-                    module.i32.const(122),
-                ),
-                binaryenCAPI._BinaryenArraySet(
-                    module.ptr,
-                    module.local.get(newStrArrayIdx, i8ArrayTypeInfo.typeRef),
-                    module.local.get(for_i_Idx, binaryen.i32),
-                    module.i32.sub(
-                        binaryenCAPI._BinaryenArrayGet(
-                            module.ptr,
-                            module.local.get(
-                                newStrArrayIdx,
-                                i8ArrayTypeInfo.typeRef,
-                            ),
-                            module.local.get(for_i_Idx, binaryen.i32),
-                            i8ArrayTypeInfo.typeRef,
-                            false,
-                        ),
-                        module.i32.const(32),
+                    module.local.set(
+                        i_index,
+                        module.i32.add(i, module.i32.const(1)),
                     ),
-                ),
+                    module.br(scan_loop),
+                ]),
+            ),
+        ]),
+    );
+
+    /* copy the code units to an i16 array, the ones before the scan
+     * position are not convertible, so all of them can go through the
+     * same loop */
+    statementArray.push(
+        module.local.set(
+            code_units_index,
+            binaryenCAPI._BinaryenArrayNew(
+                module.ptr,
+                i16ArrayTypeInfo.heapTypeRef,
+                len,
+                module.i32.const(0),
             ),
         ),
     );
+    statementArray.push(module.local.set(i_index, module.i32.const(0)));
 
-    const flattenLoop_1: FlattenLoop = {
-        label: for_label_1,
-        condition: for_condition_1,
-        statements: for_body_1,
-        incrementor: for_incrementor_1,
+    const convert_loop = 'case_convert_loop';
+    const convert_body = module.block(null, [
+        module.local.set(char_index, getCodeUnit()),
+        binaryenCAPI._BinaryenArraySet(
+            module.ptr,
+            codeUnits,
+            i,
+            module.if(
+                isCaseConvertible(module, char, lower),
+                module.i32.xor(char, module.i32.const(32)),
+                char,
+            ),
+        ),
+    ]);
+    const flattenLoop: FlattenLoop = {
+        label: convert_loop,
+        condition: module.i32.lt_u(i, len),
+        statements: convert_body,
+        incrementor: module.local.set(
+            i_index,
+            module.i32.add(i, module.i32.const(1)),
+        ),
     };
-    statementArray.push(for_init_1);
     statementArray.push(
         module.loop(
-            for_label_1,
+            convert_loop,
             FunctionalFuncs.flattenLoopStatement(
                 module,
-                flattenLoop_1,
+                flattenLoop,
                 SemanticsKind.FOR,
             ),
         ),
     );
 
-    statementArray.push(module.return(strArray));
-
-    const toLowerOrUpperCaseinternalBlock = module.block(
-        'toLowerOrUpperCaseinternal',
-        statementArray,
+    statementArray.push(
+        module.return(
+            binaryenCAPI._BinaryenStringNew(
+                module.ptr,
+                StringRefNewOp.WTF16FromArray,
+                codeUnits,
+                0,
+                module.i32.const(0),
+                len,
+                false,
+            ),
+        ),
     );
-    return toLowerOrUpperCaseinternalBlock;
+
+    return module.block('toLowerOrUpperCase', statementArray);
 }
 
+/** strip ASCII white spaces from both ends, return the string itself if
+ * there is nothing to strip */
 function string_trim(module: binaryen.Module) {
     const thisStrStructIdx = 1;
     const for_i_Idx = 2;
     const newStrCharArrayIdx = 3;
     const trimStartIdx = 4;
     const trimEndIdx = 5;
+    const lenIdx = 6;
 
     const thisStrStruct = module.local.get(
         thisStrStructIdx,
         stringTypeInfo.typeRef,
     );
-    const thisStrCharArray = binaryenCAPI._BinaryenStructGet(
-        module.ptr,
-        1,
-        thisStrStruct,
-        i8ArrayTypeInfo.typeRef,
-        false,
-    );
-    const thisStrLen = binaryenCAPI._BinaryenArrayLen(
-        module.ptr,
-        thisStrCharArray,
-    );
+    const thisStrCharArray = () =>
+        binaryenCAPI._BinaryenStructGet(
+            module.ptr,
+            1,
+            thisStrStruct,
+            i8ArrayTypeInfo.typeRef,
+            false,
+        );
+    const start = module.local.get(trimStartIdx, binaryen.i32);
+    const end = module.local.get(trimEndIdx, binaryen.i32);
+    const len = module.local.get(lenIdx, binaryen.i32);
+    const charAt = (index: () => binaryen.ExpressionRef) => () =>
+        binaryenCAPI._BinaryenArrayGet(
+            module.ptr,
+            thisStrCharArray(),
+            index(),
+            i8ArrayTypeInfo.typeRef,
+            false,
+        );
 
     const statementArray: binaryen.ExpressionRef[] = [];
 
-    /**if the array is empty */
-    const stringIsEmpty = module.if(
-        module.i32.eq(thisStrLen, module.i32.const(0)),
-        module.return(thisStrStruct),
+    statementArray.push(
+        module.local.set(
+            lenIdx,
+            binaryenCAPI._BinaryenArrayLen(module.ptr, thisStrCharArray()),
+        ),
     );
-    statementArray.push(stringIsEmpty);
 
-    /**loop1 */
-    const block_label_1 = 'block_label_1';
+    /** skip the leading white spaces, end is exclusive */
+    statementArray.push(module.local.set(trimStartIdx, module.i32.const(0)));
     const loop_label_1 = 'loop_label_1';
-
-    const loop_init_1 = module.block(null, [
-        module.local.set(trimStartIdx, module.i32.const(0)),
-        module.local.set(for_i_Idx, module.i32.const(0)),
-    ]);
-    const loop_stmts_1 = module.block(null, [
-        module.if(
-            module.i32.ne(
-                binaryenCAPI._BinaryenArrayGet(
-                    module.ptr,
-                    thisStrCharArray,
-                    module.local.get(for_i_Idx, binaryen.i32),
-                    i8ArrayTypeInfo.typeRef,
-                    false,
-                ),
-                module.i32.const(32),
-            ),
-            module.block(null, [
-                module.local.set(
-                    trimStartIdx,
-                    module.local.get(for_i_Idx, binaryen.i32),
-                ),
-                /**jump out the loop */
-                module.br(block_label_1),
-            ]),
+    const flattenLoop_1: FlattenLoop = {
+        label: loop_label_1,
+        condition: module.if(
+            module.i32.lt_u(start, len),
+            isAsciiWhiteSpace(module, charAt(() => start)),
+            module.i32.const(0),
         ),
-        /**inc i */
-        module.local.set(
-            for_i_Idx,
-            module.i32.add(
-                module.local.get(for_i_Idx, binaryen.i32),
-                module.i32.const(1),
-            ),
+        statements: module.local.set(
+            trimStartIdx,
+            module.i32.add(start, module.i32.const(1)),
         ),
-        /**jump out the loop */
-        module.br(
-            block_label_1,
-            module.i32.ge_s(
-                module.local.get(for_i_Idx, binaryen.i32),
-                thisStrLen,
+    };
+    statementArray.push(
+        module.loop(
+            loop_label_1,
+            FunctionalFuncs.flattenLoopStatement(
+                module,
+                flattenLoop_1,
+                SemanticsKind.WHILE,
             ),
         ),
-        /**jump to loop */
-        module.br(loop_label_1),
-    ]);
-    const loop_1 = module.loop(loop_label_1, loop_stmts_1);
-    const stmts_block_1 = module.block(block_label_1, [loop_init_1, loop_1]);
-    statementArray.push(stmts_block_1);
+    );
 
-    /**loop2 */
-    const block_label_2 = 'block_label_2';
+    /** skip the trailing white spaces */
+    statementArray.push(module.local.set(trimEndIdx, len));
     const loop_label_2 = 'loop_label_2';
-
-    const loop_init_2 = module.block(null, [
-        module.local.set(
-            trimEndIdx,
-            module.i32.sub(thisStrLen, module.i32.const(1)),
-        ),
-        module.local.set(
-            for_i_Idx,
-            module.i32.sub(thisStrLen, module.i32.const(1)),
-        ),
-    ]);
-    const loop_stmts_2 = module.block(null, [
-        module.if(
-            module.i32.ne(
-                binaryenCAPI._BinaryenArrayGet(
-                    module.ptr,
-                    thisStrCharArray,
-                    module.local.get(for_i_Idx, binaryen.i32),
-                    i8ArrayTypeInfo.typeRef,
-                    false,
-                ),
-                module.i32.const(32),
+    const flattenLoop_2: FlattenLoop = {
+        label: loop_label_2,
+        condition: module.if(
+            module.i32.gt_u(end, start),
+            isAsciiWhiteSpace(
+                module,
+                charAt(() => module.i32.sub(end, module.i32.const(1))),
             ),
-            module.block(null, [
-                module.local.set(
-                    trimEndIdx,
-                    module.local.get(for_i_Idx, binaryen.i32),
-                ),
-                /**jump out the loop */
-                module.br(block_label_2),
-            ]),
+            module.i32.const(0),
         ),
-        /**dec i */
-        module.local.set(
-            for_i_Idx,
-            module.i32.sub(
-                module.local.get(for_i_Idx, binaryen.i32),
-                module.i32.const(1),
-            ),
+        statements: module.local.set(
+            trimEndIdx,
+            module.i32.sub(end, module.i32.const(1)),
         ),
-        /**jump out the loop */
-        module.br(
-            block_label_2,
-            module.i32.le_s(
-                module.local.get(for_i_Idx, binaryen.i32),
-                module.i32.const(-1),
+    };
+    statementArray.push(
+        module.loop(
+            loop_label_2,
+            FunctionalFuncs.flattenLoopStatement(
+                module,
+                flattenLoop_2,
+                SemanticsKind.WHILE,
             ),
         ),
-        /**jump to loop */
-        module.br(loop_label_2),
-    ]);
-    const loop_2 = module.loop(loop_label_2, loop_stmts_2);
-    const stmts_block_2 = module.block(block_label_2, [loop_init_2, loop_2]);
-    statementArray.push(stmts_block_2);
+    );
 
-    /**copy the array between trimStart and trimEnd */
-    const newStrLen = module.i32.add(
-        module.i32.sub(
-            module.local.get(trimEndIdx, binaryen.i32),
-            module.local.get(trimStartIdx, binaryen.i32),
+    /**nothing to strip */
+    statementArray.push(
+        module.if(
+            module.i32.and(module.i32.eqz(start), module.i32.eq(end, len)),
+            module.return(thisStrStruct),
         ),
-        module.i32.const(1),
     );
 
+    /**copy the array between trimStart and trimEnd */
+    const newStrLen = () => module.i32.sub(end, start);
+
     statementArray.push(
         module.local.set(
             newStrCharArrayIdx,
             binaryenCAPI._BinaryenArrayNew(
                 module.ptr,
                 i8ArrayTypeInfo.heapTypeRef,
-                newStrLen,
+                newStrLen(),
                 module.i32.const(0),
             ),
         ),
@@ -3067,9 +3132,9 @@ function string_trim(module: binaryen.Module) {
             module.ptr,
             module.local.get(newStrCharArrayIdx, i8ArrayTypeInfo.typeRef),
             module.i32.const(0),
-            thisStrCharArray,
-            module.local.get(trimStartIdx, binaryen.i32),
-            newStrLen,
+            thisStrCharArray(),
+            start,
+            newStrLen(),
         ),
     );
     statementArray.push(
@@ -3106,96 +3171,503 @@ function string_trim_stringref(module: binaryen.Module) {
     const len = module.local.get(len_index, binaryen.i32);
     const statementArray: binaryen.ExpressionRef[] = [];
 
-    statementArray.push(
-        module.local.set(
-            len_index,
-            binaryenCAPI._BinaryenStringMeasure(
-                module.ptr,
-                StringRefMeatureOp.WTF16,
-                ref,
-            ),
-        ),
+    statementArray.push(
+        module.local.set(
+            len_index,
+            binaryenCAPI._BinaryenStringMeasure(
+                module.ptr,
+                StringRefMeatureOp.WTF16,
+                ref,
+            ),
+        ),
+    );
+    statementArray.push(module.local.set(start_index, module.i32.const(0)));
+    statementArray.push(module.local.set(end_index, len));
+    let loop_index = 0;
+    /* read the code units directly instead of creating a string by charAt
+     * for every character */
+    const while_loop = (
+        indexRef: binaryenCAPI.ExpressionRef,
+        index: number,
+        from_start: boolean,
+    ) => {
+        const char = () =>
+            binaryenCAPI._BinaryenStringWTF16Get(
+                module.ptr,
+                binaryenCAPI._BinaryenStringAs(
+                    module.ptr,
+                    StringRefAsOp.WTF16,
+                    ref,
+                ),
+                from_start
+                    ? indexRef
+                    : module.i32.sub(indexRef, module.i32.const(1)),
+            );
+        const loopLabel = `while_loop_${loop_index++}`;
+        const loopCond = module.if(
+            module.i32.lt_u(start, end),
+            isAsciiWhiteSpace(module, char),
+            module.i32.const(0),
+        );
+        const loopStmts = module.block(null, [
+            module.local.set(
+                index,
+                from_start
+                    ? module.i32.add(indexRef, module.i32.const(1))
+                    : module.i32.sub(indexRef, module.i32.const(1)),
+            ),
+        ]);
+        const flattenLoop: FlattenLoop = {
+            label: loopLabel,
+            condition: loopCond,
+            statements: loopStmts,
+        };
+        return module.loop(
+            loopLabel,
+            FunctionalFuncs.flattenLoopStatement(
+                module,
+                flattenLoop,
+                SemanticsKind.WHILE,
+            ),
+        );
+    };
+    statementArray.push(while_loop(start, start_index, true));
+    statementArray.push(while_loop(end, end_index, false));
+    statementArray.push(
+        module.if(
+            module.i32.and(module.i32.eqz(start), module.i32.eq(end, len)),
+            module.return(ref),
+        ),
+    );
+    statementArray.push(
+        binaryenCAPI._BinaryenStringSliceWTF(
+            module.ptr,
+            StringRefSliceOp.WTF16,
+            binaryenCAPI._BinaryenStringAs(
+                module.ptr,
+                StringRefAsOp.WTF16,
+                ref,
+            ),
+            start,
+            end,
+        ),
+    );
+    return module.block('string_trim', statementArray);
+}
+
+function math_round(module: binaryen.Module) {
+    /* params */
+    const x_idx = 2;
+    /* vars */
+    const res_idx = 3;
+
+    /* Math.round rounds half toward +Infinity and keeps the sign of zero:
+        res = ceil(x); if (res - 0.5 > x) res -= 1 */
+    const x = module.local.get(x_idx, binaryen.f64);
+    const res = module.local.get(res_idx, binaryen.f64);
+    const stmts: binaryen.ExpressionRef[] = [];
+    stmts.push(module.local.set(res_idx, module.f64.ceil(x)));
+    stmts.push(
+        module.if(
+            module.f64.gt(module.f64.sub(res, module.f64.const(0.5)), x),
+            module.local.set(
+                res_idx,
+                module.f64.sub(res, module.f64.const(1)),
+            ),
+        ),
+    );
+    stmts.push(module.return(res));
+    return module.block(null, stmts);
+}
+
+function math_sign(module: binaryen.Module) {
+    /* params */
+    const x_idx = 2;
+
+    /* NaN, +0 and -0 are returned as is */
+    const x = module.local.get(x_idx, binaryen.f64);
+    return module.select(
+        module.f64.gt(x, module.f64.const(0)),
+        module.f64.const(1),
+        module.select(
+            module.f64.lt(x, module.f64.const(0)),
+            module.f64.const(-1),
+            x,
+        ),
+    );
+}
+
+function math_hypot(module: binaryen.Module) {
+    /* params */
+    const values_idx = 2;
+    /* vars */
+    const loopIdx_i32_idx = 3;
+    const valuesLen_i32_idx = 4;
+    const valuesArr_idx = 5;
+    const scale_f64_idx = 6;
+    const sum_f64_idx = 7;
+    const value_f64_idx = 8;
+
+    const loopIndexValue = module.local.get(loopIdx_i32_idx, binaryen.i32);
+    const valuesArr = module.local.get(
+        valuesArr_idx,
+        numberArrayTypeInfo.typeRef,
+    );
+    const scale = module.local.get(scale_f64_idx, binaryen.f64);
+    const sum = module.local.get(sum_f64_idx, binaryen.f64);
+    const value = module.local.get(value_f64_idx, binaryen.f64);
+    const elem = binaryenCAPI._BinaryenArrayGet(
+        module.ptr,
+        valuesArr,
+        loopIndexValue,
+        numberArrayTypeInfo.typeRef,
+        false,
+    );
+
+    const stmts: binaryen.ExpressionRef[] = [];
+    stmts.push(
+        module.local.set(
+            valuesArr_idx,
+            array_get_data(
+                module,
+                module.local.get(values_idx, numberArrayStructTypeInfo.typeRef),
+            ),
+        ),
+    );
+    stmts.push(
+        module.local.set(
+            valuesLen_i32_idx,
+            array_get_length_i32(
+                module,
+                module.local.get(values_idx, numberArrayStructTypeInfo.typeRef),
+            ),
+        ),
+    );
+    stmts.push(module.local.set(scale_f64_idx, module.f64.const(0)));
+    stmts.push(module.local.set(sum_f64_idx, module.f64.const(0)));
+
+    /* find the largest magnitude, Infinity wins over NaN */
+    const scanLabel = 'scan_label';
+    const scanBody: binaryen.ExpressionRef[] = [];
+    scanBody.push(module.local.set(value_f64_idx, module.f64.abs(elem)));
+    scanBody.push(
+        module.if(
+            module.f64.eq(value, module.f64.const(Infinity)),
+            module.return(value),
+        ),
+    );
+    scanBody.push(
+        module.if(
+            module.i32.or(
+                module.f64.ne(value, value),
+                module.f64.lt(scale, value),
+            ),
+            module.local.set(scale_f64_idx, value),
+        ),
+    );
+    stmts.push(module.local.set(loopIdx_i32_idx, module.i32.const(0)));
+    stmts.push(
+        module.loop(
+            scanLabel,
+            FunctionalFuncs.flattenLoopStatement(
+                module,
+                {
+                    label: scanLabel,
+                    condition: module.i32.lt_s(
+                        loopIndexValue,
+                        module.local.get(valuesLen_i32_idx, binaryen.i32),
+                    ),
+                    statements: module.block(null, scanBody),
+                    incrementor: module.local.set(
+                        loopIdx_i32_idx,
+                        module.i32.add(loopIndexValue, module.i32.const(1)),
+                    ),
+                },
+                SemanticsKind.FOR,
+            ),
+        ),
+    );
+    /* all zero or NaN */
+    stmts.push(
+        module.if(
+            module.i32.or(
+                module.f64.eq(scale, module.f64.const(0)),
+                module.f64.ne(scale, scale),
+            ),
+            module.return(scale),
+        ),
+    );
+
+    /* sum the squares scaled to avoid overflow and underflow */
+    const sumLabel = 'sum_label';
+    stmts.push(module.local.set(loopIdx_i32_idx, module.i32.const(0)));
+    stmts.push(
+        module.loop(
+            sumLabel,
+            FunctionalFuncs.flattenLoopStatement(
+                module,
+                {
+                    label: sumLabel,
+                    condition: module.i32.lt_s(
+                        loopIndexValue,
+                        module.local.get(valuesLen_i32_idx, binaryen.i32),
+                    ),
+                    statements: module.block(null, [
+                        module.local.set(
+                            value_f64_idx,
+                            module.f64.div(elem, scale),
+                        ),
+                        module.local.set(
+                            sum_f64_idx,
+                            module.f64.add(sum, module.f64.mul(value, value)),
+                        ),
+                    ]),
+                    incrementor: module.local.set(
+                        loopIdx_i32_idx,
+                        module.i32.add(loopIndexValue, module.i32.const(1)),
+                    ),
+                },
+                SemanticsKind.FOR,
+            ),
+        ),
+    );
+    stmts.push(module.return(module.f64.mul(module.f64.sqrt(sum), scale)));
+    return module.block(null, stmts);
+}
+
+function addMathNativeMethods(module: binaryen.Module) {
+    /* Math methods without a wasm instruction are forwarded to the libm
+        backed natives, the wrappers are inlined when optimizing */
+    const addMathNativeMethod = (method: string, paramCount: number) => {
+        const nativeFuncName = `${BuiltinNames.mathNativeFuncPrefix}${method}`;
+        const params: binaryen.ExpressionRef[] = [];
+        for (let i = 0; i < paramCount; i++) {
+            params.push(module.local.get(i + 2, binaryen.f64));
+        }
+        module.addFunctionImport(
+            nativeFuncName,
+            BuiltinNames.externalModuleName,
+            nativeFuncName,
+            binaryen.createType(new Array(paramCount).fill(binaryen.f64)),
+            binaryen.f64,
+        );
+        module.addFunction(
+            UtilFuncs.getFuncName(
+                BuiltinNames.builtinModuleName,
+                `${BuiltinNames.MATH}|${method}`,
+            ),
+            binaryen.createType([
+                emptyStructType.typeRef,
+                emptyStructType.typeRef,
+                ...new Array(paramCount).fill(binaryen.f64),
+            ]),
+            binaryen.f64,
+            [],
+            module.call(nativeFuncName, params, binaryen.f64),
+        );
+    };
+
+    for (const method of BuiltinNames.mathUnaryNativeMethods) {
+        addMathNativeMethod(method, 1);
+    }
+    for (const method of BuiltinNames.mathBinaryNativeMethods) {
+        addMathNativeMethod(method, 2);
+    }
+    addMathNativeMethod('random', 0);
+    /* only used by the call site lowering of Math.hypot(x, y) */
+    module.addFunctionImport(
+        BuiltinNames.mathHypotNativeFuncName,
+        BuiltinNames.externalModuleName,
+        BuiltinNames.mathHypotNativeFuncName,
+        binaryen.createType([binaryen.f64, binaryen.f64]),
+        binaryen.f64,
+    );
+}
+
+function addNumberParseMethods(module: binaryen.Module) {
+    /* the natives read the i8 array of the string, with stringref the
+        string is copied to the linear memory as a NUL terminated string */
+    const useCString = getConfig().enableStringRef;
+    const strTypeRef = useCString
+        ? binaryenCAPI._BinaryenTypeStringref()
+        : stringTypeInfo.typeRef;
+    const addNumberParseMethod = (
+        funcName: string,
+        nativeFuncName: string,
+        isMethod: boolean,
+        withRadix: boolean,
+    ) => {
+        if (useCString) {
+            nativeFuncName = `${nativeFuncName}${BuiltinNames.cstrNativeFuncSuffix}`;
+        }
+        /** Args: context, [this], string, [radix] */
+        const paramTypes = [emptyStructType.typeRef, strTypeRef];
+        if (isMethod) {
+            paramTypes.unshift(emptyStructType.typeRef);
+        }
+        const strIdx = paramTypes.length - 1;
+        if (withRadix) {
+            paramTypes.push(binaryen.anyref);
+        }
+        /** Locals: cstrIdx, resultIdx */
+        const cstrIdx = paramTypes.length;
+        const resultIdx = cstrIdx + 1;
+        const str = module.local.get(strIdx, strTypeRef);
+
+        const nativeParamTypes = [
+            useCString ? binaryen.i32 : i8ArrayTypeInfo.typeRef,
+        ];
+        const nativeArgs = [
+            useCString
+                ? module.local.get(cstrIdx, binaryen.i32)
+                : binaryenCAPI._BinaryenStructGet(
+                      module.ptr,
+                      1,
+                      str,
+                      i8ArrayTypeInfo.typeRef,
+                      false,
+                  ),
+        ];
+        if (withRadix) {
+            /* undefined radix is passed as 0 */
+            const radix = module.local.get(strIdx + 1, binaryen.anyref);
+            nativeParamTypes.push(binaryen.f64);
+            nativeArgs.push(
+                module.if(
+                    FunctionalFuncs.isBaseType(
+                        module,
+                        radix,
+                        dyntype.dyntype_is_undefined,
+                    ),
+                    module.f64.const(0),
+                    FunctionalFuncs.unboxAnyToBase(
+                        module,
+                        module.local.get(strIdx + 1, binaryen.anyref),
+                        ValueTypeKind.NUMBER,
+                    ),
+                ),
+            );
+        }
+        module.addFunctionImport(
+            nativeFuncName,
+            BuiltinNames.externalModuleName,
+            nativeFuncName,
+            binaryen.createType(nativeParamTypes),
+            binaryen.f64,
+        );
+        const callNative = module.call(
+            nativeFuncName,
+            nativeArgs,
+            binaryen.f64,
+        );
+
+        let body = callNative;
+        if (useCString) {
+            const cstr = module.local.get(cstrIdx, binaryen.i32);
+            body = module.block(null, [
+                module.local.set(
+                    cstrIdx,
+                    module.call(
+                        BuiltinNames.mallocFunc,
+                        [
+                            module.i32.add(
+                                binaryenCAPI._BinaryenStringMeasure(
+                                    module.ptr,
+                                    StringRefMeatureOp.WTF8,
+                                    str,
+                                ),
+                                module.i32.const(1),
+                            ),
+                        ],
+                        binaryen.i32,
+                    ),
+                ),
+                module.i32.store8(
+                    0,
+                    1,
+                    module.i32.add(
+                        cstr,
+                        binaryenCAPI._BinaryenStringEncode(
+                            module.ptr,
+                            StringRefMeatureOp.WTF8,
+                            module.local.get(strIdx, strTypeRef),
+                            module.local.get(cstrIdx, binaryen.i32),
+                            0,
+                        ),
+                    ),
+                    module.i32.const(0),
+                ),
+                module.local.set(resultIdx, callNative),
+                module.call(
+                    BuiltinNames.freeFunc,
+                    [module.local.get(cstrIdx, binaryen.i32)],
+                    binaryen.none,
+                ),
+                module.return(module.local.get(resultIdx, binaryen.f64)),
+            ]);
+        }
+        module.addFunction(
+            UtilFuncs.getFuncName(BuiltinNames.builtinModuleName, funcName),
+            binaryen.createType(paramTypes),
+            binaryen.f64,
+            useCString ? [binaryen.i32, binaryen.f64] : [],
+            body,
+        );
+    };
+
+    addNumberParseMethod(
+        BuiltinNames.numberParseFloatFuncName,
+        BuiltinNames.numberParseFloatNativeFuncName,
+        true,
+        false,
     );
-    statementArray.push(
-        module.if(module.i32.eq(len, module.i32.const(0)), module.return(ref)),
+    addNumberParseMethod(
+        BuiltinNames.numberParseIntFuncName,
+        BuiltinNames.numberParseIntNativeFuncName,
+        true,
+        true,
     );
-    statementArray.push(module.local.set(start_index, module.i32.const(0)));
-    statementArray.push(
-        module.local.set(end_index, module.i32.sub(len, module.i32.const(1))),
+    /* Number(str) and +str */
+    addNumberParseMethod(
+        BuiltinNames.stringToNumberFuncName,
+        BuiltinNames.numberFromStringNativeFuncName,
+        false,
+        false,
     );
-    let loop_index = 0;
-    const while_loop = (
-        indexRef: binaryenCAPI.ExpressionRef,
-        index: number,
-        boundRef: binaryenCAPI.ExpressionRef,
-        from_start: boolean,
+}
+
+/* natives used by the call site lowering of console.log/error/warn */
+function addConsoleWriteMethods(module: binaryen.Module) {
+    const addConsoleWriteMethod = (
+        nativeFuncName: string,
+        paramTypes: binaryen.Type[],
     ) => {
-        const char = module.call(
-            UtilFuncs.getFuncName(
-                BuiltinNames.builtinModuleName,
-                BuiltinNames.stringcharAtFuncName,
-            ),
-            [
-                module.local.get(0, emptyStructType.typeRef),
-                ref,
-                module.f64.convert_u.i32(indexRef),
-            ],
-            binaryenCAPI._BinaryenTypeStringref(),
-        );
-        const accessBound = from_start
-            ? module.i32.le_u(indexRef, boundRef)
-            : module.i32.ge_u(indexRef, boundRef);
-        const loopLabel = `while_loop_${loop_index++}`;
-        const loopCond = module.i32.and(
-            accessBound,
-            binaryenCAPI._BinaryenStringEq(
-                module.ptr,
-                StringRefEqOp.EQ,
-                char,
-                binaryenCAPI._BinaryenStringConst(
-                    module.ptr,
-                    UtilFuncs.getCString(' '),
-                ),
-            ),
-        );
-        const loopStmts = module.block(null, [
-            module.local.set(
-                index,
-                from_start
-                    ? module.i32.add(indexRef, module.i32.const(1))
-                    : module.i32.sub(indexRef, module.i32.const(1)),
-            ),
-        ]);
-        const flattenLoop: FlattenLoop = {
-            label: loopLabel,
-            condition: loopCond,
-            statements: loopStmts,
-        };
-        return module.loop(
-            loopLabel,
-            FunctionalFuncs.flattenLoopStatement(
-                module,
-                flattenLoop,
-                SemanticsKind.WHILE,
-            ),
+        module.addFunctionImport(
+            nativeFuncName,
+            BuiltinNames.externalModuleName,
+            nativeFuncName,
+            binaryen.createType([binaryen.i32, ...paramTypes]),
+            binaryen.none,
         );
     };
-    statementArray.push(while_loop(start, start_index, end, true));
-    statementArray.push(while_loop(end, end_index, start, false));
-    statementArray.push(
-        binaryenCAPI._BinaryenStringSliceWTF(
-            module.ptr,
-            StringRefSliceOp.WTF16,
-            binaryenCAPI._BinaryenStringAs(
-                module.ptr,
-                StringRefAsOp.WTF16,
-                ref,
-            ),
-            start,
-            module.i32.add(end, module.i32.const(1)),
-        ),
-    );
-    return module.block('string_trim', statementArray);
+
+    addConsoleWriteMethod(BuiltinNames.consoleWriteNumberFuncName, [
+        binaryen.f64,
+    ]);
+    addConsoleWriteMethod(BuiltinNames.consoleWriteBooleanFuncName, [
+        binaryen.i32,
+    ]);
+    if (getConfig().enableStringRef) {
+        /* the native reads the string without copying it */
+        addConsoleWriteMethod(BuiltinNames.consoleWriteStringrefFuncName, [
+            binaryenCAPI._BinaryenTypeStringref(),
+        ]);
+    } else {
+        addConsoleWriteMethod(BuiltinNames.consoleWriteStringFuncName, [
+            i8ArrayTypeInfo.typeRef,
+        ]);
+    }
+    addConsoleWriteMethod(BuiltinNames.consoleWriteEndFuncName, []);
 }
 
 function Array_isArray(module: binaryen.Module) {
@@ -3388,6 +3860,37 @@ function allocExtRefTableSlot(module: binaryen.Module) {
     return module.block(null, stmts);
 }
 
+/** release a slot taken by allocExtRefTableSlot, used by runtime natives
+ * which only hold the object temporarily (e.g. timer callbacks) */
+function freeExtRefTableSlot(module: binaryen.Module) {
+    const tableIdx = 0;
+
+    const arrName = getBuiltInFuncName(BuiltinNames.extRefTableMaskArr);
+    const maskArr = binaryenCAPI._BinaryenGlobalGet(
+        module.ptr,
+        UtilFuncs.getCString(arrName),
+        i8ArrayTypeInfo.typeRef,
+    );
+    const stmts: binaryen.ExpressionRef[] = [];
+    stmts.push(
+        binaryenCAPI._BinaryenTableSet(
+            module.ptr,
+            UtilFuncs.getCString(BuiltinNames.extrefTable),
+            module.local.get(tableIdx, binaryen.i32),
+            FunctionalFuncs.getEmptyRef(module),
+        ),
+    );
+    stmts.push(
+        binaryenCAPI._BinaryenArraySet(
+            module.ptr,
+            maskArr,
+            module.local.get(tableIdx, binaryen.i32),
+            module.i32.const(0),
+        ),
+    );
+    return module.block(null, stmts);
+}
+
 /** to extref with runtime getting table index */
 function newExtRef(module: binaryen.Module) {
     const _context_unused = 0;
@@ -3711,6 +4214,30 @@ function arrayBufferConstructor(module: binaryen.Module) {
     return module.block(null, stmts);
 }
 
+/* unbox an optional number parameter, undefined gets the default value */
+function unboxOptionalAnyToI32(
+    module: binaryen.Module,
+    anyref: binaryen.ExpressionRef,
+    valueIdx: number,
+    defaultValue: binaryen.ExpressionRef,
+) {
+    const isUndefined = FunctionalFuncs.isBaseType(
+        module,
+        anyref,
+        dyntype.dyntype_is_undefined,
+    );
+    const value = FunctionalFuncs.unboxAnyToBase(
+        module,
+        anyref,
+        ValueTypeKind.INT,
+    );
+    return module.if(
+        isUndefined,
+        module.local.set(valueIdx, defaultValue),
+        module.local.set(valueIdx, value),
+    );
+}
+
 function dataViewConstructor(module: binaryen.Module) {
     /* params */
     const context_Idx = 0;
@@ -3734,30 +4261,8 @@ function dataViewConstructor(module: binaryen.Module) {
         false,
     );
 
-    const unboxAnyToI32 = (
-        module: binaryen.Module,
-        anyref: binaryen.ExpressionRef,
-        valueIdx: number,
-        defaultValue: binaryen.ExpressionRef,
-    ) => {
-        const isUndefined = FunctionalFuncs.isBaseType(
-            module,
-            anyref,
-            dyntype.dyntype_is_undefined,
-        );
-        const value = FunctionalFuncs.unboxAnyToBase(
-            module,
-            anyref,
-            ValueTypeKind.INT,
-        );
-        return module.if(
-            isUndefined,
-            module.local.set(valueIdx, defaultValue),
-            module.local.set(valueIdx, value),
-        );
-    };
     stmts.push(
-        unboxAnyToI32(
+        unboxOptionalAnyToI32(
             module,
             byteOffset_anyref,
             byteOffset_i32Idx,
@@ -3766,7 +4271,7 @@ function dataViewConstructor(module: binaryen.Module) {
     );
 
     stmts.push(
-        unboxAnyToI32(
+        unboxOptionalAnyToI32(
             module,
             byteLength_anyref,
             byteLength_i32Idx,
@@ -3948,28 +4453,109 @@ function dataView_basicOps(
     return stmts;
 }
 
-function load_i8(
+/* element sizes of the dataview natives */
+const dataViewElemSizes = new Map<string, number>([
+    [BuiltinNames.dataViewLoad16FuncName, 2],
+    [BuiltinNames.dataViewLoad32FuncName, 4],
+    [BuiltinNames.dataViewLoad64FuncName, 8],
+    [BuiltinNames.dataViewStore16FuncName, 2],
+    [BuiltinNames.dataViewStore32FuncName, 4],
+    [BuiltinNames.dataViewStore64FuncName, 8],
+]);
+
+/* copy the element between the i8 array and the reserved linear memory one
+    byte at a time, in the order given by littleEndian, for hosts without the
+    dataview natives */
+function dataView_copyBytes(
     module: binaryen.Module,
     i8Array_idx: number,
     targetOffset_idx: number,
-    memoryPtrOffset: number,
-    targetPtrOffset: number,
+    littleEndian_i32_idx: number,
+    size: number,
+    toMemory: boolean,
 ) {
-    return binaryenCAPI._BinaryenArraySet(
-        module.ptr,
-        module.local.get(i8Array_idx, i8ArrayTypeInfo.typeRef),
-        module.i32.add(
+    const copyByte = (memoryPtrOffset: number, targetPtrOffset: number) => {
+        const memoryPtr = module.i32.const(
+            BuiltinNames.memoryReserveOffset + memoryPtrOffset,
+        );
+        const targetPtr = module.i32.add(
             module.local.get(targetOffset_idx, binaryen.i32),
             module.i32.const(targetPtrOffset),
+        );
+        const i8Array = module.local.get(i8Array_idx, i8ArrayTypeInfo.typeRef);
+        return toMemory
+            ? module.i32.store8(
+                  0,
+                  1,
+                  memoryPtr,
+                  binaryenCAPI._BinaryenArrayGet(
+                      module.ptr,
+                      i8Array,
+                      targetPtr,
+                      i8ArrayTypeInfo.typeRef,
+                      false,
+                  ),
+              )
+            : binaryenCAPI._BinaryenArraySet(
+                  module.ptr,
+                  i8Array,
+                  targetPtr,
+                  module.i32.load8_s(0, 1, memoryPtr),
+              );
+    };
+    const inOrder: binaryen.ExpressionRef[] = [];
+    const reversed: binaryen.ExpressionRef[] = [];
+    for (let i = 0; i < size; i++) {
+        inOrder.push(copyByte(i, i));
+        reversed.push(copyByte(size - 1 - i, i));
+    }
+    return module.if(
+        module.i32.eq(
+            module.local.get(littleEndian_i32_idx, binaryen.i32),
+            module.i32.const(1),
         ),
-        module.i32.load8_s(
-            0,
-            1,
-            module.i32.add(
-                module.i32.const(BuiltinNames.memoryReserveOffset),
-                module.i32.const(memoryPtrOffset),
+        module.block(null, inOrder),
+        module.block(null, reversed),
+    );
+}
+
+function dataView_store(
+    module: binaryen.Module,
+    funcName: string,
+    i8Array_idx: number,
+    targetOffset_idx: number,
+    value: binaryen.ExpressionRef,
+    littleEndian_i32_idx: number,
+) {
+    if (getConfig().byteDataView) {
+        const size = dataViewElemSizes.get(funcName)!;
+        const memoryPtr = module.i32.const(BuiltinNames.memoryReserveOffset);
+        return module.block(null, [
+            size === 2
+                ? module.i32.store16(0, 2, memoryPtr, value)
+                : size === 4
+                ? module.i32.store(0, 4, memoryPtr, value)
+                : module.i64.store(0, 8, memoryPtr, value),
+            dataView_copyBytes(
+                module,
+                i8Array_idx,
+                targetOffset_idx,
+                littleEndian_i32_idx,
+                size,
+                false,
             ),
-        ),
+        ]);
+    }
+    /* write the whole element into the i8 array payload at once */
+    return module.call(
+        funcName,
+        [
+            module.local.get(i8Array_idx, i8ArrayTypeInfo.typeRef),
+            module.local.get(targetOffset_idx, binaryen.i32),
+            value,
+            module.local.get(littleEndian_i32_idx, binaryen.i32),
+        ],
+        binaryen.none,
     );
 }
 
@@ -4088,29 +4674,14 @@ function dataView_setInt16(module: binaryen.Module) {
         littleEndian_i32_idx,
     );
     stmts.push(convertI32ToUnsignedValue(module, value_idx, value_i32_idx, 2));
-    /* Put elem in linear memory based on if littleEndian */
     stmts.push(
-        module.i32.store16(
-            0,
-            2,
-            module.i32.const(BuiltinNames.memoryReserveOffset),
+        dataView_store(
+            module,
+            BuiltinNames.dataViewStore16FuncName,
+            i8Array_idx,
+            targetOffset_idx,
             module.local.get(value_i32_idx, binaryen.i32),
-        ),
-    );
-    stmts.push(
-        module.if(
-            module.i32.eq(
-                module.local.get(littleEndian_i32_idx, binaryen.i32),
-                module.i32.const(1),
-            ),
-            module.block(null, [
-                load_i8(module, i8Array_idx, targetOffset_idx, 0, 0),
-                load_i8(module, i8Array_idx, targetOffset_idx, 1, 1),
-            ]),
-            module.block(null, [
-                load_i8(module, i8Array_idx, targetOffset_idx, 1, 0),
-                load_i8(module, i8Array_idx, targetOffset_idx, 0, 1),
-            ]),
+            littleEndian_i32_idx,
         ),
     );
 
@@ -4152,33 +4723,14 @@ function dataView_setInt32(module: binaryen.Module) {
         littleEndian_i32_idx,
     );
     stmts.push(convertI32ToUnsignedValue(module, value_idx, value_i32_idx, 4));
-    /* Put elem in linear memory based on if littleEndian */
     stmts.push(
-        module.i32.store(
-            0,
-            4,
-            module.i32.const(BuiltinNames.memoryReserveOffset),
+        dataView_store(
+            module,
+            BuiltinNames.dataViewStore32FuncName,
+            i8Array_idx,
+            targetOffset_idx,
             module.local.get(value_i32_idx, binaryen.i32),
-        ),
-    );
-    stmts.push(
-        module.if(
-            module.i32.eq(
-                module.local.get(littleEndian_i32_idx, binaryen.i32),
-                module.i32.const(1),
-            ),
-            module.block(null, [
-                load_i8(module, i8Array_idx, targetOffset_idx, 0, 0),
-                load_i8(module, i8Array_idx, targetOffset_idx, 1, 1),
-                load_i8(module, i8Array_idx, targetOffset_idx, 2, 2),
-                load_i8(module, i8Array_idx, targetOffset_idx, 3, 3),
-            ]),
-            module.block(null, [
-                load_i8(module, i8Array_idx, targetOffset_idx, 3, 0),
-                load_i8(module, i8Array_idx, targetOffset_idx, 2, 1),
-                load_i8(module, i8Array_idx, targetOffset_idx, 1, 2),
-                load_i8(module, i8Array_idx, targetOffset_idx, 0, 3),
-            ]),
+            littleEndian_i32_idx,
         ),
     );
 
@@ -4228,33 +4780,14 @@ function dataView_setFloat32(module: binaryen.Module) {
             ),
         ),
     );
-    /* Put elem in linear memory based on if littleEndian */
     stmts.push(
-        module.i32.store(
-            0,
-            4,
-            module.i32.const(BuiltinNames.memoryReserveOffset),
+        dataView_store(
+            module,
+            BuiltinNames.dataViewStore32FuncName,
+            i8Array_idx,
+            targetOffset_idx,
             module.local.get(value_i32_idx, binaryen.i32),
-        ),
-    );
-    stmts.push(
-        module.if(
-            module.i32.eq(
-                module.local.get(littleEndian_i32_idx, binaryen.i32),
-                module.i32.const(1),
-            ),
-            module.block(null, [
-                load_i8(module, i8Array_idx, targetOffset_idx, 0, 0),
-                load_i8(module, i8Array_idx, targetOffset_idx, 1, 1),
-                load_i8(module, i8Array_idx, targetOffset_idx, 2, 2),
-                load_i8(module, i8Array_idx, targetOffset_idx, 3, 3),
-            ]),
-            module.block(null, [
-                load_i8(module, i8Array_idx, targetOffset_idx, 3, 0),
-                load_i8(module, i8Array_idx, targetOffset_idx, 2, 1),
-                load_i8(module, i8Array_idx, targetOffset_idx, 1, 2),
-                load_i8(module, i8Array_idx, targetOffset_idx, 0, 3),
-            ]),
+            littleEndian_i32_idx,
         ),
     );
 
@@ -4302,74 +4835,104 @@ function dataView_setFloat64(module: binaryen.Module) {
             module.i64.reinterpret(module.local.get(value_idx, binaryen.f64)),
         ),
     );
-    /* Put elem in linear memory based on if littleEndian */
     stmts.push(
-        module.i64.store(
-            0,
-            8,
-            module.i32.const(BuiltinNames.memoryReserveOffset),
+        dataView_store(
+            module,
+            BuiltinNames.dataViewStore64FuncName,
+            i8Array_idx,
+            targetOffset_idx,
             module.local.get(value_i64_idx, binaryen.i64),
-        ),
-    );
-    stmts.push(
-        module.if(
-            module.i32.eq(
-                module.local.get(littleEndian_i32_idx, binaryen.i32),
-                module.i32.const(1),
-            ),
-            module.block(null, [
-                load_i8(module, i8Array_idx, targetOffset_idx, 0, 0),
-                load_i8(module, i8Array_idx, targetOffset_idx, 1, 1),
-                load_i8(module, i8Array_idx, targetOffset_idx, 2, 2),
-                load_i8(module, i8Array_idx, targetOffset_idx, 3, 3),
-                load_i8(module, i8Array_idx, targetOffset_idx, 4, 4),
-                load_i8(module, i8Array_idx, targetOffset_idx, 5, 5),
-                load_i8(module, i8Array_idx, targetOffset_idx, 6, 6),
-                load_i8(module, i8Array_idx, targetOffset_idx, 7, 7),
-            ]),
-            module.block(null, [
-                load_i8(module, i8Array_idx, targetOffset_idx, 7, 0),
-                load_i8(module, i8Array_idx, targetOffset_idx, 6, 1),
-                load_i8(module, i8Array_idx, targetOffset_idx, 5, 2),
-                load_i8(module, i8Array_idx, targetOffset_idx, 4, 3),
-                load_i8(module, i8Array_idx, targetOffset_idx, 3, 4),
-                load_i8(module, i8Array_idx, targetOffset_idx, 2, 5),
-                load_i8(module, i8Array_idx, targetOffset_idx, 1, 6),
-                load_i8(module, i8Array_idx, targetOffset_idx, 0, 7),
-            ]),
+            littleEndian_i32_idx,
         ),
     );
 
     return module.block(null, stmts);
 }
 
-function store_i8(
+function dataView_load(
     module: binaryen.Module,
+    funcName: string,
     i8Array_idx: number,
     targetOffset_idx: number,
-    memoryPtrOffset: number,
-    targetPtrOffset: number,
+    littleEndian_i32_idx: number,
+    resultType: binaryen.Type,
 ) {
-    return module.i32.store8(
-        0,
-        1,
-        module.i32.add(
-            module.i32.const(BuiltinNames.memoryReserveOffset),
-            module.i32.const(memoryPtrOffset),
-        ),
-        binaryenCAPI._BinaryenArrayGet(
-            module.ptr,
+    if (getConfig().byteDataView) {
+        const size = dataViewElemSizes.get(funcName)!;
+        const memoryPtr = module.i32.const(BuiltinNames.memoryReserveOffset);
+        return module.block(
+            null,
+            [
+                dataView_copyBytes(
+                    module,
+                    i8Array_idx,
+                    targetOffset_idx,
+                    littleEndian_i32_idx,
+                    size,
+                    true,
+                ),
+                size === 2
+                    ? module.i32.load16_u(0, 2, memoryPtr)
+                    : size === 4
+                    ? module.i32.load(0, 4, memoryPtr)
+                    : module.i64.load(0, 8, memoryPtr),
+            ],
+            resultType,
+        );
+    }
+    /* read the whole element from the i8 array payload at once */
+    return module.call(
+        funcName,
+        [
             module.local.get(i8Array_idx, i8ArrayTypeInfo.typeRef),
-            module.i32.add(
-                module.local.get(targetOffset_idx, binaryen.i32),
-                module.i32.const(targetPtrOffset),
-            ),
-            i8ArrayTypeInfo.typeRef,
-            false,
-        ),
+            module.local.get(targetOffset_idx, binaryen.i32),
+            module.local.get(littleEndian_i32_idx, binaryen.i32),
+        ],
+        resultType,
     );
 }
 
+function addDataViewNativeImports(module: binaryen.Module) {
+    if (getConfig().byteDataView) {
+        return;
+    }
+    /* multi-byte elements are accessed by natives working on the payload of
+        the i8 array, they also swap the bytes for big endian */
+    const loads: [string, binaryen.Type][] = [
+        [BuiltinNames.dataViewLoad16FuncName, binaryen.i32],
+        [BuiltinNames.dataViewLoad32FuncName, binaryen.i32],
+        [BuiltinNames.dataViewLoad64FuncName, binaryen.i64],
+    ];
+    const stores: [string, binaryen.Type][] = [
+        [BuiltinNames.dataViewStore16FuncName, binaryen.i32],
+        [BuiltinNames.dataViewStore32FuncName, binaryen.i32],
+        [BuiltinNames.dataViewStore64FuncName, binaryen.i64],
+    ];
+    for (const [funcName, resultType] of loads) {
+        module.addFunctionImport(
+            funcName,
+            BuiltinNames.externalModuleName,
+            funcName,
+            binaryen.createType([binaryen.anyref, binaryen.i32, binaryen.i32]),
+            resultType,
+        );
+    }
+    for (const [funcName, valueType] of stores) {
+        module.addFunctionImport(
+            funcName,
+            BuiltinNames.externalModuleName,
+            funcName,
+            binaryen.createType([
+                binaryen.anyref,
+                binaryen.i32,
+                valueType,
+                binaryen.i32,
+            ]),
+            binaryen.none,
+        );
+    }
+}
+
 function convertI32ToSignedValue(
     module: binaryen.Module,
     res_i32_idx: number,
@@ -4504,37 +5067,17 @@ function dataView_getInt16(module: binaryen.Module, isSigned: boolean) {
         littleEndian_idx,
         littleEndian_i32_idx,
     );
-    /* Put elem in linear memory based on if littleEndian */
-    stmts.push(
-        module.if(
-            module.i32.eq(
-                module.local.get(littleEndian_i32_idx, binaryen.i32),
-                module.i32.const(1),
-            ),
-            module.block(null, [
-                store_i8(module, i8Array_idx, targetOffset_idx, 0, 0),
-                store_i8(module, i8Array_idx, targetOffset_idx, 1, 1),
-            ]),
-            module.block(null, [
-                store_i8(module, i8Array_idx, targetOffset_idx, 0, 1),
-                store_i8(module, i8Array_idx, targetOffset_idx, 1, 0),
-            ]),
-        ),
-    );
     stmts.push(
         module.local.set(
             res_i32_idx,
-            isSigned
-                ? module.i32.load16_s(
-                      0,
-                      2,
-                      module.i32.const(BuiltinNames.memoryReserveOffset),
-                  )
-                : module.i32.load16_u(
-                      0,
-                      2,
-                      module.i32.const(BuiltinNames.memoryReserveOffset),
-                  ),
+            dataView_load(
+                module,
+                BuiltinNames.dataViewLoad16FuncName,
+                i8Array_idx,
+                targetOffset_idx,
+                littleEndian_i32_idx,
+                binaryen.i32,
+            ),
         ),
     );
     stmts.push(
@@ -4586,34 +5129,16 @@ function dataView_getInt32(module: binaryen.Module, isSigned: boolean) {
         littleEndian_idx,
         littleEndian_i32_idx,
     );
-    /* Put elem in linear memory based on if littleEndian */
-    stmts.push(
-        module.if(
-            module.i32.eq(
-                module.local.get(littleEndian_i32_idx, binaryen.i32),
-                module.i32.const(1),
-            ),
-            module.block(null, [
-                store_i8(module, i8Array_idx, targetOffset_idx, 0, 0),
-                store_i8(module, i8Array_idx, targetOffset_idx, 1, 1),
-                store_i8(module, i8Array_idx, targetOffset_idx, 2, 2),
-                store_i8(module, i8Array_idx, targetOffset_idx, 3, 3),
-            ]),
-            module.block(null, [
-                store_i8(module, i8Array_idx, targetOffset_idx, 0, 3),
-                store_i8(module, i8Array_idx, targetOffset_idx, 1, 2),
-                store_i8(module, i8Array_idx, targetOffset_idx, 2, 1),
-                store_i8(module, i8Array_idx, targetOffset_idx, 3, 0),
-            ]),
-        ),
-    );
     stmts.push(
         module.local.set(
             res_i32_idx,
-            module.i32.load(
-                0,
-                4,
-                module.i32.const(BuiltinNames.memoryReserveOffset),
+            dataView_load(
+                module,
+                BuiltinNames.dataViewLoad32FuncName,
+                i8Array_idx,
+                targetOffset_idx,
+                littleEndian_i32_idx,
+                binaryen.i32,
             ),
         ),
     );
@@ -4666,133 +5191,574 @@ function dataView_getFloat32(module: binaryen.Module) {
         littleEndian_idx,
         littleEndian_i32_idx,
     );
-    /* Put elem in linear memory based on if littleEndian */
     stmts.push(
-        module.if(
-            module.i32.eq(
-                module.local.get(littleEndian_i32_idx, binaryen.i32),
-                module.i32.const(1),
+        module.local.set(
+            res_i32_idx,
+            dataView_load(
+                module,
+                BuiltinNames.dataViewLoad32FuncName,
+                i8Array_idx,
+                targetOffset_idx,
+                littleEndian_i32_idx,
+                binaryen.i32,
+            ),
+        ),
+    );
+    stmts.push(
+        module.return(
+            /* workaround: in type.d.ts, type is number, not wasmType f32 */
+            module.f64.promote(
+                module.f32.reinterpret(
+                    module.local.get(res_i32_idx, binaryen.i32),
+                ),
+            ),
+        ),
+    );
+
+    return module.block(null, stmts);
+}
+
+function dataView_getFloat64(module: binaryen.Module) {
+    /* params */
+    const context_idx = 0;
+    const this_idx = 1;
+    const byteOffset_idx = 2;
+    const littleEndian_idx = 3;
+    /* vars */
+    /* workaround: in type.d.ts, type is number, not wasmType i32 */
+    const byteOffset_i32_idx = 4;
+    const this_casted_idx = 5;
+    const buffer_idx = 6;
+    const dataViewLength_idx = 7;
+    const dataViewOffset_idx = 8;
+    const targetOffset_idx = 9;
+    const i8Array_idx = 10;
+    const littleEndian_i32_idx = 11;
+    const res_i64_idx = 12;
+
+    const stmts: binaryen.ExpressionRef[] = dataView_basicOps(
+        module,
+        this_idx,
+        byteOffset_idx,
+        byteOffset_i32_idx,
+        this_casted_idx,
+        buffer_idx,
+        dataViewLength_idx,
+        dataViewOffset_idx,
+        targetOffset_idx,
+        i8Array_idx,
+        8,
+        littleEndian_idx,
+        littleEndian_i32_idx,
+    );
+    stmts.push(
+        module.local.set(
+            res_i64_idx,
+            dataView_load(
+                module,
+                BuiltinNames.dataViewLoad64FuncName,
+                i8Array_idx,
+                targetOffset_idx,
+                littleEndian_i32_idx,
+                binaryen.i64,
+            ),
+        ),
+    );
+    stmts.push(
+        module.return(
+            /* workaround: in type.d.ts, type is number, not wasmType f32 */
+            module.f64.reinterpret(module.local.get(res_i64_idx, binaryen.i64)),
+        ),
+    );
+
+    return module.block(null, stmts);
+}
+
+function typedArray_getElemZero(module: binaryen.Module, name: string) {
+    switch (FunctionalFuncs.getTypedArrayElemType(name)) {
+        case binaryen.f64:
+            return module.f64.const(0);
+        case binaryen.f32:
+            return module.f32.const(0);
+        default:
+            return module.i32.const(0);
+    }
+}
+
+/* resolve a relative index (negative counts from the end) against the
+    length, the result is clamped into [0, length] */
+function typedArray_resolveIndex(
+    module: binaryen.Module,
+    anyref: binaryen.ExpressionRef,
+    res_i32_idx: number,
+    defaultValue: binaryen.ExpressionRef,
+    length_i32_idx: number,
+) {
+    const res = module.local.get(res_i32_idx, binaryen.i32);
+    const length = module.local.get(length_i32_idx, binaryen.i32);
+    return module.block(null, [
+        unboxOptionalAnyToI32(module, anyref, res_i32_idx, defaultValue),
+        module.if(
+            module.i32.lt_s(res, module.i32.const(0)),
+            module.local.set(
+                res_i32_idx,
+                module.select(
+                    module.i32.lt_s(
+                        module.i32.add(res, length),
+                        module.i32.const(0),
+                    ),
+                    module.i32.const(0),
+                    module.i32.add(res, length),
+                ),
+            ),
+            module.if(
+                module.i32.gt_s(res, length),
+                module.local.set(res_i32_idx, length),
+            ),
+        ),
+    ]);
+}
+
+function typedArrayConstructor(module: binaryen.Module, name: string) {
+    /* params */
+    const length_idx = 2;
+    /* vars */
+    const length_i32_idx = 3;
+
+    const typedArrayTypeInfo = FunctionalFuncs.getTypedArrayTypeInfo(name);
+    const backingTypeInfo = FunctionalFuncs.getTypedArrayBackingTypeInfo(name);
+    const length = module.local.get(length_i32_idx, binaryen.i32);
+
+    const stmts: binaryen.ExpressionRef[] = [];
+    stmts.push(
+        module.local.set(
+            length_i32_idx,
+            FunctionalFuncs.convertTypeToI32(
+                module,
+                module.local.get(length_idx, binaryen.f64),
+            ),
+        ),
+    );
+    stmts.push(
+        module.if(
+            module.i32.lt_s(length, module.i32.const(0)),
+            module.unreachable(),
+        ),
+    );
+    const backingArray = binaryenCAPI._BinaryenArrayNew(
+        module.ptr,
+        backingTypeInfo.heapTypeRef,
+        length,
+        typedArray_getElemZero(module, name),
+    );
+    stmts.push(
+        module.return(
+            binaryenCAPI._BinaryenStructNew(
+                module.ptr,
+                arrayToPtr([backingArray, length, module.i32.const(0)]).ptr,
+                3,
+                typedArrayTypeInfo.heapTypeRef,
+            ),
+        ),
+    );
+    return module.block(null, stmts);
+}
+
+function typedArray_fill(module: binaryen.Module, name: string) {
+    /* params */
+    const this_idx = 1;
+    const value_idx = 2;
+    const start_idx = 3;
+    const end_idx = 4;
+    /* vars */
+    const this_casted_idx = 5;
+    const length_i32_idx = 6;
+    const start_i32_idx = 7;
+    const end_i32_idx = 8;
+    const base_i32_idx = 9;
+    const elem_idx = 10;
+
+    const typedArrayTypeInfo = FunctionalFuncs.getTypedArrayTypeInfo(name);
+    const thisCasted = module.local.get(
+        this_casted_idx,
+        typedArrayTypeInfo.typeRef,
+    );
+    const start = module.local.get(start_i32_idx, binaryen.i32);
+
+    const stmts: binaryen.ExpressionRef[] = [];
+    stmts.push(
+        module.local.set(
+            this_casted_idx,
+            binaryenCAPI._BinaryenRefCast(
+                module.ptr,
+                module.local.get(this_idx, emptyStructType.typeRef),
+                typedArrayTypeInfo.typeRef,
+            ),
+        ),
+    );
+    stmts.push(
+        module.local.set(
+            length_i32_idx,
+            binaryenCAPI._BinaryenStructGet(
+                module.ptr,
+                1,
+                thisCasted,
+                typedArrayTypeInfo.typeRef,
+                false,
+            ),
+        ),
+    );
+    stmts.push(
+        typedArray_resolveIndex(
+            module,
+            module.local.get(start_idx, binaryen.anyref),
+            start_i32_idx,
+            module.i32.const(0),
+            length_i32_idx,
+        ),
+    );
+    stmts.push(
+        typedArray_resolveIndex(
+            module,
+            module.local.get(end_idx, binaryen.anyref),
+            end_i32_idx,
+            module.local.get(length_i32_idx, binaryen.i32),
+            length_i32_idx,
+        ),
+    );
+    /* convert the value only once */
+    stmts.push(
+        module.local.set(
+            elem_idx,
+            FunctionalFuncs.f64ToTypedArrayElem(
+                module,
+                name,
+                module.local.get(value_idx, binaryen.f64),
+            ),
+        ),
+    );
+    stmts.push(
+        module.local.set(
+            base_i32_idx,
+            FunctionalFuncs.getTypedArrayElemIdx(
+                module,
+                name,
+                thisCasted,
+                module.i32.const(0),
+            ),
+        ),
+    );
+    const loopLabel = 'fill_label';
+    stmts.push(
+        module.loop(
+            loopLabel,
+            FunctionalFuncs.flattenLoopStatement(
+                module,
+                {
+                    label: loopLabel,
+                    condition: module.i32.lt_s(
+                        start,
+                        module.local.get(end_i32_idx, binaryen.i32),
+                    ),
+                    statements: FunctionalFuncs.setTypedArrayElem(
+                        module,
+                        name,
+                        thisCasted,
+                        module.i32.add(
+                            module.local.get(base_i32_idx, binaryen.i32),
+                            start,
+                        ),
+                        module.local.get(
+                            elem_idx,
+                            FunctionalFuncs.getTypedArrayElemType(name),
+                        ),
+                    ),
+                    incrementor: module.local.set(
+                        start_i32_idx,
+                        module.i32.add(start, module.i32.const(1)),
+                    ),
+                },
+                SemanticsKind.FOR,
+            ),
+        ),
+    );
+    stmts.push(module.return(thisCasted));
+    return module.block(null, stmts);
+}
+
+function typedArray_set(module: binaryen.Module, name: string) {
+    /* params */
+    const this_idx = 1;
+    const array_idx = 2;
+    const offset_idx = 3;
+    /* vars */
+    const this_casted_idx = 4;
+    const offset_i32_idx = 5;
+    const srcLength_i32_idx = 6;
+
+    const typedArrayTypeInfo = FunctionalFuncs.getTypedArrayTypeInfo(name);
+    const thisCasted = module.local.get(
+        this_casted_idx,
+        typedArrayTypeInfo.typeRef,
+    );
+    const src = module.local.get(array_idx, typedArrayTypeInfo.typeRef);
+    const offset = module.local.get(offset_i32_idx, binaryen.i32);
+    const srcLength = module.local.get(srcLength_i32_idx, binaryen.i32);
+
+    const stmts: binaryen.ExpressionRef[] = [];
+    stmts.push(
+        module.local.set(
+            this_casted_idx,
+            binaryenCAPI._BinaryenRefCast(
+                module.ptr,
+                module.local.get(this_idx, emptyStructType.typeRef),
+                typedArrayTypeInfo.typeRef,
             ),
-            module.block(null, [
-                store_i8(module, i8Array_idx, targetOffset_idx, 0, 0),
-                store_i8(module, i8Array_idx, targetOffset_idx, 1, 1),
-                store_i8(module, i8Array_idx, targetOffset_idx, 2, 2),
-                store_i8(module, i8Array_idx, targetOffset_idx, 3, 3),
-            ]),
-            module.block(null, [
-                store_i8(module, i8Array_idx, targetOffset_idx, 0, 3),
-                store_i8(module, i8Array_idx, targetOffset_idx, 1, 2),
-                store_i8(module, i8Array_idx, targetOffset_idx, 2, 1),
-                store_i8(module, i8Array_idx, targetOffset_idx, 3, 0),
-            ]),
+        ),
+    );
+    stmts.push(
+        unboxOptionalAnyToI32(
+            module,
+            module.local.get(offset_idx, binaryen.anyref),
+            offset_i32_idx,
+            module.i32.const(0),
         ),
     );
     stmts.push(
         module.local.set(
-            res_i32_idx,
-            module.i32.load(
-                0,
-                4,
-                module.i32.const(BuiltinNames.memoryReserveOffset),
+            srcLength_i32_idx,
+            binaryenCAPI._BinaryenStructGet(
+                module.ptr,
+                1,
+                src,
+                typedArrayTypeInfo.typeRef,
+                false,
             ),
         ),
     );
+    /* RangeError if the source doesn't fit */
     stmts.push(
-        module.return(
-            /* workaround: in type.d.ts, type is number, not wasmType f32 */
-            module.f64.promote(
-                module.f32.reinterpret(
-                    module.local.get(res_i32_idx, binaryen.i32),
+        module.if(
+            module.i32.or(
+                module.i32.lt_s(offset, module.i32.const(0)),
+                module.i32.gt_s(
+                    module.i32.add(offset, srcLength),
+                    binaryenCAPI._BinaryenStructGet(
+                        module.ptr,
+                        1,
+                        thisCasted,
+                        typedArrayTypeInfo.typeRef,
+                        false,
+                    ),
                 ),
             ),
+            module.unreachable(),
+        ),
+    );
+    /* array.copy has memmove semantic, so overlapping views are fine */
+    stmts.push(
+        binaryenCAPI._BinaryenArrayCopy(
+            module.ptr,
+            binaryenCAPI._BinaryenStructGet(
+                module.ptr,
+                0,
+                thisCasted,
+                typedArrayTypeInfo.typeRef,
+                false,
+            ),
+            FunctionalFuncs.getTypedArrayElemIdx(
+                module,
+                name,
+                thisCasted,
+                offset,
+            ),
+            binaryenCAPI._BinaryenStructGet(
+                module.ptr,
+                0,
+                src,
+                typedArrayTypeInfo.typeRef,
+                false,
+            ),
+            FunctionalFuncs.getTypedArrayElemIdx(
+                module,
+                name,
+                src,
+                module.i32.const(0),
+            ),
+            srcLength,
         ),
     );
-
     return module.block(null, stmts);
 }
 
-function dataView_getFloat64(module: binaryen.Module) {
+function typedArray_subarray(module: binaryen.Module, name: string) {
     /* params */
-    const context_idx = 0;
     const this_idx = 1;
-    const byteOffset_idx = 2;
-    const littleEndian_idx = 3;
+    const begin_idx = 2;
+    const end_idx = 3;
     /* vars */
-    /* workaround: in type.d.ts, type is number, not wasmType i32 */
-    const byteOffset_i32_idx = 4;
-    const this_casted_idx = 5;
-    const buffer_idx = 6;
-    const dataViewLength_idx = 7;
-    const dataViewOffset_idx = 8;
-    const targetOffset_idx = 9;
-    const i8Array_idx = 10;
-    const littleEndian_i32_idx = 11;
-    const res_i64_idx = 12;
+    const this_casted_idx = 4;
+    const length_i32_idx = 5;
+    const begin_i32_idx = 6;
+    const end_i32_idx = 7;
 
-    const stmts: binaryen.ExpressionRef[] = dataView_basicOps(
-        module,
-        this_idx,
-        byteOffset_idx,
-        byteOffset_i32_idx,
+    const typedArrayTypeInfo = FunctionalFuncs.getTypedArrayTypeInfo(name);
+    const thisCasted = module.local.get(
         this_casted_idx,
-        buffer_idx,
-        dataViewLength_idx,
-        dataViewOffset_idx,
-        targetOffset_idx,
-        i8Array_idx,
-        8,
-        littleEndian_idx,
-        littleEndian_i32_idx,
+        typedArrayTypeInfo.typeRef,
     );
-    /* Put elem in linear memory based on if littleEndian */
+    const begin = module.local.get(begin_i32_idx, binaryen.i32);
+    const end = module.local.get(end_i32_idx, binaryen.i32);
+
+    const stmts: binaryen.ExpressionRef[] = [];
     stmts.push(
-        module.if(
-            module.i32.eq(
-                module.local.get(littleEndian_i32_idx, binaryen.i32),
-                module.i32.const(1),
+        module.local.set(
+            this_casted_idx,
+            binaryenCAPI._BinaryenRefCast(
+                module.ptr,
+                module.local.get(this_idx, emptyStructType.typeRef),
+                typedArrayTypeInfo.typeRef,
             ),
-            module.block(null, [
-                store_i8(module, i8Array_idx, targetOffset_idx, 0, 0),
-                store_i8(module, i8Array_idx, targetOffset_idx, 1, 1),
-                store_i8(module, i8Array_idx, targetOffset_idx, 2, 2),
-                store_i8(module, i8Array_idx, targetOffset_idx, 3, 3),
-                store_i8(module, i8Array_idx, targetOffset_idx, 4, 4),
-                store_i8(module, i8Array_idx, targetOffset_idx, 5, 5),
-                store_i8(module, i8Array_idx, targetOffset_idx, 6, 6),
-                store_i8(module, i8Array_idx, targetOffset_idx, 7, 7),
-            ]),
-            module.block(null, [
-                store_i8(module, i8Array_idx, targetOffset_idx, 0, 7),
-                store_i8(module, i8Array_idx, targetOffset_idx, 1, 6),
-                store_i8(module, i8Array_idx, targetOffset_idx, 2, 5),
-                store_i8(module, i8Array_idx, targetOffset_idx, 3, 4),
-                store_i8(module, i8Array_idx, targetOffset_idx, 4, 3),
-                store_i8(module, i8Array_idx, targetOffset_idx, 5, 2),
-                store_i8(module, i8Array_idx, targetOffset_idx, 6, 1),
-                store_i8(module, i8Array_idx, targetOffset_idx, 7, 0),
-            ]),
         ),
     );
     stmts.push(
         module.local.set(
-            res_i64_idx,
-            module.i64.load(
-                0,
-                8,
-                module.i32.const(BuiltinNames.memoryReserveOffset),
+            length_i32_idx,
+            binaryenCAPI._BinaryenStructGet(
+                module.ptr,
+                1,
+                thisCasted,
+                typedArrayTypeInfo.typeRef,
+                false,
             ),
         ),
     );
+    stmts.push(
+        typedArray_resolveIndex(
+            module,
+            module.local.get(begin_idx, binaryen.anyref),
+            begin_i32_idx,
+            module.i32.const(0),
+            length_i32_idx,
+        ),
+    );
+    stmts.push(
+        typedArray_resolveIndex(
+            module,
+            module.local.get(end_idx, binaryen.anyref),
+            end_i32_idx,
+            module.local.get(length_i32_idx, binaryen.i32),
+            length_i32_idx,
+        ),
+    );
+    stmts.push(
+        module.if(
+            module.i32.lt_s(end, begin),
+            module.local.set(end_i32_idx, begin),
+        ),
+    );
+    /* the view shares the backing array */
     stmts.push(
         module.return(
-            /* workaround: in type.d.ts, type is number, not wasmType f32 */
-            module.f64.reinterpret(module.local.get(res_i64_idx, binaryen.i64)),
+            binaryenCAPI._BinaryenStructNew(
+                module.ptr,
+                arrayToPtr([
+                    binaryenCAPI._BinaryenStructGet(
+                        module.ptr,
+                        0,
+                        thisCasted,
+                        typedArrayTypeInfo.typeRef,
+                        false,
+                    ),
+                    module.i32.sub(end, begin),
+                    module.i32.add(
+                        binaryenCAPI._BinaryenStructGet(
+                            module.ptr,
+                            2,
+                            thisCasted,
+                            typedArrayTypeInfo.typeRef,
+                            false,
+                        ),
+                        module.i32.shl(
+                            begin,
+                            module.i32.const(
+                                FunctionalFuncs.getTypedArrayElemSizeShift(
+                                    name,
+                                ),
+                            ),
+                        ),
+                    ),
+                ]).ptr,
+                3,
+                typedArrayTypeInfo.heapTypeRef,
+            ),
         ),
     );
-
     return module.block(null, stmts);
 }
 
+function addTypedArrayMethods(module: binaryen.Module) {
+    for (const name of BuiltinNames.typedArrayNames) {
+        const typedArrayTypeRef =
+            FunctionalFuncs.getTypedArrayTypeInfo(name).typeRef;
+        module.addFunction(
+            UtilFuncs.getBuiltinClassCtorName(name),
+            binaryen.createType([
+                emptyStructType.typeRef,
+                emptyStructType.typeRef,
+                binaryen.f64,
+            ]),
+            typedArrayTypeRef,
+            [binaryen.i32],
+            typedArrayConstructor(module, name),
+        );
+        module.addFunction(
+            UtilFuncs.getBuiltinClassMethodName(name, 'fill'),
+            binaryen.createType([
+                emptyStructType.typeRef,
+                emptyStructType.typeRef,
+                binaryen.f64,
+                binaryen.anyref,
+                binaryen.anyref,
+            ]),
+            typedArrayTypeRef,
+            [
+                typedArrayTypeRef,
+                binaryen.i32,
+                binaryen.i32,
+                binaryen.i32,
+                binaryen.i32,
+                FunctionalFuncs.getTypedArrayElemType(name),
+            ],
+            typedArray_fill(module, name),
+        );
+        module.addFunction(
+            UtilFuncs.getBuiltinClassMethodName(name, 'set'),
+            binaryen.createType([
+                emptyStructType.typeRef,
+                emptyStructType.typeRef,
+                typedArrayTypeRef,
+                binaryen.anyref,
+            ]),
+            binaryen.none,
+            [typedArrayTypeRef, binaryen.i32, binaryen.i32],
+            typedArray_set(module, name),
+        );
+        module.addFunction(
+            UtilFuncs.getBuiltinClassMethodName(name, 'subarray'),
+            binaryen.createType([
+                emptyStructType.typeRef,
+                emptyStructType.typeRef,
+                binaryen.anyref,
+                binaryen.anyref,
+            ]),
+            typedArrayTypeRef,
+            [typedArrayTypeRef, binaryen.i32, binaryen.i32, binaryen.i32],
+            typedArray_subarray(module, name),
+        );
+    }
+}
+
 function string_fromCharCode(module: binaryen.Module) {
     /* params */
     const context_idx = 0;
@@ -5246,6 +6212,81 @@ export function callBuiltInAPIs(module: binaryen.Module) {
         [],
         module.f64.trunc(module.local.get(2, binaryen.f64)),
     );
+    /** Math.round */
+    module.addFunction(
+        UtilFuncs.getFuncName(
+            BuiltinNames.builtinModuleName,
+            BuiltinNames.mathRoundFuncName,
+        ),
+        binaryen.createType([
+            emptyStructType.typeRef,
+            emptyStructType.typeRef,
+            binaryen.f64,
+        ]),
+        binaryen.f64,
+        [binaryen.f64],
+        math_round(module),
+    );
+    /** Math.sign */
+    module.addFunction(
+        UtilFuncs.getFuncName(
+            BuiltinNames.builtinModuleName,
+            BuiltinNames.mathSignFuncName,
+        ),
+        binaryen.createType([
+            emptyStructType.typeRef,
+            emptyStructType.typeRef,
+            binaryen.f64,
+        ]),
+        binaryen.f64,
+        [],
+        math_sign(module),
+    );
+    /** Math.fround */
+    module.addFunction(
+        UtilFuncs.getFuncName(
+            BuiltinNames.builtinModuleName,
+            BuiltinNames.mathFroundFuncName,
+        ),
+        binaryen.createType([
+            emptyStructType.typeRef,
+            emptyStructType.typeRef,
+            binaryen.f64,
+        ]),
+        binaryen.f64,
+        [],
+        module.f64.promote(
+            module.f32.demote(module.local.get(2, binaryen.f64)),
+        ),
+    );
+    /** Math.hypot */
+    module.addFunction(
+        UtilFuncs.getFuncName(
+            BuiltinNames.builtinModuleName,
+            BuiltinNames.mathHypotFuncName,
+        ),
+        binaryen.createType([
+            emptyStructType.typeRef,
+            emptyStructType.typeRef,
+            numberArrayStructTypeInfo.typeRef,
+        ]),
+        binaryen.f64,
+        [
+            binaryen.i32,
+            binaryen.i32,
+            numberArrayTypeInfo.typeRef,
+            binaryen.f64,
+            binaryen.f64,
+            binaryen.f64,
+        ],
+        math_hypot(module),
+    );
+    /** Math.pow, Math.exp, Math.log, Math.sin ... */
+    addMathNativeMethods(module);
+    /** Number.parseFloat, Number.parseInt, Number(string) */
+    addNumberParseMethods(module);
+    /** console.log, console.error, console.warn with static arguments */
+    addConsoleWriteMethods(module);
     /** Array.isArray */
     module.addFunction(
         UtilFuncs.getFuncName(
@@ -5291,6 +6332,17 @@ export function callBuiltInAPIs(module: binaryen.Module) {
         getBuiltInFuncName(BuiltinNames.allocExtRefTableSlot),
         BuiltinNames.allocExtRefTableSlot,
     );
+    module.addFunction(
+        getBuiltInFuncName(BuiltinNames.freeExtRefTableSlot),
+        binaryen.createType([binaryen.i32]),
+        binaryen.none,
+        [],
+        freeExtRefTableSlot(module),
+    );
+    module.addFunctionExport(
+        getBuiltInFuncName(BuiltinNames.freeExtRefTableSlot),
+        BuiltinNames.freeExtRefTableSlot,
+    );
     module.addFunction(
         UtilFuncs.getFuncName(
             BuiltinNames.builtinModuleName,
@@ -5548,7 +6600,12 @@ export function callBuiltInAPIs(module: binaryen.Module) {
                 binaryenCAPI._BinaryenTypeStringref(),
             ]),
             binaryenCAPI._BinaryenTypeStringref(),
-            [],
+            [
+                binaryen.i32,
+                binaryen.i32,
+                binaryen.i32,
+                i16ArrayTypeInfo.typeRef,
+            ],
             string_toLowerCase_stringref(module),
         );
         module.addFunction(
@@ -5558,7 +6615,12 @@ export function callBuiltInAPIs(module: binaryen.Module) {
                 binaryenCAPI._BinaryenTypeStringref(),
             ]),
             binaryenCAPI._BinaryenTypeStringref(),
-            [],
+            [
+                binaryen.i32,
+                binaryen.i32,
+                binaryen.i32,
+                i16ArrayTypeInfo.typeRef,
+            ],
             string_toUpperCase_stringref(module),
         );
         /** For now, here should enable --enableStringref flag to get prop name
@@ -5685,6 +6747,7 @@ export function callBuiltInAPIs(module: binaryen.Module) {
                 binaryen.i32,
                 binaryen.i32,
                 binaryen.i32,
+                binaryen.i32,
             ],
             string_trim(module),
         );
@@ -6010,6 +7073,7 @@ export function callBuiltInAPIs(module: binaryen.Module) {
         ]),
         binaryen.anyref,
     );
+    addDataViewNativeImports(module);
     module.addFunction(
         UtilFuncs.getBuiltinClassCtorName(BuiltinNames.DATAVIEW),
         binaryen.createType([
@@ -6387,6 +7451,7 @@ export function callBuiltInAPIs(module: binaryen.Module) {
         ],
         dataView_getFloat64(module),
     );
+    addTypedArrayMethods(module);
     module.addFunction(
         UtilFuncs.getBuiltinClassMethodName(
             BuiltinNames.STRINGCONSTRCTOR,
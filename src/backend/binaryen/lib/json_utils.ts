@@ -0,0 +1,2337 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* JSON.stringify and JSON.parse for values whose static type is fully
+    known (classes and object literals with number, boolean, string, object
+    and array fields). The compiler describes the type with a JSONSchema and
+    a serializer / parser is generated for every schema the first time it is
+    used, so the fields are read from or written to the wasm struct directly
+    instead of walking a boxed object through libdyntype.
+
+    The serializer builds the parts of the text into a string array and
+    concatenates them once. The parser works on the utf8 bytes of the input,
+    the cursor is kept in a global, invalid input throws a SyntaxError. */
+
+import binaryen from 'binaryen';
+import * as binaryenCAPI from '../glue/binaryen.js';
+import { BuiltinNames } from '../../../../lib/builtin/builtin_name.js';
+import { arrayToPtr, emptyStructType } from '../glue/transform.js';
+import {
+    i8ArrayTypeInfo,
+    stringArrayStructTypeInfo,
+    stringArrayTypeInfo,
+    stringTypeInfo,
+} from '../glue/packType.js';
+import { FunctionalFuncs, UtilFuncs } from '../utils.js';
+import { dyntype } from './dyntype/utils.js';
+import { SemanticsKind } from '../../../semantics/semantics_nodes.js';
+import { ValueTypeKind } from '../../../semantics/value_types.js';
+import { getConfig } from '../../../../config/config_mgr.js';
+
+export interface JSONSchemaField {
+    name: string;
+    /* index in the object struct, the vtable is field 0 */
+    index: number;
+    schema: JSONSchema;
+}
+
+export interface JSONSchema {
+    /* NUMBER, BOOLEAN, STRING, OBJECT or ARRAY */
+    kind: ValueTypeKind;
+    /* unique for the layout, used to name the generated functions */
+    id: string;
+    typeRef: binaryen.Type;
+    heapTypeRef?: binaryenCAPI.HeapTypeRef;
+    /* OBJECT */
+    fields?: JSONSchemaField[];
+    vtableTypeRef?: binaryen.Type;
+    vtableInst?: binaryen.ExpressionRef;
+    metaOffset?: number;
+    /* subtypes may reach the serializer, compare the meta before reading
+        the fields */
+    checkMeta?: boolean;
+    /* ARRAY */
+    arrayTypeRef?: binaryen.Type;
+    arrayHeapTypeRef?: binaryenCAPI.HeapTypeRef;
+    element?: JSONSchema;
+}
+
+/* used when the static path can't handle a value, e.g. an instance of a
+    subclass or a number which can't be converted exactly in wasm */
+export interface JSONFallbackInfo {
+    /* the JSON object of the JS environment */
+    globalName: string;
+    /* raw string offsets of the method names */
+    stringifyNameOffset: number;
+    parseNameOffset: number;
+    /* raw string offset of 'SyntaxError', thrown on invalid input */
+    syntaxErrorNameOffset: number;
+}
+
+const jsonParsePosName = 'json_parse_pos';
+
+const enum Char {
+    TAB = 9,
+    LF = 10,
+    CR = 13,
+    SPACE = 32,
+    QUOTE = 34,
+    PLUS = 43,
+    COMMA = 44,
+    MINUS = 45,
+    DOT = 46,
+    ZERO = 48,
+    COLON = 58,
+    UPPER_E = 69,
+    LEFT_BRACKET = 91,
+    BACKSLASH = 92,
+    RIGHT_BRACKET = 93,
+    LOWER_B = 98,
+    LOWER_E = 101,
+    LOWER_F = 102,
+    LOWER_N = 110,
+    LOWER_R = 114,
+    LOWER_T = 116,
+    LOWER_U = 117,
+    LEFT_BRACE = 123,
+    RIGHT_BRACE = 125,
+}
+
+function getJSONFuncName(name: string) {
+    return UtilFuncs.getFuncName(BuiltinNames.builtinModuleName, name);
+}
+
+function getPos(module: binaryen.Module) {
+    return module.global.get(jsonParsePosName, binaryen.i32);
+}
+
+function setPos(module: binaryen.Module, value: binaryen.ExpressionRef) {
+    return module.global.set(jsonParsePosName, value);
+}
+
+function advancePos(module: binaryen.Module, step: number) {
+    return setPos(
+        module,
+        module.i32.add(getPos(module), module.i32.const(step)),
+    );
+}
+
+function charAt(
+    module: binaryen.Module,
+    data: binaryen.ExpressionRef,
+    index: binaryen.ExpressionRef,
+) {
+    return binaryenCAPI._BinaryenArrayGet(
+        module.ptr,
+        data,
+        index,
+        i8ArrayTypeInfo.typeRef,
+        false,
+    );
+}
+
+function setChar(
+    module: binaryen.Module,
+    data: binaryen.ExpressionRef,
+    index: binaryen.ExpressionRef,
+    value: binaryen.ExpressionRef,
+) {
+    return binaryenCAPI._BinaryenArraySet(module.ptr, data, index, value);
+}
+
+function newCharArray(module: binaryen.Module, length: binaryen.ExpressionRef) {
+    return binaryenCAPI._BinaryenArrayNew(
+        module.ptr,
+        i8ArrayTypeInfo.heapTypeRef,
+        length,
+        module.i32.const(0),
+    );
+}
+
+function copyChars(
+    module: binaryen.Module,
+    dest: binaryen.ExpressionRef,
+    destIndex: binaryen.ExpressionRef,
+    src: binaryen.ExpressionRef,
+    srcIndex: binaryen.ExpressionRef,
+    length: binaryen.ExpressionRef,
+) {
+    return binaryenCAPI._BinaryenArrayCopy(
+        module.ptr,
+        dest,
+        destIndex,
+        src,
+        srcIndex,
+        length,
+    );
+}
+
+function newString(module: binaryen.Module, data: binaryen.ExpressionRef) {
+    return binaryenCAPI._BinaryenStructNew(
+        module.ptr,
+        arrayToPtr([module.i32.const(0), data]).ptr,
+        2,
+        stringTypeInfo.heapTypeRef,
+    );
+}
+
+function getStringData(module: binaryen.Module, str: binaryen.ExpressionRef) {
+    return binaryenCAPI._BinaryenStructGet(
+        module.ptr,
+        1,
+        str,
+        i8ArrayTypeInfo.typeRef,
+        false,
+    );
+}
+
+function constString(module: binaryen.Module, str: string) {
+    return FunctionalFuncs.generateStringForStructArrayStr(module, str);
+}
+
+/* head + parts[0] + ... + parts[length - 1] in one copy */
+function concatParts(
+    module: binaryen.Module,
+    head: binaryen.ExpressionRef,
+    parts: binaryen.ExpressionRef,
+    length: binaryen.ExpressionRef,
+) {
+    const partsStruct = binaryenCAPI._BinaryenStructNew(
+        module.ptr,
+        arrayToPtr([parts, length]).ptr,
+        2,
+        stringArrayStructTypeInfo.heapTypeRef,
+    );
+    return module.call(
+        getJSONFuncName(BuiltinNames.stringConcatFuncName),
+        [
+            binaryenCAPI._BinaryenRefNull(module.ptr, emptyStructType.typeRef),
+            head,
+            partsStruct,
+        ],
+        stringTypeInfo.typeRef,
+    );
+}
+
+function getZeroValue(module: binaryen.Module, schema: JSONSchema) {
+    switch (schema.kind) {
+        case ValueTypeKind.NUMBER:
+            return module.f64.const(0);
+        case ValueTypeKind.BOOLEAN:
+            return module.i32.const(0);
+        case ValueTypeKind.STRING:
+            return constString(module, '');
+        default:
+            return binaryenCAPI._BinaryenRefNull(module.ptr, schema.typeRef);
+    }
+}
+
+function forLoop(
+    module: binaryen.Module,
+    label: string,
+    index_idx: number,
+    end: binaryen.ExpressionRef,
+    statements: binaryen.ExpressionRef,
+) {
+    const index = module.local.get(index_idx, binaryen.i32);
+    return module.block(null, [
+        module.local.set(index_idx, module.i32.const(0)),
+        module.loop(
+            label,
+            FunctionalFuncs.flattenLoopStatement(
+                module,
+                {
+                    label: label,
+                    condition: module.i32.lt_s(index, end),
+                    statements: statements,
+                    incrementor: module.local.set(
+                        index_idx,
+                        module.i32.add(index, module.i32.const(1)),
+                    ),
+                },
+                SemanticsKind.FOR,
+            ),
+        ),
+    ]);
+}
+
+/* loop while the condition holds, the body may leave with br to
+    `${label}_out` */
+function whileLoop(
+    module: binaryen.Module,
+    label: string,
+    condition: binaryen.ExpressionRef,
+    statements: binaryen.ExpressionRef[],
+) {
+    return module.block(`${label}_out`, [
+        module.loop(
+            label,
+            module.if(
+                condition,
+                module.block(null, [...statements, module.br(label)]),
+            ),
+        ),
+    ]);
+}
+
+/* the bytes of `word` are at data[index...] */
+function matchWord(
+    module: binaryen.Module,
+    data: binaryen.ExpressionRef,
+    index: binaryen.ExpressionRef,
+    word: string,
+) {
+    let res: binaryen.ExpressionRef | undefined = undefined;
+    for (let i = 0; i < word.length; i++) {
+        const eq = module.i32.eq(
+            charAt(module, data, module.i32.add(index, module.i32.const(i))),
+            module.i32.const(word.charCodeAt(i)),
+        );
+        res = res ? module.i32.and(res, eq) : eq;
+    }
+    return res!;
+}
+
+/* the single character escape of c, or 0 if c needs \u00XX */
+function shortEscape(module: binaryen.Module, c: binaryen.ExpressionRef) {
+    const escapes: [number, number][] = [
+        [8, Char.LOWER_B],
+        [Char.TAB, Char.LOWER_T],
+        [Char.LF, Char.LOWER_N],
+        [12, Char.LOWER_F],
+        [Char.CR, Char.LOWER_R],
+    ];
+    let res = module.i32.const(0);
+    for (const [code, escape] of escapes) {
+        res = module.select(
+            module.i32.eq(c, module.i32.const(code)),
+            module.i32.const(escape),
+            res,
+        );
+    }
+    return res;
+}
+
+function hexDigit(module: binaryen.Module, value: binaryen.ExpressionRef) {
+    return module.i32.add(
+        value,
+        module.select(
+            module.i32.lt_u(value, module.i32.const(10)),
+            module.i32.const(Char.ZERO),
+            module.i32.const(87),
+        ),
+    );
+}
+
+function json_quote(module: binaryen.Module) {
+    /* params */
+    const str_idx = 0;
+    /* vars */
+    const data_idx = 1;
+    const len_idx = 2;
+    const i_idx = 3;
+    const c_idx = 4;
+    const extra_idx = 5;
+    const out_idx = 6;
+    const j_idx = 7;
+    const esc_idx = 8;
+
+    const str = module.local.get(str_idx, stringTypeInfo.typeRef);
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const len = module.local.get(len_idx, binaryen.i32);
+    const i = module.local.get(i_idx, binaryen.i32);
+    const c = module.local.get(c_idx, binaryen.i32);
+    const extra = module.local.get(extra_idx, binaryen.i32);
+    const out = module.local.get(out_idx, i8ArrayTypeInfo.typeRef);
+    const j = module.local.get(j_idx, binaryen.i32);
+    const esc = module.local.get(esc_idx, binaryen.i32);
+    const needsBackslash = () =>
+        module.i32.or(
+            module.i32.eq(c, module.i32.const(Char.QUOTE)),
+            module.i32.eq(c, module.i32.const(Char.BACKSLASH)),
+        );
+    const isControl = () => module.i32.lt_u(c, module.i32.const(Char.SPACE));
+    const putChar = (offset: number, value: binaryen.ExpressionRef) =>
+        setChar(
+            module,
+            out,
+            module.i32.add(j, module.i32.const(offset)),
+            value,
+        );
+    const skip = (step: number) =>
+        module.local.set(j_idx, module.i32.add(j, module.i32.const(step)));
+
+    return module.block(null, [
+        module.if(
+            module.ref.is_null(str),
+            module.return(constString(module, 'null')),
+        ),
+        module.local.set(data_idx, getStringData(module, str)),
+        module.local.set(
+            len_idx,
+            binaryenCAPI._BinaryenArrayLen(module.ptr, data),
+        ),
+        /* count the extra bytes of the escapes */
+        module.local.set(extra_idx, module.i32.const(0)),
+        forLoop(
+            module,
+            'count_loop',
+            i_idx,
+            len,
+            module.block(null, [
+                module.local.set(c_idx, charAt(module, data, i)),
+                module.local.set(esc_idx, shortEscape(module, c)),
+                module.if(
+                    needsBackslash(),
+                    module.local.set(
+                        extra_idx,
+                        module.i32.add(extra, module.i32.const(1)),
+                    ),
+                    module.if(
+                        isControl(),
+                        module.local.set(
+                            extra_idx,
+                            module.i32.add(
+                                extra,
+                                module.select(
+                                    esc,
+                                    module.i32.const(1),
+                                    module.i32.const(5),
+                                ),
+                            ),
+                        ),
+                    ),
+                ),
+            ]),
+        ),
+        module.local.set(
+            out_idx,
+            newCharArray(
+                module,
+                module.i32.add(module.i32.add(len, extra), module.i32.const(2)),
+            ),
+        ),
+        setChar(module, out, module.i32.const(0), module.i32.const(Char.QUOTE)),
+        module.if(
+            module.i32.eqz(extra),
+            copyChars(
+                module,
+                out,
+                module.i32.const(1),
+                data,
+                module.i32.const(0),
+                len,
+            ),
+            module.block(null, [
+                module.local.set(j_idx, module.i32.const(1)),
+                forLoop(
+                    module,
+                    'escape_loop',
+                    i_idx,
+                    len,
+                    module.block(null, [
+                        module.local.set(c_idx, charAt(module, data, i)),
+                        module.if(
+                            needsBackslash(),
+                            module.block(null, [
+                                putChar(0, module.i32.const(Char.BACKSLASH)),
+                                putChar(1, c),
+                                skip(2),
+                            ]),
+                            module.if(
+                                isControl(),
+                                module.block(null, [
+                                    module.local.set(
+                                        esc_idx,
+                                        shortEscape(module, c),
+                                    ),
+                                    putChar(
+                                        0,
+                                        module.i32.const(Char.BACKSLASH),
+                                    ),
+                                    module.if(
+                                        esc,
+                                        module.block(null, [
+                                            putChar(1, esc),
+                                            skip(2),
+                                        ]),
+                                        module.block(null, [
+                                            putChar(
+                                                1,
+                                                module.i32.const(Char.LOWER_U),
+                                            ),
+                                            putChar(
+                                                2,
+                                                module.i32.const(Char.ZERO),
+                                            ),
+                                            putChar(
+                                                3,
+                                                module.i32.const(Char.ZERO),
+                                            ),
+                                            putChar(
+                                                4,
+                                                hexDigit(
+                                                    module,
+                                                    module.i32.shr_u(
+                                                        c,
+                                                        module.i32.const(4),
+                                                    ),
+                                                ),
+                                            ),
+                                            putChar(
+                                                5,
+                                                hexDigit(
+                                                    module,
+                                                    module.i32.and(
+                                                        c,
+                                                        module.i32.const(15),
+                                                    ),
+                                                ),
+                                            ),
+                                            skip(6),
+                                        ]),
+                                    ),
+                                ]),
+                                module.block(null, [putChar(0, c), skip(1)]),
+                            ),
+                        ),
+                    ]),
+                ),
+            ]),
+        ),
+        setChar(
+            module,
+            out,
+            module.i32.add(module.i32.add(len, extra), module.i32.const(1)),
+            module.i32.const(Char.QUOTE),
+        ),
+        module.return(newString(module, out)),
+    ]);
+}
+
+/* Number.prototype.toString for the numbers JSON can represent. Integers
+    below 2^53 are printed in wasm, the rest goes to libdyntype. */
+function json_numberToString(module: binaryen.Module) {
+    /* params */
+    const num_idx = 0;
+    /* vars */
+    const value_idx = 1;
+    const neg_idx = 2;
+    const len_idx = 3;
+    const tmp_idx = 4;
+    const out_idx = 5;
+
+    const num = module.local.get(num_idx, binaryen.f64);
+    const value = module.local.get(value_idx, binaryen.i64);
+    const neg = module.local.get(neg_idx, binaryen.i32);
+    const len = module.local.get(len_idx, binaryen.i32);
+    const tmp = module.local.get(tmp_idx, binaryen.i64);
+    const out = module.local.get(out_idx, i8ArrayTypeInfo.typeRef);
+    const ten = module.i64.const(10, 0);
+
+    return module.block(null, [
+        module.if(
+            module.i32.or(
+                module.f64.ne(num, num),
+                module.f64.eq(module.f64.abs(num), module.f64.const(Infinity)),
+            ),
+            module.return(constString(module, 'null')),
+        ),
+        module.if(
+            module.i32.and(
+                module.f64.lt(
+                    module.f64.abs(num),
+                    module.f64.const(9007199254740992),
+                ),
+                module.f64.eq(module.f64.trunc(num), num),
+            ),
+            module.block(null, [
+                module.local.set(value_idx, module.i64.trunc_s.f64(num)),
+                module.local.set(
+                    neg_idx,
+                    module.i64.lt_s(value, module.i64.const(0, 0)),
+                ),
+                module.if(
+                    neg,
+                    module.local.set(
+                        value_idx,
+                        module.i64.sub(module.i64.const(0, 0), value),
+                    ),
+                ),
+                /* count the digits */
+                module.local.set(len_idx, module.i32.const(1)),
+                module.local.set(tmp_idx, value),
+                whileLoop(
+                    module,
+                    'digits_loop',
+                    module.i64.ge_u(tmp, ten),
+                    [
+                        module.local.set(tmp_idx, module.i64.div_u(tmp, ten)),
+                        module.local.set(
+                            len_idx,
+                            module.i32.add(len, module.i32.const(1)),
+                        ),
+                    ],
+                ),
+                module.local.set(len_idx, module.i32.add(len, neg)),
+                module.local.set(out_idx, newCharArray(module, len)),
+                module.if(
+                    neg,
+                    setChar(
+                        module,
+                        out,
+                        module.i32.const(0),
+                        module.i32.const(Char.MINUS),
+                    ),
+                ),
+                /* write the digits backwards */
+                module.loop(
+                    'write_loop',
+                    module.block(null, [
+                        module.local.set(
+                            len_idx,
+                            module.i32.sub(len, module.i32.const(1)),
+                        ),
+                        setChar(
+                            module,
+                            out,
+                            len,
+                            module.i32.add(
+                                module.i32.wrap(module.i64.rem_u(value, ten)),
+                                module.i32.const(Char.ZERO),
+                            ),
+                        ),
+                        module.local.set(
+                            value_idx,
+                            module.i64.div_u(value, ten),
+                        ),
+                        module.br(
+                            'write_loop',
+                            module.i64.ne(value, module.i64.const(0, 0)),
+                        ),
+                    ]),
+                ),
+                module.return(newString(module, out)),
+            ]),
+        ),
+        module.return(
+            module.call(
+                dyntype.dyntype_toString,
+                [
+                    FunctionalFuncs.getDynContextRef(module),
+                    FunctionalFuncs.generateDynNumber(module, num),
+                ],
+                stringTypeInfo.typeRef,
+            ),
+        ),
+    ]);
+}
+
+/* call JSON[name](arg) of the JS environment */
+function invokeJSON(
+    module: binaryen.Module,
+    fallback: JSONFallbackInfo,
+    nameOffset: number,
+    args_idx: number,
+    arg: binaryen.ExpressionRef,
+) {
+    const args = module.local.get(args_idx, dyntype.dyn_value_t);
+    return module.block(
+        null,
+        [
+            module.local.set(
+                args_idx,
+                FunctionalFuncs.generateDynArray(module, module.i32.const(1)),
+            ),
+            FunctionalFuncs.setDynArrElem(
+                module,
+                args,
+                module.i32.const(0),
+                arg,
+            ),
+            module.call(
+                dyntype.dyntype_invoke,
+                [
+                    FunctionalFuncs.getDynContextRef(module),
+                    module.i32.const(nameOffset),
+                    module.global.get(fallback.globalName, dyntype.dyn_value_t),
+                    args,
+                ],
+                dyntype.dyn_value_t,
+            ),
+        ],
+        dyntype.dyn_value_t,
+    );
+}
+
+/* instances of subclasses are boxed and serialized by the JS environment */
+function json_stringifyFallback(
+    module: binaryen.Module,
+    fallback: JSONFallbackInfo,
+) {
+    /* params */
+    const obj_idx = 0;
+    /* vars */
+    const args_idx = 1;
+
+    return module.return(
+        FunctionalFuncs.unboxAnyToBase(
+            module,
+            invokeJSON(
+                module,
+                fallback,
+                fallback.stringifyNameOffset,
+                args_idx,
+                FunctionalFuncs.generateDynExtrefByTypeKind(
+                    module,
+                    module.local.get(obj_idx, binaryen.anyref),
+                    ValueTypeKind.OBJECT,
+                ),
+            ),
+            ValueTypeKind.STRING,
+        ),
+    );
+}
+
+function addStringifyHelpers(
+    module: binaryen.Module,
+    fallback: JSONFallbackInfo,
+) {
+    const quoteName = getJSONFuncName('json_quote');
+    if (module.getFunction(quoteName)) {
+        return;
+    }
+    module.addFunction(
+        quoteName,
+        stringTypeInfo.typeRef,
+        stringTypeInfo.typeRef,
+        [
+            i8ArrayTypeInfo.typeRef,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            i8ArrayTypeInfo.typeRef,
+            binaryen.i32,
+            binaryen.i32,
+        ],
+        json_quote(module),
+    );
+    module.addFunction(
+        getJSONFuncName('json_number_to_string'),
+        binaryen.f64,
+        stringTypeInfo.typeRef,
+        [
+            binaryen.i64,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i64,
+            i8ArrayTypeInfo.typeRef,
+        ],
+        json_numberToString(module),
+    );
+    module.addFunction(
+        getJSONFuncName('json_stringify_fallback'),
+        binaryen.anyref,
+        stringTypeInfo.typeRef,
+        [dyntype.dyn_value_t],
+        json_stringifyFallback(module, fallback),
+    );
+}
+
+/* the JSON text of a value held in the struct field / array element */
+function valueToJSON(
+    module: binaryen.Module,
+    schema: JSONSchema,
+    value: binaryen.ExpressionRef,
+    fallback: JSONFallbackInfo,
+) {
+    switch (schema.kind) {
+        case ValueTypeKind.NUMBER:
+            return module.call(
+                getJSONFuncName('json_number_to_string'),
+                [value],
+                stringTypeInfo.typeRef,
+            );
+        case ValueTypeKind.BOOLEAN:
+            return module.if(
+                value,
+                constString(module, 'true'),
+                constString(module, 'false'),
+            );
+        case ValueTypeKind.STRING:
+            return module.call(
+                getJSONFuncName('json_quote'),
+                [value],
+                stringTypeInfo.typeRef,
+            );
+        default:
+            return module.call(
+                getJSONStringifyFuncName(module, schema, fallback),
+                [value],
+                stringTypeInfo.typeRef,
+            );
+    }
+}
+
+function json_stringifyObject(
+    module: binaryen.Module,
+    schema: JSONSchema,
+    fallback: JSONFallbackInfo,
+) {
+    /* params */
+    const obj_idx = 0;
+
+    const obj = module.local.get(obj_idx, schema.typeRef);
+    const fields = schema.fields!;
+    const stmts: binaryen.ExpressionRef[] = [
+        module.if(
+            module.ref.is_null(obj),
+            module.return(constString(module, 'null')),
+        ),
+    ];
+    if (schema.checkMeta) {
+        const vtable = binaryenCAPI._BinaryenStructGet(
+            module.ptr,
+            0,
+            obj,
+            schema.vtableTypeRef!,
+            false,
+        );
+        stmts.push(
+            module.if(
+                module.i32.ne(
+                    binaryenCAPI._BinaryenStructGet(
+                        module.ptr,
+                        0,
+                        vtable,
+                        binaryen.i32,
+                        false,
+                    ),
+                    module.i32.const(schema.metaOffset!),
+                ),
+                module.return(
+                    module.call(
+                        getJSONFuncName('json_stringify_fallback'),
+                        [obj],
+                        stringTypeInfo.typeRef,
+                    ),
+                ),
+            ),
+        );
+    }
+    if (fields.length === 0) {
+        stmts.push(module.return(constString(module, '{}')));
+        return module.block(null, stmts);
+    }
+
+    /* {"a": v0 ,"b": v1 } */
+    const parts: binaryen.ExpressionRef[] = [];
+    for (let i = 0; i < fields.length; i++) {
+        const field = fields[i];
+        if (i > 0) {
+            parts.push(constString(module, `,"${field.name}":`));
+        }
+        const fieldValue = binaryenCAPI._BinaryenStructGet(
+            module.ptr,
+            field.index,
+            obj,
+            field.schema.typeRef,
+            false,
+        );
+        parts.push(valueToJSON(module, field.schema, fieldValue, fallback));
+    }
+    parts.push(constString(module, '}'));
+    const partsArray = binaryenCAPI._BinaryenArrayNewFixed(
+        module.ptr,
+        stringArrayTypeInfo.heapTypeRef,
+        arrayToPtr(parts).ptr,
+        parts.length,
+    );
+    stmts.push(
+        module.return(
+            concatParts(
+                module,
+                constString(module, `{"${fields[0].name}":`),
+                partsArray,
+                module.i32.const(parts.length),
+            ),
+        ),
+    );
+    return module.block(null, stmts);
+}
+
+function json_stringifyArray(
+    module: binaryen.Module,
+    schema: JSONSchema,
+    fallback: JSONFallbackInfo,
+) {
+    /* params */
+    const arr_idx = 0;
+    /* vars */
+    const data_idx = 1;
+    const len_idx = 2;
+    const parts_idx = 3;
+    const i_idx = 4;
+
+    const element = schema.element!;
+    const arr = module.local.get(arr_idx, schema.typeRef);
+    const data = module.local.get(data_idx, schema.arrayTypeRef!);
+    const len = module.local.get(len_idx, binaryen.i32);
+    const parts = module.local.get(parts_idx, stringArrayTypeInfo.typeRef);
+    const i = module.local.get(i_idx, binaryen.i32);
+    const elemValue = binaryenCAPI._BinaryenArrayGet(
+        module.ptr,
+        data,
+        i,
+        element.typeRef,
+        false,
+    );
+
+    /* [ v0 , v1 , ... ] */
+    return module.block(null, [
+        module.if(
+            module.ref.is_null(arr),
+            module.return(constString(module, 'null')),
+        ),
+        module.local.set(
+            data_idx,
+            binaryenCAPI._BinaryenStructGet(
+                module.ptr,
+                0,
+                arr,
+                schema.arrayTypeRef!,
+                false,
+            ),
+        ),
+        module.local.set(
+            len_idx,
+            binaryenCAPI._BinaryenStructGet(
+                module.ptr,
+                1,
+                arr,
+                binaryen.i32,
+                false,
+            ),
+        ),
+        module.if(
+            module.i32.eqz(len),
+            module.return(constString(module, '[]')),
+        ),
+        module.local.set(
+            parts_idx,
+            binaryenCAPI._BinaryenArrayNew(
+                module.ptr,
+                stringArrayTypeInfo.heapTypeRef,
+                module.i32.shl(len, module.i32.const(1)),
+                binaryenCAPI._BinaryenRefNull(
+                    module.ptr,
+                    stringTypeInfo.typeRef,
+                ),
+            ),
+        ),
+        forLoop(
+            module,
+            'elem_loop',
+            i_idx,
+            len,
+            module.block(null, [
+                binaryenCAPI._BinaryenArraySet(
+                    module.ptr,
+                    parts,
+                    module.i32.shl(i, module.i32.const(1)),
+                    valueToJSON(module, element, elemValue, fallback),
+                ),
+                binaryenCAPI._BinaryenArraySet(
+                    module.ptr,
+                    parts,
+                    module.i32.add(
+                        module.i32.shl(i, module.i32.const(1)),
+                        module.i32.const(1),
+                    ),
+                    constString(module, ','),
+                ),
+            ]),
+        ),
+        binaryenCAPI._BinaryenArraySet(
+            module.ptr,
+            parts,
+            module.i32.sub(
+                module.i32.shl(len, module.i32.const(1)),
+                module.i32.const(1),
+            ),
+            constString(module, ']'),
+        ),
+        module.return(
+            concatParts(
+                module,
+                constString(module, '['),
+                parts,
+                module.i32.shl(len, module.i32.const(1)),
+            ),
+        ),
+    ]);
+}
+
+/* returns the serializer of an OBJECT or ARRAY schema, generate it at the
+    first call */
+export function getJSONStringifyFuncName(
+    module: binaryen.Module,
+    schema: JSONSchema,
+    fallback: JSONFallbackInfo,
+) {
+    const funcName = getJSONFuncName(`json_stringify|${schema.id}`);
+    if (module.getFunction(funcName)) {
+        return funcName;
+    }
+    addStringifyHelpers(module, fallback);
+    if (schema.kind === ValueTypeKind.ARRAY) {
+        module.addFunction(
+            funcName,
+            schema.typeRef,
+            stringTypeInfo.typeRef,
+            [
+                schema.arrayTypeRef!,
+                binaryen.i32,
+                stringArrayTypeInfo.typeRef,
+                binaryen.i32,
+            ],
+            json_stringifyArray(module, schema, fallback),
+        );
+    } else {
+        module.addFunction(
+            funcName,
+            schema.typeRef,
+            stringTypeInfo.typeRef,
+            [],
+            json_stringifyObject(module, schema, fallback),
+        );
+    }
+    return funcName;
+}
+
+/* skip the white spaces, return the next character or -1 at the end */
+function json_peek(module: binaryen.Module) {
+    /* params */
+    const data_idx = 0;
+    /* vars */
+    const len_idx = 1;
+    const c_idx = 2;
+
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const len = module.local.get(len_idx, binaryen.i32);
+    const c = module.local.get(c_idx, binaryen.i32);
+    const pos = getPos(module);
+
+    return module.block(null, [
+        module.local.set(
+            len_idx,
+            binaryenCAPI._BinaryenArrayLen(module.ptr, data),
+        ),
+        whileLoop(module, 'ws_loop', module.i32.lt_s(pos, len), [
+            module.local.set(c_idx, charAt(module, data, pos)),
+            module.br(
+                'ws_loop_out',
+                module.i32.eqz(
+                    module.i32.or(
+                        module.i32.or(
+                            module.i32.eq(c, module.i32.const(Char.SPACE)),
+                            module.i32.eq(c, module.i32.const(Char.TAB)),
+                        ),
+                        module.i32.or(
+                            module.i32.eq(c, module.i32.const(Char.LF)),
+                            module.i32.eq(c, module.i32.const(Char.CR)),
+                        ),
+                    ),
+                ),
+            ),
+            advancePos(module, 1),
+        ]),
+        module.if(
+            module.i32.lt_s(pos, len),
+            module.return(charAt(module, data, pos)),
+        ),
+        module.return(module.i32.const(-1)),
+    ]);
+}
+
+/* invalid input or a value not matching the schema, the text comes from
+    outside (e.g. a request body) so this must be catchable */
+function json_syntaxError(module: binaryen.Module, fallback: JSONFallbackInfo) {
+    /* vars */
+    const args_idx = 0;
+
+    /* without exception support nothing could catch it */
+    if (!getConfig().enableException) {
+        return module.unreachable();
+    }
+    const args = module.local.get(args_idx, dyntype.dyn_value_t);
+    return module.block(null, [
+        module.local.set(
+            args_idx,
+            FunctionalFuncs.generateDynArray(module, module.i32.const(1)),
+        ),
+        FunctionalFuncs.setDynArrElem(
+            module,
+            args,
+            module.i32.const(0),
+            FunctionalFuncs.generateDynString(
+                module,
+                constString(module, 'Unexpected token in JSON'),
+            ),
+        ),
+        module.throw(BuiltinNames.errorTag, [
+            module.call(
+                dyntype.dyntype_new_object_with_class,
+                [
+                    FunctionalFuncs.getDynContextRef(module),
+                    module.i32.const(fallback.syntaxErrorNameOffset),
+                    args,
+                ],
+                dyntype.dyn_value_t,
+            ),
+        ]),
+    ]);
+}
+
+function syntaxError(module: binaryen.Module) {
+    return module.block(null, [
+        module.call(getJSONFuncName('json_syntax_error'), [], binaryen.none),
+        module.unreachable(),
+    ]);
+}
+
+function callPeek(module: binaryen.Module, data: binaryen.ExpressionRef) {
+    return module.call(getJSONFuncName('json_peek'), [data], binaryen.i32);
+}
+
+/* consume the character c or throw */
+function expectChar(
+    module: binaryen.Module,
+    data: binaryen.ExpressionRef,
+    c: number,
+) {
+    return module.block(null, [
+        module.if(
+            module.i32.ne(callPeek(module, data), module.i32.const(c)),
+            syntaxError(module),
+        ),
+        advancePos(module, 1),
+    ]);
+}
+
+function json_parseHex4(module: binaryen.Module) {
+    /* params */
+    const data_idx = 0;
+    const index_idx = 1;
+    /* vars */
+    const k_idx = 2;
+    const c_idx = 3;
+    const value_idx = 4;
+
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const index = module.local.get(index_idx, binaryen.i32);
+    const k = module.local.get(k_idx, binaryen.i32);
+    const c = module.local.get(c_idx, binaryen.i32);
+    const value = module.local.get(value_idx, binaryen.i32);
+
+    return module.block(null, [
+        module.local.set(value_idx, module.i32.const(0)),
+        forLoop(
+            module,
+            'hex_loop',
+            k_idx,
+            module.i32.const(4),
+            module.block(null, [
+                module.local.set(
+                    c_idx,
+                    charAt(module, data, module.i32.add(index, k)),
+                ),
+                module.if(
+                    module.i32.le_u(
+                        module.i32.sub(c, module.i32.const(Char.ZERO)),
+                        module.i32.const(9),
+                    ),
+                    module.local.set(
+                        c_idx,
+                        module.i32.sub(c, module.i32.const(Char.ZERO)),
+                    ),
+                    module.block(null, [
+                        /* to lower case */
+                        module.local.set(
+                            c_idx,
+                            module.i32.sub(
+                                module.i32.or(c, module.i32.const(32)),
+                                module.i32.const(87),
+                            ),
+                        ),
+                        module.if(
+                            module.i32.or(
+                                module.i32.lt_s(c, module.i32.const(10)),
+                                module.i32.gt_s(c, module.i32.const(15)),
+                            ),
+                            syntaxError(module),
+                        ),
+                    ]),
+                ),
+                module.local.set(
+                    value_idx,
+                    module.i32.or(
+                        module.i32.shl(value, module.i32.const(4)),
+                        c,
+                    ),
+                ),
+            ]),
+        ),
+        module.return(value),
+    ]);
+}
+
+/* write the utf8 bytes of a code point to out[j...], advance j */
+function encodeUTF8(
+    module: binaryen.Module,
+    out_idx: number,
+    j_idx: number,
+    cp_idx: number,
+) {
+    const out = module.local.get(out_idx, i8ArrayTypeInfo.typeRef);
+    const j = module.local.get(j_idx, binaryen.i32);
+    const cp = module.local.get(cp_idx, binaryen.i32);
+    const put = (offset: number, value: binaryen.ExpressionRef) =>
+        setChar(
+            module,
+            out,
+            module.i32.add(j, module.i32.const(offset)),
+            value,
+        );
+    /* 0x80 | ((cp >> shift) & 0x3f) */
+    const tail = (shift: number) =>
+        module.i32.or(
+            module.i32.const(0x80),
+            module.i32.and(
+                module.i32.shr_u(cp, module.i32.const(shift)),
+                module.i32.const(0x3f),
+            ),
+        );
+    const lead = (mark: number, shift: number) =>
+        module.i32.or(
+            module.i32.const(mark),
+            module.i32.shr_u(cp, module.i32.const(shift)),
+        );
+    const skip = (step: number) =>
+        module.local.set(j_idx, module.i32.add(j, module.i32.const(step)));
+
+    return module.if(
+        module.i32.lt_u(cp, module.i32.const(0x80)),
+        module.block(null, [put(0, cp), skip(1)]),
+        module.if(
+            module.i32.lt_u(cp, module.i32.const(0x800)),
+            module.block(null, [
+                put(0, lead(0xc0, 6)),
+                put(1, tail(0)),
+                skip(2),
+            ]),
+            module.if(
+                module.i32.lt_u(cp, module.i32.const(0x10000)),
+                module.block(null, [
+                    put(0, lead(0xe0, 12)),
+                    put(1, tail(6)),
+                    put(2, tail(0)),
+                    skip(3),
+                ]),
+                module.block(null, [
+                    put(0, lead(0xf0, 18)),
+                    put(1, tail(12)),
+                    put(2, tail(6)),
+                    put(3, tail(0)),
+                    skip(4),
+                ]),
+            ),
+        ),
+    );
+}
+
+function json_parseString(module: binaryen.Module) {
+    /* params */
+    const data_idx = 0;
+    /* vars */
+    const len_idx = 1;
+    const start_idx = 2;
+    const i_idx = 3;
+    const c_idx = 4;
+    const escaped_idx = 5;
+    const out_idx = 6;
+    const j_idx = 7;
+    const cp_idx = 8;
+    const low_idx = 9;
+    const res_idx = 10;
+
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const len = module.local.get(len_idx, binaryen.i32);
+    const start = module.local.get(start_idx, binaryen.i32);
+    const i = module.local.get(i_idx, binaryen.i32);
+    const c = module.local.get(c_idx, binaryen.i32);
+    const escaped = module.local.get(escaped_idx, binaryen.i32);
+    const out = module.local.get(out_idx, i8ArrayTypeInfo.typeRef);
+    const j = module.local.get(j_idx, binaryen.i32);
+    const cp = module.local.get(cp_idx, binaryen.i32);
+    const low = module.local.get(low_idx, binaryen.i32);
+    const res = module.local.get(res_idx, i8ArrayTypeInfo.typeRef);
+    const hex4 = (index: binaryen.ExpressionRef) =>
+        module.call(
+            getJSONFuncName('json_parse_hex4'),
+            [data, index],
+            binaryen.i32,
+        );
+    const inRange = (
+        value: binaryen.ExpressionRef,
+        from: number,
+        to: number,
+    ) =>
+        module.i32.lt_u(
+            module.i32.sub(value, module.i32.const(from)),
+            module.i32.const(to - from),
+        );
+    const stepI = (step: number) =>
+        module.local.set(i_idx, module.i32.add(i, module.i32.const(step)));
+    /* \uD83D\uDE00, combine the surrogates into one code point */
+    const surrogatePair = module.if(
+        module.i32.and(
+            inRange(cp, 0xd800, 0xdc00),
+            module.i32.le_s(module.i32.add(i, module.i32.const(6)), len),
+        ),
+        module.if(
+            matchWord(module, data, i, '\\u'),
+            module.block(null, [
+                module.local.set(
+                    low_idx,
+                    hex4(module.i32.add(i, module.i32.const(2))),
+                ),
+                module.if(
+                    inRange(low, 0xdc00, 0xe000),
+                    module.block(null, [
+                        module.local.set(
+                            cp_idx,
+                            module.i32.add(
+                                module.i32.shl(
+                                    module.i32.sub(
+                                        cp,
+                                        module.i32.const(0xd800),
+                                    ),
+                                    module.i32.const(10),
+                                ),
+                                module.i32.add(
+                                    module.i32.sub(
+                                        low,
+                                        module.i32.const(0xdc00),
+                                    ),
+                                    module.i32.const(0x10000),
+                                ),
+                            ),
+                        ),
+                        stepI(6),
+                    ]),
+                ),
+            ]),
+        ),
+    );
+    /* a single character escape */
+    let unescaped = c;
+    const escapes: [number, number][] = [
+        [Char.LOWER_B, 8],
+        [Char.LOWER_F, 12],
+        [Char.LOWER_N, Char.LF],
+        [Char.LOWER_R, Char.CR],
+        [Char.LOWER_T, Char.TAB],
+    ];
+    for (const [escape, code] of escapes) {
+        unescaped = module.select(
+            module.i32.eq(c, module.i32.const(escape)),
+            module.i32.const(code),
+            unescaped,
+        );
+    }
+
+    return module.block(null, [
+        expectChar(module, data, Char.QUOTE),
+        module.local.set(
+            len_idx,
+            binaryenCAPI._BinaryenArrayLen(module.ptr, data),
+        ),
+        module.local.set(start_idx, getPos(module)),
+        module.local.set(i_idx, start),
+        module.local.set(escaped_idx, module.i32.const(0)),
+        /* find the closing quote */
+        module.loop(
+            'scan_loop',
+            module.block(null, [
+                module.if(module.i32.ge_s(i, len), syntaxError(module)),
+                module.local.set(c_idx, charAt(module, data, i)),
+                module.if(
+                    module.i32.ne(c, module.i32.const(Char.QUOTE)),
+                    module.block(null, [
+                        module.if(
+                            module.i32.eq(c, module.i32.const(Char.BACKSLASH)),
+                            module.block(null, [
+                                module.local.set(
+                                    escaped_idx,
+                                    module.i32.const(1),
+                                ),
+                                stepI(2),
+                            ]),
+                            stepI(1),
+                        ),
+                        module.br('scan_loop'),
+                    ]),
+                ),
+            ]),
+        ),
+        setPos(module, module.i32.add(i, module.i32.const(1))),
+        module.local.set(
+            out_idx,
+            newCharArray(module, module.i32.sub(i, start)),
+        ),
+        module.if(
+            module.i32.eqz(escaped),
+            module.block(null, [
+                copyChars(
+                    module,
+                    out,
+                    module.i32.const(0),
+                    data,
+                    start,
+                    module.i32.sub(i, start),
+                ),
+                module.return(newString(module, out)),
+            ]),
+        ),
+        /* decode the escapes, the result is never longer than the source */
+        module.local.set(len_idx, i),
+        module.local.set(i_idx, start),
+        module.local.set(j_idx, module.i32.const(0)),
+        whileLoop(module, 'decode_loop', module.i32.lt_s(i, len), [
+            module.local.set(c_idx, charAt(module, data, i)),
+            module.if(
+                module.i32.ne(c, module.i32.const(Char.BACKSLASH)),
+                module.block(null, [
+                    setChar(module, out, j, c),
+                    module.local.set(
+                        j_idx,
+                        module.i32.add(j, module.i32.const(1)),
+                    ),
+                    stepI(1),
+                ]),
+                module.block(null, [
+                    module.local.set(
+                        c_idx,
+                        charAt(
+                            module,
+                            data,
+                            module.i32.add(i, module.i32.const(1)),
+                        ),
+                    ),
+                    stepI(2),
+                    module.if(
+                        module.i32.eq(c, module.i32.const(Char.LOWER_U)),
+                        module.block(null, [
+                            module.local.set(cp_idx, hex4(i)),
+                            stepI(4),
+                            surrogatePair,
+                            encodeUTF8(module, out_idx, j_idx, cp_idx),
+                        ]),
+                        module.block(null, [
+                            setChar(module, out, j, unescaped),
+                            module.local.set(
+                                j_idx,
+                                module.i32.add(j, module.i32.const(1)),
+                            ),
+                        ]),
+                    ),
+                ]),
+            ),
+        ]),
+        module.local.set(res_idx, newCharArray(module, j)),
+        copyChars(
+            module,
+            res,
+            module.i32.const(0),
+            out,
+            module.i32.const(0),
+            j,
+        ),
+        module.return(newString(module, res)),
+    ]);
+}
+
+/* digits with value, a decimal digit is c - '0' <= 9 */
+function digitLoop(
+    module: binaryen.Module,
+    label: string,
+    data: binaryen.ExpressionRef,
+    i_idx: number,
+    len: binaryen.ExpressionRef,
+    c_idx: number,
+    statements: binaryen.ExpressionRef[],
+) {
+    const i = module.local.get(i_idx, binaryen.i32);
+    const c = module.local.get(c_idx, binaryen.i32);
+    return whileLoop(module, label, module.i32.lt_s(i, len), [
+        module.local.set(
+            c_idx,
+            module.i32.sub(
+                charAt(module, data, i),
+                module.i32.const(Char.ZERO),
+            ),
+        ),
+        module.br(`${label}_out`, module.i32.gt_u(c, module.i32.const(9))),
+        ...statements,
+        module.local.set(i_idx, module.i32.add(i, module.i32.const(1))),
+    ]);
+}
+
+/* Numbers with at most 15 significant digits and a decimal exponent within
+    22 are exact with one f64 multiplication or division (Clinger's fast
+    path), the others are parsed by the JS environment. */
+function json_parseNumber(module: binaryen.Module, fallback: JSONFallbackInfo) {
+    /* params */
+    const data_idx = 0;
+    /* vars */
+    const len_idx = 1;
+    const start_idx = 2;
+    const i_idx = 3;
+    const c_idx = 4;
+    const neg_idx = 5;
+    const mant_idx = 6;
+    const digits_idx = 7;
+    const exp_idx = 8;
+    const expSign_idx = 9;
+    const expValue_idx = 10;
+    const count_idx = 11;
+    const scale_idx = 12;
+    const k_idx = 13;
+    const sub_idx = 14;
+    const args_idx = 15;
+
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const len = module.local.get(len_idx, binaryen.i32);
+    const start = module.local.get(start_idx, binaryen.i32);
+    const i = module.local.get(i_idx, binaryen.i32);
+    const c = module.local.get(c_idx, binaryen.i32);
+    const neg = module.local.get(neg_idx, binaryen.i32);
+    const mant = module.local.get(mant_idx, binaryen.i64);
+    const digits = module.local.get(digits_idx, binaryen.i32);
+    const exp = module.local.get(exp_idx, binaryen.i32);
+    const expSign = module.local.get(expSign_idx, binaryen.i32);
+    const expValue = module.local.get(expValue_idx, binaryen.i32);
+    const count = module.local.get(count_idx, binaryen.i32);
+    const scale = module.local.get(scale_idx, binaryen.f64);
+    const k = module.local.get(k_idx, binaryen.i32);
+    const sub = module.local.get(sub_idx, i8ArrayTypeInfo.typeRef);
+    const stepI = () =>
+        module.local.set(i_idx, module.i32.add(i, module.i32.const(1)));
+    /* data[i] == ch, only read when i < len */
+    const nextIs = (ch: number) =>
+        module.if(
+            module.i32.lt_s(i, len),
+            module.i32.eq(charAt(module, data, i), module.i32.const(ch)),
+            module.i32.const(0),
+        );
+    /* mant = mant * 10 + c, the digits beyond 19 don't fit into i64 but
+        those numbers take the slow path anyway */
+    const addDigit = () =>
+        module.block(null, [
+            module.if(
+                module.i32.lt_s(digits, module.i32.const(19)),
+                module.local.set(
+                    mant_idx,
+                    module.i64.add(
+                        module.i64.mul(mant, module.i64.const(10, 0)),
+                        module.i64.extend_u(c),
+                    ),
+                ),
+            ),
+            module.local.set(
+                digits_idx,
+                module.i32.add(digits, module.i32.const(1)),
+            ),
+        ]);
+    const absExp = () =>
+        module.select(
+            module.i32.lt_s(exp, module.i32.const(0)),
+            module.i32.sub(module.i32.const(0), exp),
+            exp,
+        );
+
+    return module.block(null, [
+        module.drop(callPeek(module, data)),
+        module.local.set(
+            len_idx,
+            binaryenCAPI._BinaryenArrayLen(module.ptr, data),
+        ),
+        module.local.set(start_idx, getPos(module)),
+        module.local.set(i_idx, start),
+        module.local.set(neg_idx, nextIs(Char.MINUS)),
+        module.if(neg, stepI()),
+        module.local.set(mant_idx, module.i64.const(0, 0)),
+        module.local.set(digits_idx, module.i32.const(0)),
+        module.local.set(exp_idx, module.i32.const(0)),
+        /* integer part */
+        digitLoop(module, 'int_loop', data, i_idx, len, c_idx, [addDigit()]),
+        module.if(module.i32.eqz(digits), syntaxError(module)),
+        /* fraction */
+        module.if(
+            nextIs(Char.DOT),
+            module.block(null, [
+                stepI(),
+                module.local.set(count_idx, digits),
+                digitLoop(module, 'frac_loop', data, i_idx, len, c_idx, [
+                    addDigit(),
+                    module.local.set(
+                        exp_idx,
+                        module.i32.sub(exp, module.i32.const(1)),
+                    ),
+                ]),
+                module.if(module.i32.eq(count, digits), syntaxError(module)),
+            ]),
+        ),
+        /* exponent */
+        module.if(
+            module.i32.or(nextIs(Char.LOWER_E), nextIs(Char.UPPER_E)),
+            module.block(null, [
+                stepI(),
+                module.local.set(expSign_idx, module.i32.const(1)),
+                module.if(
+                    nextIs(Char.MINUS),
+                    module.block(null, [
+                        module.local.set(expSign_idx, module.i32.const(-1)),
+                        stepI(),
+                    ]),
+                    module.if(nextIs(Char.PLUS), stepI()),
+                ),
+                module.local.set(expValue_idx, module.i32.const(0)),
+                module.local.set(count_idx, module.i32.const(0)),
+                digitLoop(module, 'exp_loop', data, i_idx, len, c_idx, [
+                    module.if(
+                        module.i32.lt_s(expValue, module.i32.const(100000)),
+                        module.local.set(
+                            expValue_idx,
+                            module.i32.add(
+                                module.i32.mul(expValue, module.i32.const(10)),
+                                c,
+                            ),
+                        ),
+                    ),
+                    module.local.set(
+                        count_idx,
+                        module.i32.add(count, module.i32.const(1)),
+                    ),
+                ]),
+                module.if(module.i32.eqz(count), syntaxError(module)),
+                module.local.set(
+                    exp_idx,
+                    module.i32.add(exp, module.i32.mul(expValue, expSign)),
+                ),
+            ]),
+        ),
+        setPos(module, i),
+        module.if(
+            module.i32.and(
+                module.i32.le_s(digits, module.i32.const(15)),
+                module.i32.le_s(absExp(), module.i32.const(22)),
+            ),
+            module.block(null, [
+                /* 10^|exp| is exact */
+                module.local.set(scale_idx, module.f64.const(1)),
+                forLoop(
+                    module,
+                    'scale_loop',
+                    k_idx,
+                    absExp(),
+                    module.local.set(
+                        scale_idx,
+                        module.f64.mul(scale, module.f64.const(10)),
+                    ),
+                ),
+                module.local.set(
+                    scale_idx,
+                    module.if(
+                        module.i32.lt_s(exp, module.i32.const(0)),
+                        module.f64.div(module.f64.convert_u.i64(mant), scale),
+                        module.f64.mul(module.f64.convert_u.i64(mant), scale),
+                    ),
+                ),
+                module.return(
+                    module.if(neg, module.f64.neg(scale), scale),
+                ),
+            ]),
+        ),
+        module.local.set(
+            sub_idx,
+            newCharArray(module, module.i32.sub(i, start)),
+        ),
+        copyChars(
+            module,
+            sub,
+            module.i32.const(0),
+            data,
+            start,
+            module.i32.sub(i, start),
+        ),
+        module.return(
+            FunctionalFuncs.unboxAnyToBase(
+                module,
+                invokeJSON(
+                    module,
+                    fallback,
+                    fallback.parseNameOffset,
+                    args_idx,
+                    FunctionalFuncs.generateDynString(
+                        module,
+                        newString(module, sub),
+                    ),
+                ),
+                ValueTypeKind.NUMBER,
+            ),
+        ),
+    ]);
+}
+
+function json_parseBoolean(module: binaryen.Module) {
+    /* params */
+    const data_idx = 0;
+    /* vars */
+    const c_idx = 1;
+
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const c = module.local.get(c_idx, binaryen.i32);
+    const pos = getPos(module);
+
+    return module.block(null, [
+        module.local.set(c_idx, callPeek(module, data)),
+        module.if(
+            module.i32.eq(c, module.i32.const(Char.LOWER_T)),
+            module.if(
+                matchWord(module, data, pos, 'true'),
+                module.block(null, [
+                    advancePos(module, 4),
+                    module.return(module.i32.const(1)),
+                ]),
+            ),
+        ),
+        module.if(
+            module.i32.eq(c, module.i32.const(Char.LOWER_F)),
+            module.if(
+                matchWord(module, data, pos, 'false'),
+                module.block(null, [
+                    advancePos(module, 5),
+                    module.return(module.i32.const(0)),
+                ]),
+            ),
+        ),
+        syntaxError(module),
+    ]);
+}
+
+/* consume a null literal, return 0 if the next value is not null */
+function json_parseNull(module: binaryen.Module) {
+    /* params */
+    const data_idx = 0;
+
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    return module.block(null, [
+        module.if(
+            module.i32.ne(
+                callPeek(module, data),
+                module.i32.const(Char.LOWER_N),
+            ),
+            module.return(module.i32.const(0)),
+        ),
+        module.if(
+            module.i32.eqz(matchWord(module, data, getPos(module), 'null')),
+            syntaxError(module),
+        ),
+        advancePos(module, 4),
+        module.return(module.i32.const(1)),
+    ]);
+}
+
+/* skip the value of a key which is not in the schema */
+function json_skipValue(module: binaryen.Module) {
+    /* params */
+    const data_idx = 0;
+    /* vars */
+    const c_idx = 1;
+    const depth_idx = 2;
+    const len_idx = 3;
+
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const c = module.local.get(c_idx, binaryen.i32);
+    const depth = module.local.get(depth_idx, binaryen.i32);
+    const len = module.local.get(len_idx, binaryen.i32);
+    const pos = getPos(module);
+    const isChar = (ch: number) => module.i32.eq(c, module.i32.const(ch));
+    const skipString = () =>
+        module.drop(
+            module.call(
+                getJSONFuncName('json_parse_string'),
+                [data],
+                stringTypeInfo.typeRef,
+            ),
+        );
+
+    return module.block(null, [
+        module.local.set(c_idx, callPeek(module, data)),
+        module.local.set(
+            len_idx,
+            binaryenCAPI._BinaryenArrayLen(module.ptr, data),
+        ),
+        module.if(
+            isChar(Char.QUOTE),
+            module.block(null, [skipString(), module.return()]),
+        ),
+        module.if(
+            module.i32.or(isChar(Char.LEFT_BRACE), isChar(Char.LEFT_BRACKET)),
+            module.block(null, [
+                module.local.set(depth_idx, module.i32.const(0)),
+                module.loop(
+                    'nested_loop',
+                    module.block(null, [
+                        module.if(
+                            module.i32.ge_s(pos, len),
+                            syntaxError(module),
+                        ),
+                        module.local.set(c_idx, charAt(module, data, pos)),
+                        module.if(
+                            isChar(Char.QUOTE),
+                            skipString(),
+                            module.block(null, [
+                                advancePos(module, 1),
+                                module.if(
+                                    module.i32.or(
+                                        isChar(Char.LEFT_BRACE),
+                                        isChar(Char.LEFT_BRACKET),
+                                    ),
+                                    module.local.set(
+                                        depth_idx,
+                                        module.i32.add(
+                                            depth,
+                                            module.i32.const(1),
+                                        ),
+                                    ),
+                                ),
+                                module.if(
+                                    module.i32.or(
+                                        isChar(Char.RIGHT_BRACE),
+                                        isChar(Char.RIGHT_BRACKET),
+                                    ),
+                                    module.block(null, [
+                                        module.local.set(
+                                            depth_idx,
+                                            module.i32.sub(
+                                                depth,
+                                                module.i32.const(1),
+                                            ),
+                                        ),
+                                        module.if(
+                                            module.i32.eqz(depth),
+                                            module.return(),
+                                        ),
+                                    ]),
+                                ),
+                            ]),
+                        ),
+                        module.br('nested_loop'),
+                    ]),
+                ),
+            ]),
+        ),
+        /* number or literal */
+        whileLoop(module, 'scalar_loop', module.i32.lt_s(pos, len), [
+            module.local.set(c_idx, charAt(module, data, pos)),
+            module.br(
+                'scalar_loop_out',
+                module.i32.or(
+                    module.i32.or(
+                        module.i32.or(
+                            isChar(Char.COMMA),
+                            isChar(Char.RIGHT_BRACE),
+                        ),
+                        module.i32.or(
+                            isChar(Char.RIGHT_BRACKET),
+                            isChar(Char.SPACE),
+                        ),
+                    ),
+                    module.i32.or(
+                        module.i32.or(isChar(Char.TAB), isChar(Char.LF)),
+                        isChar(Char.CR),
+                    ),
+                ),
+            ),
+            advancePos(module, 1),
+        ]),
+    ]);
+}
+
+function addParseHelpers(module: binaryen.Module, fallback: JSONFallbackInfo) {
+    const peekName = getJSONFuncName('json_peek');
+    if (module.getFunction(peekName)) {
+        return;
+    }
+    const dataType = i8ArrayTypeInfo.typeRef;
+    module.addGlobal(jsonParsePosName, binaryen.i32, true, module.i32.const(0));
+    module.addFunction(
+        getJSONFuncName('json_syntax_error'),
+        binaryen.none,
+        binaryen.none,
+        [dyntype.dyn_value_t],
+        json_syntaxError(module, fallback),
+    );
+    module.addFunction(
+        peekName,
+        dataType,
+        binaryen.i32,
+        [binaryen.i32, binaryen.i32],
+        json_peek(module),
+    );
+    module.addFunction(
+        getJSONFuncName('json_parse_hex4'),
+        binaryen.createType([dataType, binaryen.i32]),
+        binaryen.i32,
+        [binaryen.i32, binaryen.i32, binaryen.i32],
+        json_parseHex4(module),
+    );
+    module.addFunction(
+        getJSONFuncName('json_parse_string'),
+        dataType,
+        stringTypeInfo.typeRef,
+        [
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            dataType,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            dataType,
+        ],
+        json_parseString(module),
+    );
+    module.addFunction(
+        getJSONFuncName('json_parse_number'),
+        dataType,
+        binaryen.f64,
+        [
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i64,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.f64,
+            binaryen.i32,
+            dataType,
+            dyntype.dyn_value_t,
+        ],
+        json_parseNumber(module, fallback),
+    );
+    module.addFunction(
+        getJSONFuncName('json_parse_boolean'),
+        dataType,
+        binaryen.i32,
+        [binaryen.i32],
+        json_parseBoolean(module),
+    );
+    module.addFunction(
+        getJSONFuncName('json_parse_null'),
+        dataType,
+        binaryen.i32,
+        [],
+        json_parseNull(module),
+    );
+    module.addFunction(
+        getJSONFuncName('json_skip_value'),
+        dataType,
+        binaryen.none,
+        [binaryen.i32, binaryen.i32, binaryen.i32],
+        json_skipValue(module),
+    );
+}
+
+function parseValue(
+    module: binaryen.Module,
+    schema: JSONSchema,
+    data: binaryen.ExpressionRef,
+    fallback: JSONFallbackInfo,
+) {
+    switch (schema.kind) {
+        case ValueTypeKind.NUMBER:
+            return module.call(
+                getJSONFuncName('json_parse_number'),
+                [data],
+                binaryen.f64,
+            );
+        case ValueTypeKind.BOOLEAN:
+            return module.call(
+                getJSONFuncName('json_parse_boolean'),
+                [data],
+                binaryen.i32,
+            );
+        case ValueTypeKind.STRING:
+            return module.call(
+                getJSONFuncName('json_parse_string'),
+                [data],
+                stringTypeInfo.typeRef,
+            );
+        default:
+            return module.call(
+                getParseFuncName(module, schema, fallback),
+                [data],
+                schema.typeRef,
+            );
+    }
+}
+
+function json_parseObject(
+    module: binaryen.Module,
+    schema: JSONSchema,
+    fallback: JSONFallbackInfo,
+) {
+    /* params */
+    const data_idx = 0;
+    /* vars */
+    const keyStart_idx = 1;
+    const keyLen_idx = 2;
+    const c_idx = 3;
+    /* the field values are kept in locals from here */
+    const fields_idx = 4;
+
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const keyStart = module.local.get(keyStart_idx, binaryen.i32);
+    const keyLen = module.local.get(keyLen_idx, binaryen.i32);
+    const c = module.local.get(c_idx, binaryen.i32);
+    const pos = getPos(module);
+    const fields = schema.fields!;
+
+    /* match the key against the field names */
+    let dispatch = module.call(
+        getJSONFuncName('json_skip_value'),
+        [data],
+        binaryen.none,
+    );
+    for (let i = fields.length - 1; i >= 0; i--) {
+        const name = fields[i].name;
+        dispatch = module.if(
+            module.i32.and(
+                module.i32.eq(keyLen, module.i32.const(name.length)),
+                matchWord(module, data, keyStart, name),
+            ),
+            module.local.set(
+                fields_idx + i,
+                parseValue(module, fields[i].schema, data, fallback),
+            ),
+            dispatch,
+        );
+    }
+
+    const stmts: binaryen.ExpressionRef[] = [
+        module.if(
+            module.call(
+                getJSONFuncName('json_parse_null'),
+                [data],
+                binaryen.i32,
+            ),
+            module.return(
+                binaryenCAPI._BinaryenRefNull(module.ptr, schema.typeRef),
+            ),
+        ),
+        expectChar(module, data, Char.LEFT_BRACE),
+    ];
+    /* missing keys leave the zero value of the field type */
+    for (let i = 0; i < fields.length; i++) {
+        stmts.push(
+            module.local.set(
+                fields_idx + i,
+                getZeroValue(module, fields[i].schema),
+            ),
+        );
+    }
+    stmts.push(
+        module.if(
+            module.i32.eq(
+                callPeek(module, data),
+                module.i32.const(Char.RIGHT_BRACE),
+            ),
+            advancePos(module, 1),
+            module.loop(
+                'member_loop',
+                module.block(null, [
+                    expectChar(module, data, Char.QUOTE),
+                    module.local.set(keyStart_idx, pos),
+                    module.loop(
+                        'key_loop',
+                        module.block(null, [
+                            module.local.set(c_idx, charAt(module, data, pos)),
+                            module.if(
+                                module.i32.ne(c, module.i32.const(Char.QUOTE)),
+                                module.block(null, [
+                                    advancePos(module, 1),
+                                    module.if(
+                                        module.i32.eq(
+                                            c,
+                                            module.i32.const(Char.BACKSLASH),
+                                        ),
+                                        advancePos(module, 1),
+                                    ),
+                                    module.br('key_loop'),
+                                ]),
+                            ),
+                        ]),
+                    ),
+                    module.local.set(keyLen_idx, module.i32.sub(pos, keyStart)),
+                    advancePos(module, 1),
+                    expectChar(module, data, Char.COLON),
+                    dispatch,
+                    module.local.set(c_idx, callPeek(module, data)),
+                    advancePos(module, 1),
+                    module.br(
+                        'member_loop',
+                        module.i32.eq(c, module.i32.const(Char.COMMA)),
+                    ),
+                    module.if(
+                        module.i32.ne(c, module.i32.const(Char.RIGHT_BRACE)),
+                        syntaxError(module),
+                    ),
+                ]),
+            ),
+        ),
+    );
+
+    const structFields = [schema.vtableInst!];
+    for (let i = 0; i < fields.length; i++) {
+        structFields.push(
+            module.local.get(fields_idx + i, fields[i].schema.typeRef),
+        );
+    }
+    stmts.push(
+        module.return(
+            binaryenCAPI._BinaryenStructNew(
+                module.ptr,
+                arrayToPtr(structFields).ptr,
+                structFields.length,
+                schema.heapTypeRef!,
+            ),
+        ),
+    );
+    return module.block(null, stmts);
+}
+
+function json_parseArray(
+    module: binaryen.Module,
+    schema: JSONSchema,
+    fallback: JSONFallbackInfo,
+) {
+    /* params */
+    const data_idx = 0;
+    /* vars */
+    const arr_idx = 1;
+    const len_idx = 2;
+    const cap_idx = 3;
+    const c_idx = 4;
+    const grown_idx = 5;
+    const elem_idx = 6;
+
+    const element = schema.element!;
+    const arrayTypeRef = schema.arrayTypeRef!;
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const arr = module.local.get(arr_idx, arrayTypeRef);
+    const len = module.local.get(len_idx, binaryen.i32);
+    const cap = module.local.get(cap_idx, binaryen.i32);
+    const c = module.local.get(c_idx, binaryen.i32);
+    const grown = module.local.get(grown_idx, arrayTypeRef);
+    const newArray = (length: binaryen.ExpressionRef) =>
+        binaryenCAPI._BinaryenArrayNew(
+            module.ptr,
+            schema.arrayHeapTypeRef!,
+            length,
+            getZeroValue(module, element),
+        );
+
+    return module.block(null, [
+        module.if(
+            module.call(
+                getJSONFuncName('json_parse_null'),
+                [data],
+                binaryen.i32,
+            ),
+            module.return(
+                binaryenCAPI._BinaryenRefNull(module.ptr, schema.typeRef),
+            ),
+        ),
+        expectChar(module, data, Char.LEFT_BRACKET),
+        module.local.set(cap_idx, module.i32.const(4)),
+        module.local.set(arr_idx, newArray(cap)),
+        module.local.set(len_idx, module.i32.const(0)),
+        module.if(
+            module.i32.eq(
+                callPeek(module, data),
+                module.i32.const(Char.RIGHT_BRACKET),
+            ),
+            advancePos(module, 1),
+            module.loop(
+                'elem_loop',
+                module.block(null, [
+                    module.local.set(
+                        elem_idx,
+                        parseValue(module, element, data, fallback),
+                    ),
+                    module.if(
+                        module.i32.eq(len, cap),
+                        module.block(null, [
+                            module.local.set(
+                                cap_idx,
+                                module.i32.shl(cap, module.i32.const(1)),
+                            ),
+                            module.local.set(grown_idx, newArray(cap)),
+                            binaryenCAPI._BinaryenArrayCopy(
+                                module.ptr,
+                                grown,
+                                module.i32.const(0),
+                                arr,
+                                module.i32.const(0),
+                                len,
+                            ),
+                            module.local.set(arr_idx, grown),
+                        ]),
+                    ),
+                    binaryenCAPI._BinaryenArraySet(
+                        module.ptr,
+                        arr,
+                        len,
+                        module.local.get(elem_idx, element.typeRef),
+                    ),
+                    module.local.set(
+                        len_idx,
+                        module.i32.add(len, module.i32.const(1)),
+                    ),
+                    module.local.set(c_idx, callPeek(module, data)),
+                    advancePos(module, 1),
+                    module.br(
+                        'elem_loop',
+                        module.i32.eq(c, module.i32.const(Char.COMMA)),
+                    ),
+                    module.if(
+                        module.i32.ne(c, module.i32.const(Char.RIGHT_BRACKET)),
+                        syntaxError(module),
+                    ),
+                ]),
+            ),
+        ),
+        module.return(
+            binaryenCAPI._BinaryenStructNew(
+                module.ptr,
+                arrayToPtr([arr, len]).ptr,
+                2,
+                schema.heapTypeRef!,
+            ),
+        ),
+    ]);
+}
+
+function getParseFuncName(
+    module: binaryen.Module,
+    schema: JSONSchema,
+    fallback: JSONFallbackInfo,
+) {
+    const funcName = getJSONFuncName(`json_parse|${schema.id}`);
+    if (module.getFunction(funcName)) {
+        return funcName;
+    }
+    if (schema.kind === ValueTypeKind.ARRAY) {
+        module.addFunction(
+            funcName,
+            i8ArrayTypeInfo.typeRef,
+            schema.typeRef,
+            [
+                schema.arrayTypeRef!,
+                binaryen.i32,
+                binaryen.i32,
+                binaryen.i32,
+                schema.arrayTypeRef!,
+                schema.element!.typeRef,
+            ],
+            json_parseArray(module, schema, fallback),
+        );
+    } else {
+        module.addFunction(
+            funcName,
+            i8ArrayTypeInfo.typeRef,
+            schema.typeRef,
+            [
+                binaryen.i32,
+                binaryen.i32,
+                binaryen.i32,
+                ...schema.fields!.map((f) => f.schema.typeRef),
+            ],
+            json_parseObject(module, schema, fallback),
+        );
+    }
+    return funcName;
+}
+
+/* returns the function parsing a whole text into an OBJECT or ARRAY schema,
+    generate it at the first call */
+export function getJSONParseFuncName(
+    module: binaryen.Module,
+    schema: JSONSchema,
+    fallback: JSONFallbackInfo,
+) {
+    const funcName = getJSONFuncName(`json_parse_text|${schema.id}`);
+    if (module.getFunction(funcName)) {
+        return funcName;
+    }
+    addParseHelpers(module, fallback);
+
+    /* params */
+    const text_idx = 0;
+    /* vars */
+    const data_idx = 1;
+    const res_idx = 2;
+
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    module.addFunction(
+        funcName,
+        stringTypeInfo.typeRef,
+        schema.typeRef,
+        [i8ArrayTypeInfo.typeRef, schema.typeRef],
+        module.block(null, [
+            module.local.set(
+                data_idx,
+                getStringData(
+                    module,
+                    module.local.get(text_idx, stringTypeInfo.typeRef),
+                ),
+            ),
+            setPos(module, module.i32.const(0)),
+            module.local.set(
+                res_idx,
+                parseValue(module, schema, data, fallback),
+            ),
+            /* nothing but white spaces after the value */
+            module.if(
+                module.i32.ne(callPeek(module, data), module.i32.const(-1)),
+                syntaxError(module),
+            ),
+            module.return(module.local.get(res_idx, schema.typeRef)),
+        ]),
+    );
+    return funcName;
+}
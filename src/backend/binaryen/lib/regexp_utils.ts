@@ -0,0 +1,1706 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* RegExp objects and the String methods taking a RegExp. The pattern is
+    compiled by libregexp in the native (lib_regexp.c), which caches the
+    bytecode per (source, flags) pair and returns its id, the RegExp struct
+    only keeps that id. A regex literal also keeps the id in a global, so
+    the native compiler is reached once per literal. The id of `new RegExp`
+    is bound to the new struct, whose finalizer lets the native evict it.
+
+    Matching runs natively and writes the byte offsets of the captures to an
+    i32 array, the result strings are sliced here. Groups which didn't
+    participate in the match give empty strings since the results are typed
+    as string[]. */
+
+import binaryen from 'binaryen';
+import * as binaryenCAPI from '../glue/binaryen.js';
+import { BuiltinNames } from '../../../../lib/builtin/builtin_name.js';
+import { arrayToPtr, emptyStructType } from '../glue/transform.js';
+import {
+    i32ArrayTypeInfo,
+    i8ArrayTypeInfo,
+    regExpTypeInfo,
+    stringArrayStructTypeInfo,
+    stringArrayTypeInfo,
+    stringTypeInfo,
+} from '../glue/packType.js';
+import { FunctionalFuncs, UtilFuncs } from '../utils.js';
+import { SemanticsKind } from '../../../semantics/semantics_nodes.js';
+
+/* the result type of matchAll (string[][]), provided by the call site */
+export interface MatchAllTypeInfo {
+    structTypeRef: binaryen.Type;
+    structHeapTypeRef: binaryenCAPI.HeapTypeRef;
+    arrayTypeRef: binaryen.Type;
+    arrayHeapTypeRef: binaryenCAPI.HeapTypeRef;
+}
+
+const enum RegExpField {
+    SOURCE = 0,
+    FLAGS,
+    GLOBAL,
+    STICKY,
+    LAST_INDEX,
+    PATTERN_ID,
+    CAPTURE_COUNT,
+}
+
+/* LRE_FLAG_STICKY of libregexp, LRE_FLAG_GLOBAL is 1 */
+const stickyFlagShift = 5;
+
+const enum Char {
+    DOLLAR = 36,
+    AMPERSAND = 38,
+    QUOTE = 39,
+    ZERO = 48,
+    BACKQUOTE = 96,
+}
+
+const substringFuncName = 'regexp_substring';
+const appendFuncName = 'regexp_append';
+const execAtFuncName = 'regexp_exec_at';
+const execFuncName = 'regexp_exec_internal';
+const groupsFuncName = 'regexp_groups';
+const execMethodName = UtilFuncs.getBuiltinClassMethodName(
+    BuiltinNames.REGEXP,
+    'exec',
+);
+const testMethodName = UtilFuncs.getBuiltinClassMethodName(
+    BuiltinNames.REGEXP,
+    'test',
+);
+
+function getRegExpFuncName(name: string) {
+    return UtilFuncs.getFuncName(BuiltinNames.builtinModuleName, name);
+}
+
+/* the String method called with a RegExp argument */
+export function getStringRegExpFuncName(method: string) {
+    return getRegExpFuncName(
+        `String|${method}${BuiltinNames.stringRegExpFuncSuffix}`,
+    );
+}
+
+function getField(
+    module: binaryen.Module,
+    re: binaryen.ExpressionRef,
+    field: RegExpField,
+    typeRef: binaryen.Type,
+) {
+    return binaryenCAPI._BinaryenStructGet(
+        module.ptr,
+        field,
+        re,
+        typeRef,
+        false,
+    );
+}
+
+function setLastIndex(
+    module: binaryen.Module,
+    re: binaryen.ExpressionRef,
+    value: binaryen.ExpressionRef,
+) {
+    return binaryenCAPI._BinaryenStructSet(
+        module.ptr,
+        RegExpField.LAST_INDEX,
+        re,
+        value,
+    );
+}
+
+function getStringData(module: binaryen.Module, str: binaryen.ExpressionRef) {
+    return binaryenCAPI._BinaryenStructGet(
+        module.ptr,
+        1,
+        str,
+        i8ArrayTypeInfo.typeRef,
+        false,
+    );
+}
+
+function charAt(
+    module: binaryen.Module,
+    data: binaryen.ExpressionRef,
+    index: binaryen.ExpressionRef,
+) {
+    return binaryenCAPI._BinaryenArrayGet(
+        module.ptr,
+        data,
+        index,
+        i8ArrayTypeInfo.typeRef,
+        false,
+    );
+}
+
+/* caps[index] */
+function capture(
+    module: binaryen.Module,
+    caps: binaryen.ExpressionRef,
+    index: binaryen.ExpressionRef,
+) {
+    return binaryenCAPI._BinaryenArrayGet(
+        module.ptr,
+        caps,
+        index,
+        i32ArrayTypeInfo.typeRef,
+        false,
+    );
+}
+
+function newStringArray(
+    module: binaryen.Module,
+    length: binaryen.ExpressionRef,
+) {
+    return binaryenCAPI._BinaryenArrayNew(
+        module.ptr,
+        stringArrayTypeInfo.heapTypeRef,
+        length,
+        binaryenCAPI._BinaryenRefNull(module.ptr, stringTypeInfo.typeRef),
+    );
+}
+
+function newStringArrayStruct(
+    module: binaryen.Module,
+    arr: binaryen.ExpressionRef,
+    length: binaryen.ExpressionRef,
+) {
+    return binaryenCAPI._BinaryenStructNew(
+        module.ptr,
+        arrayToPtr([arr, length]).ptr,
+        2,
+        stringArrayStructTypeInfo.heapTypeRef,
+    );
+}
+
+function constString(module: binaryen.Module, str: string) {
+    return FunctionalFuncs.generateStringForStructArrayStr(module, str);
+}
+
+function callSubstring(
+    module: binaryen.Module,
+    data: binaryen.ExpressionRef,
+    start: binaryen.ExpressionRef,
+    end: binaryen.ExpressionRef,
+) {
+    return module.call(
+        getRegExpFuncName(substringFuncName),
+        [data, start, end],
+        stringTypeInfo.typeRef,
+    );
+}
+
+function callExecAt(
+    module: binaryen.Module,
+    re: binaryen.ExpressionRef,
+    data: binaryen.ExpressionRef,
+    start: binaryen.ExpressionRef,
+) {
+    return module.call(
+        getRegExpFuncName(execAtFuncName),
+        [re, data, start],
+        i32ArrayTypeInfo.typeRef,
+    );
+}
+
+/* the position after a match, an empty match moves one character */
+function nextIndex(module: binaryen.Module, caps: binaryen.ExpressionRef) {
+    const end = () => capture(module, caps, module.i32.const(1));
+    return module.i32.add(
+        end(),
+        module.i32.eq(capture(module, caps, module.i32.const(0)), end()),
+    );
+}
+
+/* lastIndex as a start position, ToLength clamps it to [0, 2^53 - 1] */
+function getStartIndex(module: binaryen.Module, re: binaryen.ExpressionRef) {
+    return module.i32.trunc_s_sat.f64(
+        module.f64.max(
+            getField(module, re, RegExpField.LAST_INDEX, binaryen.f64),
+            module.f64.const(0),
+        ),
+    );
+}
+
+function forLoop(
+    module: binaryen.Module,
+    label: string,
+    index_idx: number,
+    end: binaryen.ExpressionRef,
+    statements: binaryen.ExpressionRef,
+) {
+    const index = module.local.get(index_idx, binaryen.i32);
+    return module.block(null, [
+        module.local.set(index_idx, module.i32.const(0)),
+        module.loop(
+            label,
+            FunctionalFuncs.flattenLoopStatement(
+                module,
+                {
+                    label: label,
+                    condition: module.i32.lt_s(index, end),
+                    statements: statements,
+                    incrementor: module.local.set(
+                        index_idx,
+                        module.i32.add(index, module.i32.const(1)),
+                    ),
+                },
+                SemanticsKind.FOR,
+            ),
+        ),
+    ]);
+}
+
+/* loop while the condition holds, br to `label` continues and br to
+    `${label}_out` leaves */
+function whileLoop(
+    module: binaryen.Module,
+    label: string,
+    condition: binaryen.ExpressionRef,
+    statements: binaryen.ExpressionRef[],
+) {
+    return module.block(`${label}_out`, [
+        module.loop(
+            label,
+            module.if(
+                condition,
+                module.block(null, [...statements, module.br(label)]),
+            ),
+        ),
+    ]);
+}
+
+function addNativeImports(module: binaryen.Module) {
+    module.addFunctionImport(
+        BuiltinNames.regExpCompileFuncName,
+        BuiltinNames.externalModuleName,
+        BuiltinNames.regExpCompileFuncName,
+        binaryen.createType([binaryen.anyref, binaryen.anyref]),
+        binaryen.i32,
+    );
+    module.addFunctionImport(
+        BuiltinNames.regExpCompileDynamicFuncName,
+        BuiltinNames.externalModuleName,
+        BuiltinNames.regExpCompileDynamicFuncName,
+        binaryen.createType([binaryen.anyref, binaryen.anyref]),
+        binaryen.i32,
+    );
+    module.addFunctionImport(
+        BuiltinNames.regExpBindFuncName,
+        BuiltinNames.externalModuleName,
+        BuiltinNames.regExpBindFuncName,
+        binaryen.createType([binaryen.anyref, binaryen.i32]),
+        binaryen.none,
+    );
+    module.addFunctionImport(
+        BuiltinNames.regExpCaptureCountFuncName,
+        BuiltinNames.externalModuleName,
+        BuiltinNames.regExpCaptureCountFuncName,
+        binaryen.i32,
+        binaryen.i32,
+    );
+    module.addFunctionImport(
+        BuiltinNames.regExpGetFlagsFuncName,
+        BuiltinNames.externalModuleName,
+        BuiltinNames.regExpGetFlagsFuncName,
+        binaryen.i32,
+        binaryen.i32,
+    );
+    module.addFunctionImport(
+        BuiltinNames.regExpExecFuncName,
+        BuiltinNames.externalModuleName,
+        BuiltinNames.regExpExecFuncName,
+        binaryen.createType([
+            binaryen.i32,
+            binaryen.anyref,
+            binaryen.i32,
+            binaryen.anyref,
+        ]),
+        binaryen.i32,
+    );
+}
+
+/* data[start...end] as a new string */
+function regexp_substring(module: binaryen.Module) {
+    /* params */
+    const data_idx = 0;
+    const start_idx = 1;
+    const end_idx = 2;
+    /* vars */
+    const sub_idx = 3;
+
+    const start = module.local.get(start_idx, binaryen.i32);
+    const length = () =>
+        module.i32.sub(module.local.get(end_idx, binaryen.i32), start);
+    const sub = module.local.get(sub_idx, i8ArrayTypeInfo.typeRef);
+    return module.block(null, [
+        module.local.set(
+            sub_idx,
+            binaryenCAPI._BinaryenArrayNew(
+                module.ptr,
+                i8ArrayTypeInfo.heapTypeRef,
+                length(),
+                module.i32.const(0),
+            ),
+        ),
+        binaryenCAPI._BinaryenArrayCopy(
+            module.ptr,
+            sub,
+            module.i32.const(0),
+            module.local.get(data_idx, i8ArrayTypeInfo.typeRef),
+            start,
+            length(),
+        ),
+        module.return(
+            binaryenCAPI._BinaryenStructNew(
+                module.ptr,
+                arrayToPtr([module.i32.const(0), sub]).ptr,
+                2,
+                stringTypeInfo.heapTypeRef,
+            ),
+        ),
+    ]);
+}
+
+/* parts[length] = part, returns the array which is doubled when full */
+function regexp_append(module: binaryen.Module) {
+    /* params */
+    const parts_idx = 0;
+    const length_idx = 1;
+    const part_idx = 2;
+    /* vars */
+    const grown_idx = 3;
+
+    const parts = module.local.get(parts_idx, stringArrayTypeInfo.typeRef);
+    const length = module.local.get(length_idx, binaryen.i32);
+    const grown = module.local.get(grown_idx, stringArrayTypeInfo.typeRef);
+    return module.block(null, [
+        module.if(
+            module.i32.eq(
+                length,
+                binaryenCAPI._BinaryenArrayLen(module.ptr, parts),
+            ),
+            module.block(null, [
+                module.local.set(
+                    grown_idx,
+                    newStringArray(
+                        module,
+                        module.i32.shl(length, module.i32.const(1)),
+                    ),
+                ),
+                binaryenCAPI._BinaryenArrayCopy(
+                    module.ptr,
+                    grown,
+                    module.i32.const(0),
+                    parts,
+                    module.i32.const(0),
+                    length,
+                ),
+                module.local.set(parts_idx, grown),
+            ]),
+        ),
+        binaryenCAPI._BinaryenArraySet(
+            module.ptr,
+            parts,
+            length,
+            module.local.get(part_idx, stringTypeInfo.typeRef),
+        ),
+        module.return(parts),
+    ]);
+}
+
+/* match from start, returns the capture offsets or null */
+function regexp_exec_at(module: binaryen.Module) {
+    /* params */
+    const re_idx = 0;
+    const data_idx = 1;
+    const start_idx = 2;
+    /* vars */
+    const caps_idx = 3;
+
+    const re = module.local.get(re_idx, regExpTypeInfo.typeRef);
+    const caps = module.local.get(caps_idx, i32ArrayTypeInfo.typeRef);
+    return module.block(null, [
+        module.local.set(
+            caps_idx,
+            binaryenCAPI._BinaryenArrayNew(
+                module.ptr,
+                i32ArrayTypeInfo.heapTypeRef,
+                module.i32.shl(
+                    getField(
+                        module,
+                        re,
+                        RegExpField.CAPTURE_COUNT,
+                        binaryen.i32,
+                    ),
+                    module.i32.const(1),
+                ),
+                module.i32.const(-1),
+            ),
+        ),
+        module.if(
+            module.i32.eqz(
+                module.call(
+                    BuiltinNames.regExpExecFuncName,
+                    [
+                        getField(
+                            module,
+                            re,
+                            RegExpField.PATTERN_ID,
+                            binaryen.i32,
+                        ),
+                        module.local.get(data_idx, i8ArrayTypeInfo.typeRef),
+                        module.local.get(start_idx, binaryen.i32),
+                        caps,
+                    ],
+                    binaryen.i32,
+                ),
+            ),
+            module.return(
+                binaryenCAPI._BinaryenRefNull(
+                    module.ptr,
+                    i32ArrayTypeInfo.typeRef,
+                ),
+            ),
+        ),
+        module.return(caps),
+    ]);
+}
+
+/* RegExpBuiltinExec: a global or sticky RegExp starts at lastIndex and
+    updates it */
+function regexp_exec_internal(module: binaryen.Module) {
+    /* params */
+    const re_idx = 0;
+    const str_idx = 1;
+    /* vars */
+    const caps_idx = 2;
+    const update_idx = 3;
+
+    const re = module.local.get(re_idx, regExpTypeInfo.typeRef);
+    const caps = module.local.get(caps_idx, i32ArrayTypeInfo.typeRef);
+    const update = module.local.get(update_idx, binaryen.i32);
+    return module.block(null, [
+        module.local.set(
+            update_idx,
+            module.i32.or(
+                getField(module, re, RegExpField.GLOBAL, binaryen.i32),
+                getField(module, re, RegExpField.STICKY, binaryen.i32),
+            ),
+        ),
+        module.local.set(
+            caps_idx,
+            callExecAt(
+                module,
+                re,
+                getStringData(
+                    module,
+                    module.local.get(str_idx, stringTypeInfo.typeRef),
+                ),
+                module.select(
+                    update,
+                    getStartIndex(module, re),
+                    module.i32.const(0),
+                ),
+            ),
+        ),
+        module.if(
+            update,
+            module.if(
+                module.ref.is_null(caps),
+                setLastIndex(module, re, module.f64.const(0)),
+                setLastIndex(
+                    module,
+                    re,
+                    module.f64.convert_s.i32(
+                        capture(module, caps, module.i32.const(1)),
+                    ),
+                ),
+            ),
+        ),
+        module.return(caps),
+    ]);
+}
+
+/* the matched string followed by the captured groups */
+function regexp_groups(module: binaryen.Module) {
+    /* params */
+    const data_idx = 0;
+    const caps_idx = 1;
+    const count_idx = 2;
+    /* vars */
+    const arr_idx = 3;
+    const i_idx = 4;
+    const start_idx = 5;
+
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const caps = module.local.get(caps_idx, i32ArrayTypeInfo.typeRef);
+    const count = module.local.get(count_idx, binaryen.i32);
+    const arr = module.local.get(arr_idx, stringArrayTypeInfo.typeRef);
+    const i = module.local.get(i_idx, binaryen.i32);
+    const start = module.local.get(start_idx, binaryen.i32);
+    return module.block(null, [
+        module.local.set(arr_idx, newStringArray(module, count)),
+        forLoop(
+            module,
+            'groups_loop',
+            i_idx,
+            count,
+            module.block(null, [
+                module.local.set(
+                    start_idx,
+                    capture(
+                        module,
+                        caps,
+                        module.i32.shl(i, module.i32.const(1)),
+                    ),
+                ),
+                binaryenCAPI._BinaryenArraySet(
+                    module.ptr,
+                    arr,
+                    i,
+                    module.if(
+                        module.i32.lt_s(start, module.i32.const(0)),
+                        constString(module, ''),
+                        callSubstring(
+                            module,
+                            data,
+                            start,
+                            capture(
+                                module,
+                                caps,
+                                module.i32.add(
+                                    module.i32.shl(i, module.i32.const(1)),
+                                    module.i32.const(1),
+                                ),
+                            ),
+                        ),
+                    ),
+                ),
+            ]),
+        ),
+        module.return(newStringArrayStruct(module, arr, count)),
+    ]);
+}
+
+function regexp_create(module: binaryen.Module) {
+    /* params */
+    const source_idx = 0;
+    const flags_idx = 1;
+    const id_idx = 2;
+    /* vars */
+    const bits_idx = 3;
+
+    const id = module.local.get(id_idx, binaryen.i32);
+    const bits = module.local.get(bits_idx, binaryen.i32);
+    return module.block(null, [
+        module.local.set(
+            bits_idx,
+            module.call(
+                BuiltinNames.regExpGetFlagsFuncName,
+                [id],
+                binaryen.i32,
+            ),
+        ),
+        module.return(
+            binaryenCAPI._BinaryenStructNew(
+                module.ptr,
+                arrayToPtr([
+                    module.local.get(source_idx, stringTypeInfo.typeRef),
+                    module.local.get(flags_idx, stringTypeInfo.typeRef),
+                    module.i32.and(bits, module.i32.const(1)),
+                    module.i32.and(
+                        module.i32.shr_u(
+                            bits,
+                            module.i32.const(stickyFlagShift),
+                        ),
+                        module.i32.const(1),
+                    ),
+                    module.f64.const(0),
+                    id,
+                    module.call(
+                        BuiltinNames.regExpCaptureCountFuncName,
+                        [id],
+                        binaryen.i32,
+                    ),
+                ]).ptr,
+                7,
+                regExpTypeInfo.heapTypeRef,
+            ),
+        ),
+    ]);
+}
+
+/* the entry of a dynamic pattern is referred to by the new object and
+    released by its finalizer, see lib_regexp.c */
+function regexp_new(module: binaryen.Module) {
+    /* params */
+    const source_idx = 0;
+    const flags_idx = 1;
+    /* vars */
+    const id_idx = 2;
+    const re_idx = 3;
+
+    const source = module.local.get(source_idx, stringTypeInfo.typeRef);
+    const flags = module.local.get(flags_idx, stringTypeInfo.typeRef);
+    const id = module.local.get(id_idx, binaryen.i32);
+    const re = module.local.get(re_idx, regExpTypeInfo.typeRef);
+    return module.block(null, [
+        module.local.set(
+            id_idx,
+            module.call(
+                BuiltinNames.regExpCompileDynamicFuncName,
+                [getStringData(module, source), getStringData(module, flags)],
+                binaryen.i32,
+            ),
+        ),
+        module.local.set(
+            re_idx,
+            module.call(
+                getRegExpFuncName(BuiltinNames.regExpCreateFuncName),
+                [source, flags, id],
+                regExpTypeInfo.typeRef,
+            ),
+        ),
+        module.call(BuiltinNames.regExpBindFuncName, [re, id], binaryen.none),
+        module.return(re),
+    ]);
+}
+
+function regexp_exec(module: binaryen.Module) {
+    /* params */
+    const this_idx = 1;
+    const str_idx = 2;
+    /* vars */
+    const re_idx = 3;
+    const caps_idx = 4;
+
+    const re = module.local.get(re_idx, regExpTypeInfo.typeRef);
+    const str = module.local.get(str_idx, stringTypeInfo.typeRef);
+    const caps = module.local.get(caps_idx, i32ArrayTypeInfo.typeRef);
+    return module.block(null, [
+        module.local.set(
+            re_idx,
+            binaryenCAPI._BinaryenRefCast(
+                module.ptr,
+                module.local.get(this_idx, emptyStructType.typeRef),
+                regExpTypeInfo.typeRef,
+            ),
+        ),
+        module.local.set(
+            caps_idx,
+            module.call(
+                getRegExpFuncName(execFuncName),
+                [re, str],
+                i32ArrayTypeInfo.typeRef,
+            ),
+        ),
+        module.if(
+            module.ref.is_null(caps),
+            module.return(
+                binaryenCAPI._BinaryenRefNull(
+                    module.ptr,
+                    stringArrayStructTypeInfo.typeRef,
+                ),
+            ),
+        ),
+        module.return(
+            module.call(
+                getRegExpFuncName(groupsFuncName),
+                [
+                    getStringData(module, str),
+                    caps,
+                    getField(
+                        module,
+                        re,
+                        RegExpField.CAPTURE_COUNT,
+                        binaryen.i32,
+                    ),
+                ],
+                stringArrayStructTypeInfo.typeRef,
+            ),
+        ),
+    ]);
+}
+
+function regexp_test(module: binaryen.Module) {
+    /* params */
+    const this_idx = 1;
+    const str_idx = 2;
+
+    return module.return(
+        module.i32.eqz(
+            module.ref.is_null(
+                module.call(
+                    getRegExpFuncName(execFuncName),
+                    [
+                        binaryenCAPI._BinaryenRefCast(
+                            module.ptr,
+                            module.local.get(this_idx, emptyStructType.typeRef),
+                            regExpTypeInfo.typeRef,
+                        ),
+                        module.local.get(str_idx, stringTypeInfo.typeRef),
+                    ],
+                    i32ArrayTypeInfo.typeRef,
+                ),
+            ),
+        ),
+    );
+}
+
+/* a non-global RegExp gives the result of exec, a global one gives every
+    matched string, null if nothing matched */
+function string_match_regexp(module: binaryen.Module) {
+    /* params */
+    const str_idx = 1;
+    const re_idx = 2;
+    /* vars */
+    const data_idx = 3;
+    const caps_idx = 4;
+    const arr_idx = 5;
+    const length_idx = 6;
+    const pos_idx = 7;
+
+    const str = module.local.get(str_idx, stringTypeInfo.typeRef);
+    const re = module.local.get(re_idx, regExpTypeInfo.typeRef);
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const caps = module.local.get(caps_idx, i32ArrayTypeInfo.typeRef);
+    const arr = module.local.get(arr_idx, stringArrayTypeInfo.typeRef);
+    const length = module.local.get(length_idx, binaryen.i32);
+    const pos = module.local.get(pos_idx, binaryen.i32);
+    return module.block(null, [
+        module.if(
+            module.i32.eqz(
+                getField(module, re, RegExpField.GLOBAL, binaryen.i32),
+            ),
+            module.return(
+                module.call(
+                    execMethodName,
+                    [
+                        binaryenCAPI._BinaryenRefNull(
+                            module.ptr,
+                            emptyStructType.typeRef,
+                        ),
+                        re,
+                        str,
+                    ],
+                    stringArrayStructTypeInfo.typeRef,
+                ),
+            ),
+        ),
+        module.local.set(data_idx, getStringData(module, str)),
+        module.local.set(arr_idx, newStringArray(module, module.i32.const(4))),
+        module.local.set(length_idx, module.i32.const(0)),
+        module.local.set(pos_idx, module.i32.const(0)),
+        whileLoop(module, 'match_loop', module.i32.const(1), [
+            module.local.set(caps_idx, callExecAt(module, re, data, pos)),
+            module.br('match_loop_out', module.ref.is_null(caps)),
+            module.local.set(
+                arr_idx,
+                module.call(
+                    getRegExpFuncName(appendFuncName),
+                    [
+                        arr,
+                        length,
+                        callSubstring(
+                            module,
+                            data,
+                            capture(module, caps, module.i32.const(0)),
+                            capture(module, caps, module.i32.const(1)),
+                        ),
+                    ],
+                    stringArrayTypeInfo.typeRef,
+                ),
+            ),
+            module.local.set(
+                length_idx,
+                module.i32.add(length, module.i32.const(1)),
+            ),
+            module.local.set(pos_idx, nextIndex(module, caps)),
+        ]),
+        setLastIndex(module, re, module.f64.const(0)),
+        module.if(
+            module.i32.eqz(length),
+            module.return(
+                binaryenCAPI._BinaryenRefNull(
+                    module.ptr,
+                    stringArrayStructTypeInfo.typeRef,
+                ),
+            ),
+        ),
+        module.return(newStringArrayStruct(module, arr, length)),
+    ]);
+}
+
+/* search ignores lastIndex and keeps it unchanged */
+function string_search_regexp(module: binaryen.Module) {
+    /* params */
+    const str_idx = 1;
+    const re_idx = 2;
+    /* vars */
+    const caps_idx = 3;
+
+    const caps = module.local.get(caps_idx, i32ArrayTypeInfo.typeRef);
+    return module.block(null, [
+        module.local.set(
+            caps_idx,
+            callExecAt(
+                module,
+                module.local.get(re_idx, regExpTypeInfo.typeRef),
+                getStringData(
+                    module,
+                    module.local.get(str_idx, stringTypeInfo.typeRef),
+                ),
+                module.i32.const(0),
+            ),
+        ),
+        module.if(
+            module.ref.is_null(caps),
+            module.return(module.f64.const(-1)),
+        ),
+        module.return(
+            module.f64.convert_s.i32(
+                capture(module, caps, module.i32.const(0)),
+            ),
+        ),
+    ]);
+}
+
+/* replace the first match, or every match of a global RegExp, the
+    replacement may refer to the match by $$, $&, $`, $' and $n / $nn */
+function string_replace_regexp(module: binaryen.Module) {
+    /* params */
+    const str_idx = 1;
+    const re_idx = 2;
+    const repl_idx = 3;
+    /* vars */
+    const data_idx = 4;
+    const length_idx = 5;
+    const rdata_idx = 6;
+    const rlength_idx = 7;
+    const caps_idx = 8;
+    const count_idx = 9;
+    const parts_idx = 10;
+    const n_idx = 11;
+    const pos_idx = 12;
+    const last_idx = 13;
+    const i_idx = 14;
+    const lit_idx = 15;
+    const c_idx = 16;
+    const group_idx = 17;
+    const d_idx = 18;
+    const start_idx = 19;
+    const end_idx = 20;
+    const global_idx = 21;
+
+    const str = module.local.get(str_idx, stringTypeInfo.typeRef);
+    const re = module.local.get(re_idx, regExpTypeInfo.typeRef);
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const length = module.local.get(length_idx, binaryen.i32);
+    const rdata = module.local.get(rdata_idx, i8ArrayTypeInfo.typeRef);
+    const rlength = module.local.get(rlength_idx, binaryen.i32);
+    const caps = module.local.get(caps_idx, i32ArrayTypeInfo.typeRef);
+    const count = module.local.get(count_idx, binaryen.i32);
+    const parts = module.local.get(parts_idx, stringArrayTypeInfo.typeRef);
+    const n = module.local.get(n_idx, binaryen.i32);
+    const pos = module.local.get(pos_idx, binaryen.i32);
+    const last = module.local.get(last_idx, binaryen.i32);
+    const i = module.local.get(i_idx, binaryen.i32);
+    const lit = module.local.get(lit_idx, binaryen.i32);
+    const c = module.local.get(c_idx, binaryen.i32);
+    const group = module.local.get(group_idx, binaryen.i32);
+    const d = module.local.get(d_idx, binaryen.i32);
+    const start = module.local.get(start_idx, binaryen.i32);
+    const end = module.local.get(end_idx, binaryen.i32);
+    const global = module.local.get(global_idx, binaryen.i32);
+
+    const pushSlice = (
+        src: binaryen.ExpressionRef,
+        from: binaryen.ExpressionRef,
+        to: binaryen.ExpressionRef,
+    ) =>
+        module.block(null, [
+            module.local.set(
+                parts_idx,
+                module.call(
+                    getRegExpFuncName(appendFuncName),
+                    [parts, n, callSubstring(module, src, from, to)],
+                    stringArrayTypeInfo.typeRef,
+                ),
+            ),
+            module.local.set(n_idx, module.i32.add(n, module.i32.const(1))),
+        ]);
+    /* the replacement text before $ and the substitution, then continue
+        after the substitution of `size` characters */
+    const substitute = (
+        size: binaryen.ExpressionRef,
+        from: binaryen.ExpressionRef,
+        to: binaryen.ExpressionRef,
+    ) =>
+        module.block(null, [
+            pushSlice(rdata, lit, i),
+            pushSlice(data, from, to),
+            module.local.set(i_idx, module.i32.add(i, size)),
+            module.local.set(lit_idx, i),
+            module.br('expand_loop'),
+        ]);
+    const isChar = (code: number) => module.i32.eq(c, module.i32.const(code));
+    const isDigit = (value: binaryen.ExpressionRef) =>
+        module.i32.lt_u(value, module.i32.const(10));
+    const isGroup = (value: binaryen.ExpressionRef) =>
+        module.i32.and(
+            module.i32.ge_s(value, module.i32.const(1)),
+            module.i32.lt_s(value, count),
+        );
+
+    const expand = module.block(null, [
+        module.local.set(lit_idx, module.i32.const(0)),
+        module.local.set(i_idx, module.i32.const(0)),
+        whileLoop(module, 'expand_loop', module.i32.lt_s(i, rlength), [
+            module.if(
+                module.i32.and(
+                    module.i32.eq(
+                        charAt(module, rdata, i),
+                        module.i32.const(Char.DOLLAR),
+                    ),
+                    module.i32.lt_s(
+                        module.i32.add(i, module.i32.const(1)),
+                        rlength,
+                    ),
+                ),
+                module.block(null, [
+                    module.local.set(
+                        c_idx,
+                        charAt(
+                            module,
+                            rdata,
+                            module.i32.add(i, module.i32.const(1)),
+                        ),
+                    ),
+                    /* $$ keeps one $ */
+                    module.if(
+                        isChar(Char.DOLLAR),
+                        module.block(null, [
+                            pushSlice(
+                                rdata,
+                                lit,
+                                module.i32.add(i, module.i32.const(1)),
+                            ),
+                            module.local.set(
+                                i_idx,
+                                module.i32.add(i, module.i32.const(2)),
+                            ),
+                            module.local.set(lit_idx, i),
+                            module.br('expand_loop'),
+                        ]),
+                    ),
+                    module.if(
+                        isChar(Char.AMPERSAND),
+                        substitute(module.i32.const(2), start, end),
+                    ),
+                    module.if(
+                        isChar(Char.BACKQUOTE),
+                        substitute(
+                            module.i32.const(2),
+                            module.i32.const(0),
+                            start,
+                        ),
+                    ),
+                    module.if(
+                        isChar(Char.QUOTE),
+                        substitute(module.i32.const(2), end, length),
+                    ),
+                    /* $nn if it is a group, otherwise $n */
+                    module.local.set(
+                        group_idx,
+                        module.i32.sub(c, module.i32.const(Char.ZERO)),
+                    ),
+                    module.if(
+                        isDigit(group),
+                        module.block(null, [
+                            module.local.set(c_idx, module.i32.const(2)),
+                            module.if(
+                                module.i32.lt_s(
+                                    module.i32.add(i, module.i32.const(2)),
+                                    rlength,
+                                ),
+                                module.block(null, [
+                                    module.local.set(
+                                        d_idx,
+                                        module.i32.sub(
+                                            charAt(
+                                                module,
+                                                rdata,
+                                                module.i32.add(
+                                                    i,
+                                                    module.i32.const(2),
+                                                ),
+                                            ),
+                                            module.i32.const(Char.ZERO),
+                                        ),
+                                    ),
+                                    module.if(
+                                        isDigit(d),
+                                        module.local.set(
+                                            d_idx,
+                                            module.i32.add(
+                                                module.i32.mul(
+                                                    group,
+                                                    module.i32.const(10),
+                                                ),
+                                                d,
+                                            ),
+                                        ),
+                                        module.local.set(
+                                            d_idx,
+                                            module.i32.const(0),
+                                        ),
+                                    ),
+                                    module.if(
+                                        isGroup(d),
+                                        module.block(null, [
+                                            module.local.set(group_idx, d),
+                                            module.local.set(
+                                                c_idx,
+                                                module.i32.const(3),
+                                            ),
+                                        ]),
+                                    ),
+                                ]),
+                            ),
+                            module.if(
+                                isGroup(group),
+                                module.block(null, [
+                                    module.local.set(
+                                        d_idx,
+                                        capture(
+                                            module,
+                                            caps,
+                                            module.i32.shl(
+                                                group,
+                                                module.i32.const(1),
+                                            ),
+                                        ),
+                                    ),
+                                    /* an unmatched group is empty */
+                                    module.if(
+                                        module.i32.lt_s(d, module.i32.const(0)),
+                                        substitute(c, start, start),
+                                        substitute(
+                                            c,
+                                            d,
+                                            capture(
+                                                module,
+                                                caps,
+                                                module.i32.add(
+                                                    module.i32.shl(
+                                                        group,
+                                                        module.i32.const(1),
+                                                    ),
+                                                    module.i32.const(1),
+                                                ),
+                                            ),
+                                        ),
+                                    ),
+                                ]),
+                            ),
+                        ]),
+                    ),
+                ]),
+            ),
+            module.local.set(i_idx, module.i32.add(i, module.i32.const(1))),
+        ]),
+        pushSlice(rdata, lit, rlength),
+    ]);
+
+    return module.block(null, [
+        module.local.set(data_idx, getStringData(module, str)),
+        module.local.set(
+            length_idx,
+            binaryenCAPI._BinaryenArrayLen(module.ptr, data),
+        ),
+        module.local.set(
+            rdata_idx,
+            getStringData(
+                module,
+                module.local.get(repl_idx, stringTypeInfo.typeRef),
+            ),
+        ),
+        module.local.set(
+            rlength_idx,
+            binaryenCAPI._BinaryenArrayLen(module.ptr, rdata),
+        ),
+        module.local.set(
+            count_idx,
+            getField(module, re, RegExpField.CAPTURE_COUNT, binaryen.i32),
+        ),
+        module.local.set(
+            global_idx,
+            getField(module, re, RegExpField.GLOBAL, binaryen.i32),
+        ),
+        module.local.set(
+            parts_idx,
+            newStringArray(module, module.i32.const(8)),
+        ),
+        module.local.set(n_idx, module.i32.const(0)),
+        module.local.set(pos_idx, module.i32.const(0)),
+        module.local.set(last_idx, module.i32.const(0)),
+        module.if(global, setLastIndex(module, re, module.f64.const(0))),
+        whileLoop(module, 'replace_loop', module.i32.const(1), [
+            module.local.set(
+                caps_idx,
+                module.if(
+                    global,
+                    callExecAt(module, re, data, pos),
+                    module.call(
+                        getRegExpFuncName(execFuncName),
+                        [re, str],
+                        i32ArrayTypeInfo.typeRef,
+                    ),
+                ),
+            ),
+            module.br('replace_loop_out', module.ref.is_null(caps)),
+            module.local.set(
+                start_idx,
+                capture(module, caps, module.i32.const(0)),
+            ),
+            module.local.set(
+                end_idx,
+                capture(module, caps, module.i32.const(1)),
+            ),
+            pushSlice(data, last, start),
+            expand,
+            module.local.set(last_idx, end),
+            module.br('replace_loop_out', module.i32.eqz(global)),
+            module.local.set(pos_idx, nextIndex(module, caps)),
+        ]),
+        module.if(module.i32.eqz(n), module.return(str)),
+        pushSlice(data, last, length),
+        module.return(
+            module.call(
+                getRegExpFuncName(BuiltinNames.stringConcatFuncName),
+                [
+                    binaryenCAPI._BinaryenRefNull(
+                        module.ptr,
+                        emptyStructType.typeRef,
+                    ),
+                    constString(module, ''),
+                    newStringArrayStruct(module, parts, n),
+                ],
+                stringTypeInfo.typeRef,
+            ),
+        ),
+    ]);
+}
+
+/* the pieces between the matches, each followed by the captured groups */
+function string_split_regexp(module: binaryen.Module) {
+    /* params */
+    const str_idx = 1;
+    const re_idx = 2;
+    /* vars */
+    const data_idx = 3;
+    const size_idx = 4;
+    const caps_idx = 5;
+    const arr_idx = 6;
+    const n_idx = 7;
+    const p_idx = 8;
+    const q_idx = 9;
+    const count_idx = 10;
+    const i_idx = 11;
+    const start_idx = 12;
+    const sticky_idx = 13;
+
+    const str = module.local.get(str_idx, stringTypeInfo.typeRef);
+    const re = module.local.get(re_idx, regExpTypeInfo.typeRef);
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const size = module.local.get(size_idx, binaryen.i32);
+    const caps = module.local.get(caps_idx, i32ArrayTypeInfo.typeRef);
+    const arr = module.local.get(arr_idx, stringArrayTypeInfo.typeRef);
+    const n = module.local.get(n_idx, binaryen.i32);
+    const p = module.local.get(p_idx, binaryen.i32);
+    const q = module.local.get(q_idx, binaryen.i32);
+    const count = module.local.get(count_idx, binaryen.i32);
+    const i = module.local.get(i_idx, binaryen.i32);
+    const start = module.local.get(start_idx, binaryen.i32);
+    const sticky = module.local.get(sticky_idx, binaryen.i32);
+    const push = (part: binaryen.ExpressionRef) =>
+        module.block(null, [
+            module.local.set(
+                arr_idx,
+                module.call(
+                    getRegExpFuncName(appendFuncName),
+                    [arr, n, part],
+                    stringArrayTypeInfo.typeRef,
+                ),
+            ),
+            module.local.set(n_idx, module.i32.add(n, module.i32.const(1))),
+        ]);
+    /* the groups of caps are 1...count - 1 */
+    const groupIndex = () =>
+        module.i32.shl(
+            module.i32.add(i, module.i32.const(1)),
+            module.i32.const(1),
+        );
+
+    return module.block(null, [
+        module.local.set(data_idx, getStringData(module, str)),
+        module.local.set(
+            size_idx,
+            binaryenCAPI._BinaryenArrayLen(module.ptr, data),
+        ),
+        module.local.set(arr_idx, newStringArray(module, module.i32.const(4))),
+        module.local.set(n_idx, module.i32.const(0)),
+        /* an empty string is split only if the RegExp can't match it */
+        module.if(
+            module.i32.eqz(size),
+            module.block(null, [
+                module.if(
+                    module.ref.is_null(
+                        callExecAt(module, re, data, module.i32.const(0)),
+                    ),
+                    push(str),
+                ),
+                module.return(newStringArrayStruct(module, arr, n)),
+            ]),
+        ),
+        module.local.set(
+            count_idx,
+            getField(module, re, RegExpField.CAPTURE_COUNT, binaryen.i32),
+        ),
+        module.local.set(
+            sticky_idx,
+            getField(module, re, RegExpField.STICKY, binaryen.i32),
+        ),
+        module.local.set(p_idx, module.i32.const(0)),
+        module.local.set(q_idx, module.i32.const(0)),
+        whileLoop(module, 'split_loop', module.i32.lt_s(q, size), [
+            module.local.set(caps_idx, callExecAt(module, re, data, q)),
+            /* the splitter of the spec is sticky, searching forward finds
+                the same match, a sticky RegExp retries at the next index */
+            module.if(
+                module.ref.is_null(caps),
+                module.block(null, [
+                    module.br('split_loop_out', module.i32.eqz(sticky)),
+                    module.local.set(
+                        q_idx,
+                        module.i32.add(q, module.i32.const(1)),
+                    ),
+                    module.br('split_loop'),
+                ]),
+            ),
+            module.local.set(
+                start_idx,
+                capture(module, caps, module.i32.const(0)),
+            ),
+            module.br('split_loop_out', module.i32.ge_s(start, size)),
+            /* an empty match at the end of the last piece */
+            module.if(
+                module.i32.eq(capture(module, caps, module.i32.const(1)), p),
+                module.block(null, [
+                    module.local.set(
+                        q_idx,
+                        module.i32.add(start, module.i32.const(1)),
+                    ),
+                    module.br('split_loop'),
+                ]),
+            ),
+            push(callSubstring(module, data, p, start)),
+            forLoop(
+                module,
+                'split_groups_loop',
+                i_idx,
+                module.i32.sub(count, module.i32.const(1)),
+                module.if(
+                    module.i32.lt_s(
+                        capture(module, caps, groupIndex()),
+                        module.i32.const(0),
+                    ),
+                    push(constString(module, '')),
+                    push(
+                        callSubstring(
+                            module,
+                            data,
+                            capture(module, caps, groupIndex()),
+                            capture(
+                                module,
+                                caps,
+                                module.i32.add(
+                                    groupIndex(),
+                                    module.i32.const(1),
+                                ),
+                            ),
+                        ),
+                    ),
+                ),
+            ),
+            module.local.set(p_idx, capture(module, caps, module.i32.const(1))),
+            module.local.set(q_idx, p),
+        ]),
+        push(callSubstring(module, data, p, size)),
+        module.return(newStringArrayStruct(module, arr, n)),
+    ]);
+}
+
+/* add the RegExp natives and functions, called when a module uses RegExp */
+export function addRegExpFunctions(module: binaryen.Module) {
+    if (module.getFunction(getRegExpFuncName(substringFuncName))) {
+        return;
+    }
+    addNativeImports(module);
+    const envParams = [emptyStructType.typeRef, emptyStructType.typeRef];
+    module.addFunction(
+        getRegExpFuncName(substringFuncName),
+        binaryen.createType([
+            i8ArrayTypeInfo.typeRef,
+            binaryen.i32,
+            binaryen.i32,
+        ]),
+        stringTypeInfo.typeRef,
+        [i8ArrayTypeInfo.typeRef],
+        regexp_substring(module),
+    );
+    module.addFunction(
+        getRegExpFuncName(appendFuncName),
+        binaryen.createType([
+            stringArrayTypeInfo.typeRef,
+            binaryen.i32,
+            stringTypeInfo.typeRef,
+        ]),
+        stringArrayTypeInfo.typeRef,
+        [stringArrayTypeInfo.typeRef],
+        regexp_append(module),
+    );
+    module.addFunction(
+        getRegExpFuncName(execAtFuncName),
+        binaryen.createType([
+            regExpTypeInfo.typeRef,
+            i8ArrayTypeInfo.typeRef,
+            binaryen.i32,
+        ]),
+        i32ArrayTypeInfo.typeRef,
+        [i32ArrayTypeInfo.typeRef],
+        regexp_exec_at(module),
+    );
+    module.addFunction(
+        getRegExpFuncName(execFuncName),
+        binaryen.createType([regExpTypeInfo.typeRef, stringTypeInfo.typeRef]),
+        i32ArrayTypeInfo.typeRef,
+        [i32ArrayTypeInfo.typeRef, binaryen.i32],
+        regexp_exec_internal(module),
+    );
+    module.addFunction(
+        getRegExpFuncName(groupsFuncName),
+        binaryen.createType([
+            i8ArrayTypeInfo.typeRef,
+            i32ArrayTypeInfo.typeRef,
+            binaryen.i32,
+        ]),
+        stringArrayStructTypeInfo.typeRef,
+        [stringArrayTypeInfo.typeRef, binaryen.i32, binaryen.i32],
+        regexp_groups(module),
+    );
+    module.addFunction(
+        getRegExpFuncName(BuiltinNames.regExpCreateFuncName),
+        binaryen.createType([
+            stringTypeInfo.typeRef,
+            stringTypeInfo.typeRef,
+            binaryen.i32,
+        ]),
+        regExpTypeInfo.typeRef,
+        [binaryen.i32],
+        regexp_create(module),
+    );
+    module.addFunction(
+        getRegExpFuncName(BuiltinNames.regExpNewFuncName),
+        binaryen.createType([stringTypeInfo.typeRef, stringTypeInfo.typeRef]),
+        regExpTypeInfo.typeRef,
+        [binaryen.i32, regExpTypeInfo.typeRef],
+        regexp_new(module),
+    );
+    module.addFunction(
+        execMethodName,
+        binaryen.createType([...envParams, stringTypeInfo.typeRef]),
+        stringArrayStructTypeInfo.typeRef,
+        [regExpTypeInfo.typeRef, i32ArrayTypeInfo.typeRef],
+        regexp_exec(module),
+    );
+    module.addFunction(
+        testMethodName,
+        binaryen.createType([...envParams, stringTypeInfo.typeRef]),
+        binaryen.i32,
+        [],
+        regexp_test(module),
+    );
+
+    const stringParams = [
+        emptyStructType.typeRef,
+        stringTypeInfo.typeRef,
+        regExpTypeInfo.typeRef,
+    ];
+    module.addFunction(
+        getStringRegExpFuncName('match'),
+        binaryen.createType(stringParams),
+        stringArrayStructTypeInfo.typeRef,
+        [
+            i8ArrayTypeInfo.typeRef,
+            i32ArrayTypeInfo.typeRef,
+            stringArrayTypeInfo.typeRef,
+            binaryen.i32,
+            binaryen.i32,
+        ],
+        string_match_regexp(module),
+    );
+    module.addFunction(
+        getStringRegExpFuncName('search'),
+        binaryen.createType(stringParams),
+        binaryen.f64,
+        [i32ArrayTypeInfo.typeRef],
+        string_search_regexp(module),
+    );
+    module.addFunction(
+        getStringRegExpFuncName('replace'),
+        binaryen.createType([...stringParams, stringTypeInfo.typeRef]),
+        stringTypeInfo.typeRef,
+        [
+            i8ArrayTypeInfo.typeRef,
+            binaryen.i32,
+            i8ArrayTypeInfo.typeRef,
+            binaryen.i32,
+            i32ArrayTypeInfo.typeRef,
+            binaryen.i32,
+            stringArrayTypeInfo.typeRef,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+        ],
+        string_replace_regexp(module),
+    );
+    module.addFunction(
+        getStringRegExpFuncName('split'),
+        binaryen.createType(stringParams),
+        stringArrayStructTypeInfo.typeRef,
+        [
+            i8ArrayTypeInfo.typeRef,
+            binaryen.i32,
+            i32ArrayTypeInfo.typeRef,
+            stringArrayTypeInfo.typeRef,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+            binaryen.i32,
+        ],
+        string_split_regexp(module),
+    );
+}
+
+/* `new RegExp(source, flags)` with a literal pattern, the id of the
+    compiled pattern is kept in the global `globalName` */
+export function newRegExpLiteral(
+    module: binaryen.Module,
+    globalName: string,
+    source: string,
+    flags: string,
+) {
+    addRegExpFunctions(module);
+    if (!module.getGlobal(globalName)) {
+        module.addGlobal(globalName, binaryen.i32, true, module.i32.const(-1));
+    }
+    const id = module.global.get(globalName, binaryen.i32);
+    return module.block(
+        null,
+        [
+            module.if(
+                module.i32.eq(id, module.i32.const(-1)),
+                module.global.set(
+                    globalName,
+                    module.call(
+                        BuiltinNames.regExpCompileFuncName,
+                        [
+                            getStringData(module, constString(module, source)),
+                            getStringData(module, constString(module, flags)),
+                        ],
+                        binaryen.i32,
+                    ),
+                ),
+            ),
+            module.call(
+                getRegExpFuncName(BuiltinNames.regExpCreateFuncName),
+                [
+                    constString(module, source),
+                    constString(module, flags),
+                    module.global.get(globalName, binaryen.i32),
+                ],
+                regExpTypeInfo.typeRef,
+            ),
+        ],
+        regExpTypeInfo.typeRef,
+    );
+}
+
+/* `new RegExp(source, flags)` with computed strings */
+export function newRegExp(
+    module: binaryen.Module,
+    source: binaryen.ExpressionRef,
+    flags: binaryen.ExpressionRef,
+) {
+    addRegExpFunctions(module);
+    return module.call(
+        getRegExpFuncName(BuiltinNames.regExpNewFuncName),
+        [source, flags],
+        regExpTypeInfo.typeRef,
+    );
+}
+
+/* str.matchAll(re) collects the groups of every match, the RegExp must be
+    global and its lastIndex is left unchanged */
+export function getStringMatchAllFuncName(
+    module: binaryen.Module,
+    info: MatchAllTypeInfo,
+) {
+    const funcName = getRegExpFuncName(BuiltinNames.stringMatchAllFuncName);
+    if (module.getFunction(funcName)) {
+        return funcName;
+    }
+    addRegExpFunctions(module);
+
+    /* params */
+    const str_idx = 1;
+    const re_idx = 2;
+    /* vars */
+    const data_idx = 3;
+    const caps_idx = 4;
+    const arr_idx = 5;
+    const length_idx = 6;
+    const pos_idx = 7;
+    const grown_idx = 8;
+
+    const re = module.local.get(re_idx, regExpTypeInfo.typeRef);
+    const data = module.local.get(data_idx, i8ArrayTypeInfo.typeRef);
+    const caps = module.local.get(caps_idx, i32ArrayTypeInfo.typeRef);
+    const arr = module.local.get(arr_idx, info.arrayTypeRef);
+    const length = module.local.get(length_idx, binaryen.i32);
+    const pos = module.local.get(pos_idx, binaryen.i32);
+    const grown = module.local.get(grown_idx, info.arrayTypeRef);
+    const newArray = (size: binaryen.ExpressionRef) =>
+        binaryenCAPI._BinaryenArrayNew(
+            module.ptr,
+            info.arrayHeapTypeRef,
+            size,
+            binaryenCAPI._BinaryenRefNull(
+                module.ptr,
+                stringArrayStructTypeInfo.typeRef,
+            ),
+        );
+
+    module.addFunction(
+        funcName,
+        binaryen.createType([
+            emptyStructType.typeRef,
+            stringTypeInfo.typeRef,
+            regExpTypeInfo.typeRef,
+        ]),
+        info.structTypeRef,
+        [
+            i8ArrayTypeInfo.typeRef,
+            i32ArrayTypeInfo.typeRef,
+            info.arrayTypeRef,
+            binaryen.i32,
+            binaryen.i32,
+            info.arrayTypeRef,
+        ],
+        module.block(null, [
+            /* TypeError of a non-global RegExp */
+            module.if(
+                module.i32.eqz(
+                    getField(module, re, RegExpField.GLOBAL, binaryen.i32),
+                ),
+                module.unreachable(),
+            ),
+            module.local.set(
+                data_idx,
+                getStringData(
+                    module,
+                    module.local.get(str_idx, stringTypeInfo.typeRef),
+                ),
+            ),
+            module.local.set(arr_idx, newArray(module.i32.const(4))),
+            module.local.set(length_idx, module.i32.const(0)),
+            module.local.set(pos_idx, getStartIndex(module, re)),
+            whileLoop(module, 'match_all_loop', module.i32.const(1), [
+                module.local.set(caps_idx, callExecAt(module, re, data, pos)),
+                module.br('match_all_loop_out', module.ref.is_null(caps)),
+                module.if(
+                    module.i32.eq(
+                        length,
+                        binaryenCAPI._BinaryenArrayLen(module.ptr, arr),
+                    ),
+                    module.block(null, [
+                        module.local.set(
+                            grown_idx,
+                            newArray(
+                                module.i32.shl(length, module.i32.const(1)),
+                            ),
+                        ),
+                        binaryenCAPI._BinaryenArrayCopy(
+                            module.ptr,
+                            grown,
+                            module.i32.const(0),
+                            arr,
+                            module.i32.const(0),
+                            length,
+                        ),
+                        module.local.set(arr_idx, grown),
+                    ]),
+                ),
+                binaryenCAPI._BinaryenArraySet(
+                    module.ptr,
+                    arr,
+                    length,
+                    module.call(
+                        getRegExpFuncName(groupsFuncName),
+                        [
+                            data,
+                            caps,
+                            getField(
+                                module,
+                                re,
+                                RegExpField.CAPTURE_COUNT,
+                                binaryen.i32,
+                            ),
+                        ],
+                        stringArrayStructTypeInfo.typeRef,
+                    ),
+                ),
+                module.local.set(
+                    length_idx,
+                    module.i32.add(length, module.i32.const(1)),
+                ),
+                module.local.set(pos_idx, nextIndex(module, caps)),
+            ]),
+            module.return(
+                binaryenCAPI._BinaryenStructNew(
+                    module.ptr,
+                    arrayToPtr([arr, length]).ptr,
+                    2,
+                    info.structHeapTypeRef,
+                ),
+            ),
+        ]),
+    );
+    return funcName;
+}
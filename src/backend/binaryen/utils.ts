@@ -40,7 +40,19 @@ import {
     stringrefArrayStructTypeInfo,
     arrayBufferTypeInfo,
     anyArrayTypeInfo,
+    numberArrayTypeInfo,
+    f32ArrayTypeInfo,
+    i32ArrayTypeInfo,
+    i16ArrayTypeInfo,
+    float64ArrayTypeInfo,
+    float32ArrayTypeInfo,
+    int32ArrayTypeInfo,
+    uint32ArrayTypeInfo,
+    int16ArrayTypeInfo,
+    uint8ArrayTypeInfo,
+    uint8ClampedArrayTypeInfo,
 } from './glue/packType.js';
+import { typeInfo } from './glue/utils.js';
 import {
     PredefinedTypeId,
     SourceLocation,
@@ -111,7 +123,10 @@ export const enum VtableFieldIndex {
 
 export const SIZE_OF_META_FIELD = 12;
 
+/* The word before the meta holds the offset of the mangled class name,
+    read by the runtime for diagnostics only */
 export const enum MetaDataOffset {
+    NAME_OFFSET = -4,
     TYPE_ID_OFFSET = 0,
     IMPL_ID_OFFSET = 4,
     COUNT_OFFSET = 8,
@@ -2309,6 +2324,204 @@ export namespace FunctionalFuncs {
         );
     }
 
+    /* Typed arrays are struct(array(elem), length, byteOffset), views
+        created by subarray share the backing array with their source, every
+        kind has its own struct type */
+    export function getTypedArrayTypeInfo(name: string): typeInfo {
+        switch (name) {
+            case BuiltinNames.FLOAT64ARRAY:
+                return float64ArrayTypeInfo;
+            case BuiltinNames.FLOAT32ARRAY:
+                return float32ArrayTypeInfo;
+            case BuiltinNames.INT32ARRAY:
+                return int32ArrayTypeInfo;
+            case BuiltinNames.UINT32ARRAY:
+                return uint32ArrayTypeInfo;
+            case BuiltinNames.INT16ARRAY:
+                return int16ArrayTypeInfo;
+            case BuiltinNames.UINT8ARRAY:
+                return uint8ArrayTypeInfo;
+            case BuiltinNames.UINT8CLAMPEDARRAY:
+                return uint8ClampedArrayTypeInfo;
+            default:
+                throw new UnimplementError(`${name} is not a typed array`);
+        }
+    }
+
+    export function getTypedArrayBackingTypeInfo(name: string): typeInfo {
+        switch (name) {
+            case BuiltinNames.FLOAT64ARRAY:
+                return numberArrayTypeInfo;
+            case BuiltinNames.FLOAT32ARRAY:
+                return f32ArrayTypeInfo;
+            case BuiltinNames.INT32ARRAY:
+            case BuiltinNames.UINT32ARRAY:
+                return i32ArrayTypeInfo;
+            case BuiltinNames.INT16ARRAY:
+                return i16ArrayTypeInfo;
+            case BuiltinNames.UINT8ARRAY:
+            case BuiltinNames.UINT8CLAMPEDARRAY:
+                return i8ArrayTypeInfo;
+            default:
+                throw new UnimplementError(`${name} is not a typed array`);
+        }
+    }
+
+    /* log2 of BYTES_PER_ELEMENT */
+    export function getTypedArrayElemSizeShift(name: string) {
+        switch (name) {
+            case BuiltinNames.FLOAT64ARRAY:
+                return 3;
+            case BuiltinNames.FLOAT32ARRAY:
+            case BuiltinNames.INT32ARRAY:
+            case BuiltinNames.UINT32ARRAY:
+                return 2;
+            case BuiltinNames.INT16ARRAY:
+                return 1;
+            default:
+                return 0;
+        }
+    }
+
+    /* the unpacked wasm type of the elements */
+    export function getTypedArrayElemType(name: string): binaryen.Type {
+        switch (name) {
+            case BuiltinNames.FLOAT64ARRAY:
+                return binaryen.f64;
+            case BuiltinNames.FLOAT32ARRAY:
+                return binaryen.f32;
+            default:
+                return binaryen.i32;
+        }
+    }
+
+    export function getTypedArrayElemIdx(
+        module: binaryen.Module,
+        name: string,
+        typedArrayRef: binaryen.ExpressionRef,
+        idxI32Ref: binaryen.ExpressionRef,
+    ) {
+        return module.i32.add(
+            module.i32.shr_u(
+                binaryenCAPI._BinaryenStructGet(
+                    module.ptr,
+                    2,
+                    typedArrayRef,
+                    getTypedArrayTypeInfo(name).typeRef,
+                    false,
+                ),
+                module.i32.const(getTypedArrayElemSizeShift(name)),
+            ),
+            idxI32Ref,
+        );
+    }
+
+    export function getTypedArrayElem(
+        module: binaryen.Module,
+        name: string,
+        typedArrayRef: binaryen.ExpressionRef,
+        elemIdxRef: binaryen.ExpressionRef,
+    ) {
+        return binaryenCAPI._BinaryenArrayGet(
+            module.ptr,
+            binaryenCAPI._BinaryenStructGet(
+                module.ptr,
+                0,
+                typedArrayRef,
+                getTypedArrayTypeInfo(name).typeRef,
+                false,
+            ),
+            elemIdxRef,
+            getTypedArrayElemType(name),
+            name === BuiltinNames.INT16ARRAY,
+        );
+    }
+
+    export function setTypedArrayElem(
+        module: binaryen.Module,
+        name: string,
+        typedArrayRef: binaryen.ExpressionRef,
+        elemIdxRef: binaryen.ExpressionRef,
+        elemRef: binaryen.ExpressionRef,
+    ) {
+        return binaryenCAPI._BinaryenArraySet(
+            module.ptr,
+            binaryenCAPI._BinaryenStructGet(
+                module.ptr,
+                0,
+                typedArrayRef,
+                getTypedArrayTypeInfo(name).typeRef,
+                false,
+            ),
+            elemIdxRef,
+            elemRef,
+        );
+    }
+
+    export function typedArrayElemToF64(
+        module: binaryen.Module,
+        name: string,
+        elemRef: binaryen.ExpressionRef,
+    ) {
+        switch (name) {
+            case BuiltinNames.FLOAT64ARRAY:
+                return elemRef;
+            case BuiltinNames.FLOAT32ARRAY:
+                return module.f64.promote(elemRef);
+            case BuiltinNames.UINT32ARRAY:
+                return module.f64.convert_u.i32(elemRef);
+            default:
+                /* packed elements are already extended by array.get_s/u */
+                return module.f64.convert_s.i32(elemRef);
+        }
+    }
+
+    /* valueRef is used twice, pass a local.get */
+    export function f64ToTypedArrayElem(
+        module: binaryen.Module,
+        name: string,
+        valueRef: binaryen.ExpressionRef,
+    ) {
+        switch (name) {
+            case BuiltinNames.FLOAT64ARRAY:
+                return valueRef;
+            case BuiltinNames.FLOAT32ARRAY:
+                return module.f32.demote(valueRef);
+            case BuiltinNames.UINT8CLAMPEDARRAY:
+                /* clamp to [0, 255] and round half to even, NaN becomes 0 */
+                return module.i32.trunc_s_sat.f64(
+                    module.f64.nearest(
+                        module.f64.min(
+                            module.f64.max(valueRef, module.f64.const(0)),
+                            module.f64.const(255),
+                        ),
+                    ),
+                );
+            default: {
+                /* ToInt32: trunc(x) modulo 2^32, array.set truncates packed
+                    elements. The remainder is an integer below 2^32 so the
+                    subtraction is exact for any magnitude, NaN and
+                    infinities end up as NaN and saturate to 0 */
+                return module.i32.trunc_u_sat.f64(
+                    module.f64.sub(
+                        module.f64.trunc(valueRef),
+                        module.f64.mul(
+                            module.f64.floor(
+                                module.f64.mul(
+                                    module.f64.trunc(
+                                        module.copyExpression(valueRef),
+                                    ),
+                                    module.f64.const(2 ** -32),
+                                ),
+                            ),
+                            module.f64.const(2 ** 32),
+                        ),
+                    ),
+                );
+            }
+        }
+    }
+
     export function getFieldFromMetaByOffset(
         module: binaryen.Module,
         meta: binaryen.ExpressionRef,
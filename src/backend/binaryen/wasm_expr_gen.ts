@@ -121,11 +121,41 @@ import {
 import { getBuiltInFuncName } from '../../utils.js';
 import { stringTypeInfo } from './glue/packType.js';
 import { getConfig } from '../../../config/config_mgr.js';
-import { GetBuiltinObjectType } from '../../semantics/builtin.js';
+import {
+    GetBuiltinObjectType,
+    IsStaticCollectionType,
+} from '../../semantics/builtin.js';
+import {
+    CollectionArrayInfo,
+    CollectionDynNames,
+    CollectionLoopLocals,
+    forEachEntry,
+    getCollectionMethodName,
+    getCollectionToAnyName,
+    newCollection,
+} from './lib/collection_utils.js';
+import {
+    JSONFallbackInfo,
+    JSONSchema,
+    JSONSchemaField,
+    getJSONParseFuncName,
+    getJSONStringifyFuncName,
+} from './lib/json_utils.js';
+import {
+    addRegExpFunctions,
+    getStringMatchAllFuncName,
+    getStringRegExpFuncName,
+    newRegExp,
+    newRegExpLiteral,
+} from './lib/regexp_utils.js';
 
 export class WASMExpressionGen {
     private module: binaryen.Module;
     private wasmTypeGen;
+    /* null if the type can't be handled by the static JSON functions */
+    private jsonSchemas = new Map<ValueType, JSONSchema | null>();
+    /* globals keeping the pattern id of the regex literals */
+    private regExpLiterals = new Map<string, string>();
 
     constructor(private wasmCompiler: WASMGen) {
         this.module = this.wasmCompiler.module;
@@ -223,6 +253,7 @@ export class WASMExpressionGen {
             case SemanticsValueKind.TUPLE_INDEX_GET:
             case SemanticsValueKind.WASMARRAY_INDEX_GET:
             case SemanticsValueKind.WASMSTRUCT_INDEX_GET:
+            case SemanticsValueKind.OBJECT_INDEX_GET:
                 return this.wasmElemGet(<ElementGetValue>value);
             case SemanticsValueKind.ARRAY_INDEX_SET:
             case SemanticsValueKind.OBJECT_KEY_SET:
@@ -230,6 +261,7 @@ export class WASMExpressionGen {
             case SemanticsValueKind.TUPLE_INDEX_SET:
             case SemanticsValueKind.WASMARRAY_INDEX_SET:
             case SemanticsValueKind.WASMSTRUCT_INDEX_SET:
+            case SemanticsValueKind.OBJECT_INDEX_SET:
                 return this.wasmElemSet(<ElementSetValue>value);
             case SemanticsValueKind.BLOCK:
                 return this.wasmBlockValue(<BlockValue>value);
@@ -1118,6 +1150,18 @@ export class WASMExpressionGen {
         args?: SemanticsValue[],
         isBuiltin = false,
     ) {
+        if (isBuiltin && target === BuiltinNames.MATH && args) {
+            const loweredRef = this.lowerMathCall(member.name, args);
+            if (loweredRef) {
+                return loweredRef;
+            }
+        }
+        if (isBuiltin && target === BuiltinNames.CONSOLE_CLASS && args) {
+            const loweredRef = this.lowerConsoleCall(member.name, args);
+            if (loweredRef) {
+                return loweredRef;
+            }
+        }
         let funcDecl = undefined;
         let methodName = `${target}|${member.name}`;
         if (member.isStaic) {
@@ -1144,6 +1188,140 @@ export class WASMExpressionGen {
         );
     }
 
+    /* Math.max/Math.min with 2 or 3 arguments and Math.hypot with 2 arguments
+        are lowered at the call site, so no rest array is allocated */
+    private lowerMathCall(
+        methodName: string,
+        args: SemanticsValue[],
+    ): binaryen.ExpressionRef | undefined {
+        if (
+            args.some(
+                (arg) =>
+                    arg instanceof SpreadValue ||
+                    arg.type.kind !== ValueTypeKind.NUMBER,
+            )
+        ) {
+            return undefined;
+        }
+        switch (methodName) {
+            case 'max':
+            case 'min': {
+                if (args.length < 2 || args.length > 3) {
+                    return undefined;
+                }
+                const argRefs = args.map((arg) => this.wasmExprGen(arg));
+                /* f64.max/f64.min propagate NaN and order -0 before +0,
+                    which is the same as Math.max/Math.min */
+                return argRefs
+                    .slice(1)
+                    .reduce(
+                        (res, argRef) =>
+                            methodName === 'max'
+                                ? this.module.f64.max(res, argRef)
+                                : this.module.f64.min(res, argRef),
+                        argRefs[0],
+                    );
+            }
+            case 'hypot': {
+                if (args.length !== 2) {
+                    return undefined;
+                }
+                return this.module.call(
+                    BuiltinNames.mathHypotNativeFuncName,
+                    args.map((arg) => this.wasmExprGen(arg)),
+                    binaryen.f64,
+                );
+            }
+            default:
+                return undefined;
+        }
+    }
+
+    /* console calls whose arguments are all numbers, booleans or strings
+        write each argument with a typed native, so nothing is boxed to any */
+    private lowerConsoleCall(
+        methodName: string,
+        args: SemanticsValue[],
+    ): binaryen.ExpressionRef | undefined {
+        const stream = BuiltinNames.consoleStreams.get(methodName);
+        if (stream === undefined) {
+            return undefined;
+        }
+        /* the arguments are cast to any for the rest parameter */
+        const values = args.map((arg) =>
+            arg instanceof CastValue && arg.type.kind === ValueTypeKind.ANY
+                ? arg.value
+                : arg,
+        );
+        const nativeFuncNames: string[] = [];
+        for (const value of values) {
+            switch (value.type.kind) {
+                case ValueTypeKind.NUMBER:
+                    nativeFuncNames.push(
+                        BuiltinNames.consoleWriteNumberFuncName,
+                    );
+                    break;
+                case ValueTypeKind.BOOLEAN:
+                    nativeFuncNames.push(
+                        BuiltinNames.consoleWriteBooleanFuncName,
+                    );
+                    break;
+                case ValueTypeKind.STRING:
+                case ValueTypeKind.RAW_STRING:
+                    nativeFuncNames.push(
+                        getConfig().enableStringRef
+                            ? BuiltinNames.consoleWriteStringrefFuncName
+                            : BuiltinNames.consoleWriteStringFuncName,
+                    );
+                    break;
+                default:
+                    return undefined;
+            }
+        }
+        /* evaluate every argument before the first write, so output of a
+            nested call or an exception thrown by an argument never leaves
+            a half written line in the buffer */
+        const stmts: binaryen.ExpressionRef[] = [];
+        const writes: binaryen.ExpressionRef[] = [];
+        values.forEach((value, i) => {
+            let valueRef = this.wasmExprGen(value);
+            if (
+                nativeFuncNames[i] === BuiltinNames.consoleWriteStringFuncName
+            ) {
+                valueRef = binaryenCAPI._BinaryenStructGet(
+                    this.module.ptr,
+                    1,
+                    valueRef,
+                    stringTypeInfo.typeRef,
+                    false,
+                );
+            }
+            if (binaryen.getExpressionId(valueRef) !== binaryen.ConstId) {
+                const valueType = binaryen.getExpressionType(valueRef);
+                const tmpVar =
+                    this.wasmCompiler.currentFuncCtx!.insertTmpVar(valueType);
+                stmts.push(this.module.local.set(tmpVar.index, valueRef));
+                valueRef = this.module.local.get(tmpVar.index, valueType);
+            }
+            writes.push(
+                this.module.call(
+                    nativeFuncNames[i],
+                    [this.module.i32.const(stream), valueRef],
+                    binaryen.none,
+                ),
+            );
+        });
+        stmts.push(...writes);
+        stmts.push(
+            this.module.call(
+                BuiltinNames.consoleWriteEndFuncName,
+                [this.module.i32.const(stream)],
+                binaryen.none,
+            ),
+        );
+        return this.module.block(null, stmts);
+    }
+
     private wasmOffsetCall(value: OffsetCallValue) {
         /* Array.xx, console.log */
         const ownerType = value.owner.type as ObjectType;
@@ -1413,7 +1591,19 @@ export class WASMExpressionGen {
         const ownerTypeRef = this.wasmTypeGen.getWASMValueType(owner.type);
         switch (owner.type.kind) {
             case ValueTypeKind.OBJECT: {
+                if (IsStaticCollectionType(owner.type)) {
+                    return this.callCollectionMethod(
+                        value.funcType,
+                        member.name,
+                        ownerRef,
+                        owner.type as ObjectType,
+                        value.parameters,
+                    );
+                }
                 if (BuiltinNames.builtInObjectTypes.includes(meta.name)) {
+                    if (meta.name === BuiltinNames.REGEXP) {
+                        addRegExpFunctions(this.module);
+                    }
                     const methodName = UtilFuncs.getBuiltinClassMethodName(
                         meta.name,
                         member.name,
@@ -1482,6 +1672,17 @@ export class WASMExpressionGen {
                 /* fallthrough */
             }
             default: {
+                if (owner.type.kind === ValueTypeKind.STRING) {
+                    const regExpCallRef = this.wasmStringRegExpCall(
+                        member.name,
+                        ownerRef,
+                        value.funcType.returnType,
+                        value.parameters,
+                    );
+                    if (regExpCallRef) {
+                        return regExpCallRef;
+                    }
+                }
                 /* workaround: arr.push is vtableCall */
                 const calledName = `${BuiltinNames.builtinModuleName}|${meta.name}|${member.name}`;
                 /* workaround: method.valueType.returnType various from value.funcType.returnType */
@@ -1504,6 +1705,15 @@ export class WASMExpressionGen {
         switch (owner.type.kind) {
             case ValueTypeKind.UNION:
             case ValueTypeKind.ANY: {
+                if (this.isJSONCall(value, 'stringify')) {
+                    const jsonRef = this.wasmJSONStringify(value);
+                    if (jsonRef) {
+                        return FunctionalFuncs.generateDynString(
+                            this.module,
+                            jsonRef,
+                        );
+                    }
+                }
                 /* Fallback to libdyntype */
                 let invokeArgs = [owner];
                 if (value.parameters) {
@@ -1534,6 +1744,17 @@ export class WASMExpressionGen {
                     );
                     const methodType = foundMember.valueType as FunctionType;
                     const thisRef = this.wasmExprGen(owner);
+                    if (owner.type.kind === ValueTypeKind.STRING) {
+                        const regExpCallRef = this.wasmStringRegExpCall(
+                            methodName,
+                            thisRef,
+                            methodType.returnType,
+                            value.parameters,
+                        );
+                        if (regExpCallRef) {
+                            return regExpCallRef;
+                        }
+                    }
                     const calledName = `${BuiltinNames.builtinModuleName}|${className}|${methodName}`;
                     return this.callClassMethod(
                         methodType,
@@ -1557,6 +1778,321 @@ export class WASMExpressionGen {
         }
     }
 
+    private isRegExpType(type: ValueType) {
+        return (
+            type.kind === ValueTypeKind.OBJECT &&
+            (type as ObjectType).meta.name === BuiltinNames.REGEXP
+        );
+    }
+
+    /* str.match(re), str.search(re), str.replace(re, s), str.split(re) and
+        str.matchAll(re), the semantics picks the string overload so the
+        RegExp argument arrives wrapped in a ToStringValue */
+    private wasmStringRegExpCall(
+        methodName: string,
+        strRef: binaryen.ExpressionRef,
+        returnType: ValueType,
+        args?: SemanticsValue[],
+    ): binaryen.ExpressionRef | undefined {
+        if (!args || args.length === 0) {
+            return undefined;
+        }
+        let regExp = args[0];
+        if (
+            regExp instanceof ToStringValue &&
+            BuiltinNames.stringRegExpMethods.includes(methodName)
+        ) {
+            regExp = regExp.value;
+        }
+        if (!this.isRegExpType(regExp.type)) {
+            return undefined;
+        }
+        if (getConfig().enableStringRef) {
+            throw new UnimplementError(
+                `String.${methodName} with RegExp is not supported with stringref`,
+            );
+        }
+        const argRefs = [
+            this.wasmCompiler.emptyRef,
+            strRef,
+            this.wasmExprGen(regExp),
+            ...args.slice(1).map((arg) => this.wasmExprGen(arg)),
+        ];
+        let funcName: string;
+        if (methodName === 'matchAll') {
+            funcName = getStringMatchAllFuncName(this.module, {
+                structTypeRef: this.wasmTypeGen.getWASMValueType(returnType),
+                structHeapTypeRef:
+                    this.wasmTypeGen.getWASMValueHeapType(returnType),
+                arrayTypeRef: this.wasmTypeGen.getWASMArrayOriType(returnType),
+                arrayHeapTypeRef:
+                    this.wasmTypeGen.getWASMArrayOriHeapType(returnType),
+            });
+        } else {
+            addRegExpFunctions(this.module);
+            funcName = getStringRegExpFuncName(methodName);
+        }
+        return this.module.call(
+            funcName,
+            argRefs,
+            this.wasmTypeGen.getWASMValueType(returnType),
+        );
+    }
+
+    /* new RegExp(source, flags), a literal pattern is compiled once */
+    private wasmNewRegExp(value: NewConstructorObjectValue) {
+        if (getConfig().enableStringRef) {
+            throw new UnimplementError(
+                'RegExp is not supported with stringref',
+            );
+        }
+        if (getConfig().simpleLibdyntype) {
+            throw new UnimplementError(
+                'RegExp is not supported by the simple libdyntype',
+            );
+        }
+        const [source, flags] = value.parameters;
+        if (
+            source instanceof LiteralValue &&
+            typeof source.value === 'string' &&
+            (!flags ||
+                (flags instanceof LiteralValue &&
+                    typeof flags.value === 'string'))
+        ) {
+            const flagsStr = flags ? (flags.value as string) : '';
+            const key = `${flagsStr}/${source.value}`;
+            let globalName = this.regExpLiterals.get(key);
+            if (!globalName) {
+                globalName = `regexp_literal|${this.regExpLiterals.size}`;
+                this.regExpLiterals.set(key, globalName);
+            }
+            return newRegExpLiteral(
+                this.module,
+                globalName,
+                source.value,
+                flagsStr,
+            );
+        }
+        return newRegExp(
+            this.module,
+            this.wasmExprGen(source),
+            flags
+                ? this.wasmExprGen(flags)
+                : FunctionalFuncs.generateStringForStructArrayStr(
+                      this.module,
+                      '',
+                  ),
+        );
+    }
+
+    /* JSON.xxx(arg) with the JSON object of the JS environment */
+    private isJSONCall(value: SemanticsValue, name: string) {
+        if (
+            !(value instanceof DynamicCallValue) ||
+            value.name !== name ||
+            value.parameters?.length !== 1
+        ) {
+            return false;
+        }
+        const owner = value.owner;
+        return (
+            owner instanceof VarValue &&
+            owner.ref instanceof VarDeclareNode &&
+            owner.ref.name.endsWith(BuiltinNames.jsonName)
+        );
+    }
+
+    private getJSONFallbackInfo(): JSONFallbackInfo {
+        const globalName = BuiltinNames.jsonName.split(
+            BuiltinNames.moduleDelimiter,
+        )[1];
+        BuiltinNames.JSGlobalObjects.add(globalName);
+        return {
+            globalName: globalName,
+            stringifyNameOffset:
+                this.wasmCompiler.generateRawString('stringify'),
+            parseNameOffset: this.wasmCompiler.generateRawString('parse'),
+            syntaxErrorNameOffset:
+                this.wasmCompiler.generateRawString('SyntaxError'),
+        };
+    }
+
+    /* describe the layout of a type for the static JSON functions, only
+        class instances and object literals whose fields are numbers,
+        booleans, strings or such objects and arrays are supported */
+    private getJSONSchema(
+        type: ValueType,
+        visiting = new Set<ValueType>(),
+    ): JSONSchema | undefined {
+        if (getConfig().enableStringRef) {
+            return undefined;
+        }
+        switch (type.kind) {
+            case ValueTypeKind.NUMBER:
+                return { kind: type.kind, id: 'n', typeRef: binaryen.f64 };
+            case ValueTypeKind.BOOLEAN:
+                return { kind: type.kind, id: 'b', typeRef: binaryen.i32 };
+            case ValueTypeKind.RAW_STRING:
+            case ValueTypeKind.STRING:
+                return {
+                    kind: ValueTypeKind.STRING,
+                    id: 's',
+                    typeRef: stringTypeInfo.typeRef,
+                };
+            case ValueTypeKind.ARRAY:
+            case ValueTypeKind.OBJECT:
+                break;
+            default:
+                return undefined;
+        }
+        const cached = this.jsonSchemas.get(type);
+        if (cached !== undefined) {
+            return cached ? cached : undefined;
+        }
+        /* recursive types are left to libdyntype */
+        if (visiting.has(type)) {
+            return undefined;
+        }
+        visiting.add(type);
+        const schema =
+            type.kind === ValueTypeKind.ARRAY
+                ? this.getJSONArraySchema(type as ArrayType, visiting)
+                : this.getJSONObjectSchema(type as ObjectType, visiting);
+        visiting.delete(type);
+        this.jsonSchemas.set(type, schema ? schema : null);
+        return schema;
+    }
+
+    private getJSONArraySchema(
+        type: ArrayType,
+        visiting: Set<ValueType>,
+    ): JSONSchema | undefined {
+        const element = this.getJSONSchema(type.element, visiting);
+        if (!element) {
+            return undefined;
+        }
+        return {
+            kind: ValueTypeKind.ARRAY,
+            id: `a(${element.id})`,
+            typeRef: this.wasmTypeGen.getWASMValueType(type),
+            heapTypeRef: this.wasmTypeGen.getWASMValueHeapType(type),
+            arrayTypeRef: this.wasmTypeGen.getWASMArrayOriType(type),
+            arrayHeapTypeRef: this.wasmTypeGen.getWASMArrayOriHeapType(type),
+            element: element,
+        };
+    }
+
+    private getJSONObjectSchema(
+        type: ObjectType,
+        visiting: Set<ValueType>,
+    ): JSONSchema | undefined {
+        const meta = type.meta;
+        if (
+            !meta ||
+            meta.isBuiltin ||
+            meta.name.includes(BuiltinNames.builtinTypeManglePrefix) ||
+            !(meta.isObjectInstance || meta.isLiteral) ||
+            IsStaticCollectionType(type)
+        ) {
+            return undefined;
+        }
+        const fields: JSONSchemaField[] = [];
+        for (const member of meta.members) {
+            if (member.type !== MemberType.FIELD || member.isStaic) {
+                continue;
+            }
+            /* the name is written into the serializer as is */
+            if (!/^[A-Za-z_$][\w$]*$/.test(member.name)) {
+                return undefined;
+            }
+            const fieldSchema = this.getJSONSchema(member.valueType, visiting);
+            if (!fieldSchema) {
+                return undefined;
+            }
+            fields.push({
+                name: member.name,
+                index: this.fixFieldIndex(meta, member) + 1,
+                schema: fieldSchema,
+            });
+        }
+        return {
+            kind: ValueTypeKind.OBJECT,
+            id: `o${type.typeId}`,
+            typeRef: this.wasmTypeGen.getWASMValueType(type),
+            heapTypeRef: this.wasmTypeGen.getWASMValueHeapType(type),
+            fields: fields,
+            vtableTypeRef: this.wasmTypeGen.getWASMVtableType(type),
+            vtableInst: this.wasmTypeGen.getWASMVtableInst(type),
+            metaOffset: this.wasmCompiler.generateMetaInfo(type),
+            /* a literal type may describe objects of other shapes */
+            checkMeta: meta.isLiteral || meta.drived > 0,
+        };
+    }
+
+    /* serialize the fields directly if the layout of the argument is known,
+        returns undefined to fallback to libdyntype */
+    private wasmJSONStringify(value: DynamicCallValue) {
+        let arg = value.parameters![0];
+        if (
+            arg instanceof CastValue &&
+            arg.kind === SemanticsValueKind.OBJECT_CAST_ANY
+        ) {
+            arg = arg.value;
+        }
+        const schema = this.getJSONSchema(arg.type);
+        if (
+            !schema ||
+            (schema.kind !== ValueTypeKind.OBJECT &&
+                schema.kind !== ValueTypeKind.ARRAY)
+        ) {
+            return undefined;
+        }
+        return this.module.call(
+            getJSONStringifyFuncName(
+                this.module,
+                schema,
+                this.getJSONFallbackInfo(),
+            ),
+            [this.wasmExprGen(arg)],
+            stringTypeInfo.typeRef,
+        );
+    }
+
+    /* parse the text into the struct of the target type, returns undefined
+        to fallback to libdyntype */
+    private wasmJSONParse(value: DynamicCallValue, toType: ValueType) {
+        let arg = value.parameters![0];
+        if (
+            arg instanceof CastValue &&
+            arg.kind === SemanticsValueKind.VALUE_CAST_ANY
+        ) {
+            arg = arg.value;
+        }
+        if (
+            arg.type.kind !== ValueTypeKind.STRING &&
+            arg.type.kind !== ValueTypeKind.RAW_STRING
+        ) {
+            return undefined;
+        }
+        const schema = this.getJSONSchema(toType);
+        if (
+            !schema ||
+            (schema.kind !== ValueTypeKind.OBJECT &&
+                schema.kind !== ValueTypeKind.ARRAY)
+        ) {
+            return undefined;
+        }
+        return this.module.call(
+            getJSONParseFuncName(
+                this.module,
+                schema,
+                this.getJSONFallbackInfo(),
+            ),
+            [this.wasmExprGen(arg)],
+            schema.typeRef,
+        );
+    }
+
     private wasmShapeCall(value: ShapeCallValue): binaryen.ExpressionRef {
         /* When specialized (such as Array):
          * the original unspecialized type is stored in shape, and the specific specialized type is stored in type
@@ -1670,6 +2206,18 @@ export class WASMExpressionGen {
         switch (value.kind) {
             case SemanticsValueKind.ANY_CAST_VALUE:
             case SemanticsValueKind.UNION_CAST_VALUE: {
+                /* const s: string = JSON.stringify(obj), no need to box */
+                if (
+                    toType.kind === ValueTypeKind.STRING &&
+                    this.isJSONCall(fromValue, 'stringify')
+                ) {
+                    const jsonRef = this.wasmJSONStringify(
+                        fromValue as DynamicCallValue,
+                    );
+                    if (jsonRef) {
+                        return jsonRef;
+                    }
+                }
                 const fromValueRef = this.wasmExprGen(fromValue);
                 return FunctionalFuncs.unboxAnyToBase(
                     this.module,
@@ -1692,6 +2240,16 @@ export class WASMExpressionGen {
             }
             case SemanticsValueKind.ANY_CAST_OBJECT:
             case SemanticsValueKind.UNION_CAST_OBJECT: {
+                /* JSON.parse(text) as T */
+                if (this.isJSONCall(fromValue, 'parse')) {
+                    const objRef = this.wasmJSONParse(
+                        fromValue as DynamicCallValue,
+                        toType,
+                    );
+                    if (objRef) {
+                        return objRef;
+                    }
+                }
                 const fromValueRef = this.wasmExprGen(fromValue);
                 const toTypeRef = this.wasmTypeGen.getWASMValueType(toType);
                 return FunctionalFuncs.unboxAnyToExtref(
@@ -1856,6 +2414,21 @@ export class WASMExpressionGen {
                     fromTypeRef,
                 );
             }
+        } else if (
+            fromType.kind === ValueTypeKind.STRING ||
+            fromType.kind === ValueTypeKind.RAW_STRING
+        ) {
+            if (toType.kind === ValueTypeKind.NUMBER) {
+                /* Number(str) and +str */
+                return this.module.call(
+                    UtilFuncs.getFuncName(
+                        BuiltinNames.builtinModuleName,
+                        BuiltinNames.stringToNumberFuncName,
+                    ),
+                    [this.wasmCompiler.emptyRef, fromValueRef],
+                    binaryen.f64,
+                );
+            }
         }
         throw new UnimplementError(`wasmValueCast: ${value}`);
     }
@@ -2057,6 +2630,205 @@ export class WASMExpressionGen {
         );
     }
 
+    private callCollectionMethod(
+        methodType: FunctionType,
+        methodName: string,
+        thisRef: binaryen.ExpressionRef,
+        ownerType: ObjectType,
+        args?: SemanticsValue[],
+    ) {
+        if (methodName === 'forEach') {
+            return this.collectionForEach(thisRef, ownerType, args![0]);
+        }
+        const returnType = methodType.returnType;
+        /* keys(), values() and entries() create arrays of the return type */
+        let arrayInfo: CollectionArrayInfo | undefined = undefined;
+        if (returnType instanceof ArrayType) {
+            arrayInfo = {
+                structTypeInfo: {
+                    typeRef: this.wasmTypeGen.getWASMType(returnType),
+                    heapTypeRef: this.wasmTypeGen.getWASMHeapType(returnType),
+                },
+                arrayTypeInfo: {
+                    typeRef: this.wasmTypeGen.getWASMArrayOriType(returnType),
+                    heapTypeRef:
+                        this.wasmTypeGen.getWASMArrayOriHeapType(returnType),
+                },
+                elemTypeRef: this.wasmTypeGen.getWASMValueType(
+                    returnType.element,
+                ),
+            };
+            if (returnType.element instanceof TupleType) {
+                arrayInfo.entryTypeInfo = {
+                    typeRef: this.wasmTypeGen.getWASMType(returnType.element),
+                    heapTypeRef: this.wasmTypeGen.getWASMHeapType(
+                        returnType.element,
+                    ),
+                };
+            }
+        }
+        const calledName = getCollectionMethodName(
+            this.module,
+            this.wasmTypeGen.getCollectionTypeInfo(ownerType),
+            methodName,
+            arrayInfo,
+        );
+        return this.callFunc(
+            methodType,
+            calledName,
+            this.wasmTypeGen.getWASMValueType(returnType),
+            args,
+            undefined,
+            undefined,
+            thisRef,
+        );
+    }
+
+    /* forEach of static Map and Set is inlined, the callback is called
+        through its own closure type, so it may declare fewer parameters */
+    private collectionForEach(
+        thisRef: binaryen.ExpressionRef,
+        ownerType: ObjectType,
+        callback: SemanticsValue,
+    ) {
+        const callbackType = callback.type;
+        if (!(callbackType instanceof FunctionType)) {
+            throw new UnimplementError(
+                `${ownerType.meta.name}.forEach with callback of ${callbackType}`,
+            );
+        }
+        const info = this.wasmTypeGen.getCollectionTypeInfo(ownerType);
+        const funcCtx = this.wasmCompiler.currentFuncCtx!;
+        const selfVar = funcCtx.insertTmpVar(info.structTypeInfo.typeRef);
+        const closureTypeRef = this.wasmTypeGen.getWASMValueType(callbackType);
+        const closureVar = funcCtx.insertTmpVar(closureTypeRef);
+        const locals: CollectionLoopLocals = {
+            hashes_idx: funcCtx.insertTmpVar(i32ArrayTypeInfo.typeRef).index,
+            keys_idx: funcCtx.insertTmpVar(info.keyArrayTypeInfo.typeRef).index,
+            values_idx: info.valueArrayTypeInfo
+                ? funcCtx.insertTmpVar(info.valueArrayTypeInfo.typeRef).index
+                : -1,
+            used_idx: funcCtx.i32Local().index,
+            i_idx: funcCtx.i32Local().index,
+        };
+        const self = this.module.local.get(
+            selfVar.index,
+            info.structTypeInfo.typeRef,
+        );
+        const closure = this.module.local.get(
+            closureVar.index,
+            closureTypeRef,
+        );
+        const returnTypeRef = this.wasmTypeGen.getWASMValueType(
+            callbackType.returnType,
+        );
+
+        const loop = forEachEntry(
+            this.module,
+            info,
+            self,
+            locals,
+            `collection_for_each_${selfVar.index}`,
+            (key, value) => {
+                /* (value, key, map) for Map, (value, value, set) for Set */
+                const sources: [binaryen.ExpressionRef, ValueTypeKind][] = [
+                    value ? [value, info.valueKind] : [key, info.keyKind],
+                    [key, info.keyKind],
+                    [self, ValueTypeKind.OBJECT],
+                ];
+                const callArgs: binaryen.ExpressionRef[] = [
+                    binaryenCAPI._BinaryenStructGet(
+                        this.module.ptr,
+                        0,
+                        closure,
+                        closureTypeRef,
+                        false,
+                    ),
+                    binaryenCAPI._BinaryenStructGet(
+                        this.module.ptr,
+                        1,
+                        closure,
+                        closureTypeRef,
+                        false,
+                    ),
+                ];
+                callbackType.argumentsType.forEach((paramType, i) => {
+                    if (i >= sources.length) {
+                        callArgs.push(
+                            FunctionalFuncs.generateDynUndefined(this.module),
+                        );
+                        return;
+                    }
+                    const [argRef, argKind] = sources[i];
+                    const isDynParam =
+                        paramType.kind == ValueTypeKind.ANY ||
+                        paramType.kind == ValueTypeKind.UNION;
+                    if (
+                        !isDynParam ||
+                        argKind == ValueTypeKind.ANY ||
+                        argKind == ValueTypeKind.UNION
+                    ) {
+                        callArgs.push(argRef);
+                    } else if (i == 2) {
+                        callArgs.push(
+                            this.staticCollectionToAny(argRef, ownerType),
+                        );
+                    } else {
+                        callArgs.push(
+                            FunctionalFuncs.boxNonLiteralToAny(
+                                this.module,
+                                argRef,
+                                argKind,
+                            ),
+                        );
+                    }
+                });
+                const callRef = binaryenCAPI._BinaryenCallRef(
+                    this.module.ptr,
+                    this.getFuncRefFromClosure(closure, closureTypeRef),
+                    arrayToPtr(callArgs).ptr,
+                    callArgs.length,
+                    returnTypeRef,
+                    false,
+                );
+                return returnTypeRef === binaryen.none
+                    ? callRef
+                    : this.module.drop(callRef);
+            },
+        );
+        return this.module.block(null, [
+            this.module.local.set(selfVar.index, thisRef),
+            this.module.local.set(
+                closureVar.index,
+                this.wasmExprGen(callback),
+            ),
+            loop,
+        ]);
+    }
+
+    /* static Map and Set are copied to dynamic ones when they flow into
+        any, e.g. console.log(map) */
+    private staticCollectionToAny(
+        valueRef: binaryen.ExpressionRef,
+        type: ObjectType,
+    ) {
+        const names: CollectionDynNames = {
+            map: this.wasmCompiler.generateRawString(BuiltinNames.MAP),
+            set: this.wasmCompiler.generateRawString(BuiltinNames.SET),
+            setMethod: this.wasmCompiler.generateRawString('set'),
+            addMethod: this.wasmCompiler.generateRawString('add'),
+        };
+        return this.module.call(
+            getCollectionToAnyName(
+                this.module,
+                this.wasmTypeGen.getCollectionTypeInfo(type),
+                names,
+            ),
+            [valueRef],
+            dyntype.dyn_value_t,
+        );
+    }
+
     private getBuiltinObjField(
         objRef: binaryen.ExpressionRef,
         fieldIdx: number,
@@ -2226,6 +2998,16 @@ export class WASMExpressionGen {
                 typeMember,
                 typeMember.hasSetter,
             );
+            if (BuiltinNames.builtInObjectTypes.includes(typeMeta.name)) {
+                /* builtin objects are structs without vtable, e.g.
+                    re.lastIndex = 0 */
+                return binaryenCAPI._BinaryenStructSet(
+                    this.module.ptr,
+                    propertyIdx,
+                    thisRef,
+                    this.wasmExprGen(targetValue),
+                );
+            }
             if (typeMeta.isInterface) {
                 return this.setInfcProperty(
                     typeMember,
@@ -2708,6 +3490,17 @@ export class WASMExpressionGen {
         const metaInfo = (value.type as ObjectType).meta;
         if (!metaInfo.ctor) {
             const className = metaInfo.name;
+            if (IsStaticCollectionType(value.type)) {
+                return newCollection(
+                    this.module,
+                    this.wasmTypeGen.getCollectionTypeInfo(
+                        value.type as ObjectType,
+                    ),
+                );
+            }
+            if (className === BuiltinNames.REGEXP) {
+                return this.wasmNewRegExp(value);
+            }
             if (BuiltinNames.fallbackConstructors.includes(metaInfo.name)) {
                 /* workaround: Error constructor is not defined, so we can fallback temporarily */
                 /* Fallback to libdyntype */
@@ -2819,7 +3612,10 @@ export class WASMExpressionGen {
                 } else {
                     const objRef = this.wasmExprGen(owner);
                     if (
-                        BuiltinNames.builtInObjectTypes.includes(typeMeta.name)
+                        BuiltinNames.builtInObjectTypes.includes(
+                            typeMeta.name,
+                        ) ||
+                        IsStaticCollectionType(ownerType)
                     ) {
                         const propertyIdx = this.getTruthIdx(
                             typeMeta,
@@ -3877,6 +4673,119 @@ export class WASMExpressionGen {
         return elemOperation;
     }
 
+    /* Typed array elements are accessed inline, out of bounds reads get NaN
+        (undefined converted to number) and out of bounds writes are ignored */
+    private typedArrayElemOp(
+        value: ElementGetValue | ElementSetValue,
+        typeName: string,
+    ) {
+        const module = this.module;
+        const typedArrayTypeRef =
+            FunctionalFuncs.getTypedArrayTypeInfo(typeName).typeRef;
+        const ownerVar =
+            this.wasmCompiler.currentFuncCtx!.insertTmpVar(typedArrayTypeRef);
+        const idxVar = this.wasmCompiler.currentFuncCtx!.insertTmpVar(
+            binaryen.i32,
+        );
+        const ownerRef = module.local.get(ownerVar.index, ownerVar.type);
+        const idxRef = module.local.get(idxVar.index, idxVar.type);
+        const stmts: binaryen.ExpressionRef[] = [
+            module.local.set(ownerVar.index, this.wasmExprGen(value.owner)),
+        ];
+        let inBoundsRef = module.i32.lt_u(
+            idxRef,
+            binaryenCAPI._BinaryenStructGet(
+                module.ptr,
+                1,
+                ownerRef,
+                typedArrayTypeRef,
+                false,
+            ),
+        );
+        const indexRef = this.wasmExprGen(value.index);
+        if (binaryen.getExpressionType(indexRef) === binaryen.f64) {
+            /* negative, fractional, NaN or too large indexes don't survive
+                the round trip through u32, and are out of range */
+            const idxF64Var = this.wasmCompiler.currentFuncCtx!.insertTmpVar(
+                binaryen.f64,
+            );
+            const idxF64Ref = module.local.get(
+                idxF64Var.index,
+                idxF64Var.type,
+            );
+            stmts.push(module.local.set(idxF64Var.index, indexRef));
+            stmts.push(
+                module.local.set(
+                    idxVar.index,
+                    module.i32.trunc_u_sat.f64(idxF64Ref),
+                ),
+            );
+            inBoundsRef = module.i32.and(
+                inBoundsRef,
+                module.f64.eq(module.f64.convert_u.i32(idxRef), idxF64Ref),
+            );
+        } else {
+            stmts.push(
+                module.local.set(
+                    idxVar.index,
+                    FunctionalFuncs.convertTypeToI32(module, indexRef),
+                ),
+            );
+        }
+        const elemIdxRef = FunctionalFuncs.getTypedArrayElemIdx(
+            module,
+            typeName,
+            ownerRef,
+            idxRef,
+        );
+        if (value instanceof ElementSetValue) {
+            /* the value is evaluated even if the index is out of bounds */
+            const valueVar = this.wasmCompiler.currentFuncCtx!.insertTmpVar(
+                binaryen.f64,
+            );
+            stmts.push(
+                module.local.set(
+                    valueVar.index,
+                    this.wasmExprGen(value.value!),
+                ),
+            );
+            stmts.push(
+                module.if(
+                    inBoundsRef,
+                    FunctionalFuncs.setTypedArrayElem(
+                        module,
+                        typeName,
+                        ownerRef,
+                        elemIdxRef,
+                        FunctionalFuncs.f64ToTypedArrayElem(
+                            module,
+                            typeName,
+                            module.local.get(valueVar.index, valueVar.type),
+                        ),
+                    ),
+                ),
+            );
+            return module.block(null, stmts);
+        }
+        stmts.push(
+            module.if(
+                inBoundsRef,
+                FunctionalFuncs.typedArrayElemToF64(
+                    module,
+                    typeName,
+                    FunctionalFuncs.getTypedArrayElem(
+                        module,
+                        typeName,
+                        ownerRef,
+                        elemIdxRef,
+                    ),
+                ),
+                module.f64.const(NaN),
+            ),
+        );
+        return module.block(null, stmts, binaryen.f64);
+    }
+
     private wasmElemGet(value: ElementGetValue) {
         const owner = value.owner;
         const ownerType = owner.type;
@@ -3965,6 +4874,10 @@ export class WASMExpressionGen {
                 );
             }
             case ValueTypeKind.OBJECT: {
+                const typeName = (ownerType as ObjectType).meta.name;
+                if (BuiltinNames.typedArrayNames.includes(typeName)) {
+                    return this.typedArrayElemOp(value, typeName);
+                }
                 return this.elemOp(value);
             }
             case ValueTypeKind.TUPLE:
@@ -4104,6 +5017,10 @@ export class WASMExpressionGen {
                 }
             }
             case ValueTypeKind.OBJECT: {
+                const typeName = (ownerType as ObjectType).meta.name;
+                if (BuiltinNames.typedArrayNames.includes(typeName)) {
+                    return this.typedArrayElemOp(value, typeName);
+                }
                 return this.elemOp(value);
             }
             case ValueTypeKind.TUPLE:
@@ -4213,6 +5130,12 @@ export class WASMExpressionGen {
     private generateDynamicArg(args?: Array<SemanticsValue>) {
         const restArgs = args
             ? args.map((a) => {
+                  if (IsStaticCollectionType(a.type)) {
+                      return this.staticCollectionToAny(
+                          this.wasmExprGen(a),
+                          a.type as ObjectType,
+                      );
+                  }
                   return FunctionalFuncs.boxToAny(
                       this.module,
                       this.wasmExprGen(a),
@@ -4371,6 +5294,12 @@ export class WASMExpressionGen {
             then they will be boxed to extref. Here we avoid this
             cast if we find the actual object should be fallbacked
             to libdyntype */
+        if (IsStaticCollectionType(fromType)) {
+            return this.staticCollectionToAny(
+                this.wasmExprGen(fromValue),
+                fromObjType,
+            );
+        }
         if (
             fromObjType.meta &&
             BuiltinNames.fallbackConstructors.includes(fromObjType.meta.name)
@@ -24,6 +24,7 @@ import {
     arrayBufferTypeInfo,
     dataViewTypeInfo,
     infcTypeInfo,
+    regExpTypeInfo,
     stringTypeInfo,
 } from './glue/packType.js';
 import { WASMGen } from './index.js';
@@ -53,6 +54,11 @@ import { FunctionalFuncs, UtilFuncs } from './utils.js';
 import { BuiltinNames } from '../../../lib/builtin/builtin_name.js';
 import { VarValue } from '../../semantics/value.js';
 import { needSpecialized } from '../../semantics/type_creator.js';
+import { IsStaticCollectionType } from '../../semantics/builtin.js';
+import {
+    CollectionTypeInfo,
+    getCollectionTypeInfo,
+} from './lib/collection_utils.js';
 import { getConfig } from '../../../config/config_mgr.js';
 import {
     MutabilityKind,
@@ -465,8 +471,25 @@ export class WASMTypeGen {
         this.heapTypeMap.set(type, dataViewTypeInfo.heapTypeRef);
     }
 
+    createWASMRegExpType(type: ObjectType) {
+        this.typeMap.set(type, regExpTypeInfo.typeRef);
+        this.heapTypeMap.set(type, regExpTypeInfo.heapTypeRef);
+    }
+
+    createWASMTypedArrayType(type: ObjectType) {
+        const typedArrayTypeInfo = FunctionalFuncs.getTypedArrayTypeInfo(
+            type.meta.name,
+        );
+        this.typeMap.set(type, typedArrayTypeInfo.typeRef);
+        this.heapTypeMap.set(type, typedArrayTypeInfo.heapTypeRef);
+    }
+
     createWASMBuiltinType(type: ObjectType) {
         const builtinTypeName = type.meta.name;
+        if (BuiltinNames.typedArrayNames.includes(builtinTypeName)) {
+            this.createWASMTypedArrayType(type);
+            return;
+        }
         switch (builtinTypeName) {
             case BuiltinNames.ARRAYBUFFER: {
                 this.createWASMArrayBufferType(type);
@@ -476,6 +499,10 @@ export class WASMTypeGen {
                 this.createWASMDataViewType(type);
                 break;
             }
+            case BuiltinNames.REGEXP: {
+                this.createWASMRegExpType(type);
+                break;
+            }
             default: {
                 throw new UnimplementError(
                     `${builtinTypeName} builtin type is not supported`,
@@ -484,9 +511,52 @@ export class WASMTypeGen {
         }
     }
 
+    createWASMCollectionType(type: ObjectType) {
+        if (!IsStaticCollectionType(type)) {
+            /* fallback to libdyntype */
+            this.typeMap.set(type, binaryen.anyref);
+            return;
+        }
+        const collectionTypeInfo = this.getCollectionTypeInfo(type);
+        this.typeMap.set(type, collectionTypeInfo.structTypeInfo.typeRef);
+        this.heapTypeMap.set(
+            type,
+            collectionTypeInfo.structTypeInfo.heapTypeRef,
+        );
+    }
+
+    getCollectionTypeInfo(type: ObjectType): CollectionTypeInfo {
+        const [keyType, valueType] = type.specialTypeArguments!;
+        if (type.meta.name === BuiltinNames.SET) {
+            return getCollectionTypeInfo(
+                BuiltinNames.SET,
+                keyType,
+                this.getWASMValueType(keyType),
+            );
+        }
+        const info = getCollectionTypeInfo(
+            BuiltinNames.MAP,
+            keyType,
+            this.getWASMValueType(keyType),
+            valueType,
+            this.getWASMValueType(valueType),
+        );
+        if (IsStaticCollectionType(valueType)) {
+            info.valueCollectionInfo = this.getCollectionTypeInfo(
+                valueType as ObjectType,
+            );
+        }
+        return info;
+    }
+
     createWASMObjectType(type: ObjectType) {
         const metaInfo = type.meta;
-        if (BuiltinNames.builtInObjectTypes.includes(metaInfo.name)) {
+        if (
+            metaInfo.name === BuiltinNames.MAP ||
+            metaInfo.name === BuiltinNames.SET
+        ) {
+            this.createWASMCollectionType(type);
+        } else if (BuiltinNames.builtInObjectTypes.includes(metaInfo.name)) {
             this.createWASMBuiltinType(type);
         } else {
             if (metaInfo.isInterface) {
@@ -1105,18 +1175,22 @@ export class WASMTypeGen {
                 const initValue = member.staticFieldInitValue!;
                 const memberType = member.valueType;
                 const valueType = initValue.type;
-                /** for Map/Set, it's any type */
+                /** for Map/Set without static key type, it's any type */
                 let isInitFallBackType = false;
                 if (valueType instanceof ObjectType) {
                     const name = valueType.meta.name;
                     isInitFallBackType =
-                        name == BuiltinNames.MAP || name == BuiltinNames.SET;
+                        (name == BuiltinNames.MAP ||
+                            name == BuiltinNames.SET) &&
+                        !IsStaticCollectionType(valueType);
                 }
                 let isMemFallBackType = false;
                 if (memberType instanceof ObjectType) {
                     const name = memberType.meta.name;
                     isMemFallBackType =
-                        name == BuiltinNames.MAP || name == BuiltinNames.SET;
+                        (name == BuiltinNames.MAP ||
+                            name == BuiltinNames.SET) &&
+                        !IsStaticCollectionType(memberType);
                 }
                 const curFuncCtx = this.wasmComp.currentFuncCtx;
                 this.wasmComp.currentFuncCtx = this.wasmComp.globalInitFuncCtx;
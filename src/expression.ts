@@ -528,6 +528,34 @@ export default class ExpressionProcessor {
                 res.setExprType(this.typeResolver.generateNodeType(node));
                 break;
             }
+            case ts.SyntaxKind.RegularExpressionLiteral: {
+                /* /source/flags is compiled as new RegExp(source, flags),
+                    the source is kept raw since it is parsed by libregexp */
+                const text = (<ts.RegularExpressionLiteral>node).text;
+                const flagsStart = text.lastIndexOf('/');
+                const sourceExpr = new StringLiteralExpression(
+                    text.slice(1, flagsStart),
+                );
+                const flagsExpr = new StringLiteralExpression(
+                    text.slice(flagsStart + 1),
+                );
+                sourceExpr.setExprType(builtinTypes.get('string')!);
+                flagsExpr.setExprType(builtinTypes.get('string')!);
+                /* the RegExp interface and the RegExp var share the symbol */
+                const ctorExpr = new IdentifierExpression('RegExp');
+                const symbol =
+                    this.parserCtx.typeChecker!.getTypeAtLocation(node).symbol;
+                if (symbol && symbol.valueDeclaration) {
+                    ctorExpr.setExprType(
+                        this.typeResolver.generateNodeType(
+                            symbol.valueDeclaration,
+                        ),
+                    );
+                }
+                res = new NewExpression(ctorExpr, [sourceExpr, flagsExpr]);
+                res.setExprType(this.typeResolver.generateNodeType(node));
+                break;
+            }
             case ts.SyntaxKind.FalseKeyword: {
                 res = new FalseLiteralExpression();
                 res.setExprType(this.typeResolver.generateNodeType(node));
@@ -17,6 +17,7 @@ import {
 } from './value_types.js';
 import { DefaultTypeId, PredefinedTypeId } from '../utils.js';
 import { ObjectDescription, ObjectDescriptionType, Shape } from './runtime.js';
+import { getConfig } from '../../config/config_mgr.js';
 
 export function IsBuiltInObjectType(kind: ValueTypeKind): boolean {
     return (
@@ -169,8 +170,157 @@ export const builtin_objects: { [key: string]: ObjectInfo } = {
         inst_name: 'DataView',
         class_name: 'DataViewConstructor',
     },
+    Float64Array: {
+        type: ObjectDescriptionType.OBJECT_INSTANCE,
+        id: PredefinedTypeId.FLOAT64ARRAY,
+        inst_name: 'Float64Array',
+        class_name: 'Float64ArrayConstructor',
+        has_generic: false,
+    },
+    Float64ArrayConstructor: {
+        type: ObjectDescriptionType.OBJECT_CLASS,
+        id: PredefinedTypeId.FLOAT64ARRAY_CONSTRUCTOR,
+        inst_name: 'Float64Array',
+        class_name: 'Float64ArrayConstructor',
+    },
+    Float32Array: {
+        type: ObjectDescriptionType.OBJECT_INSTANCE,
+        id: PredefinedTypeId.FLOAT32ARRAY,
+        inst_name: 'Float32Array',
+        class_name: 'Float32ArrayConstructor',
+        has_generic: false,
+    },
+    Float32ArrayConstructor: {
+        type: ObjectDescriptionType.OBJECT_CLASS,
+        id: PredefinedTypeId.FLOAT32ARRAY_CONSTRUCTOR,
+        inst_name: 'Float32Array',
+        class_name: 'Float32ArrayConstructor',
+    },
+    Int32Array: {
+        type: ObjectDescriptionType.OBJECT_INSTANCE,
+        id: PredefinedTypeId.INT32ARRAY,
+        inst_name: 'Int32Array',
+        class_name: 'Int32ArrayConstructor',
+        has_generic: false,
+    },
+    Int32ArrayConstructor: {
+        type: ObjectDescriptionType.OBJECT_CLASS,
+        id: PredefinedTypeId.INT32ARRAY_CONSTRUCTOR,
+        inst_name: 'Int32Array',
+        class_name: 'Int32ArrayConstructor',
+    },
+    Uint32Array: {
+        type: ObjectDescriptionType.OBJECT_INSTANCE,
+        id: PredefinedTypeId.UINT32ARRAY,
+        inst_name: 'Uint32Array',
+        class_name: 'Uint32ArrayConstructor',
+        has_generic: false,
+    },
+    Uint32ArrayConstructor: {
+        type: ObjectDescriptionType.OBJECT_CLASS,
+        id: PredefinedTypeId.UINT32ARRAY_CONSTRUCTOR,
+        inst_name: 'Uint32Array',
+        class_name: 'Uint32ArrayConstructor',
+    },
+    Int16Array: {
+        type: ObjectDescriptionType.OBJECT_INSTANCE,
+        id: PredefinedTypeId.INT16ARRAY,
+        inst_name: 'Int16Array',
+        class_name: 'Int16ArrayConstructor',
+        has_generic: false,
+    },
+    Int16ArrayConstructor: {
+        type: ObjectDescriptionType.OBJECT_CLASS,
+        id: PredefinedTypeId.INT16ARRAY_CONSTRUCTOR,
+        inst_name: 'Int16Array',
+        class_name: 'Int16ArrayConstructor',
+    },
+    Uint8Array: {
+        type: ObjectDescriptionType.OBJECT_INSTANCE,
+        id: PredefinedTypeId.UINT8ARRAY,
+        inst_name: 'Uint8Array',
+        class_name: 'Uint8ArrayConstructor',
+        has_generic: false,
+    },
+    Uint8ArrayConstructor: {
+        type: ObjectDescriptionType.OBJECT_CLASS,
+        id: PredefinedTypeId.UINT8ARRAY_CONSTRUCTOR,
+        inst_name: 'Uint8Array',
+        class_name: 'Uint8ArrayConstructor',
+    },
+    Uint8ClampedArray: {
+        type: ObjectDescriptionType.OBJECT_INSTANCE,
+        id: PredefinedTypeId.UINT8CLAMPEDARRAY,
+        inst_name: 'Uint8ClampedArray',
+        class_name: 'Uint8ClampedArrayConstructor',
+        has_generic: false,
+    },
+    Uint8ClampedArrayConstructor: {
+        type: ObjectDescriptionType.OBJECT_CLASS,
+        id: PredefinedTypeId.UINT8CLAMPEDARRAY_CONSTRUCTOR,
+        inst_name: 'Uint8ClampedArray',
+        class_name: 'Uint8ClampedArrayConstructor',
+    },
+    RegExp: {
+        type: ObjectDescriptionType.OBJECT_INSTANCE,
+        id: PredefinedTypeId.REGEXP,
+        inst_name: 'RegExp',
+        class_name: 'RegExpConstructor',
+        has_generic: false,
+    },
+    RegExpConstructor: {
+        type: ObjectDescriptionType.OBJECT_CLASS,
+        id: PredefinedTypeId.REGEXP_CONSTRUCTOR,
+        inst_name: 'RegExp',
+        class_name: 'RegExpConstructor',
+    },
 };
 
+function isStaticCollectionKeyType(type: ValueType) {
+    switch (type.kind) {
+        case ValueTypeKind.NUMBER:
+            return true;
+        case ValueTypeKind.STRING:
+        case ValueTypeKind.RAW_STRING:
+            /* string keys are hashed over the payload of the string struct */
+            return !getConfig().enableStringRef;
+        case ValueTypeKind.OBJECT: {
+            /* class instances are compared by identity */
+            const meta = (type as ObjectType).meta;
+            return !meta.isBuiltin && !meta.isInterface;
+        }
+        default:
+            return false;
+    }
+}
+
+/* Map<K, V> and Set<K> are compiled to wasm structs when the key type is
+    known, otherwise they still fallback to libdyntype */
+export function IsStaticCollectionType(type: ValueType): boolean {
+    if (!(type instanceof ObjectType)) {
+        return false;
+    }
+    const name = type.meta.name;
+    if (name !== 'Map' && name !== 'Set') {
+        return false;
+    }
+    const typeArgs = type.specialTypeArguments;
+    if (!typeArgs || typeArgs.length == 0) {
+        return false;
+    }
+    if (!isStaticCollectionKeyType(typeArgs[0])) {
+        return false;
+    }
+    if (name === 'Map') {
+        return (
+            typeArgs.length > 1 &&
+            typeArgs[1].kind !== ValueTypeKind.TYPE_PARAMETER &&
+            typeArgs[1].kind !== ValueTypeKind.GENERIC
+        );
+    }
+    return true;
+}
+
 export function IsBuiltinObject(name: string): boolean {
     return builtin_objects[name] != undefined;
 }
@@ -169,7 +169,11 @@ import {
     SymbolValue,
 } from './builder_context.js';
 
-import { GetShapeFromType, builtinTypes } from './builtin.js';
+import {
+    GetShapeFromType,
+    IsStaticCollectionType,
+    builtinTypes,
+} from './builtin.js';
 
 import {
     MemberType,
@@ -452,6 +456,25 @@ function buildPropertyAccessExpression(
         own = (own as VarValue).copy();
     }
 
+    /* Map and Set without static key type still fallback to libdyntype */
+    if (
+        own.type instanceof ObjectType &&
+        (own.type.meta.name == BuiltinNames.MAP ||
+            own.type.meta.name == BuiltinNames.SET) &&
+        !IsStaticCollectionType(own.type)
+    ) {
+        return createDynamicAccess(
+            new CastValue(
+                SemanticsValueKind.OBJECT_CAST_ANY,
+                Primitive.Any,
+                own,
+            ),
+            member_name,
+            member_as_write,
+            isMethodCall,
+        );
+    }
+
     const shape = own.shape;
     if (!shape || own.type.kind == ValueTypeKind.ANY) {
         Logger.warn(`WARNING Type has null shape ${type}, use dynamic Access`);
@@ -2284,6 +2307,28 @@ function buildCallExpression(
     if (func instanceof ToStringValue) {
         return func;
     }
+    if (
+        func.type.kind == ValueTypeKind.OBJECT &&
+        (func.type as ObjectType).meta.name == BuiltinNames.NUMBERCONSTRCTOR
+    ) {
+        /* Number(value) is a conversion rather than a call for primitive
+            arguments, other values (e.g. any) keep the dynamic call since
+            the cast of any to number traps on non-numbers */
+        if (expr.callArgs.length == 0) {
+            return new LiteralValue(Primitive.Number, 0);
+        }
+        const argKind = expr.callArgs[0].exprType.kind;
+        if (
+            argKind == TypeKind.STRING ||
+            argKind == TypeKind.NUMBER ||
+            argKind == TypeKind.BOOLEAN
+        ) {
+            context.pushReference(ValueReferenceKind.RIGHT);
+            const arg = buildExpression(expr.callArgs[0], context);
+            context.popReference();
+            return newCastValue(Primitive.Number, arg);
+        }
+    }
     if (func.kind === SemanticsValueKind.DYNAMIC_GET) {
         const p = func as MemberGetValue;
         if (
@@ -2855,6 +2900,15 @@ function buildUnaryExpression(
     const operand = buildExpression(expr.operand, context);
     context.popReference();
 
+    if (
+        expr.operatorKind == ts.SyntaxKind.PlusToken &&
+        (operand.type.kind == ValueTypeKind.STRING ||
+            operand.type.kind == ValueTypeKind.RAW_STRING)
+    ) {
+        /* +str ===> Number(str) */
+        return newCastValue(Primitive.Number, operand);
+    }
+
     let flattenExprValue: SemanticsValue | undefined;
     switch (expr.operatorKind) {
         case ts.SyntaxKind.PlusPlusToken:
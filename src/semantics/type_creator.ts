@@ -531,6 +531,23 @@ export function createObjectType(
             return createBuiltinObjectType(clazz, context);
         }
     }
+    /* e.g. Map<number, string>, the frontend creates a specialized class
+        without mangled name for generic builtin interfaces */
+    const genericOwner = clazz.genericOwner;
+    if (
+        genericOwner instanceof TSClass &&
+        genericOwner.mangledName.includes(
+            BuiltinNames.builtinTypeManglePrefix,
+        ) &&
+        IsBuiltinObject(genericOwner.className) &&
+        clazz.specializedArguments
+    ) {
+        createBuiltinObjectType(genericOwner, context);
+        return specializeBuiltinObjectType(
+            genericOwner.className,
+            clazz.specializedArguments.map((t) => createType(context, t)),
+        );
+    }
     let mangledName = clazz.mangledName;
     if (mangledName.length == 0) mangledName = clazz.className;
     const instName = mangledName;
@@ -676,6 +693,17 @@ function createBuiltinObjectType(
 
     context.objectDescriptions.set(obj_type.meta.name, obj_type.meta);
 
+    /* e.g. typed arrays, Array handles its index signature by ArrayType */
+    if (
+        obj_type.kind == ValueTypeKind.OBJECT &&
+        clazz.numberIndexType &&
+        !obj_type.numberIndexType
+    ) {
+        obj_type.setNumberIndexType(
+            createType(context, clazz.numberIndexType),
+        );
+    }
+
     handleRecType(context, clazz, obj_type);
 
     return obj_type;
@@ -36,6 +36,7 @@ import { ModifierKind, Variable, Parameter } from './variable.js';
 import {
     TSArray,
     TSClass,
+    TSTuple,
     Type,
     TypeKind,
     builtinTypes,
@@ -44,6 +45,7 @@ import {
 import { Logger } from './log.js';
 import { StatementError, UnimplementError } from './error.js';
 import { getConfig } from '../config/config_mgr.js';
+import { BuiltinNames } from '../lib/builtin/builtin_name.js';
 
 type StatementKind = ts.SyntaxKind;
 
@@ -1166,9 +1168,14 @@ export class StatementProcessor {
             ) as IdentifierExpression;
         }
 
-        const expr = this.parserCtx.expressionProcessor.visitNode(
+        let expr = this.parserCtx.expressionProcessor.visitNode(
             forOfStmtNode.expression,
         );
+        /* static Map and Set are iterated over a snapshot array */
+        const snapshotExpr = this.createCollectionSnapshot(expr, scope);
+        if (snapshotExpr) {
+            expr = snapshotExpr;
+        }
 
         const isStaticExpr =
             expr.exprType.kind === TypeKind.STRING ||
@@ -1373,6 +1380,90 @@ export class StatementProcessor {
         return forStatement;
     }
 
+    /* Map<K, V> and Set<K> with number, string or class instance keys are
+        compiled to wasm structs (see IsStaticCollectionType), for..of
+        iterates over the array returned by entries() or values() */
+    private createCollectionSnapshot(
+        expr: Expression,
+        scope: Scope,
+    ): Expression | undefined {
+        const exprType = expr.exprType;
+        if (!(exprType instanceof TSClass)) {
+            return undefined;
+        }
+        const genericOwner = exprType.genericOwner;
+        const typeArgs = exprType.specializedArguments;
+        if (
+            !(genericOwner instanceof TSClass) ||
+            !genericOwner.mangledName.includes(
+                BuiltinNames.builtinTypeManglePrefix,
+            ) ||
+            !typeArgs ||
+            typeArgs.length == 0
+        ) {
+            return undefined;
+        }
+        const isMap = genericOwner.className === BuiltinNames.MAP;
+        if (!isMap && genericOwner.className !== BuiltinNames.SET) {
+            return undefined;
+        }
+        const keyType = typeArgs[0];
+        const isStaticKey =
+            keyType.kind === TypeKind.NUMBER ||
+            (keyType.kind === TypeKind.STRING &&
+                !getConfig().enableStringRef) ||
+            (keyType instanceof TSClass &&
+                keyType.kind === TypeKind.CLASS &&
+                !keyType.mangledName.includes(
+                    BuiltinNames.builtinTypeManglePrefix,
+                ));
+        if (!isStaticKey) {
+            return undefined;
+        }
+        if (
+            isMap &&
+            (typeArgs.length < 2 ||
+                typeArgs[1].kind === TypeKind.TYPE_PARAMETER ||
+                typeArgs[1].kind === TypeKind.GENERIC)
+        ) {
+            return undefined;
+        }
+
+        let elemType: Type = keyType;
+        if (isMap) {
+            const entryType = new TSTuple();
+            entryType.addType(keyType);
+            entryType.addType(typeArgs[1]);
+            elemType = entryType;
+        }
+        const snapshotType = new TSArray(elemType);
+        const snapshotLabel = '@collection_snapshot';
+        const snapshotVar = new Variable(snapshotLabel, snapshotType);
+        scope.addVariable(snapshotVar);
+        const snapshotExpr = new IdentifierExpression(snapshotLabel);
+        snapshotExpr.setExprType(snapshotType);
+
+        const methodExpr = new IdentifierExpression(
+            isMap ? 'entries' : 'values',
+        );
+        methodExpr.setExprType(builtinTypes.get('any')!);
+        const methodAccessExpr = new PropertyAccessExpression(
+            expr,
+            methodExpr,
+        );
+        methodAccessExpr.setExprType(builtinTypes.get('any')!);
+        const methodCallExpr = new CallExpression(methodAccessExpr);
+        methodCallExpr.setExprType(snapshotType);
+        const assignExpr = new BinaryExpression(
+            ts.SyntaxKind.EqualsToken,
+            snapshotExpr,
+            methodCallExpr,
+        );
+        assignExpr.setExprType(snapshotType);
+        scope.addStatement(new ExpressionStatement(assignExpr));
+        return snapshotExpr;
+    }
+
     private convertForInToForLoop(
         forInStmtNode: ts.ForInStatement,
         scope: Scope,
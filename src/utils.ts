@@ -1731,6 +1731,22 @@ export enum PredefinedTypeId {
     ARRAYBUFFER_CONSTRUCTOR,
     DATAVIEW,
     DATAVIEW_CONSTRUCTOR,
+    FLOAT64ARRAY,
+    FLOAT64ARRAY_CONSTRUCTOR,
+    FLOAT32ARRAY,
+    FLOAT32ARRAY_CONSTRUCTOR,
+    INT32ARRAY,
+    INT32ARRAY_CONSTRUCTOR,
+    UINT32ARRAY,
+    UINT32ARRAY_CONSTRUCTOR,
+    INT16ARRAY,
+    INT16ARRAY_CONSTRUCTOR,
+    UINT8ARRAY,
+    UINT8ARRAY_CONSTRUCTOR,
+    UINT8CLAMPEDARRAY,
+    UINT8CLAMPEDARRAY_CONSTRUCTOR,
+    REGEXP,
+    REGEXP_CONSTRUCTOR,
     WASM_I64,
     WASM_F32,
     WASM_ARRAY,
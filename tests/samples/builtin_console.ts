@@ -20,3 +20,30 @@ export function specialNum() {
     console.log(b);
     console.log(c);
 }
+
+export function consoleLogTyped() {
+    const s = 'str';
+    const n = 0.1 + 0.2;
+    console.log(s, n, false, 1e21, 1.5e-7);
+    console.log();
+    console.log('', 'a');
+    console.log(2 ** 60, 100.78);
+}
+
+export function consoleError() {
+    /* written to stderr */
+    console.error('error', 1);
+    console.warn('warn', true);
+    console.log('done');
+}
+
+function logged(n: number) {
+    console.log('inner', n);
+    return n * 2;
+}
+
+export function consoleNestedLog() {
+    /* the inner line is written before the outer one starts */
+    console.log('outer', logged(1), logged(2));
+    console.log('next');
+}
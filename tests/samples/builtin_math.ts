@@ -53,3 +53,71 @@ export function mathNested() {
     const a = Math.pow(3, Math.abs(-3));
     return a;
 }
+
+export function mathPowFraction() {
+    const a = Math.pow(4, 0.5);
+    return a;
+}
+
+export function mathRound() {
+    console.log(Math.round(2.5));
+    console.log(Math.round(-2.5));
+    console.log(Math.round(0.49999999999999994));
+    console.log(Math.round(-3.7));
+}
+
+export function mathSign() {
+    console.log(Math.sign(-5));
+    console.log(Math.sign(8));
+    console.log(Math.sign(0));
+}
+
+export function mathTruncAndFround() {
+    console.log(Math.trunc(-3.7));
+    console.log(Math.fround(5.5));
+}
+
+export function mathExpLog() {
+    console.log(Math.exp(0));
+    console.log(Math.log(1));
+    console.log(Math.log2(8));
+    console.log(Math.log10(1000));
+}
+
+export function mathTrigonometric() {
+    console.log(Math.sin(0));
+    console.log(Math.cos(0));
+    console.log(Math.atan2(0, 1));
+}
+
+export function mathHypot() {
+    const a = 3;
+    const b = 4;
+    console.log(Math.hypot(a, b));
+    console.log(Math.hypot(2, 3, 6));
+    console.log(Math.hypot());
+}
+
+export function mathMaxMinWithTwoOrThreeOperands() {
+    const a = 3;
+    const b = 7;
+    console.log(Math.max(a, b));
+    console.log(Math.min(a, b));
+    console.log(Math.max(a, b, 5));
+    console.log(Math.min(a, b, 1));
+}
+
+export function mathMaxMinSignedZero() {
+    /* 4 operands take the variadic path, +0 is larger than -0, the
+        negative zero is computed since -0 is lowered to 0 - 0 */
+    const nz = 0 * -1;
+    console.log(1 / Math.max(nz, 0, nz, -1));
+    console.log(1 / Math.max(nz, nz, -1, -2));
+    console.log(1 / Math.min(0, nz, 0, 1));
+    console.log(1 / Math.min(0, 0, 1, 2));
+}
+
+export function mathRandom() {
+    const a = Math.random();
+    return a >= 0 && a < 1;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+export function numberParseFloat() {
+    console.log(parseFloat('3.5')); // 3.5
+    console.log(parseFloat('  -12.25px')); // -12.25
+    console.log(Number.parseFloat('.5e3')); // 500
+    console.log(parseFloat('1e-2') === 0.01); // true
+    console.log(parseFloat('0.1') + parseFloat('0.2') === 0.1 + 0.2); // true
+    console.log(parseFloat('Infinityx') === Infinity); // true
+    const nan = parseFloat('px');
+    console.log(nan !== nan); // true
+}
+
+export function numberParseInt() {
+    console.log(parseInt('42')); // 42
+    console.log(parseInt('  -17.9')); // -17
+    console.log(parseInt('0x1F')); // 31
+    console.log(parseInt('ff', 16)); // 255
+    console.log(Number.parseInt('101', 2)); // 5
+    console.log(parseInt('z', 36)); // 35
+    console.log(parseInt('9007199254740993') === 9007199254740992); // true
+    const nan = parseInt('12', 1);
+    console.log(nan !== nan); // true
+}
+
+export function numberFromString() {
+    const header = ' 8080 ';
+    const port = Number(header);
+    console.log(port + 1); // 8081
+    console.log(+'0b1010'); // 10
+    console.log(+'0o17'); // 15
+    console.log(Number('')); // 0
+    console.log(Number('-2.5e2')); // -250
+    console.log(Number() + 1); // 1
+    const nan = Number('12px');
+    console.log(nan !== nan); // true
+    let total = 0;
+    const fields = ['1', '2.5', '3'];
+    for (let i = 0; i < fields.length; i++) {
+        total += +fields[i];
+    }
+    console.log(total); // 6.5
+}
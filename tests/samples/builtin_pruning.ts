@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/* Compiled without --keepUnusedBuiltins, the unreachable builtins are
+    removed, but the natives still find allocExtRefTableSlot,
+    freeExtRefTableSlot and find_property_flag_and_index by name */
+
+class Point {
+    constructor(public x: number, public y: number) {}
+}
+
+export function prunedWorker() {
+    onMessage((message: any) => {
+        const p = message as Point;
+        postMessage(p.x + p.y);
+        closeWorker();
+    });
+}
+
+export function prunedTimerAndWorker() {
+    const point = new Point(3, 4);
+    const boxed: any = point;
+    console.log(boxed.y); // 4
+    const worker = createWorker('prunedWorker');
+    workerOnMessage(worker, (message: any) => {
+        console.log(message);
+    });
+    setTimeout(() => {
+        console.log('timeout ' + point.x);
+        workerPostMessage(worker, point);
+    }, 0);
+
+    /* Output:
+    4
+    timeout 3
+    7
+    */
+}
@@ -132,6 +132,18 @@ export function stringtrim() {
     console.log(b);
 }
 
+export function stringCaseTrimUnchanged() {
+    const lower = 'content-type';
+    console.log(lower.toLowerCase()); // content-type
+    console.log(lower.toUpperCase()); // CONTENT-TYPE
+    console.log('X-Request-ID: 42'.toLowerCase()); // x-request-id: 42
+    console.log(''.toUpperCase().length); // 0
+    console.log('[' + 'keep'.trim() + ']'); // [keep]
+    console.log('[' + '\t value\r\n'.trim() + ']'); // [value]
+    console.log('   '.trim().length); // 0
+    console.log(''.trim().length); // 0
+}
+
 export function stringreadonly() {
     const a: string = 'hello';
     let b: string = a[1];
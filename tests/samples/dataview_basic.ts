@@ -158,3 +158,19 @@ export function dataViewF64() {
     console.log(d.getFloat32(0)); // -1.8125
     console.log(d.getFloat64(0)); // -0.75
 }
+
+export function dataViewUnalignedFrame() {
+    const a = new ArrayBuffer(16);
+    const d = new DataView(a, 1, 15);
+    d.setUint16(0, 43981);
+    d.setUint32(2, 305419896, true);
+    d.setFloat64(6, 1.5);
+    d.setInt8(14, -1);
+    console.log(d.getUint8(0)); // 171
+    console.log(d.getUint16(0, true)); // 52651
+    console.log(d.getUint8(2)); // 120
+    console.log(d.getUint32(2)); // 2018915346
+    console.log(d.getUint8(6)); // 63
+    console.log(d.getFloat64(6)); // 1.5
+    console.log(d.getInt8(14)); // -1
+}
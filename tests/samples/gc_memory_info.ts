@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+export function gcMemoryInfo() {
+    const info = getGCMemoryInfo();
+    const limit = info.heapSizeLimit as number;
+    const used = info.usedHeapSize as number;
+    const peak = info.peakHeapSize as number;
+    console.log(limit > 0);
+    console.log(used <= limit);
+    console.log(peak >= used);
+    console.log((info.collections as number) >= 0);
+
+    /* Output:
+    true
+    true
+    true
+    true
+    */
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+class Node {
+    constructor(public value: number, public next: Node | null) {}
+}
+
+export function heapSnapshotWrite() {
+    let list: Node | null = null;
+    for (let i = 0; i < 10; i++) {
+        list = new Node(i, list);
+    }
+    const dyn: any = { list: list };
+    writeHeapSnapshot('/tmp/heap_snapshot_sample.heapsnapshot');
+    console.log((dyn.list as Node).value);
+
+    /* Output:
+    9
+    */
+}
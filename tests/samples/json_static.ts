@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+class Point {
+    x = 0;
+    y = 0;
+}
+
+class User {
+    id = 0;
+    name = '';
+    active = false;
+    scores: number[] = [];
+    home: Point = new Point();
+}
+
+export function jsonStringifyClass() {
+    const u = new User();
+    u.id = 42;
+    u.name = 'Ann "the" \\ coder\n';
+    u.active = true;
+    u.scores = [1, -2.5, 1e21, NaN];
+    u.home.x = -0;
+    u.home.y = 123456789;
+    console.log(JSON.stringify(u)); // {"id":42,"name":"Ann \"the\" \\ coder\n","active":true,"scores":[1,-2.5,1e+21,null],"home":{"x":0,"y":123456789}}
+    const s: string = JSON.stringify(u.home);
+    console.log(s.length); // 21
+}
+
+export function jsonStringifyLiteral() {
+    const obj = {
+        tag: 'ctl\u0001',
+        flags: [true, false],
+        empty: [] as number[],
+    };
+    console.log(JSON.stringify(obj)); // {"tag":"ctl\u0001","flags":[true,false],"empty":[]}
+    console.log(JSON.stringify([0.1, 2, 3])); // [0.1,2,3]
+}
+
+export function jsonParseClass() {
+    const text =
+        ' { "name": "B\\u006fb\\"", "id": 7, "extra": {"a": [1, {"b": "]"}]}, "scores": [3, 0.25, -1e3, 1.5e300], "active": false, "home": {"y": 2, "x": 1} } ';
+    const u = JSON.parse(text) as User;
+    console.log(u.id); // 7
+    console.log(u.name); // Bob"
+    console.log(u.active); // false
+    console.log(u.scores.length); // 4
+    console.log(u.scores[2]); // -1000
+    console.log(u.scores[3]); // 1.5e+300
+    console.log(u.home.x + u.home.y); // 3
+}
+
+export function jsonRoundTrip() {
+    const p = new Point();
+    p.x = 10;
+    p.y = 20;
+    const q = JSON.parse(JSON.stringify(p) as string) as Point;
+    console.log(q.x * q.y); // 200
+    const u = JSON.parse(
+        '{"id":1,"name":"n","active":true,"scores":[],"home":null}',
+    ) as User;
+    console.log(u.home === null); // true
+    console.log(JSON.stringify(u)); // {"id":1,"name":"n","active":true,"scores":[],"home":null}
+}
+
+function tryParsePoint(text: string) {
+    try {
+        const p = JSON.parse(text) as Point;
+        return p.x + p.y;
+    } catch (e) {
+        return -1;
+    }
+}
+
+export function jsonParseInvalid() {
+    console.log(tryParsePoint('{"x": 1, "y": 2}')); // 3
+    console.log(tryParsePoint('{"x": 1, "y": 2')); // -1
+    console.log(tryParsePoint('{"x": "1", "y": 2}')); // -1
+    console.log(tryParsePoint('{"x": 1} trailing')); // -1
+    console.log(tryParsePoint('')); // -1
+    let caught = false;
+    try {
+        const a = JSON.parse('[1, 2') as number[];
+        console.log(a.length);
+    } catch (e) {
+        caught = true;
+    }
+    console.log(caught); // true
+    /* the parser state is reset after an error */
+    console.log(tryParsePoint(' {"y": 5} ')); // 5
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+class Point {
+    constructor(public x: number, public y: number) {}
+}
+
+export function mapNumberKey() {
+    const m = new Map<number, string>();
+    m.set(1, 'one').set(2, 'two');
+    m.set(-0, 'zero');
+    m.set(NaN, 'nan');
+    console.log(m.size); // 4
+    console.log(m.get(2)); // two
+    console.log(m.get(0)); // zero
+    console.log(m.get(NaN)); // nan
+    console.log(m.has(3)); // false
+    m.set(1, 'uno');
+    console.log(m.get(1)); // uno
+    console.log(m.delete(2)); // true
+    console.log(m.delete(2)); // false
+    console.log(m.size); // 3
+}
+
+export function mapStringKey() {
+    const m = new Map<string, number>();
+    for (let i = 0; i < 100; i++) {
+        m.set('key' + i, i * 2);
+    }
+    console.log(m.size); // 100
+    console.log(m.get('key42')); // 84
+    for (let i = 0; i < 100; i += 2) {
+        m.delete('key' + i);
+    }
+    console.log(m.size); // 50
+    console.log(m.has('key42')); // false
+    console.log(m.get('key99')); // 198
+    m.clear();
+    console.log(m.size); // 0
+    console.log(m.has('key99')); // false
+}
+
+export function mapInsertAfterDelete() {
+    const m = new Map<number, number>();
+    for (let i = 0; i < 8; i++) {
+        m.set(i, i);
+    }
+    m.delete(1);
+    m.delete(3);
+    m.delete(5);
+    /* the entries are full, the rehash compacts them to 5 live ones */
+    for (let i = 8; i < 20; i++) {
+        m.set(i, i * 10);
+    }
+    console.log(m.size); // 17
+    console.log(m.has(3)); // false
+    console.log(m.get(4)); // 4
+    console.log(m.get(19)); // 190
+
+    const s = new Set<string>();
+    for (let i = 0; i < 8; i++) {
+        s.add('v' + i);
+    }
+    s.delete('v0');
+    s.delete('v1');
+    s.delete('v2');
+    for (let i = 8; i < 12; i++) {
+        s.add('v' + i);
+    }
+    console.log(s.size); // 9
+    console.log(s.has('v11')); // true
+}
+
+export function mapObjectKey() {
+    const a = new Point(1, 2);
+    const b = new Point(1, 2);
+    const m = new Map<Point, number>();
+    m.set(a, 10);
+    m.set(b, 20);
+    console.log(m.size); // 2
+    console.log(m.get(a)); // 10
+    console.log(m.get(b)); // 20
+    console.log(m.has(new Point(1, 2))); // false
+}
+
+export function mapIteration() {
+    const m = new Map<string, number>();
+    m.set('c', 3);
+    m.set('a', 1);
+    m.set('b', 2);
+    m.delete('a');
+    m.set('a', 4);
+    let res = '';
+    for (const e of m) {
+        res += e[0] + '=' + e[1] + ',';
+    }
+    console.log(res); // c=3,b=2,a=4,
+    const keys = m.keys();
+    const values = m.values();
+    console.log(keys.length); // 3
+    console.log(keys[2]); // a
+    console.log(values[0]); // 3
+}
+
+export function setStatic() {
+    const s = new Set<number>();
+    s.add(3).add(1).add(3);
+    s.add(2);
+    console.log(s.size); // 3
+    console.log(s.has(1)); // true
+    s.delete(1);
+    console.log(s.has(1)); // false
+    let sum = 0;
+    for (const v of s) {
+        sum = sum * 10 + v;
+    }
+    console.log(sum); // 32
+
+    const names = new Set<string>();
+    names.add('x');
+    names.add('y');
+    names.add('x');
+    console.log(names.size); // 2
+    console.log(names.values()[1]); // y
+}
+
+function anyToSize(c: any) {
+    return c.size;
+}
+
+function setToAny(s: Set<number>): any {
+    return s;
+}
+
+export function staticCollectionToAny() {
+    const m = new Map<number, string>();
+    m.set(1, 'one');
+    m.set(2, 'two');
+    m.delete(1);
+    m.set(3, 'three');
+    console.log(m); // [object Map]
+    const a: any = m;
+    console.log(anyToSize(m)); // 2
+    console.log(a.get(3)); // three
+    /* the dynamic Map is a copy */
+    m.set(4, 'four');
+    console.log(a.has(4)); // false
+    const s = new Set<number>();
+    s.add(7).add(8);
+    console.log(setToAny(s).has(8)); // true
+    const outer = new Map<number, Set<number>>();
+    outer.set(1, s);
+    const o: any = outer;
+    console.log(o.get(1).has(7)); // true
+}
+
+export function staticCollectionForEach() {
+    const m = new Map<number, string>();
+    m.set(2, 'b');
+    m.set(1, 'a');
+    m.set(3, 'c');
+    m.delete(1);
+    let res = '';
+    m.forEach((v, k) => {
+        res += k + '=' + v + ',';
+    });
+    console.log(res); // 2=b,3=c,
+    let sum = 0;
+    m.forEach((v: string, k: number, map: Map<number, string>) => {
+        sum += k * map.size;
+    });
+    console.log(sum); // 10
+    const s = new Set<number>();
+    s.add(5).add(6);
+    s.forEach((v: any) => {
+        console.log(v);
+    });
+    /* entries added by the callback are not visited */
+    s.forEach((v) => {
+        s.add(v * 10);
+    });
+    console.log(s.size); // 4
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+export function regexpTestExec() {
+    const re = /(\d+)-(\d+)/;
+    console.log(re.test('range 10-20')); // true
+    console.log(re.test('no range')); // false
+    const m = re.exec('from 2023-11 to 2024-01');
+    console.log(m.length); // 3
+    console.log(m[0]); // 2023-11
+    console.log(m[2]); // 11
+    console.log(re.source); // (\d+)-(\d+)
+    console.log(re.exec('none') === null); // true
+}
+
+export function regexpFlags() {
+    const re = new RegExp('ab+c', 'gi');
+    console.log(re.flags); // gi
+    console.log(re.global); // true
+    console.log(re.sticky); // false
+    console.log(re.test('xABBC abc')); // true
+    console.log(re.lastIndex); // 5
+    console.log(re.test('xABBC abc')); // true
+    console.log(re.lastIndex); // 9
+    console.log(re.test('xABBC abc')); // false
+    console.log(re.lastIndex); // 0
+    re.lastIndex = 6;
+    console.log(re.exec('xABBC abc')[0]); // abc
+}
+
+export function regexpStringMethods() {
+    const text = 'The quick brown fox jumps over the lazy dog';
+    const words = text.match(/\b\w{5}\b/g);
+    console.log(words.length); // 3
+    console.log(words[0] + ',' + words[1] + ',' + words[2]); // quick,brown,jumps
+    console.log(text.match(/cat/g) === null); // true
+    console.log(text.search(/o\w/)); // 12
+    console.log(text.search(/cat/)); // -1
+    console.log('2024-01-31'.replace(/(\d+)-(\d+)-(\d+)/, '$3/$2/$1')); // 31/01/2024
+    console.log('aaa'.replace(/a/g, '[$&]')); // [a][a][a]
+    console.log('x-y'.replace(/-/, "$$$`$'")); // x$xyy
+    const parts = 'a1b22c333d'.split(/\d+/);
+    console.log(parts.length); // 4
+    console.log(parts[3]); // d
+    const kept = 'a,b;c'.split(/([,;])/);
+    console.log(kept.length); // 5
+    console.log(kept[1] + kept[3]); // ,;
+    console.log(''.split(/x/).length); // 1
+}
+
+export function regexpMatchAll() {
+    const all = 'k1=v1&k2=v2'.matchAll(/(\w+)=(\w+)/g);
+    console.log(all.length); // 2
+    console.log(all[1][1]); // k2
+    console.log(all[1][2]); // v2
+    let total = 0;
+    for (let i = 0; i < 3; i++) {
+        /* the literal is compiled once and reused */
+        if (/^item\d$/.test('item' + i)) {
+            total++;
+        }
+    }
+    console.log(total); // 3
+}
+
+export function regexpUnmatchedGroup() {
+    /* groups which didn't participate give '', JavaScript gives undefined */
+    const m = /(a)|(b)/.exec('b');
+    console.log(m[1] === ''); // true
+    console.log(m[2]); // b
+    const found = 'b'.match(/(a)?b/);
+    console.log(found[1] === ''); // true
+    const parts = 'ab'.split(/(x)?b/);
+    console.log(parts.length); // 3
+    console.log(parts[1] === ''); // true
+    /* same as JavaScript, $n of an unmatched group is replaced by '' */
+    console.log('b'.replace(/(a)|(b)/, '[$1|$2]')); // [|b]
+}
+
+export function regexpDynamicPatterns() {
+    const kept = new RegExp('^k0$');
+    let hits = 0;
+    for (let i = 0; i < 200; i++) {
+        /* more patterns than the runtime keeps cached once unused */
+        const re = new RegExp('^k' + i + '$');
+        if (re.test('k' + i)) {
+            hits++;
+        }
+    }
+    console.log(hits); // 200
+    console.log(kept.test('k0')); // true
+    console.log(new RegExp('^k0$').test('k1')); // false
+}
+
+export function regexpUnicode() {
+    /* non-ASCII subjects are matched by character, offsets stay in bytes */
+    console.log(/^.$/.test('é')); // true
+    console.log(/É/i.test('é')); // true
+    console.log(/[é]+/.exec('cafée')[0]); // é
+    console.log('aéb'.search(/b/)); // 3
+    console.log(/^.$/u.test('😀')); // true
+    console.log(/^..$/.test('😀')); // true
+    const re = /é/g;
+    re.test('aéé');
+    console.log(re.lastIndex); // 3
+    re.test('aéé');
+    console.log(re.lastIndex); // 5
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+export function timerOrder() {
+    setTimeout(() => {
+        console.log('timeout 20');
+    }, 20);
+    setTimeout(() => {
+        console.log('timeout 0');
+    }, 0);
+    const cancelled = setTimeout(() => {
+        console.log('cancelled');
+    }, 10);
+    clearTimeout(cancelled);
+    Promise.resolve(1).then((res: number) => {
+        console.log('microtask');
+    });
+    console.log('sync');
+
+    /* Output:
+    sync
+    microtask
+    timeout 0
+    timeout 20
+    */
+}
+
+export function timerInterval() {
+    let count = 0;
+    const id = setInterval(() => {
+        count++;
+        console.log(count);
+        if (count === 3) {
+            clearInterval(id);
+        }
+    }, 1);
+
+    /* Output:
+    1
+    2
+    3
+    */
+}
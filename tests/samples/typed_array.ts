@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+export function typedArrayBasic() {
+    const f = new Float64Array(4);
+    f[0] = 1.5;
+    f[3] = f[0] * 2;
+    console.log(f.length);
+    console.log(f[0]);
+    console.log(f[1]);
+    console.log(f[3]);
+    console.log(f[4]); // NaN
+}
+
+export function typedArrayConversion() {
+    const i32 = new Int32Array(2);
+    i32[0] = 3.7;
+    i32[1] = 4294967297;
+    console.log(i32[0]); // 3
+    console.log(i32[1]); // 1
+    const u8 = new Uint8Array(2);
+    u8[0] = 257;
+    u8[1] = -1;
+    console.log(u8[0]); // 1
+    console.log(u8[1]); // 255
+    const c = new Uint8ClampedArray(3);
+    c[0] = 300;
+    c[1] = -5;
+    c[2] = 2.5;
+    console.log(c[0]); // 255
+    console.log(c[1]); // 0
+    console.log(c[2]); // 2
+    const i16 = new Int16Array(1);
+    i16[0] = 40000;
+    console.log(i16[0]); // -25536
+    const u32 = new Uint32Array(1);
+    u32[0] = -1;
+    console.log(u32[0]); // 4294967295
+    const f32 = new Float32Array(1);
+    f32[0] = 0.1;
+    console.log(f32[0] == 0.1); // false
+}
+
+export function typedArrayIndexRange() {
+    const t = new Int32Array(2);
+    t[0] = 7;
+    t[-1] = 5;
+    t[1.5] = 6;
+    t[4294967296] = 9;
+    console.log(t[0]); // 7
+    console.log(t[1]); // 0
+    console.log(t[-1]); // NaN
+    console.log(t[0.5]); // NaN
+    console.log(t[4294967296]); // NaN
+    console.log(t[-0]); // 7
+    /* ToInt32 wraps modulo 2^32 beyond the i64 range too */
+    t[0] = 2 ** 63 + 2 ** 12;
+    t[1] = -(2 ** 64) - 2 ** 13;
+    console.log(t[0]); // 4096
+    console.log(t[1]); // -8192
+    t[0] = 1e20;
+    console.log(t[0]); // 1661992960
+}
+
+export function typedArraySubarray() {
+    const a = new Int32Array(6);
+    for (let i = 0; i < a.length; i++) {
+        a[i] = i;
+    }
+    const s = a.subarray(2, -1);
+    console.log(s.length); // 3
+    console.log(s[0]); // 2
+    s[1] = 100;
+    console.log(a[3]); // 100
+    console.log(s.byteOffset); // 8
+    const t = s.subarray(1);
+    console.log(t[0]); // 100
+    console.log(t.length); // 2
+}
+
+export function typedArraySetFill() {
+    const a = new Uint8Array(6);
+    a.fill(7);
+    a.fill(9, 2, -2);
+    const b = new Uint8Array(2);
+    b[0] = 1;
+    b[1] = 2;
+    a.set(b, 4);
+    let str = '';
+    for (let i = 0; i < a.length; i++) {
+        str += a[i] + ',';
+    }
+    console.log(str); // 7,7,9,9,1,2,
+}
+
+export function typedArrayKinds() {
+    /* kinds sharing an element type are still told apart at runtime */
+    const bytes: any = new Uint8Array(2);
+    const clamped: any = new Uint8ClampedArray(2);
+    const words: any = new Uint32Array(2);
+    console.log(bytes instanceof Uint8Array); // true
+    console.log(bytes instanceof Uint8ClampedArray); // false
+    console.log(clamped instanceof Uint8ClampedArray); // true
+    console.log(clamped instanceof Uint8Array); // false
+    console.log(words instanceof Uint32Array); // true
+    console.log(words instanceof Int32Array); // false
+    const c = clamped as Uint8ClampedArray;
+    c[0] = 300;
+    console.log(c[0]); // 255
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+class Job {
+    constructor(public id: number, public values: number[]) {}
+
+    sum() {
+        let sum = 0;
+        for (let i = 0; i < this.values.length; i++) {
+            sum += this.values[i];
+        }
+        return sum;
+    }
+}
+
+export function workerSum() {
+    onMessage((message: any) => {
+        const job = message as Job;
+        postMessage(job.sum());
+        closeWorker();
+    });
+}
+
+export function workerBasic() {
+    const worker = createWorker('workerSum');
+    workerOnMessage(worker, (message: any) => {
+        console.log(message);
+    });
+    workerPostMessage(worker, new Job(1, [1, 2, 3, 4]));
+
+    /* Output:
+    10
+    */
+}
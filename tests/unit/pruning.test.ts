@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2023 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+import 'mocha';
+import { expect } from 'chai';
+import binaryen from 'binaryen';
+import path from 'path';
+import { fileURLToPath } from 'url';
+import { ParserContext } from '../../src/frontend.js';
+import { WASMGen } from '../../src/backend/binaryen/index.js';
+import { BuiltinNames } from '../../lib/builtin/builtin_name.js';
+import { setConfig } from '../../config/config_mgr.js';
+
+const SAMPLE = path.join(
+    path.dirname(fileURLToPath(import.meta.url)),
+    '../samples/builtin_pruning.ts',
+);
+
+interface ModuleSummary {
+    functions: number;
+    imports: string[];
+    exports: string[];
+}
+
+function compileSample(keepUnusedBuiltins: boolean): ModuleSummary {
+    setConfig({ opt: 0, keepUnusedBuiltins });
+    const parserCtx = new ParserContext();
+    parserCtx.parse([SAMPLE]);
+    const backend = new WASMGen(parserCtx);
+    backend.codegen();
+
+    const module = backend.module;
+    const summary: ModuleSummary = { functions: 0, imports: [], exports: [] };
+    for (let i = 0; i < module.getNumFunctions(); i++) {
+        const info = binaryen.getFunctionInfo(module.getFunctionByIndex(i));
+        if (info.module) {
+            summary.imports.push(info.base);
+        } else {
+            summary.functions++;
+        }
+    }
+    for (let i = 0; i < module.getNumExports(); i++) {
+        summary.exports.push(
+            binaryen.getExportInfo(module.getExportByIndex(i)).name,
+        );
+    }
+    backend.dispose();
+    setConfig({ keepUnusedBuiltins: false });
+    return summary;
+}
+
+describe('testPruning', function () {
+    this.timeout(60000);
+
+    it('dropUnusedBuiltinsAndImports', function () {
+        const kept = compileSample(true);
+        const pruned = compileSample(false);
+
+        expect(pruned.imports.length).lessThan(kept.imports.length);
+        expect(pruned.functions).lessThan(kept.functions);
+        expect(kept.imports).include(BuiltinNames.dataViewLoad16FuncName);
+        expect(pruned.imports).not.include(
+            BuiltinNames.dataViewLoad16FuncName,
+        );
+    });
+
+    it('keepFunctionsLookedUpByNatives', function () {
+        const pruned = compileSample(false);
+
+        expect(pruned.exports).include.members([
+            BuiltinNames.allocExtRefTableSlot,
+            BuiltinNames.freeExtRefTableSlot,
+            BuiltinNames.findPropertyFlagAndIndex,
+            'prunedWorker',
+        ]);
+        expect(pruned.imports).include.members([
+            'setTimeout',
+            'createWorker',
+            'workerPostMessage',
+        ]);
+    });
+});
@@ -9,6 +9,18 @@ function setWasmMemory(value) {
     wasmMemory = value;
 }
 
+/* identity hashes of Map/Set object keys */
+const refHashes = new WeakMap();
+let nextRefHash = 0;
+
+/* arguments of the line being written by the typed console natives,
+    indexed by stream (0: stdout, 1: stderr) */
+const consoleLines = [[], []];
+
+function consoleWrite(stream, str) {
+    consoleLines[stream].push(str);
+}
+
 const TAG_PROPERTY = '@tag';
 const REF_PROPERTY = '@ref';
 
@@ -91,6 +103,10 @@ const cstringToJsString = (offset) => {
     return string;
 };
 
+const dataViewNativeUnsupported = () => {
+    throw Error('DataView natives unsupported: compile with --byteDataView');
+};
+
 const importObject = {
     libstruct_indirect: {
         struct_get_indirect_i32: (obj, index) => {},
@@ -291,6 +307,34 @@ const importObject = {
             console.log(obj);
         },
         Console_constructor: (obj) => {},
+        Console_error: (obj) => {
+            console.error(obj);
+        },
+        Console_warn: (obj) => {
+            console.warn(obj);
+        },
+        Console_writeNumber: (stream, value) => {
+            consoleWrite(stream, String(value));
+        },
+        Console_writeBoolean: (stream, value) => {
+            consoleWrite(stream, String(!!value));
+        },
+        /** TODO: can't read the i8 array of the string */
+        Console_writeString: (stream, value) => {
+            consoleWrite(stream, '[string]');
+        },
+        Console_writeStringref: (stream, value) => {
+            consoleWrite(stream, value);
+        },
+        Console_writeEnd: (stream) => {
+            const args = consoleLines[stream];
+            consoleLines[stream] = [];
+            if (stream === 0) {
+                console.log(args.join(' '));
+            } else {
+                console.error(args.join(' '));
+            }
+        },
         strcmp(a, b) {
             let lhs = cstringToJsString(a);
             let rhs = cstringToJsString(b);
@@ -298,6 +342,56 @@ const importObject = {
         },
         setTimeout: (obj) => {},
         clearTimeout: (obj) => {},
+        setInterval: (obj) => {},
+        clearInterval: (obj) => {},
+        createWorker: (obj) => {},
+        workerPostMessage: (obj) => {},
+        workerOnMessage: (obj) => {},
+        terminateWorker: (obj) => {},
+        postMessage: (obj) => {},
+        onMessage: (obj) => {},
+        closeWorker: (obj) => {},
+        Math_pow: Math.pow,
+        Math_exp: Math.exp,
+        Math_log: Math.log,
+        Math_log2: Math.log2,
+        Math_log10: Math.log10,
+        Math_sin: Math.sin,
+        Math_cos: Math.cos,
+        Math_tan: Math.tan,
+        Math_asin: Math.asin,
+        Math_acos: Math.acos,
+        Math_atan: Math.atan,
+        Math_cbrt: Math.cbrt,
+        Math_atan2: Math.atan2,
+        Math_hypot: Math.hypot,
+        Math_random: Math.random,
+        /* the i8 array of the DataView can't be read from JS, modules run
+            here must be compiled with --byteDataView */
+        dataview_load_i16: dataViewNativeUnsupported,
+        dataview_load_i32: dataViewNativeUnsupported,
+        dataview_load_i64: dataViewNativeUnsupported,
+        dataview_store_i16: dataViewNativeUnsupported,
+        dataview_store_i32: dataViewNativeUnsupported,
+        dataview_store_i64: dataViewNativeUnsupported,
+        collection_ref_hash: (obj) => {
+            if (!refHashes.has(obj)) {
+                refHashes.set(obj, nextRefHash++);
+            }
+            return refHashes.get(obj);
+        },
+        regexp_compile: (source, flags) => {},
+        regexp_compile_dynamic: (source, flags) => {},
+        regexp_bind: (re, patternId) => {},
+        regexp_capture_count: (patternId) => {},
+        regexp_get_flags: (patternId) => {},
+        regexp_exec: (patternId, str, lastIndex, captures) => {},
+        Number_parseFloat: (str) => {},
+        Number_parseInt: (str, radix) => {},
+        Number_fromString: (str) => {},
+        Number_parseFloat_cstr: (str) => parseFloat(cstringToJsString(str)),
+        Number_parseInt_cstr: (str, radix) => parseInt(cstringToJsString(str), radix),
+        Number_fromString_cstr: (str) => Number(cstringToJsString(str)),
         malloc: (size)=>{},
         free: (size)=>{},
 